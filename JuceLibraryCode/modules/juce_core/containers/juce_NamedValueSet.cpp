@@ -46,8 +46,7 @@ NamedValueSet::NamedValue& NamedValueSet::NamedValue::operator= (const NamedValu
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 NamedValueSet::NamedValue::NamedValue (NamedValue&& other) noexcept
-    : nextListItem (static_cast <LinkedListPointer<NamedValue>&&> (other.nextListItem)),
-      name (static_cast <Identifier&&> (other.name)),
+    : name (static_cast <Identifier&&> (other.name)),
       value (static_cast <var&&> (other.value))
 {
 }
@@ -59,7 +58,6 @@ inline NamedValueSet::NamedValue::NamedValue (const Identifier& name_, var&& val
 
 NamedValueSet::NamedValue& NamedValueSet::NamedValue::operator= (NamedValue&& other) noexcept
 {
-    nextListItem = static_cast <LinkedListPointer<NamedValue>&&> (other.nextListItem);
     name = static_cast <Identifier&&> (other.name);
     value = static_cast <var&&> (other.value);
     return *this;
@@ -71,60 +69,80 @@ bool NamedValueSet::NamedValue::operator== (const NamedValueSet::NamedValue& oth
     return name == other.name && value == other.value;
 }
 
+//==============================================================================
+namespace NamedValueSetHelpers
+{
+    // Sets with fewer values than this are just searched linearly.
+    enum { minSizeForHashTable = 12 };
+
+    inline uint32 hashIdentifier (const Identifier& name) noexcept
+    {
+        // Identifiers are pooled, so the address of the string is all that needs hashing
+        const uint64 address = (uint64) (pointer_sized_int) name.getCharPointer().getAddress();
+        return (uint32) ((address * literal64bit (0x9e3779b97f4a7c15)) >> 32);
+    }
+}
+
 //==============================================================================
 NamedValueSet::NamedValueSet() noexcept
+    : hashTableSize (0)
 {
 }
 
 NamedValueSet::NamedValueSet (const NamedValueSet& other)
+    : values (other.values), hashTableSize (0)
 {
-    values.addCopyOfList (other.values);
+    rebuildHashTable();
 }
 
 NamedValueSet& NamedValueSet::operator= (const NamedValueSet& other)
 {
-    clear();
-    values.addCopyOfList (other.values);
+    if (this != &other)
+    {
+        values = other.values;
+        rebuildHashTable();
+    }
+
     return *this;
 }
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 NamedValueSet::NamedValueSet (NamedValueSet&& other) noexcept
-    : values (static_cast <LinkedListPointer<NamedValue>&&> (other.values))
+    : hashTableSize (other.hashTableSize)
 {
+    values.swapWithArray (other.values);
+    hashTable.swapWith (other.hashTable);
+    other.hashTableSize = 0;
 }
 
 NamedValueSet& NamedValueSet::operator= (NamedValueSet&& other) noexcept
 {
-    other.values.swapWith (values);
+    values.swapWithArray (other.values);
+    hashTable.swapWith (other.hashTable);
+    std::swap (hashTableSize, other.hashTableSize);
     return *this;
 }
 #endif
 
 NamedValueSet::~NamedValueSet()
 {
-    clear();
 }
 
 void NamedValueSet::clear()
 {
-    values.deleteAll();
+    values.clear();
+    hashTable.free();
+    hashTableSize = 0;
 }
 
 bool NamedValueSet::operator== (const NamedValueSet& other) const
 {
-    const NamedValue* i1 = values;
-    const NamedValue* i2 = other.values;
+    const int num = jmin (values.size(), other.values.size());
 
-    while (i1 != nullptr && i2 != nullptr)
-    {
-        if (! (*i1 == *i2))
+    for (int i = 0; i < num; ++i)
+        if (! (values.getReference (i) == other.values.getReference (i)))
             return false;
 
-        i1 = i1->nextListItem;
-        i2 = i2->nextListItem;
-    }
-
     return true;
 }
 
@@ -138,13 +156,87 @@ int NamedValueSet::size() const noexcept
     return values.size();
 }
 
-const var& NamedValueSet::operator[] (const Identifier& name) const
+//==============================================================================
+int NamedValueSet::indexOf (const Identifier& name) const noexcept
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
-        if (i->name == name)
-            return i->value;
+    if (hashTableSize > 0)
+    {
+        for (uint32 slot = NamedValueSetHelpers::hashIdentifier (name);; ++slot)
+        {
+            const int index = hashTable [slot & (uint32) (hashTableSize - 1)] - 1;
 
-    return var::null;
+            if (index < 0 || values.getReference (index).name == name)
+                return index;
+        }
+    }
+
+    const int numValues = values.size();
+
+    if (numValues > 0)
+    {
+        const NamedValue* const v = &values.getReference (0);
+
+        for (int i = 0; i < numValues; ++i)
+            if (v[i].name == name)
+                return i;
+    }
+
+    return -1;
+}
+
+void NamedValueSet::valueAdded()
+{
+    const int numValues = values.size();
+
+    if (numValues < NamedValueSetHelpers::minSizeForHashTable)
+        return;
+
+    // (the table is kept at most half full, so that the probe sequences stay short)
+    if (numValues * 2 > hashTableSize)
+    {
+        rebuildHashTable();
+    }
+    else
+    {
+        uint32 slot = NamedValueSetHelpers::hashIdentifier (values.getReference (numValues - 1).name);
+
+        while (hashTable [slot & (uint32) (hashTableSize - 1)] != 0)
+            ++slot;
+
+        hashTable [slot & (uint32) (hashTableSize - 1)] = numValues;
+    }
+}
+
+void NamedValueSet::rebuildHashTable()
+{
+    const int numValues = values.size();
+
+    if (numValues < NamedValueSetHelpers::minSizeForHashTable)
+    {
+        hashTable.free();
+        hashTableSize = 0;
+        return;
+    }
+
+    hashTableSize = nextPowerOfTwo (numValues * 4);
+    hashTable.calloc ((size_t) hashTableSize);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        uint32 slot = NamedValueSetHelpers::hashIdentifier (values.getReference (i).name);
+
+        while (hashTable [slot & (uint32) (hashTableSize - 1)] != 0)
+            ++slot;
+
+        hashTable [slot & (uint32) (hashTableSize - 1)] = i + 1;
+    }
+}
+
+//==============================================================================
+const var& NamedValueSet::operator[] (const Identifier& name) const
+{
+    const int index = indexOf (name);
+    return index >= 0 ? values.getReference (index).value : var::null;
 }
 
 var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultReturnValue) const
@@ -155,123 +247,175 @@ var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultRet
 
 var* NamedValueSet::getVarPointer (const Identifier& name) const noexcept
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
-        if (i->name == name)
-            return &(i->value);
-
-    return nullptr;
+    const int index = indexOf (name);
+    return index >= 0 ? &(values.getReference (index).value) : nullptr;
 }
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 bool NamedValueSet::set (const Identifier& name, var&& newValue)
 {
-    LinkedListPointer<NamedValue>* i = &values;
+    const int index = indexOf (name);
 
-    while (i->get() != nullptr)
+    if (index >= 0)
     {
-        NamedValue* const v = i->get();
+        var& v = values.getReference (index).value;
 
-        if (v->name == name)
-        {
-            if (v->value.equalsWithSameType (newValue))
-                return false;
-
-            v->value = static_cast <var&&> (newValue);
-            return true;
-        }
+        if (v.equalsWithSameType (newValue))
+            return false;
 
-        i = &(v->nextListItem);
+        v = static_cast <var&&> (newValue);
+        return true;
     }
 
-    i->insertNext (new NamedValue (name, static_cast <var&&> (newValue)));
+    values.add (NamedValue (name, static_cast <var&&> (newValue)));
+    valueAdded();
     return true;
 }
 #endif
 
 bool NamedValueSet::set (const Identifier& name, const var& newValue)
 {
-    LinkedListPointer<NamedValue>* i = &values;
+    const int index = indexOf (name);
 
-    while (i->get() != nullptr)
+    if (index >= 0)
     {
-        NamedValue* const v = i->get();
-
-        if (v->name == name)
-        {
-            if (v->value.equalsWithSameType (newValue))
-                return false;
+        var& v = values.getReference (index).value;
 
-            v->value = newValue;
-            return true;
-        }
+        if (v.equalsWithSameType (newValue))
+            return false;
 
-        i = &(v->nextListItem);
+        v = newValue;
+        return true;
     }
 
-    i->insertNext (new NamedValue (name, newValue));
+    values.add (NamedValue (name, newValue));
+    valueAdded();
     return true;
 }
 
 bool NamedValueSet::contains (const Identifier& name) const
 {
-    return getVarPointer (name) != nullptr;
+    return indexOf (name) >= 0;
 }
 
 bool NamedValueSet::remove (const Identifier& name)
 {
-    LinkedListPointer<NamedValue>* i = &values;
-
-    for (;;)
-    {
-        NamedValue* const v = i->get();
+    const int index = indexOf (name);
 
-        if (v == nullptr)
-            break;
+    if (index < 0)
+        return false;
 
-        if (v->name == name)
-        {
-            delete i->removeNext();
-            return true;
-        }
-
-        i = &(v->nextListItem);
-    }
-
-    return false;
+    values.remove (index);
+    rebuildHashTable();
+    return true;
 }
 
 const Identifier NamedValueSet::getName (const int index) const
 {
-    const NamedValue* const v = values[index];
-    jassert (v != nullptr);
-    return v->name;
+    jassert (isPositiveAndBelow (index, values.size()));
+    return values [index].name;
 }
 
 const var& NamedValueSet::getValueAt (const int index) const
 {
-    const NamedValue* const v = values[index];
-    jassert (v != nullptr);
-    return v->value;
+    if (isPositiveAndBelow (index, values.size()))
+        return values.getReference (index).value;
+
+    jassertfalse;
+    return var::null;
 }
 
 void NamedValueSet::setFromXmlAttributes (const XmlElement& xml)
 {
     clear();
-    LinkedListPointer<NamedValue>::Appender appender (values);
 
     const int numAtts = xml.getNumAttributes(); // xxx inefficient - should write an att iterator..
+    values.ensureStorageAllocated (numAtts);
 
     for (int i = 0; i < numAtts; ++i)
-        appender.append (new NamedValue (xml.getAttributeName (i), var (xml.getAttributeValue (i))));
+        values.add (NamedValue (xml.getAttributeName (i), var (xml.getAttributeValue (i))));
+
+    rebuildHashTable();
 }
 
 void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
+    for (int i = 0; i < values.size(); ++i)
     {
-        jassert (! i->value.isObject()); // DynamicObjects can't be stored as XML!
+        const NamedValue& v = values.getReference (i);
+
+        jassert (! v.value.isObject()); // DynamicObjects can't be stored as XML!
 
-        xml.setAttribute (i->name.toString(),
-                          i->value.toString());
+        xml.setAttribute (v.name.toString(),
+                          v.value.toString());
     }
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NamedValueSetTests  : public UnitTest
+{
+public:
+    NamedValueSetTests() : UnitTest ("NamedValueSet") {}
+
+    static Identifier getName (const int i)     { return Identifier ("name" + String (i)); }
+
+    void checkSet (const NamedValueSet& set, const int numValues)
+    {
+        expectEquals (set.size(), numValues);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            expect (set.getName (i) == getName (i));
+            expect (set [getName (i)] == var (i));
+            expect (set.contains (getName (i)));
+        }
+
+        expect (! set.contains (getName (numValues)));
+        expect (set [getName (numValues)].isVoid());
+    }
+
+    void runTest()
+    {
+        beginTest ("Basics");
+
+        // (these sizes span the point where the hash table gets used)
+        for (int size = 0; size < 40; size += 3)
+        {
+            NamedValueSet set;
+
+            for (int i = 0; i < size; ++i)
+                expect (set.set (getName (i), i));
+
+            checkSet (set, size);
+
+            for (int i = 0; i < size; ++i)
+                expect (! set.set (getName (i), i));
+
+            const NamedValueSet copy (set);
+            checkSet (copy, size);
+            expect (copy == set);
+
+            if (size > 0)
+            {
+                expect (set.remove (getName (0)));
+                expect (! set.remove (getName (0)));
+                expectEquals (set.size(), size - 1);
+                expect (! set.contains (getName (0)));
+
+                for (int i = 1; i < size; ++i)
+                    expect (set.getVarPointer (getName (i)) != nullptr && *set.getVarPointer (getName (i)) == var (i));
+            }
+
+            set.clear();
+            expectEquals (set.size(), 0);
+            expect (! set.contains (getName (1)));
+        }
+    }
+};
+
+static NamedValueSetTests namedValueSetTests;
+
+#endif
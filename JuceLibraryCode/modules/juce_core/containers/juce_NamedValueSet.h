@@ -27,11 +27,8 @@
 #define __JUCE_NAMEDVALUESET_JUCEHEADER__
 
 #include "juce_Variant.h"
-#include "../containers/juce_LinkedListPointer.h"
+#include "../containers/juce_Array.h"
 class XmlElement;
-#ifndef DOXYGEN
- class JSONFormatter;
-#endif
 
 
 //==============================================================================
@@ -39,6 +36,14 @@ class XmlElement;
 
     This can be used as a basic structure to hold a set of var object, which can
     be retrieved by using their identifier.
+
+    The values are kept in a single array, in the order in which they were added, so
+    iterating them with getName() and getValueAt() is cheap. Small sets are searched
+    linearly, but once a set has more than a few values, it also keeps a hash table
+    of its Identifiers, so that looking up a value takes constant time.
+
+    Note that adding or removing a value may move the others around in memory, so a
+    pointer returned by getVarPointer() is only valid until the set is next changed.
 */
 class JUCE_API  NamedValueSet
 {
@@ -120,6 +125,7 @@ public:
 
         Do not use this method unless you really need access to the internal var object
         for some reason - for normal reading and writing always prefer operator[]() and set().
+        The pointer will no longer be valid after any values are added or removed.
     */
     var* getVarPointer (const Identifier& name) const noexcept;
 
@@ -148,18 +154,17 @@ private:
        #endif
         bool operator== (const NamedValue& other) const noexcept;
 
-        LinkedListPointer<NamedValue> nextListItem;
         Identifier name;
         var value;
-
-    private:
-        JUCE_LEAK_DETECTOR (NamedValue);
     };
 
-    friend class LinkedListPointer<NamedValue>;
-    LinkedListPointer<NamedValue> values;
+    Array<NamedValue> values;
+    HeapBlock<int> hashTable; // (indexes into the values array, plus 1 - or 0 for an empty slot)
+    int hashTableSize;
 
-    friend class JSONFormatter;
+    int indexOf (const Identifier& name) const noexcept;
+    void valueAdded();
+    void rebuildHashTable();
 };
 
 
@@ -134,7 +134,7 @@ void PropertySet::setValue (const String& keyName, const var& v)
         if (index < 0 || properties.getAllValues() [index] != value)
         {
             properties.set (keyName, value);
-            propertyChanged();
+            valueChanged (keyName, &value);
         }
     }
 }
@@ -149,7 +149,7 @@ void PropertySet::removeValue (const String& keyName)
         if (index >= 0)
         {
             properties.remove (keyName);
-            propertyChanged();
+            valueChanged (keyName, nullptr);
         }
     }
 }
@@ -218,3 +218,8 @@ void PropertySet::restoreFromXml (const XmlElement& xml)
 void PropertySet::propertyChanged()
 {
 }
+
+void PropertySet::valueChanged (const String&, const String*)
+{
+    propertyChanged();
+}
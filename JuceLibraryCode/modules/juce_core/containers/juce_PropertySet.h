@@ -212,6 +212,19 @@ protected:
     /** Subclasses can override this to be told when one of the properies has been changed. */
     virtual void propertyChanged();
 
+    /** Subclasses can override this to be told which value was changed by a call to
+        setValue() or removeValue().
+
+        This is called (while the lock is held) after the value has been changed, and
+        the default implementation just calls propertyChanged(). Changes which affect
+        more than one value, such as clear() or restoreFromXml(), only call
+        propertyChanged().
+
+        @param keyName      the key whose value was changed
+        @param newValue     the key's new value, or nullptr if it was removed
+    */
+    virtual void valueChanged (const String& keyName, const String* newValue);
+
 private:
     //==============================================================================
     StringPairArray properties;
@@ -23,6 +23,278 @@
   ==============================================================================
 */
 
+//==============================================================================
+class DirectoryIterator::ScanTask  : public ThreadPoolTask
+{
+public:
+    ScanTask (ParallelScan& scan_, const File& directory_)
+        : scan (scan_), directory (directory_), indexInScan (-1)
+    {
+    }
+
+    void run();
+
+    ParallelScan& scan;
+    const File directory;
+    int indexInScan;
+
+    JUCE_DECLARE_NON_COPYABLE (ScanTask);
+};
+
+//==============================================================================
+/*  Scans the subdirectories of a parallel DirectoryIterator, with a task on the pool
+    for each one, and collects the files that they find until the iterator asks for them.
+*/
+class DirectoryIterator::ParallelScan
+{
+public:
+    ParallelScan (const DirectoryIterator& owner_, ThreadPool& pool_)
+        : owner (owner_), pool (pool_),
+          numDirectoriesFound (0), numDirectoriesScanned (0),
+          nextReadyResult (0), shouldStop (false)
+    {
+    }
+
+    ~ParallelScan()
+    {
+        {
+            const ScopedLock sl (lock);
+            shouldStop = true;
+        }
+
+        // (any tasks that haven't started will be run here, and will return straight away)
+        for (;;)
+        {
+            ThreadPoolTask::Ptr task;
+
+            {
+                const ScopedLock sl (lock);
+
+                if (tasks.size() == 0)
+                    break;
+
+                task = tasks.getLast();
+            }
+
+            task->waitUntilFinished();
+        }
+    }
+
+    //==============================================================================
+    enum
+    {
+        wantsFileSize       = 1,
+        wantsModTime        = 2,
+        wantsCreationTime   = 4,
+        wantsReadOnly       = 8
+    };
+
+    // Called by the iterator before each result it asks for, so that the directories that
+    // haven't been scanned yet can fetch the same details that it's currently asking for.
+    void setInfoWanted (const int64* fileSize, const Time* modTime,
+                        const Time* creationTime, const bool* isReadOnly) noexcept
+    {
+        infoWanted = (fileSize != nullptr ? wantsFileSize : 0)
+                      | (modTime != nullptr ? wantsModTime : 0)
+                      | (creationTime != nullptr ? wantsCreationTime : 0)
+                      | (isReadOnly != nullptr ? wantsReadOnly : 0);
+    }
+
+    void addDirectory (const File& directory)
+    {
+        const ScopedLock sl (lock);
+
+        if (! shouldStop)
+        {
+            ScanTask* const task = new ScanTask (*this, directory);
+            task->indexInScan = tasks.size();
+            tasks.add (task);
+            ++numDirectoriesFound;
+            pool.addTask (task);
+        }
+    }
+
+    //==============================================================================
+    bool getNextResult (File& file, bool* const isDir, bool* const isHidden, int64* const fileSize,
+                        Time* const modTime, Time* const creationTime, bool* const isReadOnly)
+    {
+        if (nextReadyResult >= readyResults.size())
+        {
+            readyResults.clearQuick();
+            nextReadyResult = 0;
+
+            {
+                const ScopedLock sl (lock);
+                readyResults.swapWithArray (results);
+            }
+
+            spaceAvailable.signal();
+
+            if (readyResults.size() == 0)
+                return false;
+        }
+
+        const Result& r = readyResults.getReference (nextReadyResult++);
+        file = r.file;
+
+        // If the caller has started asking for more than it did when the file was found,
+        // the extra details have to be looked up now..
+        if (isDir != nullptr)        *isDir        = r.isDirectory;
+        if (isHidden != nullptr)     *isHidden     = r.isHidden;
+        if (fileSize != nullptr)     *fileSize     = (r.infoIncluded & wantsFileSize) != 0 ? r.fileSize : file.getSize();
+        if (modTime != nullptr)      *modTime      = (r.infoIncluded & wantsModTime) != 0 ? r.modTime : file.getLastModificationTime();
+        if (creationTime != nullptr) *creationTime = (r.infoIncluded & wantsCreationTime) != 0 ? r.creationTime : file.getCreationTime();
+        if (isReadOnly != nullptr)   *isReadOnly   = (r.infoIncluded & wantsReadOnly) != 0 ? r.isReadOnly : ! file.hasWriteAccess();
+
+        return true;
+    }
+
+    // Blocks until there are some results to collect, or returns false if all the
+    // directories have been scanned and there's nothing left.
+    bool waitForResults()
+    {
+        for (;;)
+        {
+            {
+                const ScopedLock sl (lock);
+
+                if (results.size() > 0)
+                    return true;
+
+                if (tasks.size() == 0)
+                    return false;
+            }
+
+            resultsAvailable.wait();
+        }
+    }
+
+    float getProgress (const float progressInTopDirectory) const
+    {
+        const ScopedLock sl (lock);
+        return (progressInTopDirectory + numDirectoriesScanned) / (1 + numDirectoriesFound);
+    }
+
+    //==============================================================================
+    void scanDirectory (const File& directory)
+    {
+        const String path (File::addTrailingSeparator (directory.getFullPathName()));
+        const int info = infoWanted.get();
+
+        NativeIterator fileFinder (directory, "*");
+        Array<Result> found;
+        String filename;
+        Result r;
+        r.infoIncluded = info;
+
+        while ((! shouldStop)
+                && fileFinder.next (filename, &r.isDirectory, &r.isHidden,
+                                    (info & wantsFileSize) != 0 ? &r.fileSize : nullptr,
+                                    (info & wantsModTime) != 0 ? &r.modTime : nullptr,
+                                    (info & wantsCreationTime) != 0 ? &r.creationTime : nullptr,
+                                    (info & wantsReadOnly) != 0 ? &r.isReadOnly : nullptr))
+        {
+            if (filename.containsOnly ("."))
+                continue;
+
+            const bool isSearchedDirectory = r.isDirectory && owner.shouldSearchDirectory (r.isHidden);
+            const bool isWanted = owner.isWantedFile (filename, r.isDirectory, r.isHidden);
+
+            if (isSearchedDirectory || isWanted)
+                r.file = File::createFileWithoutCheckingPath (path + filename);
+
+            if (isSearchedDirectory)
+                addDirectory (r.file);
+
+            if (isWanted)
+            {
+                found.add (r);
+
+                if (found.size() >= resultsPerBatch)
+                    addResults (found);
+            }
+        }
+
+        addResults (found);
+    }
+
+    void taskFinished (ScanTask* const task)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            // swap the last task into this one's place, rather than shuffling the whole list down
+            ScanTask* const last = tasks.getLast();
+            tasks.set (task->indexInScan, last);
+            last->indexInScan = task->indexInScan;
+            tasks.removeLast();
+
+            ++numDirectoriesScanned;
+        }
+
+        resultsAvailable.signal();
+    }
+
+private:
+    //==============================================================================
+    struct Result
+    {
+        Result() noexcept : fileSize (0), isDirectory (false), isHidden (false), isReadOnly (false), infoIncluded (0) {}
+
+        File file;
+        int64 fileSize;
+        Time modTime, creationTime;
+        bool isDirectory, isHidden, isReadOnly;
+        int infoIncluded;
+    };
+
+    // The tasks stop when this many results are waiting, until the iterator catches up.
+    enum { resultsPerBatch = 256, maxWaitingResults = 32768 };
+
+    const DirectoryIterator& owner;
+    ThreadPool& pool;
+    CriticalSection lock;
+    ReferenceCountedArray<ScanTask> tasks;
+    Array<Result> results, readyResults;
+    WaitableEvent resultsAvailable, spaceAvailable;
+    Atomic<int> infoWanted;
+    int numDirectoriesFound, numDirectoriesScanned, nextReadyResult;
+    bool volatile shouldStop;
+
+    void addResults (Array<Result>& found)
+    {
+        if (found.size() == 0)
+            return;
+
+        while (! shouldStop)
+        {
+            {
+                const ScopedLock sl (lock);
+
+                if (results.size() < maxWaitingResults)
+                {
+                    results.addArray (found);
+                    break;
+                }
+            }
+
+            spaceAvailable.wait (20);
+        }
+
+        found.clearQuick();
+        resultsAvailable.signal();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelScan);
+};
+
+void DirectoryIterator::ScanTask::run()
+{
+    scan.scanDirectory (directory);
+    scan.taskFinished (this);
+}
+
+//==============================================================================
 DirectoryIterator::DirectoryIterator (const File& directory,
                                       bool isRecursive_,
                                       const String& wildCard_,
@@ -34,15 +306,38 @@ DirectoryIterator::DirectoryIterator (const File& directory,
     totalNumFiles (-1),
     whatToLookFor (whatToLookFor_),
     isRecursive (isRecursive_),
+    matchesAllNames (wildCard_ == "*"),
+    hasBeenAdvanced (false)
+{
+    // you have to specify the type of files you're looking for!
+    jassert ((whatToLookFor_ & (File::findFiles | File::findDirectories)) != 0);
+    jassert (whatToLookFor_ > 0 && whatToLookFor_ <= 7);
+}
+
+DirectoryIterator::DirectoryIterator (const File& directory,
+                                      ThreadPool& threadPoolToUse,
+                                      const String& wildCard_,
+                                      const int whatToLookFor_)
+  : fileFinder (directory, "*"),
+    wildCard (wildCard_),
+    path (File::addTrailingSeparator (directory.getFullPathName())),
+    index (-1),
+    totalNumFiles (-1),
+    whatToLookFor (whatToLookFor_),
+    isRecursive (true),
+    matchesAllNames (wildCard_ == "*"),
     hasBeenAdvanced (false)
 {
     // you have to specify the type of files you're looking for!
     jassert ((whatToLookFor_ & (File::findFiles | File::findDirectories)) != 0);
     jassert (whatToLookFor_ > 0 && whatToLookFor_ <= 7);
+
+    parallelScan = new ParallelScan (*this, threadPoolToUse);
 }
 
 DirectoryIterator::~DirectoryIterator()
 {
+    parallelScan = nullptr; // (this waits for its tasks, which use our wildcard and flags)
 }
 
 bool DirectoryIterator::next()
@@ -55,7 +350,14 @@ bool DirectoryIterator::next (bool* const isDirResult, bool* const isHiddenResul
 {
     hasBeenAdvanced = true;
 
-    if (subIterator != nullptr)
+    if (parallelScan != nullptr)
+    {
+        parallelScan->setInfoWanted (fileSize, modTime, creationTime, isReadOnly);
+
+        if (parallelScan->getNextResult (currentFile, isDirResult, isHiddenResult, fileSize, modTime, creationTime, isReadOnly))
+            return true;
+    }
+    else if (subIterator != nullptr)
     {
         if (subIterator->next (isDirResult, isHiddenResult, fileSize, modTime, creationTime, isReadOnly))
             return true;
@@ -71,29 +373,17 @@ bool DirectoryIterator::next (bool* const isDirResult, bool* const isHiddenResul
 
         if (! filename.containsOnly ("."))
         {
-            bool matches = false;
-
-            if (isDirectory)
+            if (isDirectory && shouldSearchDirectory (isHidden))
             {
-                if (isRecursive && ((whatToLookFor & File::ignoreHiddenFiles) == 0 || ! isHidden))
-                    subIterator = new DirectoryIterator (File::createFileWithoutCheckingPath (path + filename),
-                                                         true, wildCard, whatToLookFor);
+                const File subDirectory (File::createFileWithoutCheckingPath (path + filename));
 
-                matches = (whatToLookFor & File::findDirectories) != 0;
+                if (parallelScan != nullptr)
+                    parallelScan->addDirectory (subDirectory);
+                else
+                    subIterator = new DirectoryIterator (subDirectory, true, wildCard, whatToLookFor);
             }
-            else
-            {
-                matches = (whatToLookFor & File::findFiles) != 0;
-            }
-
-            // if recursive, we're not relying on the OS iterator to do the wildcard match, so do it now..
-            if (matches && isRecursive)
-                matches = filename.matchesWildcard (wildCard, ! File::areFileNamesCaseSensitive());
 
-            if (matches && (whatToLookFor & File::ignoreHiddenFiles) != 0)
-                matches = ! isHidden;
-
-            if (matches)
+            if (isWantedFile (filename, isDirectory, isHidden))
             {
                 currentFile = File::createFileWithoutCheckingPath (path + filename);
                 if (isHiddenResult != nullptr)     *isHiddenResult = isHidden;
@@ -103,14 +393,36 @@ bool DirectoryIterator::next (bool* const isDirResult, bool* const isHiddenResul
             }
             else if (subIterator != nullptr)
             {
-                return next();
+                return next (isDirResult, isHiddenResult, fileSize, modTime, creationTime, isReadOnly);
             }
         }
     }
 
+    if (parallelScan != nullptr)
+        while (parallelScan->waitForResults())
+            if (parallelScan->getNextResult (currentFile, isDirResult, isHiddenResult, fileSize, modTime, creationTime, isReadOnly))
+                return true;
+
     return false;
 }
 
+bool DirectoryIterator::isWantedFile (const String& filename, const bool isDirectory, const bool isHidden) const
+{
+    if ((whatToLookFor & (isDirectory ? File::findDirectories : File::findFiles)) == 0)
+        return false;
+
+    // if recursive, we're not relying on the OS iterator to do the wildcard match, so do it now..
+    if (isRecursive && ! (matchesAllNames || filename.matchesWildcard (wildCard, ! File::areFileNamesCaseSensitive())))
+        return false;
+
+    return (whatToLookFor & File::ignoreHiddenFiles) == 0 || ! isHidden;
+}
+
+bool DirectoryIterator::shouldSearchDirectory (const bool isHidden) const noexcept
+{
+    return isRecursive && ((whatToLookFor & File::ignoreHiddenFiles) == 0 || ! isHidden);
+}
+
 const File& DirectoryIterator::getFile() const
 {
     if (subIterator != nullptr && subIterator->hasBeenAdvanced)
@@ -127,11 +439,149 @@ float DirectoryIterator::getEstimatedProgress() const
     if (totalNumFiles < 0)
         totalNumFiles = File (path).getNumberOfChildFiles (File::findFilesAndDirectories);
 
-    if (totalNumFiles <= 0)
-        return 0.0f;
+    float progress = 0.0f;
 
-    const float detailedIndex = (subIterator != nullptr) ? index + subIterator->getEstimatedProgress()
-                                                         : (float) index;
+    if (totalNumFiles > 0)
+    {
+        const float detailedIndex = (subIterator != nullptr) ? index + subIterator->getEstimatedProgress()
+                                                             : (float) index;
+
+        progress = detailedIndex / totalNumFiles;
+    }
 
-    return detailedIndex / totalNumFiles;
+    if (parallelScan != nullptr)
+        return parallelScan->getProgress (progress);
+
+    return progress;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class DirectoryIteratorTests  : public UnitTest
+{
+public:
+    DirectoryIteratorTests() : UnitTest ("DirectoryIterator") {}
+
+    static void findAll (DirectoryIterator& iter, StringArray& results)
+    {
+        bool isDirectory, isHidden;
+        int64 fileSize;
+
+        while (iter.next (&isDirectory, &isHidden, &fileSize, nullptr, nullptr, nullptr))
+        {
+            const File& f = iter.getFile();
+            results.add (f.getFullPathName() + (isDirectory ? "|dir|" : "|file|")
+                           + String (fileSize) + (isHidden ? "|hidden" : ""));
+        }
+
+        results.sort (false);
+    }
+
+    void checkDetails (const StringArray& results)
+    {
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const File f (results[i].upToFirstOccurrenceOf ("|", false, false));
+
+            expect (results[i].contains ("|dir|") == f.isDirectory());
+            expect (results[i].endsWith ("|hidden") == f.getFileName().startsWithChar ('.'));
+
+            if (! f.isDirectory())
+                expect (results[i].contains ("|" + String (f.getSize())));
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Recursive searches");
+
+        const File folder (File::getSpecialLocation (File::tempDirectory)
+                             .getChildFile ("Juce DirectoryIterator Test Folder"));
+        expect (folder.deleteRecursively());
+
+        Random r (1234);
+        int numTextFiles = 0, numHiddenTextFiles = 0, numFiles = 0;
+
+        for (int i = 0; i < 20; ++i)
+        {
+            File subFolder (folder.getChildFile (i % 5 == 0 ? ".hidden" + String (i) : "sub" + String (i)));
+
+            if (i % 3 == 0)
+                subFolder = subFolder.getChildFile ("nested");
+
+            expect (subFolder.createDirectory());
+
+            for (int j = 0; j < 30; ++j)
+            {
+                const bool isText = (j % 3) == 0;
+                expect (subFolder.getChildFile ("file" + String (j) + (isText ? ".txt" : ".dat"))
+                                 .replaceWithText (String::repeatedString ("x", r.nextInt (50))));
+                ++numFiles;
+
+                if (isText)
+                {
+                    ++numTextFiles;
+
+                    if (i % 5 == 0)
+                        ++numHiddenTextFiles;
+                }
+            }
+        }
+
+        StringArray serial, serialNoHidden, parallel, parallelNoHidden;
+
+        {
+            DirectoryIterator iter (folder, true, "*.txt");
+            findAll (iter, serial);
+        }
+
+        {
+            DirectoryIterator iter (folder, true, "*.txt", File::findFiles | File::ignoreHiddenFiles);
+            findAll (iter, serialNoHidden);
+        }
+
+        expectEquals (serial.size(), numTextFiles);
+        expectEquals (serialNoHidden.size(), numTextFiles - numHiddenTextFiles);
+        checkDetails (serial);
+
+        beginTest ("Parallel searches");
+
+        ThreadPool pool (3);
+
+        {
+            DirectoryIterator iter (folder, pool, "*.txt");
+            findAll (iter, parallel);
+        }
+
+        {
+            DirectoryIterator iter (folder, pool, "*.txt", File::findFiles | File::ignoreHiddenFiles);
+            findAll (iter, parallelNoHidden);
+        }
+
+        expect (parallel == serial);
+        expect (parallelNoHidden == serialNoHidden);
+
+        {
+            StringArray all;
+            DirectoryIterator iter (folder, pool, "*", File::findFilesAndDirectories);
+            findAll (iter, all);
+            checkDetails (all);
+            expect (all.size() > numFiles);
+        }
+
+        {
+            // stopping part-way through shouldn't leave anything running
+            DirectoryIterator iter (folder, pool);
+
+            for (int i = 0; i < 10; ++i)
+                expect (iter.next());
+        }
+
+        expect (folder.deleteRecursively());
+    }
+};
+
+static DirectoryIteratorTests directoryIteratorUnitTests;
+
+#endif
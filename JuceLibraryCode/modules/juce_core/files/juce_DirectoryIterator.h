@@ -29,6 +29,8 @@
 #include "juce_File.h"
 #include "../memory/juce_ScopedPointer.h"
 
+class ThreadPool;
+
 
 //==============================================================================
 /**
@@ -73,6 +75,27 @@ public:
                        const String& wildCard = "*",
                        int whatToLookFor = File::findFiles);
 
+    /** Creates a DirectoryIterator that searches a directory and all its subdirectories,
+        using a ThreadPool to scan several of the subdirectories at once.
+
+        This finds the same files as a recursive iterator created with the other
+        constructor, but it doesn't return them in the same order: the files in the
+        subdirectories come back in whatever order the pool's threads find them, mixed
+        in with the ones in the top-level directory.
+
+        The pool must not be deleted before the iterator.
+
+        @param directory        the directory to search in
+        @param threadPoolToUse  the pool whose threads will scan the subdirectories
+        @param wildCard         the file pattern to match
+        @param whatToLookFor    a value from the File::TypesOfFileToFind enum, specifying
+                                whether to look for files, directories, or both.
+    */
+    DirectoryIterator (const File& directory,
+                       ThreadPool& threadPoolToUse,
+                       const String& wildCard = "*",
+                       int whatToLookFor = File::findFiles);
+
     /** Destructor. */
     ~DirectoryIterator();
 
@@ -137,17 +160,24 @@ private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NativeIterator);
     };
 
+    class ParallelScan;
+    class ScanTask;
     friend class ScopedPointer<NativeIterator::Pimpl>;
+    friend class ScopedPointer<ParallelScan>;
     NativeIterator fileFinder;
     String wildCard, path;
     int index;
     mutable int totalNumFiles;
     const int whatToLookFor;
-    const bool isRecursive;
+    const bool isRecursive, matchesAllNames;
     bool hasBeenAdvanced;
     ScopedPointer <DirectoryIterator> subIterator;
+    ScopedPointer <ParallelScan> parallelScan;
     File currentFile;
 
+    bool isWantedFile (const String& filename, bool isDirectory, bool isHidden) const;
+    bool shouldSearchDirectory (bool isHidden) const noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectoryIterator);
 };
 
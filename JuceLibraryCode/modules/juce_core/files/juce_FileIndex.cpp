@@ -0,0 +1,1325 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+namespace FileIndexHelpers
+{
+    inline char foldCase (const char c) noexcept
+    {
+        return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c;
+    }
+
+    inline const char* skipUTF8Character (const char* s, const char* const end) noexcept
+    {
+        while (++s < end && (*s & 0xc0) == 0x80)
+        {}
+
+        return s;
+    }
+
+    //==============================================================================
+    /*  A wildcard or substring that's been converted to UTF-8 once, so that it can be
+        compared directly against the UTF-8 names in the index.
+        If it ignores case, it's compared with a copy of the names whose ASCII
+        characters have all been converted to lower-case.
+    */
+    class NamePattern
+    {
+    public:
+        NamePattern (const String& text, const bool isWildcard_, const bool ignoreCase)
+            : isWildcard (isWildcard_)
+        {
+            const char* s = text.toUTF8();
+
+            for (; *s != 0; ++s)
+            {
+                // (a run of stars is the same as a single one)
+                if (! (isWildcard && *s == '*' && pattern.size() > 0 && pattern.getLast() == '*'))
+                    pattern.add (ignoreCase ? foldCase (*s) : *s);
+            }
+        }
+
+        bool matches (const char* const name, const int nameLength) const noexcept
+        {
+            return isWildcard ? matchesWildcard (name, name + nameLength)
+                              : contains (name, nameLength);
+        }
+
+    private:
+        Array<char> pattern;
+        const bool isWildcard;
+
+        bool matchesWildcard (const char* s, const char* const end) const noexcept
+        {
+            const char* p = pattern.begin();
+            const char* const patternEnd = pattern.end();
+            const char* starInPattern = nullptr;
+            const char* starInName = nullptr;
+
+            while (s < end)
+            {
+                if (p < patternEnd)
+                {
+                    if (*p == '*')
+                    {
+                        starInPattern = ++p;
+                        starInName = s;
+                        continue;
+                    }
+
+                    if (*p == '?')
+                    {
+                        ++p;
+                        s = skipUTF8Character (s, end);
+                        continue;
+                    }
+
+                    if (*p == *s)
+                    {
+                        ++p;
+                        ++s;
+                        continue;
+                    }
+                }
+
+                // no match here, so let the last star swallow another character and try again
+                if (starInPattern == nullptr)
+                    return false;
+
+                p = starInPattern;
+                s = starInName = skipUTF8Character (starInName, end);
+            }
+
+            while (p < patternEnd && *p == '*')
+                ++p;
+
+            return p == patternEnd;
+        }
+
+        bool contains (const char* const name, const int nameLength) const noexcept
+        {
+            const int patternLength = pattern.size();
+
+            if (patternLength == 0)
+                return true;
+
+            const char* const p = pattern.begin();
+
+            for (int i = 0; i <= nameLength - patternLength; ++i)
+                if (name[i] == p[0] && memcmp (name + i, p, (size_t) patternLength) == 0)
+                    return true;
+
+            return false;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (NamePattern);
+    };
+
+    //==============================================================================
+    void writeVarInt (OutputStream& out, uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.writeByte ((char) (value | 0x80));
+            value >>= 7;
+        }
+
+        out.writeByte ((char) value);
+    }
+
+    bool readVarInt (const uint8*& data, const uint8* const end, uint64& result) noexcept
+    {
+        result = 0;
+
+        for (int shift = 0; shift < 64 && data < end; shift += 7)
+        {
+            const uint8 byte = *data++;
+            result |= ((uint64) (byte & 0x7f)) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    // (times are zig-zag encoded, so that any before 1970 don't take up 10 bytes)
+    inline uint64 zigZagEncode (const int64 value) noexcept    { return (((uint64) value) << 1) ^ (uint64) (value >> 63); }
+    inline int64 zigZagDecode (const uint64 value) noexcept    { return (int64) (value >> 1) ^ -(int64) (value & 1); }
+
+    const int snapshotMagicNumber = 0x58444946; // "FIDX"
+    const int snapshotVersion = 1;
+}
+
+//==============================================================================
+/*  The index's data.
+
+    Each file or directory is a node, which is linked into a list of its parent's
+    children. The nodes' names are kept together in one block of UTF-8 (plus a copy
+    with its ASCII folded to lower-case, for case-insensitive searches), so that a
+    search only has to run along those blocks. Nodes are looked up by parent and name
+    in a hash table, and the nodes that get removed are recycled.
+*/
+class FileIndex::Tree
+{
+public:
+    enum
+    {
+        directoryFlag       = 1,
+        hiddenFlag          = 2,
+        insideHiddenFlag    = 4,    // (i.e. inside a hidden directory)
+        freeFlag            = 8,
+        seenFlag            = 16
+    };
+
+    struct Node
+    {
+        int parent, firstChild, nextSibling, previousSibling;
+        int nameStart, nameLength;
+        int64 fileSize, modificationTime;
+        int flags, watch;
+    };
+
+    Tree (const File& rootDirectory_)
+        : rootDirectory (rootDirectory_),
+          rootPath (File::addTrailingSeparator (rootDirectory_.getFullPathName())),
+          lastUpdateTime (0),
+          firstFreeNode (-1), numFreeNodes (0), numUsedSlots (0), numWastedNameBytes (0),
+          lastParentDirectory (-1), lastParent (-1)
+    {
+        const Node root = { -1, -1, -1, -1, 0, 0, 0, 0, directoryFlag, -1 };
+        nodes.add (root);
+    }
+
+    //==============================================================================
+    int getNumFiles() const noexcept                        { return nodes.size() - 1 - numFreeNodes; }
+    int getNumNodes() const noexcept                        { return nodes.size(); }
+    const Node& getNode (const int index) const noexcept    { return nodes.getReference (index); }
+
+    bool isDirectory (const int index) const noexcept
+    {
+        return (nodes.getReference (index).flags & (directoryFlag | freeFlag)) == directoryFlag;
+    }
+
+    const char* getNames (const bool folded) const noexcept
+    {
+        return folded ? foldedNames.begin() : names.begin();
+    }
+
+    File getFile (const int index) const
+    {
+        if (index == 0)
+            return rootDirectory;
+
+        Array<int> path;
+
+        for (int i = index; i > 0; i = nodes.getReference (i).parent)
+            path.add (i);
+
+        String result (rootPath);
+
+        for (int i = path.size(); --i >= 0;)
+        {
+            const Node& n = nodes.getReference (path.getUnchecked (i));
+            result << String::fromUTF8 (names.begin() + n.nameStart, n.nameLength);
+
+            if (i > 0)
+                result << File::separator;
+        }
+
+        return File::createFileWithoutCheckingPath (result);
+    }
+
+    int findFile (const File& file) const
+    {
+        const String fullPath (file.getFullPathName());
+
+        if (File::addTrailingSeparator (fullPath) == rootPath)
+            return 0;
+
+        if (! fullPath.startsWith (rootPath))
+            return -1;
+
+        return findPath (0, fullPath.substring (rootPath.length()));
+    }
+
+    //==============================================================================
+    int findChild (const int parent, const char* const name, const int nameLength) const noexcept
+    {
+        if (hashSlots.size() > 0)
+        {
+            const int mask = hashSlots.size() - 1;
+
+            for (int slot = hash (parent, name, nameLength) & mask;; slot = (slot + 1) & mask)
+            {
+                const int index = hashSlots.getUnchecked (slot);
+
+                if (index == emptySlot)
+                    break;
+
+                if (index >= 0)
+                {
+                    const Node& n = nodes.getReference (index);
+
+                    if (n.parent == parent && n.nameLength == nameLength
+                         && memcmp (names.begin() + n.nameStart, name, (size_t) nameLength) == 0)
+                        return index;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    // Adds a node, or if the parent already has a child with this name, updates its details.
+    int addChild (const int parent, const char* const name, const int nameLength,
+                  const int flags, const int64 fileSize, const int64 modificationTime)
+    {
+        int index = findChild (parent, name, nameLength);
+
+        if (index < 0)
+        {
+            const Node& p = nodes.getReference (parent);
+            const Node n = { parent, -1, p.firstChild, -1, names.size(), nameLength, 0, 0,
+                             (p.flags & (hiddenFlag | insideHiddenFlag)) != 0 ? insideHiddenFlag : 0, -1 };
+
+            if (firstFreeNode >= 0)
+            {
+                index = firstFreeNode;
+                firstFreeNode = nodes.getReference (index).nextSibling;
+                --numFreeNodes;
+                nodes.getReference (index) = n;
+            }
+            else
+            {
+                index = nodes.size();
+                nodes.add (n);
+            }
+
+            if (n.nextSibling >= 0)
+                nodes.getReference (n.nextSibling).previousSibling = index;
+
+            nodes.getReference (parent).firstChild = index;
+
+            names.addArray (name, nameLength);
+
+            for (int i = 0; i < nameLength; ++i)
+                foldedNames.add (FileIndexHelpers::foldCase (name[i]));
+
+            addToHashTable (index);
+        }
+
+        Node& n = nodes.getReference (index);
+        n.flags = (n.flags & ~(directoryFlag | hiddenFlag)) | flags;
+        n.fileSize = fileSize;
+        n.modificationTime = modificationTime;
+        return index;
+    }
+
+    // Adds a file, given its path relative to a directory node, creating any of the
+    // directories in between that aren't there yet.
+    void addPath (const int directory, const String& relativePath, const int flags,
+                  const int64 fileSize, const int64 modificationTime)
+    {
+        const int lastSeparator = relativePath.lastIndexOfChar (File::separator);
+        const String parentPath (relativePath.substring (0, jmax (0, lastSeparator)));
+
+        if (directory != lastParentDirectory || parentPath != lastParentPath)
+        {
+            lastParentDirectory = directory;
+            lastParentPath = parentPath;
+            lastParent = findPath (directory, parentPath, true);
+        }
+
+        const String name (relativePath.substring (lastSeparator + 1));
+        const char* const nameUTF8 = name.toUTF8();
+        addChild (lastParent, nameUTF8, (int) strlen (nameUTF8), flags, fileSize, modificationTime);
+    }
+
+    int findPath (int index, const String& relativePath, const bool createDirectories = false)
+    {
+        const char* s = relativePath.toUTF8();
+
+        while (*s != 0 && index >= 0)
+        {
+            const char* end = s;
+
+            while (*end != 0 && *end != File::separator)
+                ++end;
+
+            const int nameLength = (int) (end - s);
+
+            if (nameLength > 0)
+            {
+                const int child = findChild (index, s, nameLength);
+
+                index = (child < 0 && createDirectories) ? addChild (index, s, nameLength, directoryFlag | (*s == '.' ? hiddenFlag : 0), 0, 0)
+                                                         : child;
+            }
+
+            s = (*end != 0) ? end + 1 : end;
+        }
+
+        return index;
+    }
+
+    int findPath (const int index, const String& relativePath) const
+    {
+        return const_cast <Tree*> (this)->findPath (index, relativePath, false);
+    }
+
+    // Removes a node and everything inside it.
+    void removeNode (const int index)
+    {
+        jassert (index > 0);
+        Node& n = nodes.getReference (index);
+
+        while (n.firstChild >= 0)
+            removeNode (n.firstChild);
+
+        if (n.watch >= 0)
+            watchesToRemove.add (n.watch);
+
+        if (n.previousSibling >= 0)
+            nodes.getReference (n.previousSibling).nextSibling = n.nextSibling;
+        else
+            nodes.getReference (n.parent).firstChild = n.nextSibling;
+
+        if (n.nextSibling >= 0)
+            nodes.getReference (n.nextSibling).previousSibling = n.previousSibling;
+
+        removeFromHashTable (index);
+        numWastedNameBytes += n.nameLength;
+
+        n.flags = freeFlag;
+        n.firstChild = n.parent = n.previousSibling = -1;
+        n.watch = -1;
+        n.nextSibling = firstFreeNode;
+        firstFreeNode = index;
+        ++numFreeNodes;
+    }
+
+    void removeChildren (const int index)
+    {
+        while (nodes.getReference (index).firstChild >= 0)
+            removeNode (nodes.getReference (index).firstChild);
+    }
+
+    void getDirectories (Array<int>& results) const
+    {
+        for (int i = 0; i < nodes.size(); ++i)
+            if (isDirectory (i))
+                results.add (i);
+    }
+
+    void setWatch (const int index, const int watch) noexcept    { nodes.getReference (index).watch = watch; }
+
+    void clearWatches() noexcept
+    {
+        for (int i = nodes.size(); --i >= 0;)
+            nodes.getReference (i).watch = -1;
+    }
+
+    //==============================================================================
+    // Lists a directory, and brings its children up to date with what's on the disk.
+    // Any new subdirectories are added to the array, so the caller can list those too.
+    void updateDirectory (const int index, Array<int>& newSubdirectories)
+    {
+        const File directory (getFile (index));
+
+        for (int i = nodes.getReference (index).firstChild; i >= 0; i = nodes.getReference (i).nextSibling)
+            nodes.getReference (i).flags &= ~seenFlag;
+
+        nodes.getReference (index).modificationTime = directory.getLastModificationTime().toMilliseconds();
+
+        DirectoryIterator iter (directory, false, "*", File::findFilesAndDirectories);
+        bool isDir, isHidden;
+        int64 fileSize;
+        Time modTime;
+
+        while (iter.next (&isDir, &isHidden, &fileSize, &modTime, nullptr, nullptr))
+        {
+            const String name (iter.getFile().getFileName());
+            const char* const nameUTF8 = name.toUTF8();
+            const int nameLength = (int) strlen (nameUTF8);
+
+            int child = findChild (index, nameUTF8, nameLength);
+
+            if (child >= 0 && isDirectory (child) != isDir)
+            {
+                removeNode (child);
+                child = -1;
+            }
+
+            const bool isNew = child < 0;
+            child = addChild (index, nameUTF8, nameLength, getFlags (isDir, isHidden),
+                              fileSize, modTime.toMilliseconds());
+
+            nodes.getReference (child).flags |= seenFlag;
+
+            if (isNew && isDir)
+                newSubdirectories.add (child);
+        }
+
+        for (int i = nodes.getReference (index).firstChild; i >= 0;)
+        {
+            const int next = nodes.getReference (i).nextSibling;
+
+            if ((nodes.getReference (i).flags & seenFlag) == 0)
+                removeNode (i);
+
+            i = next;
+        }
+    }
+
+    // Returns true if a directory's modification time shows that it might have changed
+    // since it was listed. Because file systems often only store times to the nearest
+    // second, one that was modified in the same second as it was listed may have changed
+    // again afterwards without its time changing.
+    bool mayHaveChanged (const int index) const
+    {
+        const int64 modificationTime = nodes.getReference (index).modificationTime;
+
+        return modificationTime + 1000 > lastUpdateTime
+                || modificationTime != getFile (index).getLastModificationTime().toMilliseconds();
+    }
+
+    static int getFlags (const bool isDir, const bool isHidden) noexcept
+    {
+        return (isDir ? directoryFlag : 0) | (isHidden ? hiddenFlag : 0);
+    }
+
+    // When enough nodes have been removed, this packs the remaining names together again.
+    void compactNamesIfNeeded()
+    {
+        if (numWastedNameBytes < 65536 || numWastedNameBytes < names.size() / 2)
+            return;
+
+        Array<char> newNames, newFoldedNames;
+        newNames.ensureStorageAllocated (names.size() - (int) numWastedNameBytes);
+        newFoldedNames.ensureStorageAllocated (names.size() - (int) numWastedNameBytes);
+
+        for (int i = 1; i < nodes.size(); ++i)
+        {
+            Node& n = nodes.getReference (i);
+
+            if ((n.flags & freeFlag) == 0)
+            {
+                newNames.addArray (static_cast <const char*> (names.begin() + n.nameStart), n.nameLength);
+                newFoldedNames.addArray (static_cast <const char*> (foldedNames.begin() + n.nameStart), n.nameLength);
+                n.nameStart = newNames.size() - n.nameLength;
+            }
+        }
+
+        names.swapWithArray (newNames);
+        foldedNames.swapWithArray (newFoldedNames);
+        numWastedNameBytes = 0;
+    }
+
+    //==============================================================================
+    void scan (const int index, const File& directory, ThreadPool* const threadPool)
+    {
+        lastUpdateTime = Time::currentTimeMillis();
+        const String path (File::addTrailingSeparator (directory.getFullPathName()));
+
+        ScopedPointer<DirectoryIterator> iter (threadPool != nullptr
+                                                 ? new DirectoryIterator (directory, *threadPool, "*", File::findFilesAndDirectories)
+                                                 : new DirectoryIterator (directory, true, "*", File::findFilesAndDirectories));
+        bool isDir, isHidden;
+        int64 fileSize;
+        Time modTime;
+
+        while (iter->next (&isDir, &isHidden, &fileSize, &modTime, nullptr, nullptr))
+            addPath (index, iter->getFile().getFullPathName().substring (path.length()),
+                     getFlags (isDir, isHidden), fileSize, modTime.toMilliseconds());
+
+        nodes.getReference (index).modificationTime = directory.getLastModificationTime().toMilliseconds();
+    }
+
+    //==============================================================================
+    void writeTo (OutputStream& out) const
+    {
+        using namespace FileIndexHelpers;
+
+        out.writeInt (snapshotMagicNumber);
+        out.writeInt (snapshotVersion);
+        out.writeString (rootPath);
+        writeVarInt (out, (uint64) getNumFiles());
+        writeVarInt (out, zigZagEncode (nodes.getReference (0).modificationTime));
+        writeVarInt (out, zigZagEncode (lastUpdateTime));
+
+        // The nodes are written parents-first, and each one stores how far back its
+        // parent was, which is usually a small number..
+        Array<int> newIndexes;
+        newIndexes.insertMultiple (0, -1, nodes.size());
+        newIndexes.set (0, 0);
+        int numWritten = 1;
+
+        Array<int> stack;
+        stack.add (0);
+
+        while (stack.size() > 0)
+        {
+            const int index = stack.getLast();
+            stack.removeLast();
+            const Node& n = nodes.getReference (index);
+
+            if (index > 0)
+            {
+                writeVarInt (out, (uint64) (numWritten - newIndexes.getUnchecked (n.parent)));
+                writeVarInt (out, (uint64) (n.flags & (directoryFlag | hiddenFlag)));
+                writeVarInt (out, (uint64) n.fileSize);
+                writeVarInt (out, zigZagEncode (n.modificationTime));
+                writeVarInt (out, (uint64) n.nameLength);
+                out.write (names.begin() + n.nameStart, n.nameLength);
+
+                newIndexes.set (index, numWritten++);
+            }
+
+            for (int i = n.firstChild; i >= 0; i = nodes.getReference (i).nextSibling)
+                stack.add (i);
+        }
+    }
+
+    bool readFrom (const MemoryBlock& data)
+    {
+        using namespace FileIndexHelpers;
+
+        MemoryInputStream in (data, false);
+
+        if (in.readInt() != snapshotMagicNumber || in.readInt() != snapshotVersion
+              || in.readString() != rootPath)
+            return false;
+
+        const uint8* d = static_cast <const uint8*> (data.getData()) + (size_t) in.getPosition();
+        const uint8* const end = static_cast <const uint8*> (data.getData()) + data.getSize();
+
+        uint64 numFiles, rootModTime, updateTime;
+
+        if (! (readVarInt (d, end, numFiles) && readVarInt (d, end, rootModTime) && readVarInt (d, end, updateTime)))
+            return false;
+
+        if (numFiles >= (uint64) std::numeric_limits<int>::max())
+            return false;
+
+        nodes.ensureStorageAllocated ((int) numFiles + 1);
+        nodes.getReference (0).modificationTime = zigZagDecode (rootModTime);
+        lastUpdateTime = zigZagDecode (updateTime);
+
+        for (int i = 1; i <= (int) numFiles; ++i)
+        {
+            uint64 parentOffset, flags, fileSize, modTime, nameLength;
+
+            if (nodes.size() != i)   // (two nodes with the same name)
+                return false;
+
+            if (! (readVarInt (d, end, parentOffset) && readVarInt (d, end, flags)
+                    && readVarInt (d, end, fileSize) && readVarInt (d, end, modTime)
+                    && readVarInt (d, end, nameLength)))
+                return false;
+
+            if (parentOffset == 0 || parentOffset > (uint64) i || nameLength > (uint64) (end - d)
+                  || ! isDirectory (i - (int) parentOffset))
+                return false;
+
+            addChild (i - (int) parentOffset, reinterpret_cast <const char*> (d), (int) nameLength,
+                      (int) (flags & (directoryFlag | hiddenFlag)), (int64) fileSize, zigZagDecode (modTime));
+            d += nameLength;
+        }
+
+        return getNumFiles() == (int) numFiles;
+    }
+
+    //==============================================================================
+    const File rootDirectory;
+    const String rootPath;
+    int64 lastUpdateTime;
+    Array<int> watchesToRemove;
+
+private:
+    Array<Node> nodes;
+    Array<char> names, foldedNames;
+    Array<int> hashSlots;
+    int firstFreeNode, numFreeNodes, numUsedSlots;
+    int64 numWastedNameBytes;
+
+    String lastParentPath;
+    int lastParentDirectory, lastParent;
+
+    enum { emptySlot = -1, removedSlot = -2 };
+
+    static int hash (const int parent, const char* const name, const int nameLength) noexcept
+    {
+        uint32 h = 2166136261u ^ (uint32) parent;
+
+        for (int i = 0; i < nameLength; ++i)
+            h = (h ^ (uint8) name[i]) * 16777619u;
+
+        return (int) (h & 0x7fffffff);
+    }
+
+    void addToHashTable (const int index)
+    {
+        if ((numUsedSlots + 1) * 2 > hashSlots.size())
+            rehash();
+
+        const Node& n = nodes.getReference (index);
+        const int mask = hashSlots.size() - 1;
+        int slot = hash (n.parent, names.begin() + n.nameStart, n.nameLength) & mask;
+
+        while (hashSlots.getUnchecked (slot) >= 0)
+            slot = (slot + 1) & mask;
+
+        if (hashSlots.getUnchecked (slot) == emptySlot)
+            ++numUsedSlots;
+
+        hashSlots.set (slot, index);
+    }
+
+    void removeFromHashTable (const int index)
+    {
+        const Node& n = nodes.getReference (index);
+        const int mask = hashSlots.size() - 1;
+
+        for (int slot = hash (n.parent, names.begin() + n.nameStart, n.nameLength) & mask;; slot = (slot + 1) & mask)
+        {
+            const int i = hashSlots.getUnchecked (slot);
+
+            if (i == index)
+            {
+                hashSlots.set (slot, removedSlot);
+                break;
+            }
+
+            jassert (i != emptySlot); // the node wasn't in the table!
+
+            if (i == emptySlot)
+                break;
+        }
+    }
+
+    void rehash()
+    {
+        int newSize = 64;
+        while (newSize < getNumFiles() * 4)
+            newSize *= 2;
+
+        hashSlots.clearQuick();
+        hashSlots.insertMultiple (0, emptySlot, newSize);
+        numUsedSlots = 0;
+
+        const int mask = newSize - 1;
+
+        for (int i = 1; i < nodes.size(); ++i)
+        {
+            const Node& n = nodes.getReference (i);
+
+            if ((n.flags & freeFlag) == 0 && n.parent >= 0)
+            {
+                int slot = hash (n.parent, names.begin() + n.nameStart, n.nameLength) & mask;
+
+                while (hashSlots.getUnchecked (slot) != emptySlot)
+                    slot = (slot + 1) & mask;
+
+                hashSlots.set (slot, i);
+                ++numUsedSlots;
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Tree);
+};
+
+//==============================================================================
+#if JUCE_LINUX
+
+class FileIndex::Watcher  : public Thread
+{
+public:
+    Watcher (FileIndex& owner_)
+        : Thread ("FileIndex watcher"),
+          owner (owner_),
+          fd (inotify_init1 (IN_NONBLOCK | IN_CLOEXEC)),
+          buffer (bufferSize)
+    {
+    }
+
+    ~Watcher()
+    {
+        stopThread (5000);
+
+        if (fd >= 0)
+            close (fd);
+    }
+
+    bool isOpen() const noexcept        { return fd >= 0; }
+
+    // These must all be called with the owner's write lock held..
+    bool watchDirectory (Tree& tree, const int index)
+    {
+        const int watch = inotify_add_watch (fd, tree.getFile (index).getFullPathName().toUTF8(),
+                                             IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY
+                                              | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF);
+        if (watch < 0)
+            return false;
+
+        tree.setWatch (index, watch);
+        watchedNodes.set (watch, index);
+        return true;
+    }
+
+    void removeWatches (Tree& tree)
+    {
+        for (int i = 0; i < tree.watchesToRemove.size(); ++i)
+        {
+            const int watch = tree.watchesToRemove.getUnchecked (i);
+
+            if (watchedNodes.contains (watch))
+            {
+                watchedNodes.remove (watch);
+                inotify_rm_watch (fd, watch);
+            }
+        }
+
+        tree.watchesToRemove.clearQuick();
+    }
+
+    void run()
+    {
+        while (! threadShouldExit())
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if (poll (&pfd, 1, 100) <= 0)
+                continue;
+
+            const ssize_t bytesRead = read (fd, buffer, bufferSize);
+
+            if (bytesRead <= 0)
+                continue;
+
+            const ScopedWriteLock sl (owner.lock);
+
+            if (threadShouldExit())
+                break;
+
+            for (ssize_t i = 0; i + (ssize_t) sizeof (inotify_event) <= bytesRead;)
+            {
+                const inotify_event& e = *reinterpret_cast <const inotify_event*> (buffer + i);
+                handleEvent (e);
+                i += (ssize_t) (sizeof (inotify_event) + e.len);
+            }
+
+            removeWatches (*owner.tree);
+            owner.tree->compactNamesIfNeeded();
+        }
+    }
+
+private:
+    FileIndex& owner;
+    const int fd;
+    HashMap<int, int> watchedNodes;
+    enum { bufferSize = 65536 };
+    HeapBlock<char> buffer;
+
+    void handleEvent (const inotify_event& e)
+    {
+        Tree& tree = *owner.tree;
+
+        if ((e.mask & IN_Q_OVERFLOW) != 0)
+        {
+            // some events have been lost, so the whole tree needs to be checked again..
+            Array<int> directories;
+            tree.getDirectories (directories);
+            owner.updateDirectories (directories, false);
+            return;
+        }
+
+        if (! watchedNodes.contains (e.wd))
+            return;
+
+        const int directory = watchedNodes [e.wd];
+
+        if ((e.mask & IN_IGNORED) != 0)
+        {
+            watchedNodes.remove (e.wd);
+
+            if (tree.isDirectory (directory) && tree.getNode (directory).watch == e.wd)
+                tree.setWatch (directory, -1);
+        }
+        else if ((e.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+        {
+            // (the parent directory's events will take care of anything but the root)
+            if (directory == 0)
+                tree.removeChildren (0);
+        }
+        else if (e.len > 0)
+        {
+            updateEntry (tree, directory, String::fromUTF8 (e.name));
+        }
+    }
+
+    void updateEntry (Tree& tree, const int directory, const String& name)
+    {
+        const File file (tree.getFile (directory).getChildFile (name));
+        const char* const nameUTF8 = name.toUTF8();
+        const int nameLength = (int) strlen (nameUTF8);
+
+        int child = tree.findChild (directory, nameUTF8, nameLength);
+
+        if (! file.exists())
+        {
+            if (child >= 0)
+                tree.removeNode (child);
+
+            return;
+        }
+
+        const bool isDir = file.isDirectory();
+
+        if (child >= 0 && tree.isDirectory (child) != isDir)
+        {
+            tree.removeNode (child);
+            child = -1;
+        }
+
+        const bool isNew = child < 0;
+        child = tree.addChild (directory, nameUTF8, nameLength, Tree::getFlags (isDir, file.isHidden()),
+                               file.getSize(), file.getLastModificationTime().toMilliseconds());
+
+        if (isNew && isDir)
+        {
+            // A directory that has just appeared (or been moved here) may already have
+            // things inside it, so it's watched first, and then listed.
+            watchDirectory (tree, child);
+
+            Array<int> directories;
+            directories.add (child);
+            owner.updateDirectories (directories, false);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Watcher);
+};
+
+#else
+
+// (there's no implementation of this for other platforms yet, so it's never created)
+class FileIndex::Watcher
+{
+public:
+    bool watchDirectory (Tree&, int)            { return false; }
+    void removeWatches (Tree& tree)             { tree.watchesToRemove.clearQuick(); }
+};
+
+#endif
+
+//==============================================================================
+FileIndex::FileIndex (const File& rootDirectory_)
+    : rootDirectory (rootDirectory_),
+      tree (new Tree (rootDirectory_))
+{
+}
+
+FileIndex::~FileIndex()
+{
+    stopWatching();
+}
+
+//==============================================================================
+void FileIndex::rebuild (ThreadPool* const threadPoolToUse)
+{
+    ScopedPointer<Tree> newTree (new Tree (rootDirectory));
+    newTree->scan (0, rootDirectory, threadPoolToUse);
+    swapTree (newTree);
+}
+
+void FileIndex::swapTree (ScopedPointer<Tree>& newTree)
+{
+    const bool wasWatching = isWatching();
+    stopWatching();
+
+    {
+        const ScopedWriteLock sl (lock);
+        tree.swapWith (newTree);
+    }
+
+    newTree = nullptr;
+
+    if (wasWatching)
+        startWatching();
+}
+
+int FileIndex::updateChangedDirectories()
+{
+    const ScopedWriteLock sl (lock);
+
+    const int64 startTime = Time::currentTimeMillis();
+
+    Array<int> directories;
+    tree->getDirectories (directories);
+    const int numUpdated = updateDirectories (directories, true);
+    tree->lastUpdateTime = startTime;
+    tree->compactNamesIfNeeded();
+    return numUpdated;
+}
+
+int FileIndex::updateDirectories (Array<int>& directories, const bool onlyIfModified)
+{
+    const int numToCheck = directories.size();
+    int numUpdated = 0;
+
+    // (any new subdirectories that are found get added to the end of the array, and
+    // those always need to be listed)
+    for (int i = 0; i < directories.size(); ++i)
+    {
+        const int index = directories.getUnchecked (i);
+
+        if (! tree->isDirectory (index))
+            continue;
+
+        if (onlyIfModified && i < numToCheck && ! tree->mayHaveChanged (index))
+            continue;
+
+        const int firstNewDirectory = directories.size();
+        tree->updateDirectory (index, directories);
+        ++numUpdated;
+
+        if (watcher != nullptr)
+        {
+            watcher->removeWatches (*tree);
+
+            for (int j = firstNewDirectory; j < directories.size(); ++j)
+                watcher->watchDirectory (*tree, directories.getUnchecked (j));
+        }
+    }
+
+    return numUpdated;
+}
+
+int FileIndex::getNumFiles() const
+{
+    const ScopedReadLock sl (lock);
+    return tree->getNumFiles();
+}
+
+//==============================================================================
+bool FileIndex::startWatching()
+{
+   #if JUCE_LINUX
+    if (isWatching())
+        return true;
+
+    ScopedPointer<Watcher> newWatcher (new Watcher (*this));
+
+    if (! newWatcher->isOpen())
+        return false;
+
+    bool allWatched = true;
+
+    {
+        const ScopedWriteLock sl (lock);
+        watcher = newWatcher.release();
+
+        Array<int> directories;
+        tree->getDirectories (directories);
+
+        for (int i = 0; i < directories.size(); ++i)
+            if (! watcher->watchDirectory (*tree, directories.getUnchecked (i)))
+                allWatched = false;
+    }
+
+    watcher->startThread();
+    return allWatched;
+   #else
+    return false;
+   #endif
+}
+
+void FileIndex::stopWatching()
+{
+    ScopedPointer<Watcher> oldWatcher;
+
+    {
+        const ScopedWriteLock sl (lock);
+
+       #if JUCE_LINUX
+        if (watcher != nullptr)
+            watcher->signalThreadShouldExit();
+       #endif
+
+        oldWatcher = watcher.release();
+        tree->clearWatches();
+        tree->watchesToRemove.clearQuick();
+    }
+
+    // (the watcher's thread may be waiting for the lock, so it's deleted after that's released)
+    oldWatcher = nullptr;
+}
+
+//==============================================================================
+int FileIndex::findFiles (Array<File>& results, const String& wildcard,
+                          const int whatToLookFor, const bool ignoreCase, const int maxNumResults) const
+{
+    return findMatches (results, wildcard, true, whatToLookFor, ignoreCase, maxNumResults);
+}
+
+int FileIndex::findFilesContaining (Array<File>& results, const String& substring,
+                                    const int whatToLookFor, const bool ignoreCase, const int maxNumResults) const
+{
+    return findMatches (results, substring, false, whatToLookFor, ignoreCase, maxNumResults);
+}
+
+int FileIndex::findMatches (Array<File>& results, const String& text, const bool isWildcard,
+                            const int whatToLookFor, const bool ignoreCase, const int maxNumResults) const
+{
+    const FileIndexHelpers::NamePattern pattern (text, isWildcard, ignoreCase);
+    const int hiddenFlags = (whatToLookFor & File::ignoreHiddenFiles) != 0 ? (Tree::hiddenFlag | Tree::insideHiddenFlag) : 0;
+    int numFound = 0;
+
+    const ScopedReadLock sl (lock);
+    const char* const names = tree->getNames (ignoreCase);
+
+    for (int i = 1; i < tree->getNumNodes(); ++i)
+    {
+        const Tree::Node& n = tree->getNode (i);
+
+        if ((n.flags & (Tree::freeFlag | hiddenFlags)) == 0
+             && (whatToLookFor & ((n.flags & Tree::directoryFlag) != 0 ? File::findDirectories : File::findFiles)) != 0
+             && pattern.matches (names + n.nameStart, n.nameLength))
+        {
+            results.add (tree->getFile (i));
+
+            if (++numFound == maxNumResults)
+                break;
+        }
+    }
+
+    return numFound;
+}
+
+bool FileIndex::getFileDetails (const File& file, FileDetails* const details) const
+{
+    const ScopedReadLock sl (lock);
+    const int index = tree->findFile (file);
+
+    if (index < 0)
+        return false;
+
+    if (details != nullptr)
+    {
+        const Tree::Node& n = tree->getNode (index);
+        details->fileSize = n.fileSize;
+        details->modificationTime = Time (n.modificationTime);
+        details->isDirectory = (n.flags & Tree::directoryFlag) != 0;
+        details->isHidden = (n.flags & Tree::hiddenFlag) != 0;
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool FileIndex::saveSnapshot (const File& snapshotFile) const
+{
+    MemoryOutputStream out;
+
+    {
+        const ScopedReadLock sl (lock);
+        tree->writeTo (out);
+    }
+
+    return snapshotFile.replaceWithData (out.getData(), out.getDataSize());
+}
+
+bool FileIndex::loadSnapshot (const File& snapshotFile)
+{
+    MemoryBlock data;
+
+    if (! snapshotFile.loadFileAsData (data))
+        return false;
+
+    ScopedPointer<Tree> newTree (new Tree (rootDirectory));
+
+    if (! newTree->readFrom (data))
+        return false;
+
+    swapTree (newTree);
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FileIndexTests  : public UnitTest
+{
+public:
+    FileIndexTests() : UnitTest ("FileIndex") {}
+
+    static StringArray getPaths (const Array<File>& files)
+    {
+        StringArray paths;
+
+        for (int i = 0; i < files.size(); ++i)
+            paths.add (files.getReference (i).getFullPathName());
+
+        paths.sort (false);
+        return paths;
+    }
+
+    static StringArray find (const FileIndex& index, const String& wildcard, int whatToLookFor = File::findFiles)
+    {
+        Array<File> results;
+        index.findFiles (results, wildcard, whatToLookFor);
+        return getPaths (results);
+    }
+
+    static StringArray findWithIterator (const File& folder, const String& wildcard, int whatToLookFor = File::findFiles)
+    {
+        Array<File> results;
+        folder.findChildFiles (results, whatToLookFor, true, wildcard);
+        return getPaths (results);
+    }
+
+    void runTest()
+    {
+        beginTest ("Searches");
+
+        const File folder (File::getSpecialLocation (File::tempDirectory)
+                             .getChildFile ("Juce FileIndex Test Folder"));
+        expect (folder.deleteRecursively());
+
+        for (int i = 0; i < 10; ++i)
+        {
+            File subFolder (folder.getChildFile (i % 4 == 0 ? ".hidden" + String (i) : "sub" + String (i)));
+
+            if (i % 3 == 0)
+                subFolder = subFolder.getChildFile ("nested");
+
+            expect (subFolder.createDirectory());
+
+            for (int j = 0; j < 20; ++j)
+                expect (subFolder.getChildFile ("file" + String (j) + ((j % 3) == 0 ? ".txt" : ".dat"))
+                                 .replaceWithText (String::repeatedString ("x", j)));
+        }
+
+        const File unicodeFile (folder.getChildFile (CharPointer_UTF8 ("sub1/n\xc3\xa4me.txt")));
+        expect (unicodeFile.replaceWithText ("abc"));
+
+        FileIndex index (folder);
+        expectEquals (index.getNumFiles(), 0);
+        index.rebuild();
+
+        StringArray all (findWithIterator (folder, "*", File::findFilesAndDirectories));
+        expectEquals (index.getNumFiles(), all.size());
+        expect (find (index, "*", File::findFilesAndDirectories) == all);
+        expect (find (index, "*.txt") == findWithIterator (folder, "*.txt"));
+        expect (find (index, "*.TXT") == find (index, "*.txt"));
+        expect (find (index, "file1?.dat") == findWithIterator (folder, "file1?.dat"));
+        expect (find (index, "nested", File::findDirectories) == findWithIterator (folder, "nested", File::findDirectories));
+        expect (find (index, "*.txt", File::findFiles | File::ignoreHiddenFiles)
+                  == findWithIterator (folder, "*.txt", File::findFiles | File::ignoreHiddenFiles));
+        expect (find (index, CharPointer_UTF8 ("n?me.txt")) == StringArray (unicodeFile.getFullPathName()));
+
+        {
+            Array<File> results;
+            expectEquals (index.findFilesContaining (results, "LE1", File::findFiles, false), 0);
+            expectEquals (index.findFilesContaining (results, "LE1"), 11 * 10);
+            expectEquals (index.findFilesContaining (results, "e1", File::findFiles, true, 5), 5);
+        }
+
+        FileIndex::FileDetails details;
+        expect (index.getFileDetails (unicodeFile, &details));
+        expect (details.fileSize == 3);
+        expect (details.modificationTime == unicodeFile.getLastModificationTime());
+        expect (! (details.isDirectory || details.isHidden));
+        expect (index.getFileDetails (folder.getChildFile (".hidden4"), &details));
+        expect (details.isDirectory && details.isHidden);
+        expect (! index.getFileDetails (folder.getChildFile ("sub2/missing")));
+
+        beginTest ("Snapshots");
+
+        const File snapshot (folder.getSiblingFile ("Juce FileIndex Test Snapshot"));
+        expect (index.saveSnapshot (snapshot));
+
+        {
+            FileIndex loaded (folder);
+            expect (loaded.loadSnapshot (snapshot));
+            expectEquals (loaded.getNumFiles(), index.getNumFiles());
+            expect (find (loaded, "*", File::findFilesAndDirectories) == all);
+            expect (find (loaded, "*.txt", File::findFiles | File::ignoreHiddenFiles)
+                      == find (index, "*.txt", File::findFiles | File::ignoreHiddenFiles));
+
+            expect (folder.getChildFile ("sub2/new/deeper").createDirectory());
+            expect (folder.getChildFile ("sub2/new/deeper/added.txt").create());
+            expect (folder.getChildFile ("sub5/file0.txt").deleteFile());
+            expect (loaded.updateChangedDirectories() > 0);
+            expect (find (loaded, "*", File::findFilesAndDirectories)
+                      == findWithIterator (folder, "*", File::findFilesAndDirectories));
+
+            FileIndex other (folder.getChildFile ("sub2"));
+            expect (! other.loadSnapshot (snapshot));
+
+            expect (snapshot.replaceWithText ("not a snapshot"));
+            expect (! loaded.loadSnapshot (snapshot));
+            expect (find (loaded, "added.txt").size() == 1);
+        }
+
+        expect (snapshot.deleteFile());
+
+       #if JUCE_LINUX
+        beginTest ("Watching");
+
+        index.rebuild();
+        expect (index.startWatching());
+
+        expect (folder.getChildFile ("sub7/watched.txt").replaceWithText ("abc"));
+        expect (folder.getChildFile ("sub8/moved/inside").createDirectory());
+        expect (folder.getChildFile ("sub8/moved/inside/watched.txt").create());
+        expect (folder.getChildFile ("sub8/moved").moveFileTo (folder.getChildFile ("sub1/moved")));
+        expect (folder.getChildFile ("sub2").deleteRecursively());
+        expect (folder.getChildFile ("sub1/moved/inside/later.txt").create());
+
+        const StringArray expected (findWithIterator (folder, "*", File::findFilesAndDirectories));
+
+        for (int i = 0; i < 200 && find (index, "*", File::findFilesAndDirectories) != expected; ++i)
+            Thread::sleep (10);
+
+        expect (find (index, "*", File::findFilesAndDirectories) == expected);
+        expect (index.getFileDetails (folder.getChildFile ("sub7/watched.txt"), &details));
+        expect (details.fileSize == 3);
+
+        index.stopWatching();
+        expect (! index.isWatching());
+       #endif
+
+        expect (folder.deleteRecursively());
+    }
+};
+
+static FileIndexTests fileIndexTests;
+
+#endif
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_FILEINDEX_JUCEHEADER__
+#define __JUCE_FILEINDEX_JUCEHEADER__
+
+#include "juce_File.h"
+#include "../threads/juce_ReadWriteLock.h"
+#include "../memory/juce_ScopedPointer.h"
+
+class ThreadPool;
+
+
+//==============================================================================
+/**
+    Keeps an in-memory index of all the files in a directory tree, so that they can be
+    searched without going back to the disk.
+
+    The index holds the name, size, modification time and type of every file and
+    subdirectory below its root. Searching it by filename is a scan of a compact
+    block of names, so even for trees of a million files a search takes milliseconds,
+    rather than the seconds that a recursive DirectoryIterator would take, e.g.
+    @code
+    FileIndex index (File ("~/Music"));
+    index.rebuild (&threadPool);   // (or load a snapshot that was saved earlier)
+    index.startWatching();
+
+    Array<File> results;
+    index.findFiles (results, "*.wav");
+    @endcode
+
+    On Linux, startWatching() uses inotify to keep the index up to date as files are
+    created, changed, moved and deleted. On other platforms, or if the system runs out
+    of inotify watches, you'll need to call rebuild() or updateChangedDirectories() to
+    pick up any changes.
+
+    The index can be saved to a compact snapshot file with saveSnapshot(), and loaded
+    again with loadSnapshot(), which is much quicker than scanning the whole tree.
+
+    The methods can be called from any thread. Searches can carry on while rebuild()
+    is scanning the tree, but they'll wait while changes are being applied.
+
+    @see DirectoryIterator
+*/
+class JUCE_API  FileIndex
+{
+public:
+    //==============================================================================
+    /** Creates an empty index for the given directory.
+        Call rebuild() or loadSnapshot() to fill it.
+    */
+    explicit FileIndex (const File& rootDirectory);
+
+    /** Destructor. */
+    ~FileIndex();
+
+    //==============================================================================
+    /** Returns the directory that this index covers. */
+    const File& getRootDirectory() const noexcept           { return rootDirectory; }
+
+    /** Clears the index and scans the whole tree again.
+
+        If a ThreadPool is supplied, its threads are used to scan several subdirectories
+        at once. While the scan runs, the index keeps its old contents, so it can still be
+        searched. If the index is being watched, it carries on being watched afterwards.
+    */
+    void rebuild (ThreadPool* threadPoolToUse = nullptr);
+
+    /** Rescans any directories in the index whose modification time has changed, and
+        returns the number of directories that were rescanned.
+
+        A directory's modification time changes when files are added to, removed from or
+        renamed within it, so this is a quick way to bring an index that has been loaded
+        from a snapshot up to date. It won't notice changes to the contents of files that
+        are already in the index.
+    */
+    int updateChangedDirectories();
+
+    /** Returns the number of files and directories in the index (not counting the root). */
+    int getNumFiles() const;
+
+    //==============================================================================
+    /** Starts keeping the index up to date with any changes to the files on disk.
+
+        On Linux this watches every directory in the tree with inotify. It returns false
+        if the tree can't be watched, or if not all of its directories could be watched
+        (e.g. because the system's limit on inotify watches was reached) - in that case,
+        changes to the other directories are still picked up.
+    */
+    bool startWatching();
+
+    /** Stops watching for changes. */
+    void stopWatching();
+
+    /** Returns true if startWatching() has been called. */
+    bool isWatching() const noexcept                        { return watcher != nullptr; }
+
+    //==============================================================================
+    /** Finds all the files in the index whose names match a wildcard.
+
+        The wildcard can contain '*' and '?' characters, like String::matchesWildcard().
+        The results are added to the array in no particular order.
+
+        @param results          the array to add the files to
+        @param wildcard         the pattern that the filenames must match
+        @param whatToLookFor    a value from the File::TypesOfFileToFind enum
+        @param ignoreCase       whether the match ignores the case of ASCII characters
+        @param maxNumResults    if this is greater than zero, the search stops when it has
+                                found this many files
+        @returns the number of files that were added to the array
+    */
+    int findFiles (Array<File>& results,
+                   const String& wildcard,
+                   int whatToLookFor = File::findFiles,
+                   bool ignoreCase = true,
+                   int maxNumResults = 0) const;
+
+    /** Finds all the files in the index whose names contain a substring.
+
+        The parameters work in the same way as for findFiles().
+    */
+    int findFilesContaining (Array<File>& results,
+                             const String& substring,
+                             int whatToLookFor = File::findFiles,
+                             bool ignoreCase = true,
+                             int maxNumResults = 0) const;
+
+    /** The details that an index holds for each of its files. */
+    struct FileDetails
+    {
+        int64 fileSize;
+        Time modificationTime;
+        bool isDirectory;
+        bool isHidden;
+    };
+
+    /** Looks up a file in the index, and returns true if it's there.
+        If the details pointer isn't null, it's filled in with the file's details.
+    */
+    bool getFileDetails (const File& file, FileDetails* details = nullptr) const;
+
+    //==============================================================================
+    /** Writes the whole index to a file.
+        @see loadSnapshot
+    */
+    bool saveSnapshot (const File& snapshotFile) const;
+
+    /** Replaces the contents of the index with a snapshot that was saved by saveSnapshot().
+
+        This fails if the file isn't a valid snapshot, or if it was saved from an index of
+        a different directory. The files on disk may have changed since the snapshot was
+        saved, so you may want to call updateChangedDirectories() afterwards.
+    */
+    bool loadSnapshot (const File& snapshotFile);
+
+private:
+    //==============================================================================
+    class Tree;
+    class Watcher;
+    friend class ScopedPointer<Tree>;
+    friend class ScopedPointer<Watcher>;
+
+    const File rootDirectory;
+    ReadWriteLock lock;
+    ScopedPointer<Tree> tree;
+    ScopedPointer<Watcher> watcher;
+
+    void swapTree (ScopedPointer<Tree>& newTree);
+    int updateDirectories (Array<int>& directories, bool onlyIfModified);
+    int findMatches (Array<File>&, const String&, bool isWildcard, int whatToLookFor, bool ignoreCase, int maxNumResults) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileIndex);
+};
+
+
+#endif   // __JUCE_FILEINDEX_JUCEHEADER__
@@ -26,109 +26,194 @@
 class JSONParser
 {
 public:
-    static Result parseAny (String::CharPointerType& t, var& result)
+    JSONParser (const char* const start, const char* const end_) noexcept
+        : t (start), end (end_), scratchSize (0)
     {
-        t = t.findEndOfWhitespace();
-        String::CharPointerType t2 (t);
+    }
+
+    Result parse (var& result)
+    {
+        if (parseAny (result))
+            return Result::ok();
+
+        return Result::fail (errorMessage);
+    }
+
+private:
+    //==============================================================================
+    // The text is read as raw UTF-8 bytes, and doesn't need to be null-terminated.
+    const char* t;
+    const char* const end;
+    String errorMessage;
+    HeapBlock<char> scratch;
+    size_t scratchSize;
+
+    bool fail (const char* const message, const char* const location = nullptr)
+    {
+        errorMessage = message;
 
-        switch (t2.getAndAdvance())
+        if (location != nullptr)
         {
-            case '{':    t = t2; return parseObject (t, result);
-            case '[':    t = t2; return parseArray (t, result);
-            case '"':    t = t2; return parseString (t, result);
+            const char* e = location;
 
-            case '-':
-                t2 = t2.findEndOfWhitespace();
-                if (! CharacterFunctions::isDigit (*t2))
-                    break;
+            for (int i = 20; --i >= 0 && e < end && *e != 0;)
+                while (++e < end && (*e & 0xc0) == 0x80) {}
 
-                t = t2;
-                return parseNumber (t, result, true);
+            errorMessage << ": \"" << String (CharPointer_UTF8 (location), CharPointer_UTF8 (e)) << '"';
+        }
 
-            case '0': case '1': case '2': case '3': case '4':
-            case '5': case '6': case '7': case '8': case '9':
-                return parseNumber (t, result, false);
+        return false;
+    }
 
-            case 't':   // "true"
-                if (t2.getAndAdvance() == 'r' && t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'e')
-                {
-                    t = t2;
-                    result = var (true);
-                    return Result::ok();
-                }
-                break;
+    char peek() const noexcept
+    {
+        return t < end ? *t : 0;
+    }
 
-            case 'f':   // "false"
-                if (t2.getAndAdvance() == 'a' && t2.getAndAdvance() == 'l'
-                      && t2.getAndAdvance() == 's' && t2.getAndAdvance() == 'e')
-                {
-                    t = t2;
-                    result = var (false);
-                    return Result::ok();
-                }
+    char getAndAdvance() noexcept
+    {
+        return t < end ? *t++ : 0;
+    }
+
+    static uint64 readEightBytes (const char* const p) noexcept
+    {
+        uint64 v;
+        memcpy (&v, p, sizeof (v));
+        return v;
+    }
+
+    static uint64 hasZeroByte (const uint64 v) noexcept
+    {
+        return (v - literal64bit (0x0101010101010101)) & ~v & literal64bit (0x8080808080808080);
+    }
+
+    void skipWhitespace() noexcept
+    {
+        while (t < end)
+        {
+            // (indentation is usually a run of spaces, so these are skipped 8 at a time)
+            if (end - t >= 8 && readEightBytes (t) == literal64bit (0x2020202020202020))
+                t += 8;
+            else if (CharacterFunctions::isWhitespace (*t))
+                ++t;
+            else
                 break;
+        }
+    }
 
-            case 'n':   // "null"
-                if (t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'l' && t2.getAndAdvance() == 'l')
-                {
-                    t = t2;
-                    result = var::null;
-                    return Result::ok();
-                }
+    /* Returns the first quote, backslash or null character at or after p, checking
+       8 bytes at a time.
+    */
+    const char* findEndOfStringRun (const char* p) const noexcept
+    {
+        for (;;)
+        {
+            while (end - p >= 8)
+            {
+                const uint64 v = readEightBytes (p);
+
+                if ((hasZeroByte (v)
+                      | hasZeroByte (v ^ literal64bit (0x2222222222222222))
+                      | hasZeroByte (v ^ literal64bit (0x5c5c5c5c5c5c5c5c))) != 0)
+                    break;
+
+                p += 8;
+            }
+
+            const char* const blockEnd = p + jmin ((ptrdiff_t) 8, end - p);
+
+            for (; p < blockEnd; ++p)
+                if (*p == '"' || *p == '\\' || *p == 0)
+                    return p;
+
+            if (p >= end)
+                return end;
+        }
+    }
+
+    //==============================================================================
+    bool parseAny (var& result)
+    {
+        skipWhitespace();
+
+        switch (peek())
+        {
+            case '{':    ++t; return parseObject (result);
+            case '[':    ++t; return parseArray (result);
+            case '"':    ++t; return parseString (result);
+
+            case '-':
+            {
+                const char* const oldT = t++;
+                skipWhitespace();
+
+                if (CharacterFunctions::isDigit (peek()))
+                    return parseNumber (result, true);
+
+                t = oldT;
                 break;
+            }
+
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                return parseNumber (result, false);
+
+            case 't':   if (matches ("true"))   { t += 4; result = var (true);  return true; }  break;
+            case 'f':   if (matches ("false"))  { t += 5; result = var (false); return true; }  break;
+            case 'n':   if (matches ("null"))   { t += 4; result = var::null;   return true; }  break;
 
             default:
                 break;
         }
 
-        return createFail ("Syntax error", &t);
+        return fail ("Syntax error", t);
     }
 
-private:
-    static Result createFail (const char* const message, const String::CharPointerType* location = nullptr)
+    bool matches (const char* const keyword) const noexcept
     {
-        String m (message);
-        if (location != nullptr)
-            m << ": \"" << String (*location, 20) << '"';
-
-        return Result::fail (m);
+        const size_t len = strlen (keyword);
+        return (size_t) (end - t) >= len && memcmp (t, keyword, len) == 0;
     }
 
-    static Result parseNumber (String::CharPointerType& t, var& result, const bool isNegative)
+    bool parseNumber (var& result, const bool isNegative)
     {
-        String::CharPointerType oldT (t);
-
-        int64 intValue = t.getAndAdvance() - '0';
-        jassert (intValue >= 0 && intValue < 10);
+        const char* const oldT = t;
+        int64 intValue = 0;
 
         for (;;)
         {
-            String::CharPointerType previousChar (t);
-            const juce_wchar c = t.getAndAdvance();
+            const char c = peek();
             const int digit = ((int) c) - '0';
 
             if (isPositiveAndBelow (digit, 10))
             {
                 intValue = intValue * 10 + digit;
+                ++t;
                 continue;
             }
 
             if (c == 'e' || c == 'E' || c == '.')
             {
+                // copy the number, as the input isn't null-terminated
+                char number [64] = { 0 };
                 t = oldT;
-                const double asDouble = CharacterFunctions::readDoubleValue (t);
+
+                for (int i = 0; i < numElementsInArray (number) - 1 && t < end
+                                  && (CharacterFunctions::isDigit (*t) || *t == '.' || *t == 'e'
+                                       || *t == 'E' || *t == '+' || *t == '-'); ++i)
+                    number[i] = *t++;
+
+                CharPointer_ASCII n (number);
+                const double asDouble = CharacterFunctions::readDoubleValue (n);
                 result = isNegative ? -asDouble : asDouble;
-                return Result::ok();
+                return true;
             }
 
             if (CharacterFunctions::isWhitespace (c)
                  || c == ',' || c == '}' || c == ']' || c == 0)
-            {
-                t = previousChar;
                 break;
-            }
 
-            return createFail ("Syntax error in number", &oldT);
+            return fail ("Syntax error in number", oldT);
         }
 
         const int64 correctedValue = isNegative ? -intValue : intValue;
@@ -138,10 +223,19 @@ private:
         else
             result = (int) correctedValue;
 
-        return Result::ok();
+        return true;
     }
 
-    static Result parseObject (String::CharPointerType& t, var& result)
+    static Identifier createIdentifier (const char* const start, const char* const nameEnd)
+    {
+       #if JUCE_STRING_UTF_TYPE == 8
+        return Identifier (String::CharPointerType (start), String::CharPointerType (nameEnd));
+       #else
+        return Identifier (String (CharPointer_UTF8 (start), CharPointer_UTF8 (nameEnd)));
+       #endif
+    }
+
+    bool parseObject (var& result)
     {
         DynamicObject* const resultObject = new DynamicObject();
         result = resultObject;
@@ -149,48 +243,45 @@ private:
 
         for (;;)
         {
-            t = t.findEndOfWhitespace();
+            skipWhitespace();
 
-            String::CharPointerType oldT (t);
-            const juce_wchar c = t.getAndAdvance();
+            const char* oldT = t;
+            const char c = getAndAdvance();
 
             if (c == '}')
                 break;
 
             if (c == 0)
-                return createFail ("Unexpected end-of-input in object declaration");
+                return fail ("Unexpected end-of-input in object declaration");
 
             if (c == '"')
             {
-                var propertyNameVar;
-                Result r (parseString (t, propertyNameVar));
-
-                if (r.failed())
-                    return r;
+                const char* nameStart;
+                const char* nameEnd;
 
-                const String propertyName (propertyNameVar.toString());
+                if (! readString (nameStart, nameEnd))
+                    return false;
 
-                if (propertyName.isNotEmpty())
+                if (nameEnd > nameStart)
                 {
-                    t = t.findEndOfWhitespace();
+                    skipWhitespace();
                     oldT = t;
 
-                    const juce_wchar c2 = t.getAndAdvance();
-                    if (c2 != ':')
-                        return createFail ("Expected ':', but found", &oldT);
+                    if (getAndAdvance() != ':')
+                        return fail ("Expected ':', but found", oldT);
 
-                    resultProperties.set (propertyName, var::null);
-                    var* propertyValue = resultProperties.getVarPointer (propertyName);
+                    const Identifier propertyName (createIdentifier (nameStart, nameEnd));
+                    var propertyValue;
 
-                    Result r2 (parseAny (t, *propertyValue));
+                    if (! parseAny (propertyValue))
+                        return false;
 
-                    if (r2.failed())
-                        return r2;
+                    resultProperties.set (propertyName, propertyValue);
 
-                    t = t.findEndOfWhitespace();
+                    skipWhitespace();
                     oldT = t;
 
-                    const juce_wchar nextChar = t.getAndAdvance();
+                    const char nextChar = getAndAdvance();
 
                     if (nextChar == ',')
                         continue;
@@ -199,133 +290,241 @@ private:
                 }
             }
 
-            return createFail ("Expected object member declaration, but found", &oldT);
+            return fail ("Expected object member declaration, but found", oldT);
         }
 
-        return Result::ok();
+        return true;
     }
 
-    static Result parseArray (String::CharPointerType& t, var& result)
+    bool parseArray (var& result)
     {
         result = var (Array<var>());
         Array<var>* const destArray = result.getArray();
 
         for (;;)
         {
-            t = t.findEndOfWhitespace();
+            skipWhitespace();
 
-            String::CharPointerType oldT (t);
-            const juce_wchar c = t.getAndAdvance();
+            const char c = peek();
 
             if (c == ']')
+            {
+                ++t;
                 break;
+            }
 
             if (c == 0)
-                return createFail ("Unexpected end-of-input in array declaration");
+                return fail ("Unexpected end-of-input in array declaration");
 
-            t = oldT;
             destArray->add (var::null);
-            Result r (parseAny (t, destArray->getReference (destArray->size() - 1)));
-
-            if (r.failed())
-                return r;
 
-            t = t.findEndOfWhitespace();
-            oldT = t;
+            if (! parseAny (destArray->getReference (destArray->size() - 1)))
+                return false;
 
-            const juce_wchar nextChar = t.getAndAdvance();
+            skipWhitespace();
+            const char* const oldT = t;
+            const char nextChar = getAndAdvance();
 
             if (nextChar == ',')
                 continue;
             else if (nextChar == ']')
                 break;
 
-            return createFail ("Expected object array item, but found", &oldT);
+            return fail ("Expected object array item, but found", oldT);
         }
 
-        return Result::ok();
+        return true;
+    }
+
+    bool parseString (var& result)
+    {
+        const char* start;
+        const char* stringEnd;
+
+        if (! readString (start, stringEnd))
+            return false;
+
+        result = (start < stringEnd) ? String (CharPointer_UTF8 (start), CharPointer_UTF8 (stringEnd))
+                                     : String::empty;
+        return true;
     }
 
-    static Result parseString (String::CharPointerType& t, var& result)
+    /* Finds the end of the string that starts at t. If it contains no escape sequences,
+       this returns the range of the source text that it occupies - otherwise, it's decoded
+       into the scratch buffer, which stays valid until the next string is read.
+    */
+    bool readString (const char*& start, const char*& stringEnd)
     {
-        Array<juce_wchar> buffer;
-        buffer.ensureStorageAllocated (256);
+        const char* const stringStart = t;
+        bool hasEscapes = false;
 
         for (;;)
         {
-            juce_wchar c = t.getAndAdvance();
+            t = findEndOfStringRun (t);
 
-            if (c == '"')
+            if (t >= end || *t == 0)
+                return fail ("Unexpected end-of-input in string constant");
+
+            if (*t == '"')
                 break;
 
-            if (c == '\\')
+            hasEscapes = true;
+            t += 2; // (skips the backslash and the character after it)
+        }
+
+        start = stringStart;
+        stringEnd = t++;
+
+        return hasEscapes ? decodeEscapeSequences (start, stringEnd) : true;
+    }
+
+    static int readHexDigits (const char* const s) noexcept
+    {
+        int value = 0;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            const int digitValue = CharacterFunctions::getHexDigitValue ((juce_wchar) s[i]);
+
+            if (digitValue < 0)
+                return -1;
+
+            value = (value << 4) + digitValue;
+        }
+
+        return value;
+    }
+
+    bool decodeEscapeSequences (const char*& start, const char*& stringEnd)
+    {
+        // (the decoded string can't be longer than the original)
+        const size_t maxLength = (size_t) (stringEnd - start) + 1;
+
+        if (scratchSize < maxLength)
+        {
+            scratchSize = maxLength + maxLength / 2;
+            scratch.malloc (scratchSize);
+        }
+
+        const char* s = start;
+        CharPointer_UTF8 dest (scratch);
+
+        while (s < stringEnd)
+        {
+            if (*s != '\\')
+            {
+                const char* const runStart = s;
+
+                while (s < stringEnd && *s != '\\')
+                    ++s;
+
+                const size_t numBytes = (size_t) (s - runStart);
+                memcpy (dest.getAddress(), runStart, numBytes);
+                dest = CharPointer_UTF8 (dest.getAddress() + numBytes);
+                continue;
+            }
+
+            juce_wchar c = (juce_wchar) (uint8) s[1];
+            s += 2;
+
+            switch (c)
             {
-                c = t.getAndAdvance();
+                case 'b':  c = '\b'; break;
+                case 'f':  c = '\f'; break;
+                case 'n':  c = '\n'; break;
+                case 'r':  c = '\r'; break;
+                case 't':  c = '\t'; break;
 
-                switch (c)
+                case 'u':
                 {
-                    case '"':
-                    case '\\':
-                    case '/':  break;
+                    const int value = (stringEnd - s >= 4) ? readHexDigits (s) : -1;
+
+                    if (value < 0)
+                        return fail ("Syntax error in unicode escape sequence");
 
-                    case 'b':  c = '\b'; break;
-                    case 'f':  c = '\f'; break;
-                    case 'n':  c = '\n'; break;
-                    case 'r':  c = '\r'; break;
-                    case 't':  c = '\t'; break;
+                    c = (juce_wchar) value;
+                    s += 4;
 
-                    case 'u':
+                    // a surrogate pair..
+                    if (c >= 0xd800 && c <= 0xdbff && stringEnd - s >= 6 && s[0] == '\\' && s[1] == 'u')
                     {
-                        c = 0;
+                        const int low = readHexDigits (s + 2);
 
-                        for (int i = 4; --i >= 0;)
+                        if (low >= 0xdc00 && low <= 0xdfff)
                         {
-                            const int digitValue = CharacterFunctions::getHexDigitValue (t.getAndAdvance());
-                            if (digitValue < 0)
-                                return createFail ("Syntax error in unicode escape sequence");
-
-                            c = (juce_wchar) ((c << 4) + digitValue);
+                            c = (juce_wchar) (0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00));
+                            s += 6;
                         }
-
-                        break;
                     }
+
+                    break;
                 }
+
+                default:
+                    // (any other character is just taken literally)
+                    *dest.getAddress() = s[-1];
+                    dest = CharPointer_UTF8 (dest.getAddress() + 1);
+                    continue;
             }
 
             if (c == 0)
-                return createFail ("Unexpected end-of-input in string constant");
+                return fail ("Unexpected end-of-input in string constant");
 
-            buffer.add (c);
+            dest.write (c);
         }
 
-        buffer.add (0);
-        result = String (CharPointer_UTF32 (buffer.getRawDataPointer()));
-        return Result::ok();
+        start = scratch;
+        stringEnd = dest.getAddress();
+        return true;
     }
+
+    JUCE_DECLARE_NON_COPYABLE (JSONParser);
 };
 
 //==============================================================================
+/*  Writes JSON into a local buffer, which is passed on to the stream in large blocks. */
 class JSONFormatter
 {
 public:
-    static void write (OutputStream& out, const var& v,
-                       const int indentLevel, const bool allOnOneLine)
+    JSONFormatter (OutputStream& out_, const bool allOnOneLine_)
+        : out (out_), numBuffered (0), allOnOneLine (allOnOneLine_),
+          newLine (out_.getNewLineString().toUTF8())
+    {
+    }
+
+    ~JSONFormatter()
+    {
+        flush();
+    }
+
+    void write (const var& v, const int indentLevel)
     {
         if (v.isString())
         {
-            writeString (out, v.toString().getCharPointer());
+            writeString (v.toString().getCharPointer());
         }
         else if (v.isVoid())
         {
-            out << "null";
+            writeRaw ("null", 4);
         }
         else if (v.isBool())
         {
-            out << (static_cast<bool> (v) ? "true" : "false");
+            if (static_cast<bool> (v))
+                writeRaw ("true", 4);
+            else
+                writeRaw ("false", 5);
+        }
+        else if (v.isInt() || v.isInt64())
+        {
+            writeInteger (static_cast<int64> (v));
+        }
+        else if (v.isDouble())
+        {
+            writeDouble (static_cast<double> (v));
         }
         else if (v.isArray())
         {
-            writeArray (out, *v.getArray(), indentLevel, allOnOneLine);
+            writeArray (*v.getArray(), indentLevel);
         }
         else if (v.isObject())
         {
@@ -333,27 +532,117 @@ public:
 
             jassert (object != nullptr); // Only DynamicObjects can be converted to JSON!
 
-            writeObject (out, *object, indentLevel, allOnOneLine);
+            writeObject (*object, indentLevel);
         }
         else
         {
             jassert (! v.isMethod()); // Can't convert an object with methods to JSON!
 
-            out << v.toString();
+            const String s (v.toString());
+            writeRaw (s.toUTF8().getAddress(), (size_t) s.getNumBytesAsUTF8());
         }
     }
 
 private:
-    enum { indentSize = 2 };
+    enum { indentSize = 2, bufferSize = 8192 };
+
+    OutputStream& out;
+    char buffer [bufferSize];
+    size_t numBuffered;
+    const bool allOnOneLine;
+    const String newLine;
 
-    static void writeEscapedChar (OutputStream& out, const unsigned short value)
+    void flush()
     {
-        out << "\\u" << String::toHexString ((int) value).paddedLeft ('0', 4);
+        if (numBuffered > 0)
+        {
+            out.write (buffer, numBuffered);
+            numBuffered = 0;
+        }
     }
 
-    static void writeString (OutputStream& out, String::CharPointerType t)
+    char* getSpace (const size_t numBytes)
     {
-        out << '"';
+        jassert (numBytes <= bufferSize);
+
+        if (numBuffered + numBytes > bufferSize)
+            flush();
+
+        char* const space = buffer + numBuffered;
+        numBuffered += numBytes;
+        return space;
+    }
+
+    void writeChar (const char c)
+    {
+        *getSpace (1) = c;
+    }
+
+    void writeRaw (const char* const text, const size_t numBytes)
+    {
+        if (numBytes > bufferSize)
+        {
+            flush();
+            out.write (text, numBytes);
+        }
+        else
+        {
+            memcpy (getSpace (numBytes), text, numBytes);
+        }
+    }
+
+    void writeInteger (const int64 value)
+    {
+        char text [24];
+        char* const textEnd = text + numElementsInArray (text);
+        char* t = textEnd;
+        uint64 v = (uint64) (value >= 0 ? value : -value);
+
+        do
+        {
+            *--t = (char) ('0' + (int) (v % 10));
+            v /= 10;
+        }
+        while (v > 0);
+
+        if (value < 0)
+            *--t = '-';
+
+        writeRaw (t, (size_t) (textEnd - t));
+    }
+
+    void writeDouble (const double value)
+    {
+        // (this is the same format that String uses for a double)
+        char text [48];
+
+       #if JUCE_WINDOWS
+        const int len = _sprintf_l (text, "%.9g", _create_locale (LC_NUMERIC, "C"), value);
+       #elif JUCE_MAC || JUCE_IOS
+        const int len = sprintf_l (text, nullptr, "%.9g", value);
+       #else
+        const int len = sprintf (text, "%.9g", value);
+       #endif
+
+        writeRaw (text, (size_t) len);
+    }
+
+    void writeEscapedChar (const unsigned short value)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+        char* const d = getSpace (6);
+
+        d[0] = '\\';
+        d[1] = 'u';
+        d[2] = hexDigits [(value >> 12) & 15];
+        d[3] = hexDigits [(value >> 8) & 15];
+        d[4] = hexDigits [(value >> 4) & 15];
+        d[5] = hexDigits [value & 15];
+    }
+
+    void writeString (String::CharPointerType t)
+    {
+        writeChar ('"');
 
         for (;;)
         {
@@ -361,20 +650,20 @@ private:
 
             switch (c)
             {
-                case 0:  out << '"'; return;
+                case 0:  writeChar ('"'); return;
 
-                case '\"':  out << "\\\""; break;
-                case '\\':  out << "\\\\"; break;
-                case '\b':  out << "\\b";  break;
-                case '\f':  out << "\\f";  break;
-                case '\t':  out << "\\t";  break;
-                case '\r':  out << "\\r";  break;
-                case '\n':  out << "\\n";  break;
+                case '\"':  writeRaw ("\\\"", 2); break;
+                case '\\':  writeRaw ("\\\\", 2); break;
+                case '\b':  writeRaw ("\\b", 2);  break;
+                case '\f':  writeRaw ("\\f", 2);  break;
+                case '\t':  writeRaw ("\\t", 2);  break;
+                case '\r':  writeRaw ("\\r", 2);  break;
+                case '\n':  writeRaw ("\\n", 2);  break;
 
                 default:
                     if (c >= 32 && c < 127)
                     {
-                        out << (char) c;
+                        writeChar ((char) c);
                     }
                     else
                     {
@@ -385,11 +674,11 @@ private:
                             utf16.write (c);
 
                             for (int i = 0; i < 2; ++i)
-                                writeEscapedChar (out, (unsigned short) chars[i]);
+                                writeEscapedChar ((unsigned short) chars[i]);
                         }
                         else
                         {
-                            writeEscapedChar (out, (unsigned short) c);
+                            writeEscapedChar ((unsigned short) c);
                         }
                     }
 
@@ -398,93 +687,94 @@ private:
         }
     }
 
-    static void writeSpaces (OutputStream& out, int numSpaces)
+    void writeSpaces (int numSpaces)
+    {
+        while (numSpaces > 0)
+        {
+            const int num = jmin (numSpaces, (int) bufferSize);
+            memset (getSpace ((size_t) num), ' ', (size_t) num);
+            numSpaces -= num;
+        }
+    }
+
+    void writeNewLine()
     {
-        out.writeRepeatedByte (' ', numSpaces);
+        writeRaw (newLine.getCharPointer().getAddress(), (size_t) newLine.getNumBytesAsUTF8());
     }
 
-    static void writeArray (OutputStream& out, const Array<var>& array,
-                            const int indentLevel, const bool allOnOneLine)
+    void writeSeparator (const bool isLast)
     {
-        out << '[';
+        if (! isLast)
+        {
+            if (allOnOneLine)
+                writeRaw (", ", 2);
+            else
+            {
+                writeChar (',');
+                writeNewLine();
+            }
+        }
+        else if (! allOnOneLine)
+        {
+            writeNewLine();
+        }
+    }
+
+    void writeArray (const Array<var>& array, const int indentLevel)
+    {
+        writeChar ('[');
         if (! allOnOneLine)
-            out << newLine;
+            writeNewLine();
 
         for (int i = 0; i < array.size(); ++i)
         {
             if (! allOnOneLine)
-                writeSpaces (out, indentLevel + indentSize);
-
-            write (out, array.getReference(i), indentLevel + indentSize, allOnOneLine);
+                writeSpaces (indentLevel + indentSize);
 
-            if (i < array.size() - 1)
-            {
-                if (allOnOneLine)
-                    out << ", ";
-                else
-                    out << ',' << newLine;
-            }
-            else if (! allOnOneLine)
-                out << newLine;
+            write (array.getReference(i), indentLevel + indentSize);
+            writeSeparator (i == array.size() - 1);
         }
 
         if (! allOnOneLine)
-            writeSpaces (out, indentLevel);
+            writeSpaces (indentLevel);
 
-        out << ']';
+        writeChar (']');
     }
 
-    static void writeObject (OutputStream& out, DynamicObject& object,
-                             const int indentLevel, const bool allOnOneLine)
+    void writeObject (DynamicObject& object, const int indentLevel)
     {
         NamedValueSet& props = object.getProperties();
 
-        out << '{';
+        writeChar ('{');
         if (! allOnOneLine)
-            out << newLine;
+            writeNewLine();
 
-        LinkedListPointer<NamedValueSet::NamedValue>* i = &(props.values);
-
-        for (;;)
+        for (int i = 0; i < props.size(); ++i)
         {
-            NamedValueSet::NamedValue* const v = i->get();
-
-            if (v == nullptr)
-                break;
-
             if (! allOnOneLine)
-                writeSpaces (out, indentLevel + indentSize);
+                writeSpaces (indentLevel + indentSize);
 
-            writeString (out, v->name);
-            out << ": ";
-            write (out, v->value, indentLevel + indentSize, allOnOneLine);
-
-            if (v->nextListItem.get() != nullptr)
-            {
-                if (allOnOneLine)
-                    out << ", ";
-                else
-                    out << ',' << newLine;
-            }
-            else if (! allOnOneLine)
-                out << newLine;
-
-            i = &(v->nextListItem);
+            writeString (props.getName (i));
+            writeRaw (": ", 2);
+            write (props.getValueAt (i), indentLevel + indentSize);
+            writeSeparator (i == props.size() - 1);
         }
 
         if (! allOnOneLine)
-            writeSpaces (out, indentLevel);
+            writeSpaces (indentLevel);
 
-        out << '}';
+        writeChar ('}');
     }
+
+    JUCE_DECLARE_NON_COPYABLE (JSONFormatter);
 };
 
 //==============================================================================
 var JSON::parse (const String& text)
 {
     var result;
-    String::CharPointerType t (text.getCharPointer());
-    if (! JSONParser::parseAny (t, result))
+
+    if (! parse (text, result))
         result = var::null;
 
     return result;
@@ -492,30 +782,69 @@ var JSON::parse (const String& text)
 
 var JSON::parse (InputStream& input)
 {
-    return parse (input.readEntireStreamAsString());
+    MemoryBlock data;
+    input.readIntoMemoryBlock (data);
+
+    var result;
+
+    if (! parse (data.getData(), data.getSize(), result))
+        result = var::null;
+
+    return result;
 }
 
 var JSON::parse (const File& file)
 {
-    return parse (file.loadFileAsString());
+    var result;
+    Result r (Result::ok());
+
+    {
+        const MemoryMappedFile mappedFile (file, MemoryMappedFile::readOnly);
+
+        if (mappedFile.getData() != nullptr)
+            r = parse (mappedFile.getData(), mappedFile.getSize(), result);
+        else
+            r = parse (file.loadFileAsString(), result);
+    }
+
+    if (! r)
+        result = var::null;
+
+    return result;
 }
 
 Result JSON::parse (const String& text, var& result)
 {
-    String::CharPointerType t (text.getCharPointer());
-    return JSONParser::parseAny (t, result);
+    const CharPointer_UTF8 utf8 (text.toUTF8());
+    JSONParser parser (utf8.getAddress(), utf8.getAddress() + text.getNumBytesAsUTF8());
+    return parser.parse (result);
+}
+
+Result JSON::parse (const void* const utf8Data, const size_t numBytes, var& result)
+{
+    const uint8* const d = static_cast <const uint8*> (utf8Data);
+
+    // UTF-16 text has to be converted first..
+    if (numBytes >= 2 && ((d[0] == 0xff && d[1] == 0xfe) || (d[0] == 0xfe && d[1] == 0xff)))
+        return parse (String::createStringFromData (utf8Data, (int) numBytes), result);
+
+    const size_t bomSize = (numBytes >= 3 && d[0] == 0xef && d[1] == 0xbb && d[2] == 0xbf) ? 3 : 0;
+
+    JSONParser parser (reinterpret_cast <const char*> (d + bomSize), reinterpret_cast <const char*> (d + numBytes));
+    return parser.parse (result);
 }
 
 String JSON::toString (const var& data, const bool allOnOneLine)
 {
     MemoryOutputStream mo (1024);
-    JSONFormatter::write (mo, data, 0, allOnOneLine);
+    writeToStream (mo, data, allOnOneLine);
     return mo.toString();
 }
 
 void JSON::writeToStream (OutputStream& output, const var& data, const bool allOnOneLine)
 {
-    JSONFormatter::write (output, data, 0, allOnOneLine);
+    JSONFormatter formatter (output, allOnOneLine);
+    formatter.write (data, 0);
 }
 
 //==============================================================================
@@ -626,6 +955,27 @@ public:
             String parsedString (JSON::toString (parsed, oneLine));
             expect (asString.isNotEmpty() && parsedString == asString);
         }
+
+        beginTest ("Escapes and raw data");
+
+        expect (JSON::parse ("\"a\\\"b\\/\\n\\u00e9\"") == var (String (CharPointer_UTF8 ("a\"b/\n\xc3\xa9"))));
+        expect (JSON::parse ("\"\\ud83d\\ude00\"") == var (String::charToString ((juce_wchar) 0x1f600)));
+        expect (JSON::toString (String::charToString ((juce_wchar) 0x1f600)) == "\"\\ud83d\\ude00\"");
+        expect (JSON::parse ("\"abc") == var::null);
+        expect (JSON::parse ("[1, 2") == var::null);
+
+        {
+            const char data[] = "\xef\xbb\xbf {\"a\": [1, 2.5, \"x\"], \"b\": true, \"a\": null}";
+            var result;
+
+            // (the data isn't null-terminated, so the parser mustn't read past the end)
+            expect (JSON::parse (data, sizeof (data) - 1, result).wasOk());
+            expect (result.getDynamicObject()->getProperties().size() == 2);
+            expect (result ["a"].isVoid());
+            expect (result ["b"] == var (true));
+
+            expect (JSON::parse (data, sizeof (data) - 2, result).failed());
+        }
     }
 };
 
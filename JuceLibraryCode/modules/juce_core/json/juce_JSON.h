@@ -69,8 +69,8 @@ public:
     /** Attempts to parse some JSON-formatted text from a file, and returns the result
         as a var object.
 
-        Note that this is just a short-cut for reading the entire file into a string and
-        parsing the result.
+        The file is memory-mapped where possible, so that it can be parsed without
+        first being read into a string.
 
         If the parsing fails, this simply returns var::null - if you need to find out more
         detail about the parse error, use the alternative parse() method which returns a Result.
@@ -80,14 +80,22 @@ public:
     /** Attempts to parse some JSON-formatted text from a stream, and returns the result
         as a var object.
 
-        Note that this is just a short-cut for reading the entire stream into a string and
-        parsing the result.
+        Note that this reads the entire stream into memory before parsing it.
 
         If the parsing fails, this simply returns var::null - if you need to find out more
         detail about the parse error, use the alternative parse() method which returns a Result.
     */
     static var parse (InputStream& input);
 
+    /** Parses a block of UTF-8 JSON-formatted text, and returns a result code containing
+        any parse errors.
+
+        The text is read directly from the memory that is passed in, so this is the fastest
+        way to parse a large document that's already in memory, e.g. in a MemoryMappedFile.
+        The data doesn't need to be null-terminated.
+    */
+    static Result parse (const void* utf8Data, size_t numBytes, var& parsedResult);
+
     //==============================================================================
     /** Returns a string which contains a JSON-formatted representation of the var object.
         If allOnOneLine is true, the result will be compacted into a single line of text
@@ -101,6 +101,7 @@ namespace juce
 #include "containers/juce_Variant.cpp"
 #include "files/juce_DirectoryIterator.cpp"
 #include "files/juce_File.cpp"
+#include "files/juce_FileIndex.cpp"
 #include "files/juce_FileInputStream.cpp"
 #include "files/juce_FileOutputStream.cpp"
 #include "files/juce_FileSearchPath.cpp"
@@ -111,6 +112,8 @@ namespace juce
 #include "maths/juce_BigInteger.cpp"
 #include "maths/juce_Expression.cpp"
 #include "maths/juce_Random.cpp"
+#include "memory/juce_AllocationHooks.cpp"
+#include "memory/juce_MemoryArena.cpp"
 #include "memory/juce_MemoryBlock.cpp"
 #include "misc/juce_Result.cpp"
 #include "misc/juce_Uuid.cpp"
@@ -144,6 +147,7 @@ namespace juce
 #include "unit_tests/juce_UnitTest.cpp"
 #include "xml/juce_XmlDocument.cpp"
 #include "xml/juce_XmlElement.cpp"
+#include "xml/juce_XmlPullParser.cpp"
 #include "zip/juce_GZIPDecompressorInputStream.cpp"
 #include "zip/juce_GZIPCompressorOutputStream.cpp"
 #include "zip/juce_ZipFile.cpp"
@@ -198,3 +202,46 @@ namespace juce
 
 #endif
 }
+
+//==============================================================================
+#if JUCE_ENABLE_ALLOCATION_HOOKS
+// (these have to be in the global namespace)
+#if JUCE_LINUX
+ // With glibc, malloc itself can be replaced too, which also catches the allocations
+ // that HeapBlock (and so Array, EdgeTable, etc) make.
+ extern "C"
+ {
+     void* __libc_malloc (size_t);
+     void* __libc_calloc (size_t, size_t);
+     void* __libc_realloc (void*, size_t);
+     void  __libc_free (void*);
+
+     void* malloc (size_t size)                  { juce::AllocationHooks::allocationMade(); return __libc_malloc (size); }
+     void* calloc (size_t num, size_t size)      { juce::AllocationHooks::allocationMade(); return __libc_calloc (num, size); }
+     void* realloc (void* p, size_t size)        { juce::AllocationHooks::allocationMade(); return __libc_realloc (p, size); }
+     void  free (void* p)                        { __libc_free (p); }
+ }
+#endif
+
+void* operator new (std::size_t size) throw (std::bad_alloc)
+{
+   #if ! JUCE_LINUX
+    juce::AllocationHooks::allocationMade();
+   #endif
+
+    void* const p = std::malloc (size > 0 ? size : 1);
+
+    if (p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void* operator new[] (std::size_t size) throw (std::bad_alloc)
+{
+    return operator new (size);
+}
+
+void operator delete (void* p) throw()      { std::free (p); }
+void operator delete[] (void* p) throw()    { std::free (p); }
+#endif
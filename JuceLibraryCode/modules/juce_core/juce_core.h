@@ -77,6 +77,18 @@ namespace DummyNamespaceStatementToCatchSyntaxErrors {}
  #define JUCE_CHECK_MEMORY_LEAKS 1
 #endif
 
+//=============================================================================
+/** Config: JUCE_ENABLE_ALLOCATION_HOOKS
+
+    Replaces the global operator new (and on Linux, malloc) with versions that count
+    every allocation, so that tests and benchmarks can use the AllocationHooks class to
+    see how many allocations some code makes. This slows down every allocation a little,
+    so it should be left off in release builds.
+*/
+#ifndef JUCE_ENABLE_ALLOCATION_HOOKS
+ #define JUCE_ENABLE_ALLOCATION_HOOKS 0
+#endif
+
 //=============================================================================
 /** Config: JUCE_DONT_AUTOLINK_TO_WIN32_LIBRARIES
 
@@ -180,6 +192,9 @@ namespace juce
 #ifndef __JUCE_FILE_JUCEHEADER__
  #include "files/juce_File.h"
 #endif
+#ifndef __JUCE_FILEINDEX_JUCEHEADER__
+ #include "files/juce_FileIndex.h"
+#endif
 #ifndef __JUCE_FILEINPUTSTREAM_JUCEHEADER__
  #include "files/juce_FileInputStream.h"
 #endif
@@ -219,6 +234,9 @@ namespace juce
 #ifndef __JUCE_RANGE_JUCEHEADER__
  #include "maths/juce_Range.h"
 #endif
+#ifndef __JUCE_ALLOCATIONHOOKS_JUCEHEADER__
+ #include "memory/juce_AllocationHooks.h"
+#endif
 #ifndef __JUCE_ATOMIC_JUCEHEADER__
  #include "memory/juce_Atomic.h"
 #endif
@@ -234,6 +252,9 @@ namespace juce
 #ifndef __JUCE_MEMORY_JUCEHEADER__
  #include "memory/juce_Memory.h"
 #endif
+#ifndef __JUCE_MEMORYARENA_JUCEHEADER__
+ #include "memory/juce_MemoryArena.h"
+#endif
 #ifndef __JUCE_MEMORYBLOCK_JUCEHEADER__
  #include "memory/juce_MemoryBlock.h"
 #endif
@@ -408,6 +429,9 @@ namespace juce
 #ifndef __JUCE_XMLELEMENT_JUCEHEADER__
  #include "xml/juce_XmlElement.h"
 #endif
+#ifndef __JUCE_XMLPULLPARSER_JUCEHEADER__
+ #include "xml/juce_XmlPullParser.h"
+#endif
 #ifndef __JUCE_GZIPCOMPRESSOROUTPUTSTREAM_JUCEHEADER__
  #include "zip/juce_GZIPCompressorOutputStream.h"
 #endif
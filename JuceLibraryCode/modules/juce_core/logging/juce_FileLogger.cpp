@@ -23,6 +23,177 @@
   ==============================================================================
 */
 
+//==============================================================================
+/*  Collects the messages that are logged, and writes them to the file in batches.
+
+    Each message is pushed onto a lock-free list, so logging threads never wait for
+    each other or for the file. The writer thread takes the whole list at once, which
+    means that no entries are ever popped individually, so the list can't suffer from
+    the ABA problem.
+*/
+class FileLogger::Writer  : public Thread
+{
+public:
+    Writer (const File& file_, const int64 maxFileSizeBytes_, const int numOldFilesToKeep_)
+        : Thread ("FileLogger"),
+          file (file_),
+          maxFileSizeBytes (maxFileSizeBytes_),
+          numOldFilesToKeep (jmax (0, numOldFilesToKeep_))
+    {
+        startThread();
+    }
+
+    ~Writer()
+    {
+        stopThread (10000);
+
+        // (in case anything was logged while the thread was stopping)
+        writePendingMessages();
+    }
+
+    void add (const String& message)
+    {
+        Message* const m = new Message (message);
+
+        do
+        {
+            m->next = messages.get();
+        }
+        while (! messages.compareAndSetBool (m, m->next));
+
+        // (the writer only gets woken early if the queue is getting long)
+        if (((++numAdded) & 4095) == 0)
+            notify();
+    }
+
+    bool waitUntilWritten (const int timeOutMilliseconds)
+    {
+        const int64 target = numAdded.get();
+        const uint32 startTime = Time::getMillisecondCounter();
+
+        while (numWritten.get() < target)
+        {
+            const int elapsed = (int) (Time::getMillisecondCounter() - startTime);
+
+            if (timeOutMilliseconds >= 0 && elapsed >= timeOutMilliseconds)
+                return false;
+
+            notify();
+            batchWritten.wait (timeOutMilliseconds >= 0 ? jmin (10, timeOutMilliseconds - elapsed) : 10);
+        }
+
+        return true;
+    }
+
+    void run()
+    {
+        while (! threadShouldExit())
+        {
+            wait (writeIntervalMs);
+            writePendingMessages();
+        }
+    }
+
+private:
+    struct Message
+    {
+        Message (const String& text_) : text (text_), next (nullptr) {}
+
+        String text;
+        Message* next;
+    };
+
+    enum { writeIntervalMs = 20 };
+
+    const File file;
+    const int64 maxFileSizeBytes;
+    const int numOldFilesToKeep;
+    Atomic<Message*> messages;
+    Atomic<int64> numAdded, numWritten;
+    ScopedPointer<FileOutputStream> out;
+    MemoryOutputStream batch;
+    WaitableEvent batchWritten;
+
+    void writePendingMessages()
+    {
+        Message* m = messages.exchange (nullptr);
+
+        if (m == nullptr)
+            return;
+
+        // (the list is newest-first, so it needs reversing)
+        Message* oldestFirst = nullptr;
+        int numMessages = 0;
+
+        while (m != nullptr)
+        {
+            Message* const next = m->next;
+            m->next = oldestFirst;
+            oldestFirst = m;
+            m = next;
+            ++numMessages;
+        }
+
+        batch.reset();
+
+        while (oldestFirst != nullptr)
+        {
+            const ScopedPointer<Message> message (oldestFirst);
+            oldestFirst = message->next;
+            batch << message->text << newLine;
+        }
+
+        if (out != nullptr && maxFileSizeBytes > 0
+             && out->getPosition() > 0
+             && out->getPosition() + (int64) batch.getDataSize() > maxFileSizeBytes)
+            rotateFiles();
+
+        if (out == nullptr)
+        {
+            file.create();
+
+            // (a zero buffer size makes it write each batch straight to the file)
+            out = new FileOutputStream (file, 0);
+
+            if (out->failedToOpen())
+                out = nullptr;
+        }
+
+        if (out != nullptr)
+            out->write (batch.getData(), (int) batch.getDataSize());
+
+        numWritten += numMessages;
+        batchWritten.signal();
+    }
+
+    File getOldFile (const int index) const
+    {
+        return file.getSiblingFile (file.getFileNameWithoutExtension() + "." + String (index) + file.getFileExtension());
+    }
+
+    void rotateFiles()
+    {
+        out = nullptr;
+
+        if (numOldFilesToKeep > 0)
+        {
+            getOldFile (numOldFilesToKeep).deleteFile();
+
+            for (int i = numOldFilesToKeep; --i > 0;)
+                getOldFile (i).moveFileTo (getOldFile (i + 1));
+
+            file.moveFileTo (getOldFile (1));
+        }
+        else
+        {
+            file.deleteFile();
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Writer);
+};
+
+//==============================================================================
 FileLogger::FileLogger (const File& logFile_,
                         const String& welcomeMessage,
                         const int maxInitialFileSizeBytes)
@@ -51,10 +222,29 @@ FileLogger::~FileLogger()
 }
 
 //==============================================================================
+void FileLogger::startWritingOnBackgroundThread (const int64 maxFileSizeBytes, const int numOldFilesToKeep)
+{
+    const ScopedLock sl (logLock);
+
+    if (writer == nullptr)
+        writer = new Writer (logFile, maxFileSizeBytes, numOldFilesToKeep);
+}
+
+bool FileLogger::flush (const int timeOutMilliseconds)
+{
+    return writer == nullptr || writer->waitUntilWritten (timeOutMilliseconds);
+}
+
 void FileLogger::logMessage (const String& message)
 {
     DBG (message);
 
+    if (writer != nullptr)
+    {
+        writer->add (message);
+        return;
+    }
+
     const ScopedLock sl (logLock);
 
     FileOutputStream out (logFile, 256);
@@ -130,3 +320,114 @@ FileLogger* FileLogger::createDefaultAppLogger (const String& logFileSubDirector
 
     return new FileLogger (logFile, welcomeMessage, maxInitialFileSizeBytes);
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FileLoggerTests  : public UnitTest
+{
+public:
+    FileLoggerTests()   : UnitTest ("FileLogger") {}
+
+    class LoggingThread  : public Thread
+    {
+    public:
+        LoggingThread (FileLogger& logger_, const int index_)
+            : Thread ("logging test"), logger (logger_), index (index_)
+        {
+        }
+
+        void run()
+        {
+            for (int i = 0; i < numMessages; ++i)
+                logger.logMessage ("thread " + String (index) + " message " + String (i));
+        }
+
+        enum { numMessages = 500 };
+
+    private:
+        FileLogger& logger;
+        const int index;
+    };
+
+    void runTest()
+    {
+        beginTest ("Background writing");
+
+        const TemporaryFile temp (".txt");
+        const File& file = temp.getFile();
+        const int numThreads = 4;
+
+        {
+            FileLogger logger (file, "welcome", -1);
+            logger.startWritingOnBackgroundThread();
+
+            OwnedArray<LoggingThread> threads;
+
+            for (int i = 0; i < numThreads; ++i)
+                threads.add (new LoggingThread (logger, i));
+
+            for (int i = 0; i < numThreads; ++i)
+                threads.getUnchecked (i)->startThread();
+
+            for (int i = 0; i < numThreads; ++i)
+                threads.getUnchecked (i)->waitForThreadToExit (-1);
+
+            expect (logger.flush (5000));
+
+            StringArray lines;
+            lines.addLines (file.loadFileAsString());
+
+            Array<int> nextMessage;
+            nextMessage.insertMultiple (0, 0, numThreads);
+            bool allInOrder = true;
+
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                if (lines[i].startsWith ("thread "))
+                {
+                    const int thread = lines[i].fromFirstOccurrenceOf (" ", false, false).getIntValue();
+                    const int message = lines[i].fromLastOccurrenceOf (" ", false, false).getIntValue();
+
+                    allInOrder = allInOrder && nextMessage [thread] == message;
+                    nextMessage.set (thread, message + 1);
+                }
+            }
+
+            expect (allInOrder);
+
+            for (int i = 0; i < numThreads; ++i)
+                expectEquals (nextMessage[i], (int) LoggingThread::numMessages);
+        }
+
+        beginTest ("Rotation");
+
+        {
+            FileLogger logger (file, "welcome", 0);
+            logger.startWritingOnBackgroundThread (1000, 2);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                logger.logMessage (String (i) + " " + String::repeatedString ("x", 50));
+
+                if (i % 10 == 9)
+                    expect (logger.flush (5000));
+            }
+        }
+
+        const File oldFile1 (file.getSiblingFile (file.getFileNameWithoutExtension() + ".1.txt"));
+        const File oldFile2 (file.getSiblingFile (file.getFileNameWithoutExtension() + ".2.txt"));
+
+        expect (oldFile1.existsAsFile() && oldFile2.existsAsFile());
+        expect (! file.getSiblingFile (file.getFileNameWithoutExtension() + ".3.txt").exists());
+        expect (file.getSize() < 2000 && oldFile1.getSize() < 2000);
+        expect (file.loadFileAsString().contains ("199 xxx"));
+
+        oldFile1.deleteFile();
+        oldFile2.deleteFile();
+    }
+};
+
+static FileLoggerTests fileLoggerTests;
+
+#endif
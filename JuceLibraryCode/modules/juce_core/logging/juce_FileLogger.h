@@ -35,6 +35,11 @@
 /**
     A simple implemenation of a Logger that writes to a file.
 
+    By default, each message is written to the file before logMessage() returns. If
+    you're logging a lot, or from many threads, call startWritingOnBackgroundThread()
+    so that logMessage() just queues the message, and a background thread writes the
+    queued messages in batches.
+
     @see Logger
 */
 class JUCE_API  FileLogger  : public Logger
@@ -69,6 +74,33 @@ public:
 
     File getLogFile() const               { return logFile; }
 
+    //==============================================================================
+    /** Makes the logger write its messages on a background thread.
+
+        After this has been called, logMessage() doesn't take any locks or touch the file -
+        it just adds the message to a queue. A background thread keeps the file open, and
+        every few milliseconds it writes all the queued messages to it in a single write.
+
+        @param maxFileSizeBytes     if this is greater than zero, then whenever the file
+                                    grows past this size, it'll be renamed to a backup
+                                    (e.g. "MyAppLog.1.txt"), and a new file will be started
+        @param numOldFilesToKeep    the number of backups to keep when the file is being
+                                    rotated - the oldest ones are deleted
+
+        Call this before any other threads start logging to this object.
+        @see flush
+    */
+    void startWritingOnBackgroundThread (int64 maxFileSizeBytes = -1, int numOldFilesToKeep = 1);
+
+    /** Waits until all the messages that were logged before this call have been written
+        to the file.
+
+        Returns true if they were all written, or false if it gave up after the given
+        timeout. If the logger isn't writing on a background thread, this returns true
+        immediately.
+    */
+    bool flush (int timeOutMilliseconds = 1000);
+
     //==============================================================================
     /** Helper function to create a log file in the correct place for this platform.
 
@@ -99,6 +131,10 @@ private:
     File logFile;
     CriticalSection logLock;
 
+    class Writer;
+    friend class ScopedPointer<Writer>;
+    ScopedPointer<Writer> writer;
+
     void trimFileSize (int maxFileSizeBytes) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileLogger);
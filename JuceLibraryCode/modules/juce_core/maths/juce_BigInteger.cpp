@@ -23,10 +23,367 @@
   ==============================================================================
 */
 
+#if JUCE_USE_INTRINSICS && ! defined (__INTEL_COMPILER)
+ #pragma intrinsic (_BitScanReverse)
+#endif
+
+namespace BitFunctions
+{
+    inline int countBitsInInt32 (uint32 n) noexcept
+    {
+        n -= ((n >> 1) & 0x55555555);
+        n =  (((n >> 2) & 0x33333333) + (n & 0x33333333));
+        n =  (((n >> 4) + n) & 0x0f0f0f0f);
+        n += (n >> 8);
+        n += (n >> 16);
+        return (int) (n & 0x3f);
+    }
+
+    inline int highestBitInInt (uint32 n) noexcept
+    {
+        jassert (n != 0); // (the built-in functions may not work for n = 0)
+
+      #if JUCE_GCC
+        return 31 - __builtin_clz (n);
+      #elif JUCE_USE_INTRINSICS
+        unsigned long highest;
+        _BitScanReverse (&highest, n);
+        return (int) highest;
+      #else
+        n |= (n >> 1);
+        n |= (n >> 2);
+        n |= (n >> 4);
+        n |= (n >> 8);
+        n |= (n >> 16);
+        return countBitsInInt32 (n >> 1);
+      #endif
+    }
+}
+
 namespace
 {
     inline size_t bitToIndex (const int bit) noexcept   { return (size_t) (bit >> 5); }
     inline uint32 bitToMask  (const int bit) noexcept   { return (uint32) 1 << (bit & 31); }
+
+    //==============================================================================
+    /*  These functions work on arrays of 32-bit words, lowest word first. */
+    enum { karatsubaThreshold = 32 };
+
+    inline size_t getNumWords (const int highestBit) noexcept
+    {
+        return highestBit < 0 ? 0 : bitToIndex (highestBit) + 1;
+    }
+
+    // adds b to a, returning the carry
+    uint32 addWords (uint32* const a, const size_t numA, const uint32* const b, const size_t numB) noexcept
+    {
+        jassert (numA >= numB);
+        uint64 carry = 0;
+        size_t i = 0;
+
+        for (; i < numB; ++i)
+        {
+            carry += (uint64) a[i] + b[i];
+            a[i] = (uint32) carry;
+            carry >>= 32;
+        }
+
+        for (; carry != 0 && i < numA; ++i)
+        {
+            carry += a[i];
+            a[i] = (uint32) carry;
+            carry >>= 32;
+        }
+
+        return (uint32) carry;
+    }
+
+    // subtracts b from a, returning the borrow
+    uint32 subtractWords (uint32* const a, const size_t numA, const uint32* const b, const size_t numB) noexcept
+    {
+        jassert (numA >= numB);
+        uint32 borrow = 0;
+        size_t i = 0;
+
+        for (; i < numB; ++i)
+        {
+            const uint64 diff = (uint64) a[i] - b[i] - borrow;
+            a[i] = (uint32) diff;
+            borrow = (uint32) (diff >> 63);
+        }
+
+        for (; borrow != 0 && i < numA; ++i)
+        {
+            borrow = (a[i] == 0) ? 1 : 0;
+            --a[i];
+        }
+
+        return borrow;
+    }
+
+    int compareWords (const uint32* const a, const uint32* const b, const size_t num) noexcept
+    {
+        for (size_t i = num; i > 0; --i)
+            if (a[i - 1] != b[i - 1])
+                return a[i - 1] > b[i - 1] ? 1 : -1;
+
+        return 0;
+    }
+
+    void multiplyWordsSimple (uint32* const result, const uint32* const a, const size_t numA,
+                              const uint32* const b, const size_t numB) noexcept
+    {
+        zeromem (result, sizeof (uint32) * (numA + numB));
+
+        for (size_t i = 0; i < numA; ++i)
+        {
+            const uint64 n = a[i];
+
+            if (n != 0)
+            {
+                uint64 carry = 0;
+
+                for (size_t j = 0; j < numB; ++j)
+                {
+                    carry += n * b[j] + result[i + j];
+                    result[i + j] = (uint32) carry;
+                    carry >>= 32;
+                }
+
+                result[i + numB] = (uint32) carry;
+            }
+        }
+    }
+
+    void multiplyWords (uint32* result, const uint32* a, size_t numA, const uint32* b, size_t numB);
+
+    // multiplies two numbers of the same length, using Karatsuba's method
+    void multiplyWordsKaratsuba (uint32* const result, const uint32* const a, const uint32* const b, const size_t num)
+    {
+        const size_t low = num / 2;
+        const size_t high = num - low;
+
+        // (result = a0*b0 + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1) * base^low + a1*b1 * base^(2*low))
+        multiplyWords (result, a, low, b, low);
+        multiplyWords (result + 2 * low, a + low, high, b + low, high);
+
+        const size_t numSum = high + 1;
+        HeapBlock<uint32> scratch (4 * numSum);
+        uint32* const sumA = scratch;
+        uint32* const sumB = scratch + numSum;
+        uint32* const middle = scratch + 2 * numSum;
+
+        memcpy (sumA, a + low, sizeof (uint32) * high);
+        memcpy (sumB, b + low, sizeof (uint32) * high);
+        sumA[high] = addWords (sumA, high, a, low);
+        sumB[high] = addWords (sumB, high, b, low);
+
+        multiplyWords (middle, sumA, numSum, sumB, numSum);
+
+        size_t numMiddle = 2 * numSum;
+        subtractWords (middle, numMiddle, result, 2 * low);
+        subtractWords (middle, numMiddle, result + 2 * low, 2 * high);
+
+        while (numMiddle > 0 && middle [numMiddle - 1] == 0)
+            --numMiddle;
+
+        addWords (result + low, 2 * num - low, middle, numMiddle);
+    }
+
+    // result must have space for numA + numB words
+    void multiplyWords (uint32* const result, const uint32* a, size_t numA, const uint32* b, size_t numB)
+    {
+        if (numA < numB)
+        {
+            std::swap (a, b);
+            std::swap (numA, numB);
+        }
+
+        if (numB < karatsubaThreshold)
+        {
+            multiplyWordsSimple (result, a, numA, b, numB);
+        }
+        else if (numA == numB)
+        {
+            multiplyWordsKaratsuba (result, a, b, numA);
+        }
+        else
+        {
+            // (for unbalanced sizes, the longer number is multiplied in pieces the size of the shorter one)
+            zeromem (result, sizeof (uint32) * (numA + numB));
+            HeapBlock<uint32> piece (2 * numB);
+
+            for (size_t i = 0; i < numA; i += numB)
+            {
+                const size_t numInPiece = jmin (numB, numA - i);
+                multiplyWords (piece, a + i, numInPiece, b, numB);
+                addWords (result + i, numA + numB - i, piece, numInPiece + numB);
+            }
+        }
+    }
+
+    // divides a by a single word, returning the remainder
+    uint32 divideWordsByWord (uint32* const quotient, const uint32* const a, const size_t numA, const uint32 divisor) noexcept
+    {
+        uint64 remainder = 0;
+
+        for (size_t i = numA; i > 0; --i)
+        {
+            remainder = (remainder << 32) | a[i - 1];
+            quotient[i - 1] = (uint32) (remainder / divisor);
+            remainder %= divisor;
+        }
+
+        return (uint32) remainder;
+    }
+
+    /*  Knuth's algorithm D. The divisor must have at least 2 words and a non-zero top word,
+        and numA must be at least numV. The quotient needs numA - numV + 1 words, and the
+        remainder needs numV words.
+    */
+    void divideWords (uint32* const quotient, uint32* const remainder,
+                      const uint32* const a, const size_t numA,
+                      const uint32* const v, const size_t numV)
+    {
+        jassert (numV >= 2 && v [numV - 1] != 0 && numA >= numV);
+
+        // normalise, so that the top bit of the divisor is set..
+        const int shift = 31 - BitFunctions::highestBitInInt (v [numV - 1]);
+        HeapBlock<uint32> vn (numV), un (numA + 1);
+
+        for (size_t i = numV; --i > 0;)
+            vn[i] = (v[i] << shift) | (shift == 0 ? 0 : (v[i - 1] >> (32 - shift)));
+
+        vn[0] = v[0] << shift;
+
+        un[numA] = (shift == 0 ? 0 : (a [numA - 1] >> (32 - shift)));
+
+        for (size_t i = numA; --i > 0;)
+            un[i] = (a[i] << shift) | (shift == 0 ? 0 : (a[i - 1] >> (32 - shift)));
+
+        un[0] = a[0] << shift;
+
+        const uint64 base = ((uint64) 1) << 32;
+        const uint64 vTop = vn [numV - 1];
+        const uint64 vNext = vn [numV - 2];
+
+        for (size_t j = numA - numV + 1; j-- > 0;)
+        {
+            // estimate the next quotient word from the top words..
+            const uint64 top = (((uint64) un [j + numV]) << 32) | un [j + numV - 1];
+            uint64 qHat = top / vTop;
+            uint64 rHat = top - qHat * vTop;
+
+            while (qHat >= base || qHat * vNext > ((rHat << 32) | un [j + numV - 2]))
+            {
+                --qHat;
+                rHat += vTop;
+
+                if (rHat >= base)
+                    break;
+            }
+
+            // ..then multiply and subtract
+            uint64 carry = 0;
+            uint32 borrow = 0;
+
+            for (size_t i = 0; i < numV; ++i)
+            {
+                carry += qHat * vn[i];
+                const uint64 diff = (uint64) un [i + j] - (uint32) carry - borrow;
+                un [i + j] = (uint32) diff;
+                borrow = (uint32) (diff >> 63);
+                carry >>= 32;
+            }
+
+            const uint64 diff = (uint64) un [j + numV] - carry - borrow;
+            un [j + numV] = (uint32) diff;
+
+            if ((diff >> 63) != 0)
+            {
+                // the estimate was one too big, so add the divisor back
+                --qHat;
+                un [j + numV] += addWords (un + j, numV, vn, numV);
+            }
+
+            quotient[j] = (uint32) qHat;
+        }
+
+        // un-normalise the remainder
+        for (size_t i = 0; i < numV; ++i)
+            remainder[i] = (un[i] >> shift) | (shift == 0 ? 0 : (un[i + 1] << (32 - shift)));
+    }
+
+    //==============================================================================
+    /*  Multiplies numbers in Montgomery form, for a modulus with an odd lowest word. */
+    class MontgomeryMultiplier
+    {
+    public:
+        MontgomeryMultiplier (const uint32* const modulus_, const size_t numWords_)
+            : modulus (modulus_), numWords (numWords_), temp (numWords_ + 2)
+        {
+            // find -1 / modulus mod 2^32 with Newton's method (each step doubles the number of correct bits)
+            const uint32 m0 = modulus[0];
+            uint32 inverse = m0;
+
+            for (int i = 0; i < 4; ++i)
+                inverse *= 2 - m0 * inverse;
+
+            jassert (m0 * inverse == 1);
+            modulusInverse = (uint32) 0 - inverse;
+        }
+
+        // result = a * b / R mod m, where R is 2^(32 * numWords). (result can be the same as a or b)
+        void multiply (uint32* const result, const uint32* const a, const uint32* const b) noexcept
+        {
+            zeromem (temp, sizeof (uint32) * (numWords + 2));
+
+            for (size_t i = 0; i < numWords; ++i)
+            {
+                const uint64 ai = a[i];
+                uint64 carry = 0;
+
+                for (size_t j = 0; j < numWords; ++j)
+                {
+                    carry += ai * b[j] + temp[j];
+                    temp[j] = (uint32) carry;
+                    carry >>= 32;
+                }
+
+                carry += temp [numWords];
+                temp [numWords] = (uint32) carry;
+                temp [numWords + 1] = (uint32) (carry >> 32);
+
+                // add a multiple of the modulus that makes the lowest word zero, and shift down a word
+                const uint64 u = (uint32) (temp[0] * modulusInverse);
+                carry = (u * modulus[0] + temp[0]) >> 32;
+
+                for (size_t j = 1; j < numWords; ++j)
+                {
+                    carry += u * modulus[j] + temp[j];
+                    temp [j - 1] = (uint32) carry;
+                    carry >>= 32;
+                }
+
+                carry += temp [numWords];
+                temp [numWords - 1] = (uint32) carry;
+                temp [numWords] = temp [numWords + 1] + (uint32) (carry >> 32);
+            }
+
+            if (temp [numWords] != 0 || compareWords (temp, modulus, numWords) >= 0)
+                subtractWords (temp, numWords + 1, modulus, numWords);
+
+            memcpy (result, temp, sizeof (uint32) * numWords);
+        }
+
+    private:
+        const uint32* const modulus;
+        const size_t numWords;
+        uint32 modulusInverse;
+        HeapBlock<uint32> temp;
+
+        JUCE_DECLARE_NON_COPYABLE (MontgomeryMultiplier);
+    };
 }
 
 //==============================================================================
@@ -298,43 +655,6 @@ void BigInteger::negate() noexcept
     negative = (! negative) && ! isZero();
 }
 
-#if JUCE_USE_INTRINSICS && ! defined (__INTEL_COMPILER)
- #pragma intrinsic (_BitScanReverse)
-#endif
-
-namespace BitFunctions
-{
-    inline int countBitsInInt32 (uint32 n) noexcept
-    {
-        n -= ((n >> 1) & 0x55555555);
-        n =  (((n >> 2) & 0x33333333) + (n & 0x33333333));
-        n =  (((n >> 4) + n) & 0x0f0f0f0f);
-        n += (n >> 8);
-        n += (n >> 16);
-        return (int) (n & 0x3f);
-    }
-
-    inline int highestBitInInt (uint32 n) noexcept
-    {
-        jassert (n != 0); // (the built-in functions may not work for n = 0)
-
-      #if JUCE_GCC
-        return 31 - __builtin_clz (n);
-      #elif JUCE_USE_INTRINSICS
-        unsigned long highest;
-        _BitScanReverse (&highest, n);
-        return (int) highest;
-      #else
-        n |= (n >> 1);
-        n |= (n >> 2);
-        n |= (n >> 4);
-        n |= (n >> 8);
-        n |= (n >> 16);
-        return countBitsInInt32 (n >> 1);
-      #endif
-    }
-}
-
 int BigInteger::countNumberOfSetBits() const noexcept
 {
     int total = 0;
@@ -480,23 +800,22 @@ BigInteger& BigInteger::operator-= (const BigInteger& other)
 
 BigInteger& BigInteger::operator*= (const BigInteger& other)
 {
-    BigInteger total;
-    highestBit = getHighestBit();
-    const bool wasNegative = isNegative();
-    setNegative (false);
+    const size_t numA = getNumWords (getHighestBit());
+    const size_t numB = getNumWords (other.getHighestBit());
 
-    for (int i = 0; i <= highestBit; ++i)
+    if (numA == 0 || numB == 0)
     {
-        if (operator[](i))
-        {
-            BigInteger n (other);
-            n.setNegative (false);
-            n <<= i;
-            total += n;
-        }
+        clear();
+        return *this;
     }
 
-    total.setNegative (wasNegative ^ other.isNegative());
+    BigInteger total;
+    total.ensureSize (numA + numB);
+    multiplyWords (total.values, values, numA, other.values, numB);
+
+    total.highestBit = (int) (numA + numB) * 32 - 1;
+    total.highestBit = total.getHighestBit();
+    total.negative = isNegative() ^ other.isNegative();
     swapWith (total);
     return *this;
 }
@@ -517,31 +836,41 @@ void BigInteger::divideBy (const BigInteger& divisor, BigInteger& remainder)
     else
     {
         const bool wasNegative = isNegative();
+        const bool divisorWasNegative = divisor.isNegative();
+        const size_t numWords = getNumWords (ourHB);
+        const size_t numDivisorWords = getNumWords (divHB);
 
-        swapWith (remainder);
-        remainder.setNegative (false);
-        clear();
-
-        BigInteger temp (divisor);
-        temp.setNegative (false);
+        BigInteger quotient, newRemainder;
 
-        int leftShift = ourHB - divHB;
-        temp <<= leftShift;
-
-        while (leftShift >= 0)
+        if (ourHB < divHB)
         {
-            if (remainder.compareAbsolute (temp) >= 0)
+            newRemainder = *this;
+        }
+        else
+        {
+            quotient.ensureSize (numWords);
+
+            if (numDivisorWords == 1)
+            {
+                newRemainder = BigInteger (divideWordsByWord (quotient.values, values, numWords, divisor.values[0]));
+            }
+            else
             {
-                remainder -= temp;
-                setBit (leftShift);
+                newRemainder.ensureSize (numDivisorWords);
+                divideWords (quotient.values, newRemainder.values, values, numWords, divisor.values, numDivisorWords);
+                newRemainder.highestBit = (int) numDivisorWords * 32 - 1;
+                newRemainder.highestBit = newRemainder.getHighestBit();
             }
 
-            if (--leftShift >= 0)
-                temp >>= 1;
+            quotient.highestBit = (int) numWords * 32 - 1;
+            quotient.highestBit = quotient.getHighestBit();
         }
 
-        negative = wasNegative ^ divisor.isNegative();
-        remainder.setNegative (wasNegative);
+        quotient.negative = wasNegative ^ divisorWasNegative;
+        newRemainder.negative = wasNegative;
+
+        swapWith (quotient);
+        remainder.swapWith (newRemainder);
     }
 }
 
@@ -822,25 +1151,94 @@ BigInteger BigInteger::findGreatestCommonDivisor (BigInteger n) const
 
 void BigInteger::exponentModulo (const BigInteger& exponent, const BigInteger& modulus)
 {
-    BigInteger exp (exponent);
-    exp %= modulus;
+    BigInteger m (modulus);
+    m.setNegative (false);
 
-    BigInteger value (1);
-    swapWith (value);
-    value %= modulus;
+    if (m.isZero() || m.isOne())
+    {
+        clear();
+        return;
+    }
+
+    operator%= (m);
+
+    if (isNegative())
+        operator+= (m);
 
-    while (! exp.isZero())
+    if (! m[0])
     {
-        if (exp [0])
+        // (Montgomery multiplication only works with odd moduli, so this just squares and multiplies)
+        BigInteger result (1);
+
+        for (int i = exponent.getHighestBit(); i >= 0; --i)
         {
-            operator*= (value);
-            operator%= (modulus);
+            result *= result;
+            result %= m;
+
+            if (exponent[i])
+            {
+                result *= *this;
+                result %= m;
+            }
         }
 
-        value *= value;
-        value %= modulus;
-        exp >>= 1;
+        swapWith (result);
+        return;
+    }
+
+    const size_t numWords = getNumWords (m.getHighestBit());
+    const int numBitsInR = (int) numWords * 32;
+    MontgomeryMultiplier multiplier (m.values, numWords);
+
+    // powers[i] holds (this ^ i) * R mod m, for each value of a 4-bit window of the exponent
+    const int windowBits = 4;
+    HeapBlock<uint32> powers;
+    powers.calloc (numWords << windowBits);
+
+    {
+        BigInteger n (1);
+        n <<= numBitsInR;
+        n %= m;
+        memcpy (powers, n.values, sizeof (uint32) * getNumWords (n.getHighestBit()));
+
+        n = *this;
+        n <<= numBitsInR;
+        n %= m;
+        memcpy (powers + numWords, n.values, sizeof (uint32) * getNumWords (n.getHighestBit()));
+    }
+
+    for (int i = 2; i < (1 << windowBits); ++i)
+        multiplier.multiply (powers + numWords * (size_t) i, powers + numWords * (size_t) (i - 1), powers + numWords);
+
+    HeapBlock<uint32> result (numWords);
+    memcpy (result, powers, sizeof (uint32) * numWords);
+    bool isFirstWindow = true;
+
+    for (int bit = (jmax (0, exponent.getHighestBit()) / windowBits) * windowBits; bit >= 0; bit -= windowBits)
+    {
+        if (! isFirstWindow)
+            for (int i = 0; i < windowBits; ++i)
+                multiplier.multiply (result, result, result);
+
+        const uint32 window = exponent.getBitRangeAsInt (bit, windowBits);
+
+        if (window != 0)
+            multiplier.multiply (result, result, powers + numWords * window);
+
+        isFirstWindow = false;
     }
+
+    // (multiplying by 1 takes it back out of Montgomery form)
+    HeapBlock<uint32> one;
+    one.calloc (numWords);
+    one[0] = 1;
+    multiplier.multiply (result, result, one);
+
+    clear();
+    ensureSize (numWords);
+    memcpy (values, result, sizeof (uint32) * numWords);
+    highestBit = numBitsInR - 1;
+    highestBit = getHighestBit();
 }
 
 void BigInteger::inverseModulo (const BigInteger& modulus)
@@ -1016,3 +1414,117 @@ void BigInteger::loadFromMemoryBlock (const MemoryBlock& data)
     for (int i = (int) data.getSize(); --i >= 0;)
         this->setBitRangeAsInt (i << 3, 8, (uint32) data [i]);
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class BigIntegerTests  : public UnitTest
+{
+public:
+    BigIntegerTests()   : UnitTest ("BigInteger") {}
+
+    static BigInteger getRandomNumber (Random& r, const int numBits)
+    {
+        BigInteger n;
+        r.fillBitsRandomly (n, 0, numBits);
+        return n;
+    }
+
+    // (the original bit-by-bit algorithms, to check the results against)
+    static BigInteger multiplySlowly (const BigInteger& a, const BigInteger& b)
+    {
+        BigInteger total;
+
+        for (int i = 0; i <= a.getHighestBit(); ++i)
+            if (a[i])
+                total += b << i;
+
+        return total;
+    }
+
+    static BigInteger exponentModuloSlowly (const BigInteger& a, const BigInteger& exponent, const BigInteger& modulus)
+    {
+        BigInteger result (1);
+
+        for (int i = exponent.getHighestBit(); i >= 0; --i)
+        {
+            result = multiplySlowly (result, result) % modulus;
+
+            if (exponent[i])
+                result = multiplySlowly (result, a) % modulus;
+        }
+
+        return result;
+    }
+
+    void runTest()
+    {
+        beginTest ("Multiplication and division");
+        Random r (1);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            // (sizes either side of the Karatsuba threshold, and some unbalanced ones)
+            const BigInteger a (getRandomNumber (r, 1 + r.nextInt (3000)));
+            const BigInteger b (getRandomNumber (r, 1 + r.nextInt (i < 50 ? 3000 : 100)));
+
+            const BigInteger product (a * b);
+            expect (product == multiplySlowly (a, b));
+
+            if (! b.isZero())
+            {
+                BigInteger quotient (product + a), remainder;
+                quotient.divideBy (b, remainder);
+
+                expect (remainder < b && ! remainder.isNegative());
+                expect (quotient * b + remainder == product + a);
+            }
+        }
+
+        expect (BigInteger (-7) * BigInteger (6) == BigInteger (-42));
+        expect (BigInteger (-43) / BigInteger (6) == BigInteger (-7));
+        expect (BigInteger (-43) % BigInteger (6) == BigInteger (-1));
+
+        beginTest ("exponentModulo");
+
+        {
+            BigInteger n (4);
+            n.exponentModulo (13, 497);
+            expectEquals (n.toInteger(), 445);
+
+            n = 2;
+            n.exponentModulo (5, 3);
+            expectEquals (n.toInteger(), 2);
+        }
+
+        // (2^127 - 1 is prime, so a^(p-1) mod p == 1)
+        BigInteger prime;
+        prime.setRange (0, 127, true);
+
+        for (int i = 0; i < 5; ++i)
+        {
+            BigInteger n (getRandomNumber (r, 120));
+            ++n;
+            n.exponentModulo (prime - 1, prime);
+            expect (n.isOne());
+        }
+
+        for (int i = 0; i < 20; ++i)
+        {
+            BigInteger modulus (getRandomNumber (r, 40 + r.nextInt (200)));
+            modulus.setBit (0, (i & 1) != 0);
+            modulus.setBit (30);
+
+            const BigInteger a (getRandomNumber (r, 300));
+            const BigInteger exponent (getRandomNumber (r, 100));
+
+            BigInteger n (a);
+            n.exponentModulo (exponent, modulus);
+            expect (n == exponentModuloSlowly (a % modulus, exponent, modulus));
+        }
+    }
+};
+
+static BigIntegerTests bigIntegerTests;
+
+#endif
@@ -32,6 +32,7 @@ public:
     virtual Type getType() const noexcept = 0;
     virtual Term* clone() const = 0;
     virtual ReferenceCountedObjectPtr<Term> resolve (const Scope&, int recursionDepth) = 0;
+    virtual void compile (Program&, const Scope&, int recursionDepth) = 0;
     virtual String toString() const = 0;
     virtual double toDouble() const                                          { return 0; }
     virtual int getInputIndexFor (const Term*) const                         { return -1; }
@@ -114,6 +115,7 @@ struct Expression::Helpers
         Type getType() const noexcept                { return constantType; }
         Term* clone() const                          { return new Constant (value, isResolutionTarget); }
         TermPtr resolve (const Scope&, int)          { return this; }
+        void compile (Program& program, const Scope&, int)  { program.addInstruction (Program::pushConstant, 0, value); }
         double toDouble() const                      { return value; }
         TermPtr negated()                            { return new Constant (-value, isResolutionTarget); }
 
@@ -150,6 +152,7 @@ struct Expression::Helpers
 
         virtual double performFunction (double left, double right) const = 0;
         virtual void writeOperator (String& dest) const = 0;
+        virtual Program::Opcode getOpcode() const = 0;
 
         TermPtr resolve (const Scope& scope, int recursionDepth)
         {
@@ -157,6 +160,13 @@ struct Expression::Helpers
                                                   right->resolve (scope, recursionDepth)->toDouble()), false);
         }
 
+        void compile (Program& program, const Scope& scope, int recursionDepth)
+        {
+            left->compile (program, scope, recursionDepth);
+            right->compile (program, scope, recursionDepth);
+            program.addInstruction (getOpcode(), 2);
+        }
+
         String toString() const
         {
             String s;
@@ -207,6 +217,17 @@ struct Expression::Helpers
             return scope.getSymbolValue (symbol).term->resolve (scope, recursionDepth + 1);
         }
 
+        void compile (Program& program, const Scope& scope, int recursionDepth)
+        {
+            checkRecursionDepth (recursionDepth);
+            Scope::SymbolReader* const reader = scope.createSymbolReader (symbol);
+
+            if (reader != nullptr)
+                program.addSymbol (reader);
+            else
+                scope.getSymbolValue (symbol).term->compile (program, scope, recursionDepth + 1);
+        }
+
         Type getType() const noexcept   { return symbolType; }
         Term* clone() const             { return new SymbolTerm (symbol); }
         String toString() const         { return symbol; }
@@ -265,6 +286,37 @@ struct Expression::Helpers
             return new Constant (result, false);
         }
 
+        void compile (Program& program, const Scope& scope, int recursionDepth)
+        {
+            checkRecursionDepth (recursionDepth);
+            const int numParams = parameters.size();
+            const Program::Opcode opcode = getOpcode (numParams);
+
+            for (int i = 0; i < numParams; ++i)
+                parameters.getReference(i).term->compile (program, scope, recursionDepth + 1);
+
+            program.addInstruction (opcode, numParams);
+        }
+
+        Program::Opcode getOpcode (const int numParams) const
+        {
+            if (numParams > 0)
+            {
+                if (functionName == "min")  return Program::minimum;
+                if (functionName == "max")  return Program::maximum;
+
+                if (numParams == 1)
+                {
+                    if (functionName == "sin")  return Program::sine;
+                    if (functionName == "cos")  return Program::cosine;
+                    if (functionName == "tan")  return Program::tangent;
+                    if (functionName == "abs")  return Program::absolute;
+                }
+            }
+
+            throw EvaluationError ("Can't compile function: \"" + functionName + "\"");
+        }
+
         int getInputIndexFor (const Term* possibleInput) const
         {
             for (int i = 0; i < parameters.size(); ++i)
@@ -312,11 +364,23 @@ struct Expression::Helpers
             return visitor.output;
         }
 
+        void compile (Program& program, const Scope& scope, int recursionDepth)
+        {
+            checkRecursionDepth (recursionDepth);
+
+            CompilingVisitor visitor (right, program, recursionDepth + 1);
+            scope.visitRelativeScope (getSymbol()->symbol, visitor);
+
+            if (! visitor.wasVisited)
+                throw EvaluationError ("Unknown symbol: " + getSymbol()->symbol);
+        }
+
         Term* clone() const                             { return new DotOperator (getSymbol(), right); }
         String getName() const                          { return "."; }
         int getOperatorPrecedence() const               { return 1; }
         void writeOperator (String& dest) const         { dest << '.'; }
         double performFunction (double, double) const   { return 0.0; }
+        Program::Opcode getOpcode() const               { return Program::pushConstant; }
 
         void visitAllSymbols (SymbolVisitor& visitor, const Scope& scope, int recursionDepth)
         {
@@ -364,6 +428,27 @@ struct Expression::Helpers
             JUCE_DECLARE_NON_COPYABLE (EvaluationVisitor);
         };
 
+        class CompilingVisitor  : public Scope::Visitor
+        {
+        public:
+            CompilingVisitor (const TermPtr& input_, Program& program_, const int recursionCount_)
+                : input (input_), program (program_), recursionCount (recursionCount_), wasVisited (false) {}
+
+            void visit (const Scope& scope)
+            {
+                input->compile (program, scope, recursionCount);
+                wasVisited = true;
+            }
+
+            const TermPtr input;
+            Program& program;
+            const int recursionCount;
+            bool wasVisited;
+
+        private:
+            JUCE_DECLARE_NON_COPYABLE (CompilingVisitor);
+        };
+
         class SymbolVisitingVisitor  : public Scope::Visitor
         {
         public:
@@ -422,6 +507,12 @@ struct Expression::Helpers
             return new Constant (-input->resolve (scope, recursionDepth)->toDouble(), false);
         }
 
+        void compile (Program& program, const Scope& scope, int recursionDepth)
+        {
+            input->compile (program, scope, recursionDepth);
+            program.addInstruction (Program::negate, 1);
+        }
+
         String getName() const          { return "-"; }
         TermPtr negated()               { return input; }
 
@@ -458,6 +549,7 @@ struct Expression::Helpers
         double performFunction (double lhs, double rhs) const    { return lhs + rhs; }
         int getOperatorPrecedence() const       { return 3; }
         String getName() const                  { return "+"; }
+        Program::Opcode getOpcode() const       { return Program::add; }
         void writeOperator (String& dest) const { dest << " + "; }
 
         TermPtr createTermToEvaluateInput (const Scope& scope, const Term* input, double overallTarget, Term* topLevelTerm) const
@@ -483,6 +575,7 @@ struct Expression::Helpers
         double performFunction (double lhs, double rhs) const    { return lhs - rhs; }
         int getOperatorPrecedence() const       { return 3; }
         String getName() const                  { return "-"; }
+        Program::Opcode getOpcode() const       { return Program::subtract; }
         void writeOperator (String& dest) const { dest << " - "; }
 
         TermPtr createTermToEvaluateInput (const Scope& scope, const Term* input, double overallTarget, Term* topLevelTerm) const
@@ -510,6 +603,7 @@ struct Expression::Helpers
         Term* clone() const                     { return new Multiply (left->clone(), right->clone()); }
         double performFunction (double lhs, double rhs) const    { return lhs * rhs; }
         String getName() const                  { return "*"; }
+        Program::Opcode getOpcode() const       { return Program::multiply; }
         void writeOperator (String& dest) const { dest << " * "; }
         int getOperatorPrecedence() const       { return 2; }
 
@@ -535,6 +629,7 @@ struct Expression::Helpers
         Term* clone() const                     { return new Divide (left->clone(), right->clone()); }
         double performFunction (double lhs, double rhs) const    { return lhs / rhs; }
         String getName() const                  { return "/"; }
+        Program::Opcode getOpcode() const       { return Program::divide; }
         void writeOperator (String& dest) const { dest << " / "; }
         int getOperatorPrecedence() const       { return 2; }
 
@@ -1176,3 +1271,220 @@ String Expression::Scope::getScopeUID() const
 {
     return String::empty;
 }
+
+Expression::Scope::SymbolReader* Expression::Scope::createSymbolReader (const String&) const
+{
+    return nullptr;
+}
+
+//==============================================================================
+Expression::Program::Program()
+    : stackDepth (0), maxStackDepth (0)
+{
+}
+
+Expression::Program::~Program()
+{
+}
+
+bool Expression::Program::compile (const Expression& expression, const Scope& scope)
+{
+    clear();
+
+    try
+    {
+        expression.term->compile (*this, scope, 0);
+        jassert (stackDepth == 1);
+        return true;
+    }
+    catch (Helpers::EvaluationError& e)
+    {
+        clear();
+        error = e.description;
+    }
+
+    return false;
+}
+
+void Expression::Program::clear()
+{
+    instructions.clearQuick();
+    symbolReaders.clear();
+    stackDepth = maxStackDepth = 0;
+    error = String::empty;
+}
+
+void Expression::Program::addInstruction (const Opcode opcode, const int numInputs, const double value)
+{
+    const Instruction i = { opcode, numInputs, value };
+    instructions.add (i);
+
+    stackDepth += 1 - numInputs;
+    maxStackDepth = jmax (maxStackDepth, stackDepth);
+}
+
+void Expression::Program::addSymbol (Scope::SymbolReader* const reader)
+{
+    jassert (reader != nullptr);
+    addInstruction (pushSymbol, 0, (double) symbolReaders.size());
+    symbolReaders.add (reader);
+}
+
+double Expression::Program::evaluate() const
+{
+    if (instructions.size() == 0)
+        return 0;
+
+    double localStack [16];
+    HeapBlock<double> heapStack;
+    double* stack = localStack;
+
+    if (maxStackDepth > numElementsInArray (localStack))
+    {
+        heapStack.malloc ((size_t) maxStackDepth);
+        stack = heapStack;
+    }
+
+    double* top = stack - 1;
+
+    for (const Instruction* i = instructions.begin(), * const end = instructions.end(); i != end; ++i)
+    {
+        switch (i->opcode)
+        {
+            case pushConstant:  *++top = i->value; break;
+            case pushSymbol:    *++top = symbolReaders.getUnchecked ((int) i->value)->getValue(); break;
+            case add:           --top; *top += top[1]; break;
+            case subtract:      --top; *top -= top[1]; break;
+            case multiply:      --top; *top *= top[1]; break;
+            case divide:        --top; *top /= top[1]; break;
+            case negate:        *top = -*top; break;
+            case sine:          *top = sin (*top); break;
+            case cosine:        *top = cos (*top); break;
+            case tangent:       *top = tan (*top); break;
+            case absolute:      *top = std::abs (*top); break;
+
+            case minimum:
+                for (int n = i->numInputs; --n > 0;)
+                {
+                    --top;
+                    *top = jmin (*top, top[1]);
+                }
+                break;
+
+            case maximum:
+                for (int n = i->numInputs; --n > 0;)
+                {
+                    --top;
+                    *top = jmax (*top, top[1]);
+                }
+                break;
+
+            default:
+                jassertfalse;
+                break;
+        }
+    }
+
+    jassert (top == stack);
+    return *top;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ExpressionTests  : public UnitTest
+{
+public:
+    ExpressionTests()   : UnitTest ("Expression") {}
+
+    // A scope with a couple of variables that can be read directly, a symbol that's defined
+    // by another expression, and a relative scope called "other".
+    class TestScope  : public Expression::Scope
+    {
+    public:
+        TestScope (double* const values_)  : values (values_) {}
+
+        Expression getSymbolValue (const String& symbol) const
+        {
+            if (symbol == "a")  return Expression (values[0]);
+            if (symbol == "b")  return Expression (values[1]);
+            if (symbol == "c")  return Expression ("a * 2 + b");
+
+            return Expression::Scope::getSymbolValue (symbol);
+        }
+
+        SymbolReader* createSymbolReader (const String& symbol) const
+        {
+            if (symbol == "a")  return new Reader (values[0]);
+            if (symbol == "b")  return new Reader (values[1]);
+
+            return nullptr;
+        }
+
+        void visitRelativeScope (const String& scopeName, Visitor& visitor) const
+        {
+            if (scopeName == "other")
+                visitor.visit (TestScope (values + 2));
+            else
+                Expression::Scope::visitRelativeScope (scopeName, visitor);
+        }
+
+    private:
+        double* const values;
+
+        struct Reader  : public SymbolReader
+        {
+            Reader (const double& value_) : value (value_) {}
+            double getValue() const     { return value; }
+
+            const double& value;
+        };
+
+        JUCE_DECLARE_NON_COPYABLE (TestScope);
+    };
+
+    void runTest()
+    {
+        beginTest ("Compiled programs");
+
+        double values[] = { 3.0, -7.5, 100.0, 0.25 };
+        TestScope scope (values);
+
+        const char* const expressions[] = { "1 + 2 * 3", "a - b / 4", "-(a + b) * c", "c + other.c - other.a",
+                                            "min (a, b, 5) + max (a, other.b)", "abs (b) + sin (a) * cos (b) - tan (c / 10)",
+                                            "a / (b - -b) + 2 * (1 - c)" };
+
+        Random r (1);
+
+        for (int i = 0; i < numElementsInArray (expressions); ++i)
+        {
+            const Expression e (expressions[i]);
+            Expression::Program program;
+            expect (program.compile (e, scope));
+            expect (program.isCompiled());
+
+            for (int j = 0; j < 10; ++j)
+            {
+                expect (program.evaluate() == e.evaluate (scope));
+
+                // the program reads the new values without needing to be recompiled
+                for (int k = 0; k < numElementsInArray (values); ++k)
+                    values[k] = r.nextDouble() * 200.0 - 100.0;
+            }
+        }
+
+        beginTest ("Compilation errors");
+
+        Expression::Program program;
+        expect (program.evaluate() == 0);
+        expect (! program.compile (Expression ("a + unknown"), scope));
+        expect (! program.isCompiled() && program.getError().isNotEmpty());
+        expect (! program.compile (Expression ("nowhere.a"), scope));
+        expect (! program.compile (Expression ("foo (a)"), scope));
+        expect (program.evaluate() == 0);
+    }
+};
+
+static ExpressionTests expressionTests;
+
+#endif
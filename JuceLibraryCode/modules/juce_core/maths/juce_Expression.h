@@ -28,6 +28,7 @@
 
 #include "../memory/juce_ReferenceCountedObject.h"
 #include "../containers/juce_Array.h"
+#include "../containers/juce_OwnedArray.h"
 #include "../memory/juce_ScopedPointer.h"
 
 
@@ -154,8 +155,33 @@ public:
             new scope.
         */
         virtual void visitRelativeScope (const String& scopeName, Visitor& visitor) const;
+
+        /** An object that returns the current value of a symbol, without needing to look it up by name.
+            @see createSymbolReader, Expression::Program
+        */
+        class JUCE_API  SymbolReader
+        {
+        public:
+            virtual ~SymbolReader() {}
+
+            /** Returns the symbol's current value. */
+            virtual double getValue() const = 0;
+        };
+
+        /** Creates an object that can read the current value of a symbol, for use by an
+            Expression::Program.
+
+            The program keeps the object that is returned and calls it each time it's evaluated,
+            so it mustn't refer to this Scope, which may be a temporary object. The default
+            implementation returns nullptr, in which case the program calls getSymbolValue()
+            while it's being compiled, and builds the expression that this returns into its
+            own instructions.
+        */
+        virtual SymbolReader* createSymbolReader (const String& symbol) const;
     };
 
+    class Program;
+
     /** Evaluates this expression, without using a Scope.
         Without a Scope, no symbols can be used, and only basic functions such as sin, cos, tan,
         min, max are available.
@@ -268,4 +294,78 @@ private:
     explicit Expression (Term*);
 };
 
+//==============================================================================
+/**
+    A compiled version of an Expression, which can be evaluated repeatedly much more
+    quickly than the original expression.
+
+    Compiling flattens the expression's tree into a simple list of instructions, and
+    binds each of the symbols that it uses to a slot, using Scope::createSymbolReader().
+    Evaluating the program after that involves no string look-ups or allocations, so
+    it's worth doing when the same expression needs to be re-evaluated many times, e.g.
+    each time a component is moved or resized.
+
+    Because the symbols are bound when the program is compiled, you'll need to call
+    compile() again if anything changes which the symbols refer to. Only the built-in
+    functions (min, max, sin, cos, tan and abs) can be used in a compiled program.
+
+    @see Expression::evaluate, Expression::Scope::createSymbolReader
+*/
+class JUCE_API  Expression::Program
+{
+public:
+    //==============================================================================
+    /** Creates an empty program, which evaluates to 0. */
+    Program();
+
+    /** Destructor. */
+    ~Program();
+
+    //==============================================================================
+    /** Compiles an expression, binding its symbols to values provided by the given scope.
+
+        If the expression can't be evaluated in this scope, this returns false and leaves
+        the program empty, and getError() will describe the problem.
+    */
+    bool compile (const Expression& expression, const Scope& scope);
+
+    /** Resets the program to an empty state. */
+    void clear();
+
+    /** Returns true if the program contains a successfully compiled expression. */
+    bool isCompiled() const noexcept                    { return instructions.size() > 0; }
+
+    /** Returns the error that was encountered by the last call to compile(), if it failed. */
+    const String& getError() const noexcept             { return error; }
+
+    /** Evaluates the program, using the current values of its symbols. */
+    double evaluate() const;
+
+private:
+    //==============================================================================
+    enum Opcode
+    {
+        pushConstant, pushSymbol, add, subtract, multiply, divide, negate,
+        minimum, maximum, sine, cosine, tangent, absolute
+    };
+
+    struct Instruction
+    {
+        Opcode opcode;
+        int numInputs;
+        double value;
+    };
+
+    Array<Instruction> instructions;
+    OwnedArray<Scope::SymbolReader> symbolReaders;
+    int stackDepth, maxStackDepth;
+    String error;
+
+    friend struct Expression::Helpers;
+    void addInstruction (Opcode opcode, int numInputs, double value = 0.0);
+    void addSymbol (Scope::SymbolReader* reader);
+
+    JUCE_DECLARE_NON_COPYABLE (Program);
+};
+
 #endif   // __JUCE_EXPRESSION_JUCEHEADER__
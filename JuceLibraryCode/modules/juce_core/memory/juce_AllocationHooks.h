@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_ALLOCATIONHOOKS_JUCEHEADER__
+#define __JUCE_ALLOCATIONHOOKS_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    Counts the heap allocations that the app makes, so that tests and benchmarks
+    can check how many allocations a piece of code needs.
+
+    This only works if the JUCE_ENABLE_ALLOCATION_HOOKS config flag is turned on,
+    which replaces the global operator new (and, on Linux, malloc and friends) with
+    versions that keep count. That adds a little overhead to every allocation, so it's
+    off by default, and shouldn't be enabled in release builds.
+
+    e.g. @code
+    const int64 numBefore = AllocationHooks::getNumAllocations();
+    doSomething();
+    jassert (AllocationHooks::getNumAllocations() == numBefore);
+    @endcode
+*/
+class JUCE_API  AllocationHooks
+{
+public:
+    //==============================================================================
+    /** Returns true if allocations are being counted, i.e. if JUCE_ENABLE_ALLOCATION_HOOKS is on. */
+    static bool isEnabled() noexcept;
+
+    /** Returns the number of allocations that all threads have made since the app started.
+        If the hooks aren't enabled, this always returns 0.
+    */
+    static int64 getNumAllocations() noexcept;
+
+    /** Called by the replacement allocation functions - there's no need to call this yourself. */
+    static void allocationMade() noexcept;
+
+private:
+    AllocationHooks();
+    JUCE_DECLARE_NON_COPYABLE (AllocationHooks);
+};
+
+
+#endif   // __JUCE_ALLOCATIONHOOKS_JUCEHEADER__
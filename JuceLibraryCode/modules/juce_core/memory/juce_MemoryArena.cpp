@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+namespace MemoryArenaHelpers
+{
+    // everything inside a block is kept at multiples of this, so it stays as well-aligned as the block itself
+    const size_t alignment = 16;
+
+    inline size_t roundUp (const size_t n) noexcept   { return (n + alignment - 1) & ~(alignment - 1); }
+
+    // each chunk is preceded by a header of this size, which holds its size class
+    const size_t headerSize = alignment;
+
+    // size class n holds chunks of (alignment << n) bytes
+    inline int getSizeClass (const size_t numBytes) noexcept
+    {
+        int sizeClass = 0;
+
+        while ((alignment << sizeClass) < numBytes)
+            ++sizeClass;
+
+        return sizeClass;
+    }
+}
+
+//==============================================================================
+MemoryArena::MemoryArena (const size_t initialSizeInBytes)
+    : blocks (nullptr),
+      initialSize (jmax ((size_t) 1024, initialSizeInBytes)),
+      numLiveAllocations (0),
+      numHeapAllocations (0)
+{
+    clearFreeChunks();
+}
+
+MemoryArena::~MemoryArena()
+{
+    // Something's still using memory from this arena!
+    jassert (numLiveAllocations == 0);
+
+    freeAllBlocks();
+}
+
+//==============================================================================
+void* MemoryArena::allocate (const size_t numBytes)
+{
+    using namespace MemoryArenaHelpers;
+    const int sizeClass = getSizeClass (numBytes);
+    jassert (sizeClass < (int) numSizeClasses);
+
+    ++numLiveAllocations;
+
+    FreeChunk* const chunk = freeChunks [sizeClass];
+
+    if (chunk != nullptr)
+    {
+        freeChunks [sizeClass] = chunk->next;
+        return chunk;
+    }
+
+    const size_t size = headerSize + (alignment << sizeClass);
+
+    if (blocks == nullptr || blocks->numBytesUsed + size > blocks->size)
+        addBlock (size);
+
+    char* const header = reinterpret_cast <char*> (blocks) + roundUp (sizeof (Block)) + blocks->numBytesUsed;
+    blocks->numBytesUsed += size;
+    *reinterpret_cast <int*> (header) = sizeClass;
+    return header + headerSize;
+}
+
+void MemoryArena::release (void* const block) noexcept
+{
+    if (block != nullptr)
+    {
+        jassert (numLiveAllocations > 0 && ownsBlock (block));
+
+        if (--numLiveAllocations == 0)
+        {
+            clearFreeChunks();
+
+            if (blocks->next != nullptr)
+            {
+                // we had to use more than one block, so swap them all for a single one that's big enough..
+                const size_t totalSize = getTotalSize();
+                freeAllBlocks();
+                initialSize = totalSize;
+            }
+            else
+            {
+                blocks->numBytesUsed = 0;
+            }
+        }
+        else
+        {
+            const int sizeClass = *reinterpret_cast <const int*> (static_cast <const char*> (block) - MemoryArenaHelpers::headerSize);
+
+            FreeChunk* const chunk = static_cast <FreeChunk*> (block);
+            chunk->next = freeChunks [sizeClass];
+            freeChunks [sizeClass] = chunk;
+        }
+    }
+}
+
+size_t MemoryArena::getTotalSize() const noexcept
+{
+    size_t total = 0;
+
+    for (const Block* b = blocks; b != nullptr; b = b->next)
+        total += b->size;
+
+    return total;
+}
+
+//==============================================================================
+void MemoryArena::addBlock (const size_t minimumSize)
+{
+    using namespace MemoryArenaHelpers;
+    const size_t size = jmax (minimumSize, blocks != nullptr ? blocks->size * 2 : initialSize);
+
+    Block* const b = static_cast <Block*> (std::malloc (roundUp (sizeof (Block)) + size));
+
+    if (b == nullptr)
+        throw std::bad_alloc();
+
+    b->next = blocks;
+    b->size = size;
+    b->numBytesUsed = 0;
+    blocks = b;
+    ++numHeapAllocations;
+}
+
+void MemoryArena::freeAllBlocks() noexcept
+{
+    while (blocks != nullptr)
+    {
+        Block* const next = blocks->next;
+        std::free (blocks);
+        blocks = next;
+    }
+}
+
+void MemoryArena::clearFreeChunks() noexcept
+{
+    for (int i = 0; i < (int) numSizeClasses; ++i)
+        freeChunks [i] = nullptr;
+}
+
+bool MemoryArena::ownsBlock (const void* const block) const noexcept
+{
+    for (const Block* b = blocks; b != nullptr; b = b->next)
+    {
+        const char* const start = reinterpret_cast <const char*> (b) + MemoryArenaHelpers::roundUp (sizeof (Block));
+
+        if (block >= start && block < start + b->numBytesUsed)
+            return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MemoryArenaTests  : public UnitTest
+{
+public:
+    MemoryArenaTests() : UnitTest ("MemoryArena") {}
+
+    void runTest()
+    {
+        beginTest ("Basics");
+
+        MemoryArena arena (1024);
+        Random r;
+
+        Array<int> sizes;
+        for (int i = 0; i < 100; ++i)
+            sizes.add (r.nextInt (200) + 1);
+
+        int heapAllocationsAfterFirstFrame = 0;
+
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            Array<void*> blocks;
+
+            for (int i = 0; i < sizes.size(); ++i)
+            {
+                const int size = sizes.getUnchecked (i);
+                char* const block = static_cast <char*> (arena.allocate ((size_t) size));
+                expect (block != nullptr && (pointer_sized_int) block % sizeof (double) == 0);
+
+                memset (block, i, (size_t) size);
+                blocks.add (block);
+            }
+
+            expectEquals (arena.getNumLiveAllocations(), 100);
+
+            for (int i = 0; i < blocks.size(); ++i)
+            {
+                const char* const block = static_cast <const char*> (blocks.getUnchecked (i));
+
+                for (int j = 0; j < sizes.getUnchecked (i); ++j)
+                    expect (block[j] == (char) i);
+            }
+
+            for (int i = blocks.size(); --i >= 0;)
+                arena.release (blocks.getUnchecked (i));
+
+            expectEquals (arena.getNumLiveAllocations(), 0);
+
+            if (frame == 0)
+                heapAllocationsAfterFirstFrame = arena.getNumHeapAllocations();
+        }
+
+        // once everything's been released, it should have merged its blocks into a single
+        // one that's big enough, and only needed the heap again to create that..
+        expectEquals (arena.getNumHeapAllocations(), heapAllocationsAfterFirstFrame + 1);
+
+        const int heapAllocationsSoFar = arena.getNumHeapAllocations();
+        void* const block = arena.allocate (16);
+        expectEquals (arena.getNumHeapAllocations(), heapAllocationsSoFar);
+        arena.release (block);
+
+        beginTest ("Recycling around a long-lived allocation");
+
+        void* const longLived = arena.allocate (100);
+        const size_t sizeBefore = arena.getTotalSize();
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            void* const a = arena.allocate ((size_t) r.nextInt (2000) + 1);
+            void* const b = arena.allocate ((size_t) r.nextInt (2000) + 1);
+            arena.release (a);
+            arena.release (b);
+        }
+
+        // the released blocks should have been re-used, rather than new space getting used up..
+        expect (arena.getTotalSize() <= sizeBefore * 2);
+        expectEquals (arena.getNumLiveAllocations(), 1);
+        arena.release (longLived);
+    }
+};
+
+static MemoryArenaTests memoryArenaTests;
+
+#endif
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_MEMORYARENA_JUCEHEADER__
+#define __JUCE_MEMORYARENA_JUCEHEADER__
+
+#include "../memory/juce_HeapBlock.h"
+
+
+//==============================================================================
+/**
+    A simple bump allocator for lots of short-lived blocks of memory.
+
+    Each call to allocate() just hands out the next chunk of a large block. Sizes are
+    rounded up to a power of two, and a released chunk is put on a free list for its
+    size, so that later allocations of a similar size can re-use it - that way a few
+    long-lived allocations don't stop the space around them being recycled. The arena
+    also keeps count of how many of its allocations are still in use, and once they've
+    all been released, it starts again from the beginning of its memory. If it ever
+    runs out of space, it gets another large block from the heap, and the next time it
+    empties, it merges all of its blocks into one that's big enough to hold everything
+    at once.
+
+    So for something like a renderer that makes a burst of temporary allocations for
+    each frame and then throws them all away, the heap only gets used for the first
+    few frames.
+
+    This class isn't thread-safe.
+*/
+class JUCE_API  MemoryArena
+{
+public:
+    //==============================================================================
+    /** Creates an arena. No memory is allocated until the first call to allocate().
+
+        @param initialSizeInBytes   the size of the first block to get from the heap
+    */
+    explicit MemoryArena (size_t initialSizeInBytes = 65536);
+
+    /** Destructor.
+        Everything that was allocated from the arena should have been released by now.
+    */
+    ~MemoryArena();
+
+    //==============================================================================
+    /** Returns a block of memory with at least the given size.
+
+        The block is aligned as well as one from malloc() would be, and must be passed
+        back to release() when it's no longer needed.
+    */
+    void* allocate (size_t numBytes);
+
+    /** Marks a block that was returned by allocate() as no longer needed.
+        Passing a null pointer does nothing.
+    */
+    void release (void* block) noexcept;
+
+    //==============================================================================
+    /** Returns the number of allocations that haven't been released yet. */
+    int getNumLiveAllocations() const noexcept          { return numLiveAllocations; }
+
+    /** Returns the total number of bytes that the arena has got from the heap. */
+    size_t getTotalSize() const noexcept;
+
+    /** Returns the number of times the arena has had to go to the heap for more space. */
+    int getNumHeapAllocations() const noexcept          { return numHeapAllocations; }
+
+private:
+    //==============================================================================
+    struct Block
+    {
+        Block* next;
+        size_t size, numBytesUsed;
+    };
+
+    struct FreeChunk
+    {
+        FreeChunk* next;
+    };
+
+    enum { numSizeClasses = 8 * sizeof (size_t) - 4 };
+
+    Block* blocks;
+    FreeChunk* freeChunks [numSizeClasses];
+    size_t initialSize;
+    int numLiveAllocations, numHeapAllocations;
+
+    void addBlock (size_t minimumSize);
+    void freeAllBlocks() noexcept;
+    void clearFreeChunks() noexcept;
+    bool ownsBlock (const void*) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MemoryArena);
+};
+
+
+#endif   // __JUCE_MEMORYARENA_JUCEHEADER__
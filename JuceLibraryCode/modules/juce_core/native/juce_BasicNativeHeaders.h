@@ -181,6 +181,9 @@
  #include <sys/sysinfo.h>
  #include <sys/file.h>
  #include <sys/prctl.h>
+ #include <sys/syscall.h>
+ #include <sys/inotify.h>
+ #include <poll.h>
  #include <signal.h>
  #include <stddef.h>
 
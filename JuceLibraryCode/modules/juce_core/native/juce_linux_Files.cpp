@@ -228,47 +228,42 @@ class DirectoryIterator::NativeIterator::Pimpl
 {
 public:
     Pimpl (const File& directory, const String& wildCard_)
-        : parentDir (File::addTrailingSeparator (directory.getFullPathName())),
-          wildCard (wildCard_),
-          dir (opendir (directory.getFullPathName().toUTF8()))
+        : wildCard (wildCard_),
+          matchesAllNames (wildCard_ == "*"),
+          dirFD (open (directory.getFullPathName().toUTF8(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)),
+          buffer (bufferSize),
+          bufferPos (0), bufferEnd (0)
     {
     }
 
     ~Pimpl()
     {
-        if (dir != nullptr)
-            closedir (dir);
+        if (dirFD >= 0)
+            close (dirFD);
     }
 
     bool next (String& filenameFound,
                bool* const isDir, bool* const isHidden, int64* const fileSize,
                Time* const modTime, Time* const creationTime, bool* const isReadOnly)
     {
-        if (dir != nullptr)
+        while (dirFD >= 0)
         {
-            const char* wildcardUTF8 = nullptr;
+            if (bufferPos >= bufferEnd && ! readNextBatch())
+                break;
 
-            for (;;)
-            {
-                struct dirent* const de = readdir (dir);
-
-                if (de == nullptr)
-                    break;
-
-                if (wildcardUTF8 == nullptr)
-                    wildcardUTF8 = wildCard.toUTF8();
+            const LinuxDirEntry* const de = reinterpret_cast <const LinuxDirEntry*> (buffer + bufferPos);
+            bufferPos += de->d_reclen;
 
-                if (fnmatch (wildcardUTF8, de->d_name, FNM_CASEFOLD) == 0)
-                {
-                    filenameFound = CharPointer_UTF8 (de->d_name);
+            if (matchesAllNames || fnmatch (wildCard.toUTF8(), de->d_name, FNM_CASEFOLD) == 0)
+            {
+                filenameFound = CharPointer_UTF8 (de->d_name);
 
-                    updateStatInfoForFile (parentDir + filenameFound, isDir, fileSize, modTime, creationTime, isReadOnly);
+                updateStatInfo (*de, isDir, fileSize, modTime, creationTime, isReadOnly);
 
-                    if (isHidden != nullptr)
-                        *isHidden = filenameFound.startsWithChar ('.');
+                if (isHidden != nullptr)
+                    *isHidden = de->d_name[0] == '.';
 
-                    return true;
-                }
+                return true;
             }
         }
 
@@ -276,8 +271,60 @@ public:
     }
 
 private:
-    String parentDir, wildCard;
-    DIR* dir;
+    // The layout that the getdents64 syscall uses - glibc doesn't declare it.
+    struct LinuxDirEntry
+    {
+        uint64 d_ino;
+        int64 d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    enum { bufferSize = 32768 };
+
+    const String wildCard;
+    const bool matchesAllNames;
+    int dirFD;
+    HeapBlock<char> buffer;
+    int bufferPos, bufferEnd;
+
+    // Reads as many entries as will fit into the buffer in one go, rather than
+    // making a call per entry like readdir() can.
+    bool readNextBatch()
+    {
+        const long bytesRead = syscall (SYS_getdents64, dirFD, buffer.getData(), (int) bufferSize);
+
+        bufferPos = 0;
+        bufferEnd = bytesRead > 0 ? (int) bytesRead : 0;
+        return bufferEnd > 0;
+    }
+
+    void updateStatInfo (const LinuxDirEntry& de, bool* const isDir, int64* const fileSize,
+                         Time* const modTime, Time* const creationTime, bool* const isReadOnly) const
+    {
+        // If all we need is whether it's a directory, the entry's type will usually tell us without
+        // a stat, unless it's a symlink (which we need to follow) or the filesystem didn't fill it in.
+        if (fileSize == nullptr && modTime == nullptr && creationTime == nullptr
+             && (isDir == nullptr || (de.d_type != DT_UNKNOWN && de.d_type != DT_LNK)))
+        {
+            if (isDir != nullptr)
+                *isDir = de.d_type == DT_DIR;
+        }
+        else
+        {
+            juce_statStruct info;
+            const bool statOk = fstatat64 (dirFD, de.d_name, &info, 0) == 0;
+
+            if (isDir != nullptr)         *isDir        = statOk && ((info.st_mode & S_IFDIR) != 0);
+            if (fileSize != nullptr)      *fileSize     = statOk ? info.st_size : 0;
+            if (modTime != nullptr)       *modTime      = Time (statOk ? (int64) info.st_mtime * 1000 : 0);
+            if (creationTime != nullptr)  *creationTime = Time (statOk ? (int64) info.st_ctime * 1000 : 0);
+        }
+
+        if (isReadOnly != nullptr)
+            *isReadOnly = faccessat (dirFD, de.d_name, W_OK, 0) != 0;
+    }
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl);
 };
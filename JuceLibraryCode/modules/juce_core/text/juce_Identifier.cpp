@@ -61,6 +61,14 @@ Identifier::Identifier (const char* const name_)
     jassert (isValidIdentifier (toString()));
 }
 
+Identifier::Identifier (const String::CharPointerType nameStart, const String::CharPointerType nameEnd)
+    : name (Identifier::getPool().getPooledString (nameStart, nameEnd))
+{
+    /* An Identifier string must be suitable for use as a script variable or XML
+       attribute, so it can only contain this limited set of characters.. */
+    jassert (isValidIdentifier (toString()));
+}
+
 Identifier::~Identifier()
 {
 }
@@ -57,6 +57,12 @@ public:
     */
     Identifier (const String& name);
 
+    /** Creates an identifier from a range of characters.
+        Because this name may need to be used in contexts such as script variables or XML
+        tags, it must only contain ascii letters and digits, or the underscore character.
+    */
+    Identifier (String::CharPointerType nameStart, String::CharPointerType nameEnd);
+
     /** Creates a copy of another identifier. */
     Identifier (const Identifier& other) noexcept;
 
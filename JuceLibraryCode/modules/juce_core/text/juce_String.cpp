@@ -128,6 +128,29 @@ public:
         return dest;
     }
 
+    // (if the range is already in the right format, it can just be copied)
+    static const CharPointerType createFromCharPointer (const CharPointerType& start, const CharPointerType& end)
+    {
+        const CharType* const src = start.getAddress();
+
+        if (src == nullptr || end.getAddress() <= src)
+            return getEmpty();
+
+        const size_t maxUnits = (size_t) (end.getAddress() - src);
+        size_t numUnits = 0;
+
+        while (numUnits < maxUnits && src [numUnits] != 0)
+            ++numUnits;
+
+        if (numUnits == 0)
+            return getEmpty();
+
+        const CharPointerType dest (createUninitialisedBytes ((numUnits + 1) * sizeof (CharType)));
+        memcpy (dest.getAddress(), src, numUnits * sizeof (CharType));
+        dest.getAddress() [numUnits] = 0;
+        return dest;
+    }
+
     static const CharPointerType createFromFixedLength (const char* const src, const size_t numChars)
     {
         const CharPointerType dest (createUninitialisedBytes (numChars * sizeof (CharType) + sizeof (CharType)));
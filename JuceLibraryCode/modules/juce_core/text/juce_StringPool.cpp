@@ -23,65 +23,224 @@
   ==============================================================================
 */
 
-StringPool::StringPool() noexcept   {}
-StringPool::~StringPool()           {}
-
 namespace StringPoolHelpers
 {
-    template <class StringType>
-    String::CharPointerType getPooledStringFromArray (Array<String>& strings,
-                                                      StringType newString,
-                                                      const CriticalSection& lock)
+    /* Lets a range of characters be hashed and compared as if it were a null-terminated string. */
+    struct CharRange
+    {
+        CharRange (String::CharPointerType start_, String::CharPointerType end_) noexcept
+            : text (start_), end (end_)
+        {
+        }
+
+        juce_wchar getAndAdvance() noexcept     { return text < end ? text.getAndAdvance() : 0; }
+
+        String::CharPointerType text, end;
+    };
+
+    template <class CharPointerType>
+    static String createString (const CharPointerType text)     { return String (text); }
+    static String createString (const CharRange& range)         { return String (range.text, range.end); }
+}
+
+//==============================================================================
+/*  Each shard is a hash table of singly-linked lists of strings, where new strings are
+    added at the head of a list. Strings are only ever added, so a reader can walk the
+    lists without locking anything. All changes are made while holding the shard's lock,
+    and if a lock-free search fails, it's repeated under the lock before adding the
+    string - so if a reader misses a string because the table was being rehashed at the
+    time, the worst that happens is that it has to take the lock.
+*/
+class StringPool::Shard
+{
+public:
+    Shard()
+        : table (nullptr)
+    {
+    }
+
+    ~Shard()
+    {
+        // (the nodes and tables are owned by the arrays)
+    }
+
+    template <class CharPointerType>
+    String::CharPointerType getPooled (const CharPointerType text, const uint32 hash, Atomic<int>& numStrings)
     {
+        if (const Node* const existing = find (text, hash))
+            return existing->text.getCharPointer();
+
         const ScopedLock sl (lock);
-        int start = 0;
-        int end = strings.size();
 
-        for (;;)
+        if (const Node* const existing = find (text, hash))
+            return existing->text.getCharPointer();
+
+        if (table.get() == nullptr || nodes.size() >= table.get()->numBuckets * 2)
+            rehash();
+
+        Node* const node = new Node (StringPoolHelpers::createString (text), hash);
+        nodes.add (node);
+        Atomic<Node*>& bucket = table.get()->getBucket (hash);
+        node->next = bucket.get();
+        bucket = node; // (this is an atomic store, so the node's contents are visible to readers before it is)
+
+        ++numStrings;
+        return node->text.getCharPointer();
+    }
+
+    int size() const
+    {
+        const ScopedLock sl (lock);
+        return nodes.size();
+    }
+
+    String::CharPointerType getString (const int index) const
+    {
+        const ScopedLock sl (lock);
+        const Node* const node = nodes [index];
+        return node != nullptr ? node->text.getCharPointer() : String::empty.getCharPointer();
+    }
+
+private:
+    //==============================================================================
+    struct Node
+    {
+        Node (const String& text_, const uint32 hash_) : text (text_), hash (hash_) {}
+
+        const String text;
+        const uint32 hash;
+        Atomic<Node*> next;
+
+        JUCE_DECLARE_NON_COPYABLE (Node);
+    };
+
+    struct Table
+    {
+        Table (const int numBuckets_) : numBuckets (numBuckets_)
         {
-            if (start >= end)
-            {
-                jassert (start <= end);
-                strings.insert (start, newString);
-                return strings.getReference (start).getCharPointer();
-            }
-            else
-            {
-                const String& startString = strings.getReference (start);
+            buckets.calloc ((size_t) numBuckets);
+        }
 
-                if (startString == newString)
-                    return startString.getCharPointer();
+        Atomic<Node*>& getBucket (const uint32 hash) const noexcept
+        {
+            // (the bottom bits of the hash were used to pick the shard)
+            return buckets [(hash >> 6) & (uint32) (numBuckets - 1)];
+        }
+
+        const int numBuckets;
+        HeapBlock<Atomic<Node*> > buckets;
 
-                const int halfway = (start + end) >> 1;
+        JUCE_DECLARE_NON_COPYABLE (Table);
+    };
 
-                if (halfway == start)
-                {
-                    if (startString.compare (newString) < 0)
-                        ++start;
+    CriticalSection lock;
+    Atomic<Table*> table;
+    OwnedArray<Node> nodes;   // all the nodes, in the order they were added
+    OwnedArray<Table> tables; // old tables are kept, in case a reader is still looking at one
 
-                    strings.insert (start, newString);
-                    return strings.getReference (start).getCharPointer();
-                }
+    template <class CharPointerType>
+    const Node* find (const CharPointerType text, const uint32 hash) const noexcept
+    {
+        const Table* const t = table.get();
 
-                const int comp = strings.getReference (halfway).compare (newString);
+        if (t != nullptr)
+            for (const Node* n = t->getBucket (hash).get(); n != nullptr; n = n->next.get())
+                if (n->hash == hash && n->text.getCharPointer().compare (text) == 0)
+                    return n;
 
-                if (comp == 0)
-                    return strings.getReference (halfway).getCharPointer();
-                else if (comp < 0)
-                    start = halfway;
-                else
-                    end = halfway;
-            }
+        return nullptr;
+    }
+
+    void rehash()
+    {
+        Table* const newTable = new Table (nextPowerOfTwo (jmax (16, nodes.size())));
+        tables.add (newTable);
+
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            Node* const node = nodes.getUnchecked (i);
+            Atomic<Node*>& bucket = newTable->getBucket (node->hash);
+            node->next = bucket.get();
+            bucket = node;
+        }
+
+        table = newTable;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Shard);
+};
+
+//==============================================================================
+StringPool::StringPool() noexcept
+{
+    shards.calloc (numShards);
+
+   #if JUCE_CHECK_MEMORY_LEAKS
+    {
+        /* The leak detectors for the objects that a shard uses are static objects, so if
+           this pool is itself a static object, they need to be created before it, or
+           they'll get deleted first and will report the shards as leaks.
+        */
+        Shard dummyShard;
+        Atomic<int> dummyCount;
+        dummyShard.getPooled (CharPointer_ASCII ("x"), 0, dummyCount);
+    }
+   #endif
+}
+
+StringPool::~StringPool()
+{
+    for (int i = 0; i < numShards; ++i)
+        delete shards[i];
+}
+
+namespace StringPoolHelpers
+{
+    template <class CharPointerType>
+    uint32 calculateHash (CharPointerType text) noexcept
+    {
+        // FNV-1a, applied to the unicode characters so that the same string gets the
+        // same hash whatever encoding it arrives in
+        uint32 hash = 2166136261u;
+
+        for (;;)
+        {
+            const juce_wchar c = text.getAndAdvance();
+
+            if (c == 0)
+                break;
+
+            hash = (hash ^ (uint32) c) * 16777619u;
         }
+
+        return hash;
     }
 }
 
+template <class CharPointerType>
+String::CharPointerType StringPool::getPooled (const CharPointerType text)
+{
+    const uint32 hash = StringPoolHelpers::calculateHash (text);
+    Shard*& shard = shards [hash & (numShards - 1)];
+
+    if (shard == nullptr)
+    {
+        // (shards are created on demand, so an empty pool doesn't cost much)
+        Shard* const newShard = new Shard();
+
+        if (! reinterpret_cast <Atomic<Shard*>&> (shard).compareAndSetBool (newShard, nullptr))
+            delete newShard;
+    }
+
+    return reinterpret_cast <Atomic<Shard*>&> (shard).get()->getPooled (text, hash, numStrings);
+}
+
 String::CharPointerType StringPool::getPooledString (const String& s)
 {
     if (s.isEmpty())
         return String::empty.getCharPointer();
 
-    return StringPoolHelpers::getPooledStringFromArray (strings, s, lock);
+    return getPooled (s.getCharPointer());
 }
 
 String::CharPointerType StringPool::getPooledString (const char* const s)
@@ -89,7 +248,7 @@ String::CharPointerType StringPool::getPooledString (const char* const s)
     if (s == nullptr || *s == 0)
         return String::empty.getCharPointer();
 
-    return StringPoolHelpers::getPooledStringFromArray (strings, s, lock);
+    return getPooled (CharPointer_ASCII (s));
 }
 
 String::CharPointerType StringPool::getPooledString (const wchar_t* const s)
@@ -97,15 +256,131 @@ String::CharPointerType StringPool::getPooledString (const wchar_t* const s)
     if (s == nullptr || *s == 0)
         return String::empty.getCharPointer();
 
-    return StringPoolHelpers::getPooledStringFromArray (strings, s, lock);
+    return getPooled (CharPointer_wchar_t (s));
+}
+
+String::CharPointerType StringPool::getPooledString (const String::CharPointerType start, const String::CharPointerType end)
+{
+    if (start.getAddress() == nullptr || start >= end)
+        return String::empty.getCharPointer();
+
+    return getPooled (StringPoolHelpers::CharRange (start, end));
 }
 
 int StringPool::size() const noexcept
 {
-    return strings.size();
+    return numStrings.get();
 }
 
-String::CharPointerType StringPool::operator[] (const int index) const noexcept
+String::CharPointerType StringPool::operator[] (int index) const noexcept
 {
-    return strings [index].getCharPointer();
+    if (index >= 0)
+    {
+        for (int i = 0; i < numShards; ++i)
+        {
+            if (const Shard* const shard = shards[i])
+            {
+                const int numInShard = shard->size();
+
+                if (index < numInShard)
+                    return shard->getString (index);
+
+                index -= numInShard;
+            }
+        }
+    }
+
+    return String::empty.getCharPointer();
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StringPoolTests  : public UnitTest
+{
+public:
+    StringPoolTests() : UnitTest ("StringPool") {}
+
+    class InterningThread  : public Thread
+    {
+    public:
+        InterningThread (StringPool& pool_, int firstName_, int numNames_)
+            : Thread ("StringPool test"), pool (pool_), firstName (firstName_), numNames (numNames_)
+        {
+            results.ensureStorageAllocated (numNames);
+        }
+
+        void run()
+        {
+            for (int i = 0; i < numNames; ++i)
+                results.add (pool.getPooledString ("name" + String (firstName + i)).getAddress());
+        }
+
+        StringPool& pool;
+        const int firstName, numNames;
+        Array<const void*> results;
+    };
+
+    void runTest()
+    {
+        beginTest ("Basics");
+
+        {
+            StringPool pool;
+            const String::CharPointerType a (pool.getPooledString ("abc"));
+
+            expect (a.getAddress() == pool.getPooledString (String ("abc")).getAddress());
+            expect (a.getAddress() == pool.getPooledString (L"abc").getAddress());
+            expect (a.getAddress() != pool.getPooledString ("abcd").getAddress());
+            expect (pool.getPooledString ("").isEmpty());
+            expectEquals (pool.size(), 2);
+
+            const String abcdef ("abcdef");
+            const String::CharPointerType start (abcdef.getCharPointer());
+            expect (a.getAddress() == pool.getPooledString (start, start + 3).getAddress());
+            expect (pool.getPooledString (start, start).isEmpty());
+
+            const String nonAscii (CharPointer_UTF8 ("\xc3\xa9t\xc3\xa9"));
+            expect (pool.getPooledString (nonAscii).getAddress() == pool.getPooledString (nonAscii.toWideCharPointer()).getAddress());
+
+            StringArray all;
+            for (int i = 0; i < pool.size(); ++i)
+                all.add (String (pool[i]));
+
+            all.sort (false);
+            expect (all.joinIntoString (",") == "abc,abcd," + nonAscii);
+        }
+
+        beginTest ("Multi-threaded");
+
+        {
+            // the threads' names overlap, so several of them will be racing to add the same ones
+            StringPool pool;
+            OwnedArray<InterningThread> threads;
+
+            for (int i = 0; i < 8; ++i)
+                threads.add (new InterningThread (pool, (i / 2) * 2000, 4000));
+
+            for (int i = 0; i < threads.size(); ++i)
+                threads.getUnchecked(i)->startThread();
+
+            for (int i = 0; i < threads.size(); ++i)
+                threads.getUnchecked(i)->waitForThreadToExit (-1);
+
+            expectEquals (pool.size(), 10000);
+
+            for (int i = 0; i < threads.size(); ++i)
+            {
+                const InterningThread& t = *threads.getUnchecked(i);
+
+                for (int j = 0; j < t.numNames; j += 97)
+                    expect (t.results.getUnchecked (j) == pool.getPooledString ("name" + String (t.firstName + j)).getAddress());
+            }
+        }
+    }
+};
+
+static StringPoolTests stringPoolTests;
+
+#endif
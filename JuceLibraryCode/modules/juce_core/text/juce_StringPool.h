@@ -27,7 +27,8 @@
 #define __JUCE_STRINGPOOL_JUCEHEADER__
 
 #include "juce_String.h"
-#include "../containers/juce_Array.h"
+#include "../memory/juce_Atomic.h"
+#include "../memory/juce_HeapBlock.h"
 
 
 //==============================================================================
@@ -40,6 +41,11 @@
     is returned every time a matching string is asked for. This means that it's trivial to
     compare two pooled strings for equality, as you can simply compare their pointers. It
     also cuts down on storage if you're using many copies of the same string.
+
+    The pool is thread-safe. Its strings are kept in a set of hash tables, each with
+    its own lock, so threads that are adding different strings won't usually hold each
+    other up - and looking up a string that's already in the pool doesn't need a lock
+    at all.
 */
 class JUCE_API  StringPool
 {
@@ -76,16 +82,32 @@ public:
     */
     String::CharPointerType getPooledString (const wchar_t* original);
 
+    /** Returns a pointer to a copy of the string between two character pointers.
+        This is the same as calling getPooledString (String (start, end)), but without
+        creating a temporary String if the string is already in the pool.
+    */
+    String::CharPointerType getPooledString (String::CharPointerType start, String::CharPointerType end);
+
     //==============================================================================
     /** Returns the number of strings in the pool. */
     int size() const noexcept;
 
-    /** Returns one of the strings in the pool, by index. */
+    /** Returns one of the strings in the pool, by index.
+        The strings aren't kept in any particular order.
+    */
     String::CharPointerType operator[] (int index) const noexcept;
 
 private:
-    Array <String> strings;
-    CriticalSection lock;
+    //==============================================================================
+    class Shard;
+    enum { numShards = 64 };
+    HeapBlock<Shard*> shards;
+    Atomic<int> numStrings;
+
+    template <class CharPointerType>
+    String::CharPointerType getPooled (CharPointerType);
+
+    JUCE_DECLARE_NON_COPYABLE (StringPool);
 };
 
 
@@ -54,6 +54,146 @@ void ThreadPoolJob::signalJobShouldExit()
     shouldStop = true;
 }
 
+//==============================================================================
+ThreadPoolTask::ThreadPoolTask()
+    : pool (nullptr),
+      finishedEvent (true)
+{
+}
+
+ThreadPoolTask::~ThreadPoolTask()
+{
+    // A pool keeps a reference to any task that it hasn't run yet, so this shouldn't be possible..
+    jassert (state.get() != queued && state.get() != running);
+}
+
+bool ThreadPoolTask::hasFinished() const noexcept
+{
+    return state.get() == finished;
+}
+
+bool ThreadPoolTask::runIfNotStarted()
+{
+    if (! state.compareAndSetBool (running, queued))
+        return false;
+
+    JUCE_TRY
+    {
+        run();
+    }
+    JUCE_CATCH_ALL_ASSERT
+
+    state = finished;
+    finishedEvent.signal();
+    return true;
+}
+
+bool ThreadPoolTask::waitUntilFinished (const int timeOutMs)
+{
+    // If nobody's started it yet, it's quicker to just do it ourselves..
+    if (runIfNotStarted() || hasFinished())
+        return true;
+
+    jassert (pool != nullptr); // this task hasn't been added to a pool!
+
+    ThreadPool::ThreadPoolThread* const poolThread = pool != nullptr ? pool->getCurrentPoolThread() : nullptr;
+
+    if (poolThread == nullptr)
+        return finishedEvent.wait (timeOutMs);
+
+    // If we're one of the pool's threads, we'll make ourselves useful until it's done,
+    // in case the task is waiting for something that's in our own queue..
+    const uint32 start = Time::getMillisecondCounter();
+
+    while (! hasFinished())
+    {
+        if (timeOutMs >= 0 && Time::getMillisecondCounter() >= start + (uint32) timeOutMs)
+            return false;
+
+        if (! pool->runNextTask (poolThread))
+            finishedEvent.wait (1);
+    }
+
+    return true;
+}
+
+//==============================================================================
+/*  A double-ended queue of tasks. The thread that owns it adds and removes tasks at the
+    back, and other threads steal the oldest ones from the front. The queue holds a
+    reference to each task that's in it.
+*/
+class ThreadPool::TaskQueue
+{
+public:
+    TaskQueue() noexcept
+        : capacity (0), head (0), numTasks (0)
+    {
+    }
+
+    ~TaskQueue()
+    {
+        jassert (numTasks == 0);
+    }
+
+    void addLast (ThreadPoolTask* const task)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (numTasks == capacity)
+        {
+            const int newCapacity = jmax (32, capacity * 2);
+            HeapBlock<ThreadPoolTask*> newTasks ((size_t) newCapacity);
+
+            for (int i = 0; i < numTasks; ++i)
+                newTasks[i] = tasks [(head + i) & (capacity - 1)];
+
+            tasks.swapWith (newTasks);
+            capacity = newCapacity;
+            head = 0;
+        }
+
+        tasks [(head + numTasks) & (capacity - 1)] = task;
+        ++numTasks;
+    }
+
+    ThreadPoolTask* removeLast() noexcept
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (numTasks == 0)
+            return nullptr;
+
+        --numTasks;
+        return tasks [(head + numTasks) & (capacity - 1)];
+    }
+
+    ThreadPoolTask* removeFirst() noexcept
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (numTasks == 0)
+            return nullptr;
+
+        ThreadPoolTask* const task = tasks [head];
+        head = (head + 1) & (capacity - 1);
+        --numTasks;
+        return task;
+    }
+
+    bool isEmpty() const noexcept
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        return numTasks == 0;
+    }
+
+private:
+    SpinLock lock;
+    HeapBlock<ThreadPoolTask*> tasks;
+    int capacity, head, numTasks; // (capacity is always a power of 2)
+
+    JUCE_DECLARE_NON_COPYABLE (TaskQueue);
+};
+
 //==============================================================================
 class ThreadPool::ThreadPoolThread  : public Thread
 {
@@ -68,17 +208,74 @@ public:
     {
         while (! threadShouldExit())
         {
-            if (! pool.runNextJob())
+            if (pool.runNextTask (this) || pool.runNextJob())
+                continue;
+
+            // Flag ourselves as idle before checking the queues one last time, so that
+            // anything that's added after the check is guaranteed to wake us up..
+            isIdle = 1;
+
+            if (! pool.hasQueuedTasks())
                 wait (500);
+
+            isIdle = 0;
         }
     }
 
+    TaskQueue tasks;
+    Atomic<int> isIdle;
+
 private:
     ThreadPool& pool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolThread);
 };
 
+//==============================================================================
+class ThreadPool::ParallelForTask  : public ThreadPoolTask
+{
+public:
+    struct Range
+    {
+        Range (const int start, const int end_, const int grainSize_, ParallelForBody& body_) noexcept
+            : next (start), end (end_), grainSize (grainSize_), body (body_)
+        {
+        }
+
+        void processChunks()
+        {
+            for (;;)
+            {
+                const int chunkStart = next.get();
+
+                if (chunkStart >= end)
+                    break;
+
+                // (this never steps beyond the end, so it can't overflow when end is near INT_MAX)
+                const int chunkEnd = chunkStart + jmin (grainSize, end - chunkStart);
+
+                if (next.compareAndSetBool (chunkEnd, chunkStart))
+                    body.processRange (chunkStart, chunkEnd);
+            }
+        }
+
+        Atomic<int> next;
+        const int end, grainSize;
+        ParallelForBody& body;
+
+        JUCE_DECLARE_NON_COPYABLE (Range);
+    };
+
+    ParallelForTask (Range& range_) noexcept : range (range_) {}
+
+    void run()      { range.processChunks(); }
+
+private:
+    Range& range;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelForTask);
+};
+
 //==============================================================================
 ThreadPool::ThreadPool (const int numThreads)
 {
@@ -95,7 +292,15 @@ ThreadPool::ThreadPool()
 ThreadPool::~ThreadPool()
 {
     removeAllJobs (true, 5000);
+
+    // run any tasks that are still waiting, as there might be threads waiting for them
+    while (runNextTask (nullptr))
+    {}
+
     stopThreads();
+
+    while (runNextTask (nullptr))
+    {}
 }
 
 void ThreadPool::createThreads (int numThreads)
@@ -138,6 +343,113 @@ void ThreadPool::addJob (ThreadPoolJob* const job, const bool deleteJobWhenFinis
     }
 }
 
+ThreadPoolTask::Ptr ThreadPool::addTask (ThreadPoolTask* const task)
+{
+    jassert (task != nullptr);
+    ThreadPoolTask::Ptr handle (task);
+
+    if (task != nullptr)
+    {
+        // A task can only be added to a pool once!
+        jassert (task->pool == nullptr && task->state.get() == ThreadPoolTask::notQueued);
+
+        task->pool = this;
+        task->state = ThreadPoolTask::queued;
+        task->incReferenceCount(); // (this reference belongs to the queue)
+
+        ThreadPoolThread* thread = getCurrentPoolThread();
+
+        if (thread == nullptr)
+            thread = threads.getUnchecked ((int) ((uint32) ++nextThreadForTask % (uint32) threads.size()));
+
+        thread->tasks.addLast (task);
+        wakeAnIdleThread();
+    }
+
+    return handle;
+}
+
+void ThreadPool::parallelFor (const int startIndex, const int endIndex, int grainSize, ParallelForBody& body)
+{
+    grainSize = jmax (1, grainSize);
+    const int64 numChunks = ((int64) endIndex - startIndex + grainSize - 1) / grainSize;
+
+    if (numChunks <= 1)
+    {
+        if (endIndex > startIndex)
+            body.processRange (startIndex, endIndex);
+
+        return;
+    }
+
+    ParallelForTask::Range range (startIndex, endIndex, grainSize, body);
+    Array<ThreadPoolTask::Ptr> helpers;
+
+    for (int i = (int) jmin ((int64) threads.size(), numChunks - 1); --i >= 0;)
+        helpers.add (addTask (new ParallelForTask (range)));
+
+    range.processChunks();
+
+    // (any helpers that haven't started by now will just be run here and find nothing left to do)
+    for (int i = helpers.size(); --i >= 0;)
+        helpers.getReference (i)->waitUntilFinished();
+}
+
+bool ThreadPool::runNextTask (ThreadPoolThread* const thread)
+{
+    ThreadPoolTask* task = thread != nullptr ? thread->tasks.removeLast() : nullptr;
+
+    if (task == nullptr)
+    {
+        // nothing of our own to do, so try to steal something..
+        const int firstVictim = jmax (0, threads.indexOf (thread));
+
+        for (int i = 0; i < threads.size() && task == nullptr; ++i)
+            task = threads.getUnchecked ((firstVictim + i) % threads.size())->tasks.removeFirst();
+
+        if (task == nullptr)
+            return false;
+    }
+
+    task->runIfNotStarted();
+    task->decReferenceCount();
+    return true;
+}
+
+bool ThreadPool::hasQueuedTasks() const
+{
+    for (int i = threads.size(); --i >= 0;)
+        if (! threads.getUnchecked(i)->tasks.isEmpty())
+            return true;
+
+    return false;
+}
+
+ThreadPool::ThreadPoolThread* ThreadPool::getCurrentPoolThread() const noexcept
+{
+    const Thread::ThreadID currentThreadId = Thread::getCurrentThreadId();
+
+    for (int i = threads.size(); --i >= 0;)
+        if (threads.getUnchecked(i)->getThreadId() == currentThreadId)
+            return threads.getUnchecked(i);
+
+    return nullptr;
+}
+
+void ThreadPool::wakeAnIdleThread() const
+{
+    for (int i = threads.size(); --i >= 0;)
+    {
+        ThreadPoolThread* const thread = threads.getUnchecked(i);
+
+        if (thread->isIdle.get() != 0)
+        {
+            thread->notify();
+            break;
+        }
+    }
+}
+
 int ThreadPool::getNumJobs() const
 {
     return jobs.size();
@@ -375,3 +687,122 @@ void ThreadPool::addToDeleteList (OwnedArray<ThreadPoolJob>& deletionList, Threa
     if (job->shouldBeDeleted)
         deletionList.add (job);
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ThreadPoolTests  : public UnitTest
+{
+public:
+    ThreadPoolTests() : UnitTest ("ThreadPool") {}
+
+    class SumBody  : public ThreadPool::ParallelForBody
+    {
+    public:
+        SumBody (const Array<int>& values_) : values (values_) {}
+
+        void processRange (const int start, const int end)
+        {
+            int sum = 0;
+            for (int i = start; i < end; ++i)
+                sum += values.getUnchecked (i);
+
+            total += sum;
+        }
+
+        const Array<int>& values;
+        Atomic<int> total;
+    };
+
+    class CountBody  : public ThreadPool::ParallelForBody
+    {
+    public:
+        CountBody (const int start_, const int end_) : start (start_), end (end_), outOfRange (0) {}
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            if (rangeStart < start || rangeEnd > end || rangeStart >= rangeEnd)
+                outOfRange = 1;
+            else
+                count += rangeEnd - rangeStart;
+        }
+
+        const int start, end;
+        Atomic<int> count, outOfRange;
+    };
+
+    class SumTask  : public ThreadPoolTask
+    {
+    public:
+        SumTask (ThreadPool& pool_, const Array<int>& values_, int grainSize_)
+            : pool (pool_), body (values_), grainSize (grainSize_)
+        {}
+
+        void run()
+        {
+            pool.parallelFor (0, body.values.size(), grainSize, body);
+        }
+
+        ThreadPool& pool;
+        SumBody body;
+        const int grainSize;
+    };
+
+    void runTest()
+    {
+        Array<int> values;
+        int expectedTotal = 0;
+        Random r;
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            values.add (r.nextInt (100));
+            expectedTotal += values.getLast();
+        }
+
+        ThreadPool pool (4);
+
+        beginTest ("parallelFor");
+
+        for (int grainSize = 1; grainSize <= 16384; grainSize *= 8)
+        {
+            SumBody body (values);
+            pool.parallelFor (0, values.size(), grainSize, body);
+            expectEquals (body.total.get(), expectedTotal);
+        }
+
+        {
+            // chunks that would step past the end of an int mustn't wrap around..
+            const int end = std::numeric_limits<int>::max();
+            CountBody body (end - 1000, end);
+            pool.parallelFor (body.start, body.end, 300, body);
+            expectEquals (body.count.get(), 1000);
+            expectEquals (body.outOfRange.get(), 0);
+        }
+
+        beginTest ("Tasks");
+
+        // each of these does a nested parallelFor from inside the pool
+        Array<ThreadPoolTask::Ptr> handles;
+        Array<SumTask*> tasks;
+
+        for (int i = 0; i < 20; ++i)
+        {
+            SumTask* const task = new SumTask (pool, values, 1 + r.nextInt (500));
+            tasks.add (task);
+            handles.add (pool.addTask (task));
+        }
+
+        for (int i = 0; i < handles.size(); ++i)
+        {
+            expect (handles.getReference (i)->waitUntilFinished (10000));
+            expect (handles.getReference (i)->hasFinished());
+            expectEquals (tasks.getUnchecked (i)->body.total.get(), expectedTotal);
+        }
+    }
+};
+
+static ThreadPoolTests threadPoolTests;
+
+#endif
@@ -30,6 +30,7 @@
 #include "../text/juce_StringArray.h"
 #include "../containers/juce_Array.h"
 #include "../containers/juce_OwnedArray.h"
+#include "../memory/juce_ReferenceCountedObject.h"
 class ThreadPool;
 class ThreadPoolThread;
 
@@ -132,6 +133,95 @@ private:
 };
 
 
+//==============================================================================
+/**
+    A lightweight, run-once piece of work for a ThreadPool.
+
+    Tasks are meant for lots of small jobs, where the overhead of a ThreadPoolJob would
+    be too much. Each of the pool's threads keeps its own queue of tasks, and when a thread
+    runs out of work, it steals tasks from the other threads' queues.
+
+    A task can't be interrupted or removed once it's been added to a pool, but the object
+    itself works as a handle for waiting until it's finished. It's reference-counted, so
+    you can just keep the ThreadPoolTask::Ptr that ThreadPool::addTask() returns and let
+    go of it when you're done, e.g.
+    @code
+    class SumTask  : public ThreadPoolTask
+    {
+    public:
+        SumTask (const int* data_, int num_) : data (data_), num (num_), result (0) {}
+
+        void run()
+        {
+            for (int i = 0; i < num; ++i)
+                result += data[i];
+        }
+
+        const int* data;
+        int num, result;
+    };
+
+    SumTask* const task = new SumTask (data, 1000);
+    ThreadPoolTask::Ptr handle (pool.addTask (task));
+    ...do some other work...
+    handle->waitUntilFinished();
+    int total = task->result;
+    @endcode
+
+    @see ThreadPool::addTask, ThreadPool::parallelFor
+*/
+class JUCE_API  ThreadPoolTask  : public ReferenceCountedObject
+{
+public:
+    //==============================================================================
+    /** Creates a task. After creating it, add it to a pool with ThreadPool::addTask(). */
+    ThreadPoolTask();
+
+    /** Destructor. */
+    ~ThreadPoolTask();
+
+    /** A handle to a task. */
+    typedef ReferenceCountedObjectPtr<ThreadPoolTask> Ptr;
+
+    //==============================================================================
+    /** Your subclass must implement this to do the task's work.
+
+        It's called once, either by one of the pool's threads or by a thread that
+        calls waitUntilFinished() before the pool has got round to it.
+    */
+    virtual void run() = 0;
+
+    //==============================================================================
+    /** Returns true if the task's run() method has been called and has returned. */
+    bool hasFinished() const noexcept;
+
+    /** Waits until the task has finished.
+
+        If none of the pool's threads has started the task yet, it'll be run
+        immediately on the calling thread instead. And if the calling thread is one of
+        the pool's own threads, it'll run other tasks while it waits, so it's safe for
+        a task to add more tasks and wait for them.
+
+        @param timeOutMilliseconds  how long to wait, or a negative number to wait forever
+        @returns true if the task has finished, or false if the timeout expired first
+    */
+    bool waitUntilFinished (int timeOutMilliseconds = -1);
+
+private:
+    //==============================================================================
+    friend class ThreadPool;
+    enum State { notQueued, queued, running, finished };
+
+    Atomic<int> state;
+    ThreadPool* pool;
+    WaitableEvent finishedEvent;
+
+    bool runIfNotStarted();
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadPoolTask);
+};
+
+
 //==============================================================================
 /**
     A set of threads that will run a list of jobs.
@@ -278,6 +368,48 @@ public:
     */
     StringArray getNamesOfAllJobs (bool onlyReturnActiveJobs) const;
 
+    //==============================================================================
+    /** Adds a task to the pool, and returns a handle to it.
+
+        If this is called from one of the pool's own threads, the task goes onto that
+        thread's queue, otherwise the tasks are shared out between the threads. Once a
+        task's finished, the pool lets go of its reference to it, so if nothing else
+        is holding a reference, it'll be deleted.
+
+        A task can only be added to one pool, once.
+
+        @see ThreadPoolTask::waitUntilFinished, parallelFor
+    */
+    ThreadPoolTask::Ptr addTask (ThreadPoolTask* task);
+
+    /** A callback used by parallelFor(). */
+    class JUCE_API  ParallelForBody
+    {
+    public:
+        virtual ~ParallelForBody() {}
+
+        /** Should do the work for all the indexes from startIndex up to (but not
+            including) endIndex.
+
+            This will be called by several threads at once, with different ranges.
+        */
+        virtual void processRange (int startIndex, int endIndex) = 0;
+    };
+
+    /** Calls a ParallelForBody for all the indexes from startIndex up to (but not
+        including) endIndex, using all the pool's threads, and returns when they've all
+        been done.
+
+        The range is chopped up into chunks of grainSize indexes, which are handed out
+        to the threads as they become free. The calling thread does its share too, so
+        this can safely be called from inside a task or another parallelFor().
+
+        Pick a grain size that makes each chunk do at least a few microseconds of work,
+        otherwise the overhead of handing out the chunks will outweigh the gains.
+    */
+    void parallelFor (int startIndex, int endIndex, int grainSize, ParallelForBody& body);
+
+    //==============================================================================
     /** Changes the priority of all the threads.
 
         This will call Thread::setPriority() for each thread in the pool.
@@ -292,13 +424,22 @@ private:
 
     class ThreadPoolThread;
     friend class ThreadPoolThread;
+    friend class ThreadPoolTask;
     friend class OwnedArray <ThreadPoolThread>;
     OwnedArray <ThreadPoolThread> threads;
 
     CriticalSection lock;
     WaitableEvent jobFinishedSignal;
+    Atomic<int> nextThreadForTask;
+
+    class TaskQueue;
+    class ParallelForTask;
 
     bool runNextJob();
+    bool runNextTask (ThreadPoolThread*);
+    bool hasQueuedTasks() const;
+    ThreadPoolThread* getCurrentPoolThread() const noexcept;
+    void wakeAnIdleThread() const;
     ThreadPoolJob* pickNextJobToRun();
     void addToDeleteList (OwnedArray<ThreadPoolJob>&, ThreadPoolJob*) const;
     void createThreads (int numThreads);
@@ -25,14 +25,12 @@
 
 XmlDocument::XmlDocument (const String& documentText)
     : originalText (documentText),
-      input (nullptr),
       ignoreEmptyTextElements (true)
 {
 }
 
 XmlDocument::XmlDocument (const File& file)
-    : input (nullptr),
-      ignoreEmptyTextElements (true),
+    : ignoreEmptyTextElements (true),
       inputSource (new FileInputSource (file))
 {
 }
@@ -63,790 +61,318 @@ void XmlDocument::setEmptyTextElementsIgnored (const bool shouldBeIgnored) noexc
     ignoreEmptyTextElements = shouldBeIgnored;
 }
 
-namespace XmlIdentifierChars
+//==============================================================================
+/*  An XmlPullParser that can look up entities in the document's DTD, and which can
+    parse any elements that an entity expands to.
+*/
+class XmlDocument::Parser  : public XmlPullParser
 {
-    static bool isIdentifierCharSlow (const juce_wchar c) noexcept
+public:
+    Parser (XmlDocument& owner_, const String& text)
+        : XmlPullParser (text.toUTF8().getAddress(), (size_t) text.getNumBytesAsUTF8()),
+          owner (owner_), needToLoadDTD (true), elementsFromEntities (nullptr)
     {
-        return CharacterFunctions::isLetterOrDigit (c)
-                 || c == '_' || c == '-' || c == ':' || c == '.';
     }
 
-    static bool isIdentifierChar (const juce_wchar c) noexcept
+    Parser (XmlDocument& owner_, InputStream* const in)
+        : XmlPullParser (in, true),
+          owner (owner_), needToLoadDTD (true), elementsFromEntities (nullptr)
     {
-        static const uint32 legalChars[] = { 0, 0x7ff6000, 0x87fffffe, 0x7fffffe, 0 };
-
-        return ((int) c < (int) numElementsInArray (legalChars) * 32) ? ((legalChars [c >> 5] & (1 << (c & 31))) != 0)
-                                                                      : isIdentifierCharSlow (c);
     }
 
-    /*static void generateIdentifierCharConstants()
-    {
-        uint32 n[8] = { 0 };
-        for (int i = 0; i < 256; ++i)
-            if (isIdentifierCharSlow (i))
-                n[i >> 5] |= (1 << (i & 31));
-
-        String s;
-        for (int i = 0; i < 8; ++i)
-            s << "0x" << String::toHexString ((int) n[i]) << ", ";
-
-        DBG (s);
-    }*/
-}
-
-XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentElement)
-{
-    String textToParse (originalText);
-
-    if (textToParse.isEmpty() && inputSource != nullptr)
+    /* Returns the text of the current text event. If any of its entities expand to
+       elements, these are added to the array.
+    */
+    String getText (Array<XmlElement*>& elements)
     {
-        ScopedPointer <InputStream> in (inputSource->createInputStream());
-
-        if (in != nullptr)
-        {
-            MemoryOutputStream data;
-            data.writeFromInputStream (*in, onlyReadOuterDocumentElement ? 8192 : -1);
-            textToParse = data.toString();
-
-            if (! onlyReadOuterDocumentElement)
-                originalText = textToParse;
-        }
+        elementsFromEntities = &elements;
+        const String text (getDecodedValue());
+        elementsFromEntities = nullptr;
+        return text;
     }
 
-    input = textToParse.getCharPointer();
-    lastError = String::empty;
-    errorOccurred = false;
-    outOfData = false;
-    needToLoadDTD = true;
-
-    if (textToParse.isEmpty())
+    String expandEntity (const String& entity)
     {
-        lastError = "not enough input";
-    }
-    else
-    {
-        skipHeader();
-
-        if (input.getAddress() != nullptr)
-        {
-            ScopedPointer <XmlElement> result (readNextElement (! onlyReadOuterDocumentElement));
+        const String ent (expandExternalEntity (entity));
 
-            if (! errorOccurred)
-                return result.release();
-        }
-        else
+        if (elementsFromEntities != nullptr && ent.startsWithChar ('<') && ent [1] != 0)
         {
-            lastError = "incorrect xml header";
-        }
-    }
-
-    return nullptr;
-}
-
-const String& XmlDocument::getLastParseError() const noexcept
-{
-    return lastError;
-}
-
-void XmlDocument::setLastError (const String& desc, const bool carryOn)
-{
-    lastError = desc;
-    errorOccurred = ! carryOn;
-}
-
-String XmlDocument::getFileContents (const String& filename) const
-{
-    if (inputSource != nullptr)
-    {
-        const ScopedPointer <InputStream> in (inputSource->createInputStreamFor (filename.trim().unquoted()));
-
-        if (in != nullptr)
-            return in->readEntireStreamAsString();
-    }
+            Parser p (owner, ent);
+            p.tokenisedDTD = tokenisedDTD;
+            p.needToLoadDTD = false;
 
-    return String::empty;
-}
-
-juce_wchar XmlDocument::readNextChar() noexcept
-{
-    const juce_wchar c = input.getAndAdvance();
+            while (p.next() == XmlPullParser::startElement)
+                elementsFromEntities->add (owner.readNextElement (p, true));
 
-    if (c == 0)
-    {
-        outOfData = true;
-        --input;
-    }
-
-    return c;
-}
-
-int XmlDocument::findNextTokenLength() noexcept
-{
-    int len = 0;
-    juce_wchar c = *input;
-
-    while (XmlIdentifierChars::isIdentifierChar (c))
-        c = input [++len];
-
-    return len;
-}
-
-void XmlDocument::skipHeader()
-{
-    const int headerStart = input.indexOf (CharPointer_UTF8 ("<?xml"));
+            if (p.getEventType() == XmlPullParser::parseError)
+                setLastError (p.getLastError(), true);
 
-    if (headerStart >= 0)
-    {
-        const int headerEnd = (input + headerStart).indexOf (CharPointer_UTF8 ("?>"));
-        if (headerEnd < 0)
-            return;
-
-       #if JUCE_DEBUG
-        const String header (input + headerStart, (size_t) (headerEnd - headerStart));
-        const String encoding (header.fromFirstOccurrenceOf ("encoding", false, true)
-                                     .fromFirstOccurrenceOf ("=", false, false)
-                                     .fromFirstOccurrenceOf ("\"", false, false)
-                                     .upToFirstOccurrenceOf ("\"", false, false).trim());
-
-        /* If you load an XML document with a non-UTF encoding type, it may have been
-           loaded wrongly.. Since all the files are read via the normal juce file streams,
-           they're treated as UTF-8, so by the time it gets to the parser, the encoding will
-           have been lost. Best plan is to stick to utf-8 or if you have specific files to
-           read, use your own code to convert them to a unicode String, and pass that to the
-           XML parser.
-        */
-        jassert (encoding.isEmpty() || encoding.startsWithIgnoreCase ("utf-"));
-       #endif
-
-        input += headerEnd + 2;
-    }
-
-    skipNextWhiteSpace();
-
-    const int docTypeIndex = input.indexOf (CharPointer_UTF8 ("<!DOCTYPE"));
-    if (docTypeIndex < 0)
-        return;
-
-    input += docTypeIndex + 9;
-    const String::CharPointerType docType (input);
-
-    int n = 1;
-
-    while (n > 0)
-    {
-        const juce_wchar c = readNextChar();
-
-        if (outOfData)
-            return;
+            return String::empty;
+        }
 
-        if (c == '<')
-            ++n;
-        else if (c == '>')
-            --n;
+        return ent;
     }
 
-    dtdText = String (docType, (size_t) (input.getAddress() - (docType.getAddress() + 1))).trim();
-}
+private:
+    XmlDocument& owner;
+    StringArray tokenisedDTD;
+    bool needToLoadDTD;
+    Array<XmlElement*>* elementsFromEntities;
 
-void XmlDocument::skipNextWhiteSpace()
-{
-    for (;;)
+    String getFileContents (const String& filename) const
     {
-        juce_wchar c = *input;
-
-        while (CharacterFunctions::isWhitespace (c))
-            c = *++input;
-
-        if (c == 0)
+        if (owner.inputSource != nullptr)
         {
-            outOfData = true;
-            break;
-        }
-        else if (c == '<')
-        {
-            if (input[1] == '!'
-                 && input[2] == '-'
-                 && input[3] == '-')
-            {
-                input += 4;
-                const int closeComment = input.indexOf (CharPointer_UTF8 ("-->"));
-
-                if (closeComment < 0)
-                {
-                    outOfData = true;
-                    break;
-                }
-
-                input += closeComment + 3;
-                continue;
-            }
-            else if (input[1] == '?')
-            {
-                input += 2;
-                const int closeBracket = input.indexOf (CharPointer_UTF8 ("?>"));
+            const ScopedPointer <InputStream> in (owner.inputSource->createInputStreamFor (filename.trim().unquoted()));
 
-                if (closeBracket < 0)
-                {
-                    outOfData = true;
-                    break;
-                }
-
-                input += closeBracket + 2;
-                continue;
-            }
+            if (in != nullptr)
+                return in->readEntireStreamAsString();
         }
 
-        break;
+        return String::empty;
     }
-}
 
-void XmlDocument::readQuotedString (String& result)
-{
-    const juce_wchar quote = readNextChar();
-
-    while (! outOfData)
+    String expandSubEntity (const String& ent)
     {
-        const juce_wchar c = readNextChar();
-
-        if (c == quote)
-            break;
+        if (ent.equalsIgnoreCase ("amp"))   return String::charToString ('&');
+        if (ent.equalsIgnoreCase ("quot"))  return String::charToString ('"');
+        if (ent.equalsIgnoreCase ("apos"))  return String::charToString ('\'');
+        if (ent.equalsIgnoreCase ("lt"))    return String::charToString ('<');
+        if (ent.equalsIgnoreCase ("gt"))    return String::charToString ('>');
 
-        --input;
-
-        if (c == '&')
+        if (ent[0] == '#')
         {
-            readEntity (result);
-        }
-        else
-        {
-            const String::CharPointerType start (input);
-            size_t numChars = 0;
+            const juce_wchar char1 = ent[1];
 
-            for (;;)
-            {
-                const juce_wchar character = *input;
+            if (char1 == 'x' || char1 == 'X')
+                return String::charToString (static_cast <juce_wchar> (ent.substring (2).getHexValue32()));
 
-                if (character == quote)
-                {
-                    result.appendCharPointer (start, numChars);
-                    ++input;
-                    return;
-                }
-                else if (character == '&')
-                {
-                    result.appendCharPointer (start, numChars);
-                    break;
-                }
-                else if (character == 0)
-                {
-                    outOfData = true;
-                    setLastError ("unmatched quotes", false);
-                    break;
-                }
+            if (char1 >= '0' && char1 <= '9')
+                return String::charToString (static_cast <juce_wchar> (ent.substring (1).getIntValue()));
 
-                ++input;
-                ++numChars;
-            }
+            setLastError ("illegal escape sequence", true);
+            return String::charToString ('&');
         }
-    }
-}
 
-XmlElement* XmlDocument::readNextElement (const bool alsoParseSubElements)
-{
-    XmlElement* node = nullptr;
-
-    skipNextWhiteSpace();
-    if (outOfData)
-        return nullptr;
-
-    const int openBracket = input.indexOf ((juce_wchar) '<');
+        return expandExternalEntity (ent);
+    }
 
-    if (openBracket >= 0)
+    String expandExternalEntity (const String& entity)
     {
-        input += openBracket + 1;
-        int tagLen = findNextTokenLength();
-
-        if (tagLen == 0)
-        {
-            // no tag name - but allow for a gap after the '<' before giving an error
-            skipNextWhiteSpace();
-            tagLen = findNextTokenLength();
-
-            if (tagLen == 0)
-            {
-                setLastError ("tag name missing", false);
-                return node;
-            }
-        }
-
-        node = new XmlElement (String (input, (size_t) tagLen));
-        input += tagLen;
-        LinkedListPointer<XmlElement::XmlAttributeNode>::Appender attributeAppender (node->attributes);
-
-        // look for attributes
-        for (;;)
+        if (needToLoadDTD)
         {
-            skipNextWhiteSpace();
-
-            const juce_wchar c = *input;
+            String dtdText (getDocType());
 
-            // empty tag..
-            if (c == '/' && input[1] == '>')
+            if (dtdText.isNotEmpty())
             {
-                input += 2;
-                break;
-            }
-
-            // parse the guts of the element..
-            if (c == '>')
-            {
-                ++input;
+                dtdText = dtdText.trimCharactersAtEnd (">");
+                tokenisedDTD.addTokens (dtdText, true);
 
-                if (alsoParseSubElements)
-                    readChildElements (node);
-
-                break;
-            }
-
-            // get an attribute..
-            if (XmlIdentifierChars::isIdentifierChar (c))
-            {
-                const int attNameLen = findNextTokenLength();
-
-                if (attNameLen > 0)
+                if (tokenisedDTD [tokenisedDTD.size() - 2].equalsIgnoreCase ("system")
+                     && tokenisedDTD [tokenisedDTD.size() - 1].isQuotedString())
                 {
-                    const String::CharPointerType attNameStart (input);
-                    input += attNameLen;
+                    const String fn (tokenisedDTD [tokenisedDTD.size() - 1]);
 
-                    skipNextWhiteSpace();
+                    tokenisedDTD.clear();
+                    tokenisedDTD.addTokens (getFileContents (fn), true);
+                }
+                else
+                {
+                    tokenisedDTD.clear();
+                    const int openBracket = dtdText.indexOfChar ('[');
 
-                    if (readNextChar() == '=')
+                    if (openBracket > 0)
                     {
-                        skipNextWhiteSpace();
-
-                        const juce_wchar nextChar = *input;
-
-                        if (nextChar == '"' || nextChar == '\'')
-                        {
-                            XmlElement::XmlAttributeNode* const newAtt
-                                = new XmlElement::XmlAttributeNode (String (attNameStart, (size_t) attNameLen),
-                                                                    String::empty);
+                        const int closeBracket = dtdText.lastIndexOfChar (']');
 
-                            readQuotedString (newAtt->value);
-                            attributeAppender.append (newAtt);
-                            continue;
-                        }
+                        if (closeBracket > openBracket)
+                            tokenisedDTD.addTokens (dtdText.substring (openBracket + 1,
+                                                                       closeBracket), true);
                     }
                 }
-            }
-            else
-            {
-                if (! outOfData)
-                    setLastError ("illegal character found in " + node->getTagName() + ": '" + c + "'", false);
-            }
-
-            break;
-        }
-    }
-
-    return node;
-}
-
-void XmlDocument::readChildElements (XmlElement* parent)
-{
-    LinkedListPointer<XmlElement>::Appender childAppender (parent->firstChildElement);
-
-    for (;;)
-    {
-        const String::CharPointerType preWhitespaceInput (input);
-        skipNextWhiteSpace();
-
-        if (outOfData)
-        {
-            setLastError ("unmatched tags", false);
-            break;
-        }
-
-        if (*input == '<')
-        {
-            if (input[1] == '/')
-            {
-                // our close tag..
-                const int closeTag = input.indexOf ((juce_wchar) '>');
-
-                if (closeTag >= 0)
-                    input += closeTag + 1;
 
-                break;
-            }
-            else if (input[1] == '!'
-                  && input[2] == '['
-                  && input[3] == 'C'
-                  && input[4] == 'D'
-                  && input[5] == 'A'
-                  && input[6] == 'T'
-                  && input[7] == 'A'
-                  && input[8] == '[')
-            {
-                input += 9;
-                const String::CharPointerType inputStart (input);
-
-                size_t len = 0;
-
-                for (;;)
+                for (int i = tokenisedDTD.size(); --i >= 0;)
                 {
-                    if (*input == 0)
+                    if (tokenisedDTD[i].startsWithChar ('%')
+                         && tokenisedDTD[i].endsWithChar (';'))
                     {
-                        setLastError ("unterminated CDATA section", false);
-                        outOfData = true;
-                        break;
-                    }
-                    else if (input[0] == ']'
-                              && input[1] == ']'
-                              && input[2] == '>')
-                    {
-                        input += 3;
-                        break;
-                    }
+                        const String parsed (getParameterEntity (tokenisedDTD[i].substring (1, tokenisedDTD[i].length() - 1)));
+                        StringArray newToks;
+                        newToks.addTokens (parsed, true);
 
-                    ++input;
-                    ++len;
-                }
+                        tokenisedDTD.remove (i);
 
-                childAppender.append (XmlElement::createTextElement (String (inputStart, len)));
+                        for (int j = newToks.size(); --j >= 0;)
+                            tokenisedDTD.insert (i, newToks[j]);
+                    }
+                }
             }
-            else
-            {
-                // this is some other element, so parse and add it..
-                XmlElement* const n = readNextElement (true);
 
-                if (n != nullptr)
-                    childAppender.append (n);
-                else
-                    break;
-            }
+            needToLoadDTD = false;
         }
-        else  // must be a character block
-        {
-            input = preWhitespaceInput; // roll back to include the leading whitespace
-            String textElementContent;
 
-            for (;;)
+        for (int i = 0; i < tokenisedDTD.size(); ++i)
+        {
+            if (tokenisedDTD[i] == entity)
             {
-                const juce_wchar c = *input;
-
-                if (c == '<')
-                    break;
-
-                if (c == 0)
+                if (tokenisedDTD[i - 1].equalsIgnoreCase ("<!entity"))
                 {
-                    setLastError ("unmatched tags", false);
-                    outOfData = true;
-                    return;
-                }
+                    String ent (tokenisedDTD [i + 1].trimCharactersAtEnd (">").trim().unquoted());
 
-                if (c == '&')
-                {
-                    String entity;
-                    readEntity (entity);
+                    // check for sub-entities..
+                    int ampersand = ent.indexOfChar ('&');
 
-                    if (entity.startsWithChar ('<') && entity [1] != 0)
+                    while (ampersand >= 0)
                     {
-                        const String::CharPointerType oldInput (input);
-                        const bool oldOutOfData = outOfData;
-
-                        input = entity.getCharPointer();
-                        outOfData = false;
+                        const int semiColon = ent.indexOf (i + 1, ";");
 
-                        for (;;)
+                        if (semiColon < 0)
                         {
-                            XmlElement* const n = readNextElement (true);
-
-                            if (n == nullptr)
-                                break;
-
-                            childAppender.append (n);
+                            setLastError ("entity without terminating semi-colon", true);
+                            break;
                         }
 
-                        input = oldInput;
-                        outOfData = oldOutOfData;
-                    }
-                    else
-                    {
-                        textElementContent += entity;
-                    }
-                }
-                else
-                {
-                    const String::CharPointerType start (input);
-                    size_t len = 0;
-
-                    for (;;)
-                    {
-                        const juce_wchar nextChar = *input;
+                        const String resolved (expandSubEntity (ent.substring (i + 1, semiColon)));
 
-                        if (nextChar == '<' || nextChar == '&')
-                        {
-                            break;
-                        }
-                        else if (nextChar == 0)
-                        {
-                            setLastError ("unmatched tags", false);
-                            outOfData = true;
-                            return;
-                        }
+                        ent = ent.substring (0, ampersand)
+                               + resolved
+                               + ent.substring (semiColon + 1);
 
-                        ++input;
-                        ++len;
+                        ampersand = ent.indexOfChar (semiColon + 1, '&');
                     }
 
-                    textElementContent.appendCharPointer (start, len);
+                    return ent;
                 }
             }
-
-            if ((! ignoreEmptyTextElements) || textElementContent.containsNonWhitespaceChars())
-            {
-                childAppender.append (XmlElement::createTextElement (textElementContent));
-            }
         }
-    }
-}
 
-void XmlDocument::readEntity (String& result)
-{
-    // skip over the ampersand
-    ++input;
+        setLastError ("unknown entity", false);
 
-    if (input.compareIgnoreCaseUpTo (CharPointer_UTF8 ("amp;"), 4) == 0)
-    {
-        input += 4;
-        result += '&';
+        return entity;
     }
-    else if (input.compareIgnoreCaseUpTo (CharPointer_UTF8 ("quot;"), 5) == 0)
-    {
-        input += 5;
-        result += '"';
-    }
-    else if (input.compareIgnoreCaseUpTo (CharPointer_UTF8 ("apos;"), 5) == 0)
-    {
-        input += 5;
-        result += '\'';
-    }
-    else if (input.compareIgnoreCaseUpTo (CharPointer_UTF8 ("lt;"), 3) == 0)
-    {
-        input += 3;
-        result += '<';
-    }
-    else if (input.compareIgnoreCaseUpTo (CharPointer_UTF8 ("gt;"), 3) == 0)
-    {
-        input += 3;
-        result += '>';
-    }
-    else if (*input == '#')
-    {
-        int charCode = 0;
-        ++input;
 
-        if (*input == 'x' || *input == 'X')
+    String getParameterEntity (const String& entity)
+    {
+        for (int i = 0; i < tokenisedDTD.size(); ++i)
         {
-            ++input;
-            int numChars = 0;
-
-            while (input[0] != ';')
+            if (tokenisedDTD[i] == entity
+                 && tokenisedDTD [i - 1] == "%"
+                 && tokenisedDTD [i - 2].equalsIgnoreCase ("<!entity"))
             {
-                const int hexValue = CharacterFunctions::getHexDigitValue (input[0]);
+                const String ent (tokenisedDTD [i + 1].trimCharactersAtEnd (">"));
 
-                if (hexValue < 0 || ++numChars > 8)
-                {
-                    setLastError ("illegal escape sequence", true);
-                    break;
-                }
-
-                charCode = (charCode << 4) | hexValue;
-                ++input;
+                if (ent.equalsIgnoreCase ("system"))
+                    return getFileContents (tokenisedDTD [i + 2].trimCharactersAtEnd (">"));
+                else
+                    return ent.trim().unquoted();
             }
-
-            ++input;
         }
-        else if (input[0] >= '0' && input[0] <= '9')
-        {
-            int numChars = 0;
 
-            while (input[0] != ';')
-            {
-                if (++numChars > 12)
-                {
-                    setLastError ("illegal escape sequence", true);
-                    break;
-                }
+        return entity;
+    }
 
-                charCode = charCode * 10 + ((int) input[0] - '0');
-                ++input;
-            }
+    JUCE_DECLARE_NON_COPYABLE (Parser);
+};
 
-            ++input;
-        }
-        else
-        {
-            setLastError ("illegal escape sequence", true);
-            result += '&';
-            return;
-        }
+//==============================================================================
+XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentElement)
+{
+    ScopedPointer <Parser> parser;
 
-        result << (juce_wchar) charCode;
+    if (originalText.isNotEmpty())
+    {
+        parser = new Parser (*this, originalText);
     }
-    else
+    else if (inputSource != nullptr)
     {
-        const String::CharPointerType entityNameStart (input);
-        const int closingSemiColon = input.indexOf ((juce_wchar) ';');
-
-        if (closingSemiColon < 0)
-        {
-            outOfData = true;
-            result += '&';
-        }
-        else
-        {
-            input += closingSemiColon + 1;
+        InputStream* const in = inputSource->createInputStream();
 
-            result += expandExternalEntity (String (entityNameStart, (size_t) closingSemiColon));
-        }
+        if (in != nullptr)
+            parser = new Parser (*this, in);
     }
-}
 
-String XmlDocument::expandEntity (const String& ent)
-{
-    if (ent.equalsIgnoreCase ("amp"))   return String::charToString ('&');
-    if (ent.equalsIgnoreCase ("quot"))  return String::charToString ('"');
-    if (ent.equalsIgnoreCase ("apos"))  return String::charToString ('\'');
-    if (ent.equalsIgnoreCase ("lt"))    return String::charToString ('<');
-    if (ent.equalsIgnoreCase ("gt"))    return String::charToString ('>');
+    lastError = String::empty;
 
-    if (ent[0] == '#')
+    if (parser == nullptr)
     {
-        const juce_wchar char1 = ent[1];
+        lastError = "not enough input";
+        return nullptr;
+    }
 
-        if (char1 == 'x' || char1 == 'X')
-            return String::charToString (static_cast <juce_wchar> (ent.substring (2).getHexValue32()));
+    ScopedPointer <XmlElement> result;
 
-        if (char1 >= '0' && char1 <= '9')
-            return String::charToString (static_cast <juce_wchar> (ent.substring (1).getIntValue()));
+    if (parser->next() == XmlPullParser::startElement)
+        result = readNextElement (*parser, ! onlyReadOuterDocumentElement);
 
-        setLastError ("illegal escape sequence", false);
-        return String::charToString ('&');
-    }
+    lastError = parser->getLastError();
 
-    return expandExternalEntity (ent);
-}
-
-String XmlDocument::expandExternalEntity (const String& entity)
-{
-    if (needToLoadDTD)
+    if (parser->getEventType() == XmlPullParser::parseError)
     {
-        if (dtdText.isNotEmpty())
-        {
-            dtdText = dtdText.trimCharactersAtEnd (">");
-            tokenisedDTD.addTokens (dtdText, true);
+        // (when only the outer element's wanted, an error in its content doesn't matter)
+        if (! (onlyReadOuterDocumentElement && result != nullptr && parser->hasFinishedStartTag()))
+            return nullptr;
 
-            if (tokenisedDTD [tokenisedDTD.size() - 2].equalsIgnoreCase ("system")
-                 && tokenisedDTD [tokenisedDTD.size() - 1].isQuotedString())
-            {
-                const String fn (tokenisedDTD [tokenisedDTD.size() - 1]);
+        lastError = String::empty;
+    }
 
-                tokenisedDTD.clear();
-                tokenisedDTD.addTokens (getFileContents (fn), true);
-            }
-            else
-            {
-                tokenisedDTD.clear();
-                const int openBracket = dtdText.indexOfChar ('[');
+    if (result == nullptr && lastError.isEmpty())
+        lastError = "not enough input";
 
-                if (openBracket > 0)
-                {
-                    const int closeBracket = dtdText.lastIndexOfChar (']');
+    return result.release();
+}
 
-                    if (closeBracket > openBracket)
-                        tokenisedDTD.addTokens (dtdText.substring (openBracket + 1,
-                                                                   closeBracket), true);
-                }
-            }
+const String& XmlDocument::getLastParseError() const noexcept
+{
+    return lastError;
+}
 
-            for (int i = tokenisedDTD.size(); --i >= 0;)
-            {
-                if (tokenisedDTD[i].startsWithChar ('%')
-                     && tokenisedDTD[i].endsWithChar (';'))
-                {
-                    const String parsed (getParameterEntity (tokenisedDTD[i].substring (1, tokenisedDTD[i].length() - 1)));
-                    StringArray newToks;
-                    newToks.addTokens (parsed, true);
+// (this is called when the parser has just returned a startElement event)
+XmlElement* XmlDocument::readNextElement (Parser& parser, const bool alsoParseSubElements)
+{
+    XmlElement* const node = new XmlElement (parser.getName().toString());
+    LinkedListPointer<XmlElement::XmlAttributeNode>::Appender attributeAppender (node->attributes);
 
-                    tokenisedDTD.remove (i);
+    while (parser.next() == XmlPullParser::attribute)
+        attributeAppender.append (new XmlElement::XmlAttributeNode (parser.getName().toString(),
+                                                                    parser.getDecodedValue()));
 
-                    for (int j = newToks.size(); --j >= 0;)
-                        tokenisedDTD.insert (i, newToks[j]);
-                }
-            }
-        }
+    if (alsoParseSubElements)
+        readChildElements (parser, node);
 
-        needToLoadDTD = false;
-    }
+    return node;
+}
 
-    for (int i = 0; i < tokenisedDTD.size(); ++i)
+void XmlDocument::readChildElements (Parser& parser, XmlElement* parent)
+{
+    LinkedListPointer<XmlElement>::Appender childAppender (parent->firstChildElement);
+
+    for (XmlPullParser::EventType e = parser.getEventType();; e = parser.next())
     {
-        if (tokenisedDTD[i] == entity)
+        if (e == XmlPullParser::startElement)
         {
-            if (tokenisedDTD[i - 1].equalsIgnoreCase ("<!entity"))
+            childAppender.append (readNextElement (parser, true));
+        }
+        else if (e == XmlPullParser::text)
+        {
+            if (parser.isCData())
             {
-                String ent (tokenisedDTD [i + 1].trimCharactersAtEnd (">").trim().unquoted());
-
-                // check for sub-entities..
-                int ampersand = ent.indexOfChar ('&');
-
-                while (ampersand >= 0)
-                {
-                    const int semiColon = ent.indexOf (i + 1, ";");
-
-                    if (semiColon < 0)
-                    {
-                        setLastError ("entity without terminating semi-colon", false);
-                        break;
-                    }
-
-                    const String resolved (expandEntity (ent.substring (i + 1, semiColon)));
-
-                    ent = ent.substring (0, ampersand)
-                           + resolved
-                           + ent.substring (semiColon + 1);
+                childAppender.append (XmlElement::createTextElement (parser.getValue().toString()));
+            }
+            else
+            {
+                Array<XmlElement*> elementsFromEntities;
+                const String textElementContent (parser.getText (elementsFromEntities));
 
-                    ampersand = ent.indexOfChar (semiColon + 1, '&');
-                }
+                for (int i = 0; i < elementsFromEntities.size(); ++i)
+                    childAppender.append (elementsFromEntities.getUnchecked (i));
 
-                return ent;
+                if ((! ignoreEmptyTextElements) || textElementContent.containsNonWhitespaceChars())
+                    childAppender.append (XmlElement::createTextElement (textElementContent));
             }
         }
-    }
-
-    setLastError ("unknown entity", true);
-
-    return entity;
-}
-
-String XmlDocument::getParameterEntity (const String& entity)
-{
-    for (int i = 0; i < tokenisedDTD.size(); ++i)
-    {
-        if (tokenisedDTD[i] == entity
-             && tokenisedDTD [i - 1] == "%"
-             && tokenisedDTD [i - 2].equalsIgnoreCase ("<!entity"))
+        else
         {
-            const String ent (tokenisedDTD [i + 1].trimCharactersAtEnd (">"));
-
-            if (ent.equalsIgnoreCase ("system"))
-                return getFileContents (tokenisedDTD [i + 2].trimCharactersAtEnd (">"));
-            else
-                return ent.trim().unquoted();
+            break; // (the end of this element, or an error)
         }
     }
-
-    return entity;
 }
@@ -27,6 +27,7 @@
 #define __JUCE_XMLDOCUMENT_JUCEHEADER__
 
 #include "juce_XmlElement.h"
+#include "juce_XmlPullParser.h"
 #include "../text/juce_StringArray.h"
 #include "../files/juce_File.h"
 #include "../memory/juce_ScopedPointer.h"
@@ -37,6 +38,10 @@ class InputSource;
 /**
     Parses a text-based XML document and creates an XmlElement object from it.
 
+    Documents are read with an XmlPullParser, so a file is read in chunks rather
+    than being loaded into memory in one go. If you don't need a whole tree of
+    XmlElement objects, you can use an XmlPullParser directly.
+
     The parser will parse DTDs to load external entities but won't
     check the document for validity against the DTD.
 
@@ -67,7 +72,7 @@ class InputSource;
         ...etc
     @endcode
 
-    @see XmlElement
+    @see XmlElement, XmlPullParser
 */
 class JUCE_API  XmlDocument
 {
@@ -153,28 +158,15 @@ public:
     //==============================================================================
 private:
     String originalText;
-    String::CharPointerType input;
-    bool outOfData, errorOccurred;
-
-    String lastError, dtdText;
-    StringArray tokenisedDTD;
-    bool needToLoadDTD, ignoreEmptyTextElements;
+    String lastError;
+    bool ignoreEmptyTextElements;
     ScopedPointer <InputSource> inputSource;
 
-    void setLastError (const String& desc, bool carryOn);
-    void skipHeader();
-    void skipNextWhiteSpace();
-    juce_wchar readNextChar() noexcept;
-    XmlElement* readNextElement (bool alsoParseSubElements);
-    void readChildElements (XmlElement* parent);
-    int findNextTokenLength() noexcept;
-    void readQuotedString (String& result);
-    void readEntity (String& result);
-
-    String getFileContents (const String& filename) const;
-    String expandEntity (const String& entity);
-    String expandExternalEntity (const String& entity);
-    String getParameterEntity (const String& entity);
+    class Parser;
+    friend class Parser;
+
+    XmlElement* readNextElement (Parser&, bool alsoParseSubElements);
+    void readChildElements (Parser&, XmlElement* parent);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XmlDocument);
 };
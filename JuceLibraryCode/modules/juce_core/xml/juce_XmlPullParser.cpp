@@ -0,0 +1,834 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+namespace XmlIdentifierChars
+{
+    static bool isIdentifierCharSlow (const juce_wchar c) noexcept
+    {
+        return CharacterFunctions::isLetterOrDigit (c)
+                 || c == '_' || c == '-' || c == ':' || c == '.';
+    }
+
+    static bool isIdentifierChar (const juce_wchar c) noexcept
+    {
+        static const uint32 legalChars[] = { 0, 0x7ff6000, 0x87fffffe, 0x7fffffe, 0 };
+
+        return ((int) c < (int) numElementsInArray (legalChars) * 32) ? ((legalChars [c >> 5] & (1 << (c & 31))) != 0)
+                                                                      : isIdentifierCharSlow (c);
+    }
+
+    /*static void generateIdentifierCharConstants()
+    {
+        uint32 n[8] = { 0 };
+        for (int i = 0; i < 256; ++i)
+            if (isIdentifierCharSlow (i))
+                n[i >> 5] |= (1 << (i & 31));
+
+        String s;
+        for (int i = 0; i < 8; ++i)
+            s << "0x" << String::toHexString ((int) n[i]) << ", ";
+
+        DBG (s);
+    }*/
+
+    static bool isIdentifierByte (const char c) noexcept
+    {
+        // (all the bytes of a multi-byte UTF-8 character are treated as part of the identifier)
+        return (c & 0x80) != 0 || isIdentifierChar ((juce_wchar) c);
+    }
+}
+
+//==============================================================================
+String XmlPullParser::Chars::toString() const
+{
+    return numBytes > 0 ? String (CharPointer_UTF8 (start), CharPointer_UTF8 (start + numBytes))
+                        : String::empty;
+}
+
+bool XmlPullParser::Chars::operator== (const char* const other) const noexcept
+{
+    return strncmp (start, other, numBytes) == 0 && other [numBytes] == 0;
+}
+
+//==============================================================================
+XmlPullParser::XmlPullParser (const void* const utf8Data, const size_t numBytes)
+    : data (static_cast <const char*> (utf8Data)),
+      position (0), dataEnd (utf8Data != nullptr ? numBytes : 0), eventStart (0), bufferSize (0)
+{
+    initialise();
+}
+
+XmlPullParser::XmlPullParser (const MemoryMappedFile& file)
+    : data (static_cast <const char*> (file.getData())),
+      position (0), dataEnd (file.getData() != nullptr ? file.getSize() : 0), eventStart (0), bufferSize (0)
+{
+    initialise();
+}
+
+XmlPullParser::XmlPullParser (InputStream* const sourceStream, const bool deleteStreamWhenDone,
+                              const int bufferSizeToUse)
+    : data (nullptr),
+      position (0), dataEnd (0), eventStart (0),
+      bufferSize ((size_t) jmax (256, bufferSizeToUse)),
+      stream (sourceStream, deleteStreamWhenDone)
+{
+    jassert (sourceStream != nullptr);
+
+    buffer.malloc (bufferSize);
+    data = buffer;
+    initialise();
+}
+
+XmlPullParser::~XmlPullParser()
+{
+}
+
+void XmlPullParser::initialise()
+{
+    state = readingProlog;
+    currentEvent = endOfDocument;
+    depth = 0;
+    nameStart = nameLength = valueStart = valueLength = elementNameStart = elementNameLength = 0;
+    currentIsCData = valueHasEntities = errorOccurred = startTagFinished = false;
+
+    ensureAvailable (3);
+    const size_t numAvailable = dataEnd - position;
+    const uint8* const d = reinterpret_cast <const uint8*> (data + position);
+
+    if (numAvailable >= 2 && ((d[0] == 0xff && d[1] == 0xfe) || (d[0] == 0xfe && d[1] == 0xff)))
+    {
+        // UTF-16 data has to be converted before it can be parsed..
+        MemoryOutputStream utf16;
+        utf16.write (d, numAvailable);
+
+        if (stream != nullptr)
+            utf16.writeFromInputStream (*stream, -1);
+
+        stream.clear();
+        buffer.free();
+
+        convertedText = String::createStringFromData (utf16.getData(), (int) utf16.getDataSize());
+        data = convertedText.toUTF8().getAddress();
+        position = 0;
+        dataEnd = (size_t) convertedText.getNumBytesAsUTF8();
+    }
+    else if (numAvailable >= 3 && d[0] == 0xef && d[1] == 0xbb && d[2] == 0xbf)
+    {
+        position += 3;  // skip a UTF-8 byte-order-mark
+    }
+
+    eventStart = position;
+}
+
+//==============================================================================
+bool XmlPullParser::readMoreData()
+{
+    if (stream == nullptr)
+        return false;
+
+    if (eventStart > 0)
+    {
+        // discard everything before the start of the current event..
+        const size_t numToKeep = dataEnd - eventStart;
+        memmove (buffer, buffer + eventStart, numToKeep);
+
+        position -= eventStart;
+        nameStart -= eventStart;
+        valueStart -= eventStart;
+        elementNameStart -= eventStart;
+        dataEnd = numToKeep;
+        eventStart = 0;
+    }
+
+    if (dataEnd == bufferSize)
+    {
+        // ..and if the event still doesn't fit, make the buffer bigger
+        bufferSize *= 2;
+        buffer.realloc (bufferSize);
+        data = buffer;
+    }
+
+    const int numRead = stream->read (buffer + dataEnd, (int) (bufferSize - dataEnd));
+
+    if (numRead <= 0)
+        return false;
+
+    dataEnd += (size_t) numRead;
+    return true;
+}
+
+bool XmlPullParser::ensureAvailable (const size_t numBytes)
+{
+    while (dataEnd - position < numBytes)
+        if (! readMoreData())
+            return false;
+
+    return true;
+}
+
+bool XmlPullParser::matches (const char* const text)
+{
+    const size_t len = strlen (text);
+    return ensureAvailable (len) && memcmp (data + position, text, len) == 0;
+}
+
+bool XmlPullParser::skipPast (const char* const terminator)
+{
+    const size_t len = strlen (terminator);
+
+    for (;;)
+    {
+        if (! ensureAvailable (len))
+        {
+            position = dataEnd;
+            return false;
+        }
+
+        const char* const start = data + position;
+        const char* const found = static_cast <const char*> (memchr (start, terminator[0], dataEnd - position - (len - 1)));
+
+        if (found == nullptr)
+        {
+            // (keep the last few bytes, in case they're the start of the terminator)
+            position = dataEnd - (len - 1);
+
+            if (! readMoreData())
+            {
+                position = dataEnd;
+                return false;
+            }
+        }
+        else if (memcmp (found, terminator, len) == 0)
+        {
+            position += (size_t) (found - start) + len;
+            return true;
+        }
+        else
+        {
+            position += (size_t) (found - start) + 1;
+        }
+    }
+}
+
+void XmlPullParser::skipWhitespace()
+{
+    for (;;)
+    {
+        while (position < dataEnd && CharacterFunctions::isWhitespace (data [position]))
+            ++position;
+
+        if (position < dataEnd || ! readMoreData())
+            break;
+    }
+}
+
+bool XmlPullParser::skipCommentOrProcessingInstruction()
+{
+    if (matches ("<!--"))
+    {
+        position += 4;
+        skipPast ("-->");
+        return true;
+    }
+
+    if (matches ("<?"))
+    {
+       #if JUCE_DEBUG
+        if (matches ("<?xml") && skipPast ("?>"))
+        {
+            const String header (CharPointer_UTF8 (data + eventStart), CharPointer_UTF8 (data + position));
+            const String encoding (header.fromFirstOccurrenceOf ("encoding", false, true)
+                                         .fromFirstOccurrenceOf ("=", false, false)
+                                         .fromFirstOccurrenceOf ("\"", false, false)
+                                         .upToFirstOccurrenceOf ("\"", false, false).trim());
+
+            /* If you load an XML document with a non-UTF encoding type, it may have been
+               loaded wrongly.. Since all the files are read via the normal juce file streams,
+               they're treated as UTF-8, so by the time it gets to the parser, the encoding will
+               have been lost. Best plan is to stick to utf-8 or if you have specific files to
+               read, use your own code to convert them to a unicode String, and pass that to the
+               XML parser.
+            */
+            jassert (encoding.isEmpty() || encoding.startsWithIgnoreCase ("utf-"));
+            return true;
+        }
+       #endif
+
+        position += 2;
+        skipPast ("?>");
+        return true;
+    }
+
+    return false;
+}
+
+size_t XmlPullParser::readName()
+{
+    // (this is stored relative to the event start, because reading more data may move things)
+    const size_t offset = position - eventStart;
+
+    for (;;)
+    {
+        while (position < dataEnd && XmlIdentifierChars::isIdentifierByte (data [position]))
+            ++position;
+
+        if (position < dataEnd || ! readMoreData())
+            break;
+    }
+
+    return position - (eventStart + offset);
+}
+
+//==============================================================================
+XmlPullParser::EventType XmlPullParser::next()
+{
+    if (errorOccurred)
+    {
+        state = finished;
+        return setEvent (parseError);
+    }
+
+    if (state == finished)
+        return currentEvent;
+
+    // While reading a start tag, the element's name is kept for when an empty tag
+    // has to return its endElement event. Otherwise, nothing before here is needed.
+    if (state != readingStartTag)
+        eventStart = position;
+
+    if (state == readingStartTag)
+        return readAttribute();
+
+    if (state == readingContent)
+        return readContent();
+
+    for (;;)
+    {
+        skipWhitespace();
+
+        if (! ensureAvailable (1))
+        {
+            state = finished;
+            return setEvent (endOfDocument);
+        }
+
+        if (data [position] == '<')
+        {
+            if (skipCommentOrProcessingInstruction())
+            {
+                eventStart = position;
+                continue;
+            }
+
+            if (matches ("<!DOCTYPE"))
+            {
+                readDocType();
+                continue;
+            }
+
+            return readStartOfElement();
+        }
+
+        // skip any junk before the first element
+        eventStart = ++position;
+    }
+}
+
+XmlPullParser::EventType XmlPullParser::setEvent (const EventType newEvent)
+{
+    return currentEvent = newEvent;
+}
+
+XmlPullParser::EventType XmlPullParser::fail (const String& error)
+{
+    setLastError (error, true);
+    state = finished;
+    return setEvent (parseError);
+}
+
+void XmlPullParser::setLastError (const String& description, const bool isFatal)
+{
+    lastError = description;
+
+    if (isFatal)
+        errorOccurred = true;
+}
+
+void XmlPullParser::readDocType()
+{
+    position += 9;
+    eventStart = position;
+    int n = 1;
+
+    while (n > 0)
+    {
+        if (! ensureAvailable (1))
+            return;
+
+        const char c = data [position++];
+
+        if (c == '<')
+            ++n;
+        else if (c == '>')
+            --n;
+    }
+
+    docType = String (CharPointer_UTF8 (data + eventStart), CharPointer_UTF8 (data + position - 1)).trim();
+    eventStart = position;
+}
+
+XmlPullParser::EventType XmlPullParser::readStartOfElement()
+{
+    ++position;
+    size_t len = readName();
+
+    if (len == 0)
+    {
+        // no tag name - but allow for a gap after the '<' before giving an error
+        skipWhitespace();
+        len = readName();
+
+        if (len == 0)
+            return fail ("tag name missing");
+    }
+
+    elementNameStart = nameStart = position - len;
+    elementNameLength = nameLength = len;
+    eventStart = elementNameStart;
+
+    ++depth;
+    state = readingStartTag;
+    startTagFinished = false;
+    return setEvent (startElement);
+}
+
+XmlPullParser::EventType XmlPullParser::readEndOfElement()
+{
+    --depth;
+    state = depth > 0 ? readingContent : readingProlog;
+    return setEvent (endElement);
+}
+
+XmlPullParser::EventType XmlPullParser::readAttribute()
+{
+    skipWhitespace();
+
+    if (! ensureAvailable (1))
+        return fail ("unmatched tags");
+
+    const char c = data [position];
+
+    // empty tag..
+    if (c == '/' && matches ("/>"))
+    {
+        position += 2;
+        startTagFinished = true;
+        nameStart = elementNameStart;
+        nameLength = elementNameLength;
+        return readEndOfElement();
+    }
+
+    // the start of the element's content..
+    if (c == '>')
+    {
+        eventStart = ++position;
+        state = readingContent;
+        startTagFinished = true;
+        return readContent();
+    }
+
+    // an attribute..
+    const size_t len = readName();
+
+    if (len > 0)
+    {
+        nameStart = position - len;
+        nameLength = len;
+        skipWhitespace();
+
+        if (ensureAvailable (1) && data [position] == '=')
+        {
+            ++position;
+            skipWhitespace();
+
+            if (ensureAvailable (1) && (data [position] == '"' || data [position] == '\''))
+            {
+                const char quote = data [position++];
+                valueStart = position;
+                valueHasEntities = false;
+
+                for (;;)
+                {
+                    if (position == dataEnd && ! readMoreData())
+                        return fail ("unmatched quotes");
+
+                    const char ch = data [position];
+
+                    if (ch == quote)
+                        break;
+
+                    if (ch == '&')
+                        valueHasEntities = true;
+
+                    ++position;
+                }
+
+                valueLength = position++ - valueStart;
+                currentIsCData = false;
+                return setEvent (attribute);
+            }
+        }
+    }
+
+    return fail ("illegal character found in "
+                  + Chars (data + elementNameStart, elementNameLength).toString() + ": '"
+                  + (ensureAvailable (1) ? String::charToString ((juce_wchar) (uint8) data [position]) : String::empty) + "'");
+}
+
+XmlPullParser::EventType XmlPullParser::readContent()
+{
+    for (;;)
+    {
+        eventStart = position;
+        skipWhitespace();
+
+        if (! ensureAvailable (1))
+            return fail ("unmatched tags");
+
+        if (data [position] != '<')
+        {
+            // a block of text, including any whitespace before it..
+            position = valueStart = eventStart;
+            valueHasEntities = false;
+
+            for (;;)
+            {
+                const char* p = data + position;
+                const char* const end = data + dataEnd;
+
+                while (p < end && *p != '<')
+                    valueHasEntities = (*p++ == '&') || valueHasEntities;
+
+                position = (size_t) (p - data);
+
+                if (p < end)
+                    break;
+
+                if (! readMoreData())
+                    return fail ("unmatched tags");
+            }
+
+            valueLength = position - valueStart;
+            currentIsCData = false;
+            return setEvent (text);
+        }
+
+        if (skipCommentOrProcessingInstruction())
+            continue;
+
+        if (matches ("</"))
+        {
+            // the end of the current element..
+            position += 2;
+            skipWhitespace();
+            const size_t len = readName();
+            nameStart = position - len;
+            nameLength = len;
+
+            if (! skipPast (">"))
+                return fail ("unmatched tags");
+
+            return readEndOfElement();
+        }
+
+        if (matches ("<![CDATA["))
+        {
+            position += 9;
+            valueStart = position;
+
+            if (! skipPast ("]]>"))
+                return fail ("unterminated CDATA section");
+
+            valueLength = position - 3 - valueStart;
+            valueHasEntities = false;
+            currentIsCData = true;
+            return setEvent (text);
+        }
+
+        return readStartOfElement();
+    }
+}
+
+//==============================================================================
+XmlPullParser::Chars XmlPullParser::getName() const noexcept
+{
+    if (currentEvent == startElement || currentEvent == attribute || currentEvent == endElement)
+        return Chars (data + nameStart, nameLength);
+
+    return Chars();
+}
+
+XmlPullParser::Chars XmlPullParser::getValue() const noexcept
+{
+    if (currentEvent == attribute || currentEvent == text)
+        return Chars (data + valueStart, valueLength);
+
+    return Chars();
+}
+
+String XmlPullParser::getDecodedValue()
+{
+    const Chars value (getValue());
+
+    if (! valueHasEntities)
+        return value.toString();
+
+    String result;
+    const char* t = data + valueStart;
+    const char* const end = t + valueLength;
+
+    while (t < end)
+    {
+        if (*t == '&')
+        {
+            readEntity (t, end, result);
+        }
+        else
+        {
+            const char* const start = t;
+
+            while (t < end && *t != '&')
+                ++t;
+
+            result.appendCharPointer (CharPointer_UTF8 (start), CharPointer_UTF8 (start).lengthUpTo (CharPointer_UTF8 (t)));
+        }
+    }
+
+    return result;
+}
+
+namespace XmlEntityHelpers
+{
+    static bool isEntity (const char* const name, const size_t length, const char* const entityName) noexcept
+    {
+        return length == strlen (entityName)
+                && CharPointer_UTF8 (name).compareIgnoreCaseUpTo (CharPointer_ASCII (entityName), (int) length) == 0;
+    }
+}
+
+void XmlPullParser::readEntity (const char*& t, const char* const end, String& result)
+{
+    // skip over the ampersand
+    const char* const name = ++t;
+
+    while (t < end && *t != ';')
+        ++t;
+
+    if (t == end)
+    {
+        // (a bare ampersand isn't allowed)
+        setLastError ("unterminated entity", true);
+        t = name;
+        result += '&';
+        return;
+    }
+
+    const size_t length = (size_t) (t++ - name);
+
+    if      (XmlEntityHelpers::isEntity (name, length, "amp"))   result += '&';
+    else if (XmlEntityHelpers::isEntity (name, length, "quot"))  result += '"';
+    else if (XmlEntityHelpers::isEntity (name, length, "apos"))  result += '\'';
+    else if (XmlEntityHelpers::isEntity (name, length, "lt"))    result += '<';
+    else if (XmlEntityHelpers::isEntity (name, length, "gt"))    result += '>';
+    else if (length > 1 && *name == '#')
+    {
+        const bool isHex = (name[1] == 'x' || name[1] == 'X');
+        const char* digit = name + (isHex ? 2 : 1);
+        const size_t numDigits = (size_t) ((name + length) - digit);
+        uint32 charCode = 0;
+        bool isValid = numDigits > 0 && numDigits <= (isHex ? 8u : 12u);
+
+        for (; isValid && digit < name + length; ++digit)
+        {
+            const int value = isHex ? CharacterFunctions::getHexDigitValue ((juce_wchar) *digit)
+                                    : ((*digit >= '0' && *digit <= '9') ? (*digit - '0') : -1);
+
+            if (value < 0)
+                isValid = false;
+            else
+                charCode = charCode * (isHex ? 16 : 10) + (uint32) value;
+        }
+
+        if (isValid)
+        {
+            result << (juce_wchar) charCode;
+        }
+        else
+        {
+            setLastError ("illegal escape sequence", false);
+            result += Chars (name - 1, length + 2).toString();
+        }
+    }
+    else
+    {
+        result += expandEntity (Chars (name, length).toString());
+    }
+}
+
+String XmlPullParser::expandEntity (const String& entityName)
+{
+    setLastError ("unknown entity", false);
+    return entityName;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class XmlPullParserTests  : public UnitTest
+{
+public:
+    XmlPullParserTests() : UnitTest ("XmlPullParser") {}
+
+    static String describeEvents (XmlPullParser& parser)
+    {
+        String s;
+
+        for (;;)
+        {
+            switch (parser.next())
+            {
+                case XmlPullParser::startElement:   s << '<' << parser.getName().toString() << '>'; break;
+                case XmlPullParser::attribute:      s << parser.getName().toString() << '=' << parser.getDecodedValue() << ' '; break;
+                case XmlPullParser::text:           s << '[' << parser.getDecodedValue() << ']'; break;
+                case XmlPullParser::endElement:     s << "</" << parser.getName().toString() << '>'; break;
+                case XmlPullParser::parseError:     return s + "error: " + parser.getLastError();
+                default:                            return s;
+            }
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Events");
+
+        const String doc ("<?xml version=\"1.0\"?>\n<!-- comment -->\n"
+                          "<A x=\"1\" y='&lt;2&gt;'>\n  <B/> text &amp; more <!-- c --><![CDATA[<raw>]]>"
+                          "<C z=\"&#65;&#x42;\">  </C></A>");
+
+        const String expected ("<A>x=1 y=<2> <B></B>[ text & more ][<raw>]<C>z=AB </C></A>");
+
+        {
+            XmlPullParser parser (doc.toUTF8().getAddress(), (size_t) doc.getNumBytesAsUTF8());
+            expectEquals (describeEvents (parser), expected);
+        }
+
+        beginTest ("Streaming");
+
+        {
+            // with the smallest buffer, lots of tokens will be split across reads
+            String longDoc ("<ROOT>");
+
+            for (int i = 0; i < 200; ++i)
+                longDoc << "<ITEM name=\"item " << i << "\" value=\"" << String::repeatedString ("x", i) << "\">"
+                        << "text &amp; " << i << "</ITEM>";
+
+            longDoc << "</ROOT>";
+
+            XmlPullParser memoryParser (longDoc.toUTF8().getAddress(), (size_t) longDoc.getNumBytesAsUTF8());
+            XmlPullParser streamParser (new MemoryInputStream (longDoc.toUTF8().getAddress(), (size_t) longDoc.getNumBytesAsUTF8(), false), true, 0);
+
+            const String memoryEvents (describeEvents (memoryParser));
+            expect (memoryEvents.endsWith ("</ROOT>"));
+            expectEquals (describeEvents (streamParser), memoryEvents);
+        }
+
+        beginTest ("Errors");
+
+        {
+            const char* const badDocs[] = { "<A><B></A", "<A x=\"1></A>", "<A x=1></A>", "<A><![CDATA[x</A>", "<A>&amp</A>" };
+
+            for (int i = 0; i < numElementsInArray (badDocs); ++i)
+            {
+                XmlPullParser parser (badDocs[i], strlen (badDocs[i]));
+                expect (describeEvents (parser).contains ("error"));
+                expect (parser.next() == XmlPullParser::parseError);
+            }
+        }
+
+        beginTest ("XmlDocument");
+
+        {
+            XmlElement root ("ROOT");
+            root.setAttribute ("name", "quotes \" & < > '");
+
+            for (int i = 0; i < 10; ++i)
+            {
+                XmlElement* const child = root.createNewChildElement ("CHILD");
+                child->setAttribute ("index", i);
+                child->addTextElement ("text " + String (i) + " & " + String (CharPointer_UTF8 ("\xc3\xa9")));
+            }
+
+            const String text (root.createDocument (String::empty));
+            ScopedPointer<XmlElement> parsed (XmlDocument::parse (text));
+            expect (parsed != nullptr && parsed->isEquivalentTo (&root, false));
+
+            MemoryOutputStream utf16;
+            utf16.writeByte ((char) 0xff);
+            utf16.writeByte ((char) 0xfe);
+            utf16.write (text.toUTF16().getAddress(), (size_t) text.length() * 2);
+            const String utf16Text (String::createStringFromData (utf16.getData(), (int) utf16.getDataSize()));
+            parsed = XmlDocument::parse (utf16Text);
+            expect (parsed != nullptr && parsed->isEquivalentTo (&root, false));
+
+            XmlDocument doc ("<!DOCTYPE X [ <!ENTITY greeting \"hello\"> <!ENTITY sub \"<IN a='1'/>\"> ]>"
+                             "<X a=\"&greeting;\">&greeting; &sub;</X>");
+            parsed = doc.getDocumentElement();
+            expect (parsed != nullptr);
+
+            if (parsed != nullptr)
+            {
+                expectEquals (parsed->getStringAttribute ("a"), String ("hello"));
+                expect (parsed->getChildByName ("IN") != nullptr);
+                expectEquals (parsed->getAllSubText(), String ("hello "));
+            }
+
+            // when only the outer element's wanted, it doesn't matter what comes after its start tag..
+            XmlDocument unfinished ("<A x=\"1\">");
+            expect (unfinished.getDocumentElement() == nullptr);
+            parsed = unfinished.getDocumentElement (true);
+            expect (parsed != nullptr && parsed->hasTagName ("A") && parsed->getIntAttribute ("x") == 1);
+            expect (unfinished.getLastParseError().isEmpty());
+
+            expect (XmlDocument ("<A x=\"1").getDocumentElement (true) == nullptr);
+            expect (XmlDocument ("<A x=\"&amp\">").getDocumentElement (true) == nullptr);
+            expect (XmlDocument ("<A>&amp</A>").getDocumentElement() == nullptr);
+        }
+    }
+};
+
+static XmlPullParserTests xmlPullParserTests;
+
+#endif
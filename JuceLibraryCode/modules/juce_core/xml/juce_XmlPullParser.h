@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_XMLPULLPARSER_JUCEHEADER__
+#define __JUCE_XMLPULLPARSER_JUCEHEADER__
+
+#include "../text/juce_String.h"
+#include "../memory/juce_HeapBlock.h"
+#include "../memory/juce_OptionalScopedPointer.h"
+#include "../streams/juce_InputStream.h"
+class MemoryMappedFile;
+
+
+//==============================================================================
+/**
+    A low-level XML parser which reads a document one piece at a time.
+
+    Rather than building a tree of XmlElement objects, this reports the contents of
+    the document as a sequence of events - the start of an element, each of its
+    attributes, any text it contains, and the end of the element. The names and values
+    that it returns refer directly to the parser's source data, so nothing needs to be
+    copied unless you ask for it as a String.
+
+    It can read from a block of memory (e.g. a MemoryMappedFile), in which case it never
+    copies the data at all, or from an InputStream, which it reads in chunks, so that
+    the whole document never needs to be held in memory at once.
+
+    e.g.
+    @code
+    XmlPullParser parser (myInputStream);
+
+    for (;;)
+    {
+        const XmlPullParser::EventType e = parser.next();
+
+        if (e == XmlPullParser::startElement && parser.getName() == "ITEM")
+            ..etc
+
+        if (e == XmlPullParser::endOfDocument || e == XmlPullParser::parseError)
+            break;
+    }
+    @endcode
+
+    The data is expected to be UTF-8 (a UTF-16 stream that starts with a byte-order-mark
+    will be converted first). Comments, processing instructions and whitespace that's
+    directly followed by a tag are skipped. The parser doesn't check that end tags match
+    their start tags, and if the data contains more than one top-level element, they'll
+    be reported one after the other.
+
+    This is what XmlDocument uses internally to build its XmlElement trees.
+
+    @see XmlDocument
+*/
+class JUCE_API  XmlPullParser
+{
+public:
+    //==============================================================================
+    /** Creates a parser that reads a block of memory.
+        The data isn't copied, so it must remain valid while the parser is in use.
+    */
+    XmlPullParser (const void* utf8Data, size_t numBytes);
+
+    /** Creates a parser that reads the contents of a memory-mapped file.
+        The MemoryMappedFile must remain valid while the parser is in use.
+    */
+    explicit XmlPullParser (const MemoryMappedFile& file);
+
+    /** Creates a parser that reads from a stream.
+
+        The stream is read in chunks of the given size, and the parser's buffer will only
+        grow beyond this if it finds a single tag or block of text that won't fit into it.
+
+        @param sourceStream         the stream to read - if deleteStreamWhenDone is false,
+                                    this must remain valid while the parser is in use
+        @param deleteStreamWhenDone whether the parser should delete the stream
+        @param bufferSizeToUse      the number of bytes to read at a time
+    */
+    XmlPullParser (InputStream* sourceStream, bool deleteStreamWhenDone,
+                   int bufferSizeToUse = 65536);
+
+    /** Destructor. */
+    virtual ~XmlPullParser();
+
+    //==============================================================================
+    /** The types of event that next() can return. */
+    enum EventType
+    {
+        startElement,   /**< The start of an element: getName() is the tag name. If the element has any
+                             attributes, these will be the next events. */
+        attribute,      /**< An attribute of the element that was just started: getName() and getValue()
+                             are the attribute's name and value. */
+        text,           /**< A block of text (or a CDATA section) inside an element. */
+        endElement,     /**< The end of an element: getName() is the tag name. An empty tag like
+                             <TAG/> produces a startElement followed immediately by an endElement. */
+        endOfDocument,  /**< There's nothing more to read. */
+        parseError      /**< The document was malformed - getLastError() will describe the problem. */
+    };
+
+    /** Reads the next event from the document.
+
+        Once this has returned endOfDocument or parseError, it'll keep doing so.
+        Calling this invalidates any Chars objects that were returned for the last event.
+    */
+    EventType next();
+
+    /** Returns the event that was last returned by next(). */
+    EventType getEventType() const noexcept             { return currentEvent; }
+
+    /** Returns true if the parser has read the whole of the last start tag that it found.
+        Once an element's attributes have been returned, this tells you whether a parseError
+        that follows them was found in the start tag itself, or in the element's content.
+    */
+    bool hasFinishedStartTag() const noexcept           { return startTagFinished; }
+
+    /** Returns the nesting depth of the current event.
+        This is 1 for the outer element and its attributes and text, and so on.
+    */
+    int getDepth() const noexcept                       { return depth; }
+
+    //==============================================================================
+    /**
+        A range of UTF-8 characters inside the parser's source data.
+
+        These are only valid until the parser's next() method is called.
+    */
+    class JUCE_API  Chars
+    {
+    public:
+        Chars() noexcept : start (nullptr), numBytes (0)    {}
+        Chars (const char* start_, size_t numBytes_) noexcept : start (start_), numBytes (numBytes_) {}
+
+        /** Returns a pointer to the first character. The text is not null-terminated! */
+        CharPointer_UTF8 getCharPointer() const noexcept    { return CharPointer_UTF8 (start); }
+        /** Returns the number of bytes in the range. */
+        size_t getNumBytes() const noexcept                 { return numBytes; }
+        /** Returns true if the range is empty. */
+        bool isEmpty() const noexcept                       { return numBytes == 0; }
+
+        /** Returns a copy of the text as a String. */
+        String toString() const;
+
+        /** Compares the text with a null-terminated ASCII or UTF-8 string. */
+        bool operator== (const char* other) const noexcept;
+        /** Compares the text with a null-terminated ASCII or UTF-8 string. */
+        bool operator!= (const char* other) const noexcept  { return ! operator== (other); }
+
+    private:
+        const char* start;
+        size_t numBytes;
+    };
+
+    /** Returns the tag name of a startElement or endElement event, or an attribute's name. */
+    Chars getName() const noexcept;
+
+    /** Returns the raw text of an attribute or text event, exactly as it appears in the document.
+        This includes any entities (e.g. "&amp;") - use getDecodedValue() to expand them.
+    */
+    Chars getValue() const noexcept;
+
+    /** Returns the value of an attribute or text event as a String, with any entities expanded. */
+    String getDecodedValue();
+
+    /** Returns true if the current text event came from a CDATA section. */
+    bool isCData() const noexcept                       { return currentIsCData; }
+
+    /** Returns the contents of the document's DOCTYPE declaration, if it had one.
+        This will only be available once the outer element has been started.
+    */
+    const String& getDocType() const noexcept           { return docType; }
+
+    /** Returns a description of the last error that was found.
+        Some problems, like unknown entities, aren't serious enough to stop the parser, so
+        this may be set even if next() hasn't returned parseError.
+    */
+    const String& getLastError() const noexcept         { return lastError; }
+
+protected:
+    //==============================================================================
+    /** Called to expand an entity that isn't one of the standard XML ones.
+        The default implementation sets an error and returns the name unchanged, but you
+        can override this to look up entities from a DTD.
+    */
+    virtual String expandEntity (const String& entityName);
+
+    /** Sets the error that getLastError() will return.
+        If isFatal is true, the next call to next() will return parseError.
+    */
+    void setLastError (const String& description, bool isFatal);
+
+private:
+    //==============================================================================
+    enum State { readingProlog, readingStartTag, readingContent, finished };
+
+    const char* data;
+    size_t position, dataEnd, eventStart, bufferSize;
+    HeapBlock<char> buffer;
+    OptionalScopedPointer<InputStream> stream;
+    String convertedText;
+
+    State state;
+    EventType currentEvent;
+    int depth;
+    size_t nameStart, nameLength, valueStart, valueLength, elementNameStart, elementNameLength;
+    bool currentIsCData, valueHasEntities, errorOccurred, startTagFinished;
+    String docType, lastError;
+
+    void initialise();
+    bool readMoreData();
+    bool ensureAvailable (size_t numBytes);
+    bool matches (const char* text);
+    bool skipPast (const char* terminator);
+    void skipWhitespace();
+    bool skipCommentOrProcessingInstruction();
+    size_t readName();
+    EventType readStartOfElement();
+    EventType readAttribute();
+    EventType readContent();
+    void readDocType();
+    EventType readEndOfElement();
+    EventType fail (const String& error);
+    EventType setEvent (EventType);
+    void readEntity (const char*& text, const char* end, String& result);
+
+    JUCE_DECLARE_NON_COPYABLE (XmlPullParser);
+};
+
+
+#endif   // __JUCE_XMLPULLPARSER_JUCEHEADER__
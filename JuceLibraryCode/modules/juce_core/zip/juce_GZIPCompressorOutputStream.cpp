@@ -30,7 +30,9 @@ public:
         : compLevel ((compressionLevel < 1 || compressionLevel > 9) ? -1 : compressionLevel),
           isFirstDeflate (true),
           streamIsValid (false),
-          finished (false)
+          finished (false),
+          buffer ((size_t) defaultBufferSize),
+          bufferSize (defaultBufferSize)
     {
         using namespace zlibNamespace;
         zerostruct (stream);
@@ -65,16 +67,24 @@ public:
         int dataSize = 0;
 
         while (! finished)
-            doNextBlock (data, dataSize, destStream, Z_FINISH);
+            if (! doNextBlock (data, dataSize, destStream, Z_FINISH))
+                break;
+    }
+
+    void setBufferSize (const int newSize)
+    {
+        buffer.malloc ((size_t) newSize);
+        bufferSize = newSize;
     }
 
 private:
-    enum { strategy = 0 };
+    enum { strategy = 0, defaultBufferSize = 32768 };
 
     zlibNamespace::z_stream stream;
     const int compLevel;
     bool isFirstDeflate, streamIsValid, finished;
-    zlibNamespace::Bytef buffer[32768];
+    HeapBlock <zlibNamespace::Bytef> buffer;
+    int bufferSize;
 
     bool doNextBlock (const uint8*& data, int& dataSize, OutputStream& destStream, const int flushMode)
     {
@@ -84,7 +94,7 @@ private:
             stream.next_in   = const_cast <uint8*> (data);
             stream.next_out  = buffer;
             stream.avail_in  = (z_uInt) dataSize;
-            stream.avail_out = (z_uInt) sizeof (buffer);
+            stream.avail_out = (z_uInt) bufferSize;
 
             const int result = isFirstDeflate ? deflateParams (&stream, compLevel, strategy)
                                               : deflate (&stream, flushMode);
@@ -99,7 +109,7 @@ private:
                 {
                     data += dataSize - stream.avail_in;
                     dataSize = (int) stream.avail_in;
-                    const int bytesDone = ((int) sizeof (buffer)) - (int) stream.avail_out;
+                    const int bytesDone = bufferSize - (int) stream.avail_out;
                     return bytesDone <= 0 || destStream.write (buffer, bytesDone);
                 }
 
@@ -114,13 +124,56 @@ private:
     JUCE_DECLARE_NON_COPYABLE (GZIPCompressorHelper);
 };
 
+//==============================================================================
+/*  Compresses a set of blocks of the pending data into separate streams. */
+class GZIPCompressorOutputStream::BlockCompressor  : public ThreadPool::ParallelForBody
+{
+public:
+    BlockCompressor (const GZIPCompressorOutputStream& owner_, const size_t numBytes_)
+        : owner (owner_), numBytes (numBytes_), failed (false)
+    {
+    }
+
+    void processRange (const int startIndex, const int endIndex)
+    {
+        for (int i = startIndex; i < endIndex; ++i)
+        {
+            const size_t blockStart = (size_t) i * (size_t) owner.blockSize;
+            const int blockBytes = (int) jmin ((size_t) owner.blockSize, numBytes - blockStart);
+
+            MemoryOutputStream out (*results.getUnchecked (i), false);
+            GZIPCompressorHelper blockHelper (owner.compressionLevel, owner.windowBits);
+
+            if (! blockHelper.write (static_cast <const uint8*> (owner.pendingData.getData()) + blockStart, blockBytes, out))
+                failed = true;
+
+            blockHelper.finish (out);
+        }
+    }
+
+    const GZIPCompressorOutputStream& owner;
+    const size_t numBytes;
+    OwnedArray<MemoryBlock> results;
+    bool failed;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (BlockCompressor);
+};
+
 //==============================================================================
 GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream* const destStream_,
-                                                        const int compressionLevel,
+                                                        const int compressionLevel_,
                                                         const bool deleteDestStream,
-                                                        const int windowBits)
+                                                        const int windowBits_)
     : destStream (destStream_, deleteDestStream),
-      helper (new GZIPCompressorHelper (compressionLevel, windowBits))
+      compressionLevel (compressionLevel_),
+      windowBits (windowBits_),
+      blockSize (0),
+      blocksFinished (false),
+      threadPool (nullptr),
+      originalDestPos (destStream_ != nullptr ? destStream_->getPosition() : 0),
+      numBytesInWrittenBlocks (0),
+      helper (new GZIPCompressorHelper (compressionLevel_, windowBits_))
 {
     jassert (destStream_ != nullptr);
 }
@@ -130,9 +183,35 @@ GZIPCompressorOutputStream::~GZIPCompressorOutputStream()
     flush();
 }
 
+void GZIPCompressorOutputStream::setBlockSize (const int blockSizeBytes, ThreadPool* const pool)
+{
+    // This can't be changed once you've started writing!
+    jassert (pendingData.getSize() == 0 && seekPoints.size() == 0);
+
+    blockSize = jmax (0, blockSizeBytes);
+    threadPool = pool;
+}
+
+void GZIPCompressorOutputStream::setBufferSize (const int numBytes)
+{
+    helper->setBufferSize (jmax (256, numBytes));
+}
+
 void GZIPCompressorOutputStream::flush()
 {
-    helper->finish (*destStream);
+    if (blockSize > 0)
+    {
+        if (! blocksFinished)
+        {
+            writePendingBlocks (true);
+            blocksFinished = true;
+        }
+    }
+    else
+    {
+        helper->finish (*destStream);
+    }
+
     destStream->flush();
 }
 
@@ -140,9 +219,61 @@ bool GZIPCompressorOutputStream::write (const void* destBuffer, int howMany)
 {
     jassert (destBuffer != nullptr && howMany >= 0);
 
+    if (blockSize > 0)
+    {
+        // When you call flush() on a gzip stream, the stream is closed, and you can
+        // no longer continue to write data to it!
+        jassert (! blocksFinished);
+
+        pendingData.append (destBuffer, (size_t) howMany);
+
+        const int blocksPerBatch = threadPool != nullptr ? jmax (2, SystemStats::getNumCpus() * 2) : 1;
+
+        return pendingData.getSize() < (size_t) blockSize * (size_t) blocksPerBatch
+                || writePendingBlocks (false);
+    }
+
     return helper->write (static_cast <const uint8*> (destBuffer), howMany, *destStream);
 }
 
+bool GZIPCompressorOutputStream::writePendingBlocks (const bool isFinalBatch)
+{
+    const size_t numBytes = isFinalBatch ? pendingData.getSize()
+                                         : pendingData.getSize() - pendingData.getSize() % (size_t) blockSize;
+
+    int numBlocks = (int) ((numBytes + (size_t) blockSize - 1) / (size_t) blockSize);
+
+    // (there must always be at least one block, or the output won't be a valid stream)
+    if (isFinalBatch && numBlocks == 0 && seekPoints.size() == 0)
+        numBlocks = 1;
+
+    BlockCompressor compressor (*this, numBytes);
+
+    for (int i = 0; i < numBlocks; ++i)
+        compressor.results.add (new MemoryBlock());
+
+    if (threadPool != nullptr && numBlocks > 1)
+        threadPool->parallelFor (0, numBlocks, 1, compressor);
+    else
+        compressor.processRange (0, numBlocks);
+
+    bool ok = ! compressor.failed;
+
+    for (int i = 0; i < numBlocks && ok; ++i)
+    {
+        const GZIPDecompressorInputStream::SeekPoint seekPoint = { numBytesInWrittenBlocks,
+                                                                   destStream->getPosition() - originalDestPos };
+        seekPoints.add (seekPoint);
+        numBytesInWrittenBlocks += (int64) jmin ((size_t) blockSize, numBytes - (size_t) i * (size_t) blockSize);
+
+        const MemoryBlock& block = *compressor.results.getUnchecked (i);
+        ok = destStream->write (block.getData(), (int) block.getSize());
+    }
+
+    pendingData.removeSection (0, numBytes);
+    return ok;
+}
+
 int64 GZIPCompressorOutputStream::getPosition()
 {
     return destStream->getPosition();
@@ -162,6 +293,19 @@ class GZIPTests  : public UnitTest
 public:
     GZIPTests()   : UnitTest ("GZIP") {}
 
+    static void compress (MemoryOutputStream& dest, const char* text, const bool noWrap)
+    {
+        GZIPCompressorOutputStream zipper (&dest, 6, false, noWrap ? -15 : 0);
+        zipper.writeText (text, false, false);
+    }
+
+    static String decompress (const MemoryOutputStream& source, const bool noWrap)
+    {
+        GZIPDecompressorInputStream unzipper (new MemoryInputStream (source.getData(), source.getDataSize(), false),
+                                              true, noWrap);
+        return unzipper.readEntireStreamAsString();
+    }
+
     void runTest()
     {
         beginTest ("GZIP");
@@ -201,6 +345,81 @@ public:
                                 original.getData(),
                                 original.getDataSize()) == 0);
         }
+
+        beginTest ("Blocks");
+
+        MemoryOutputStream original;
+
+        for (int i = 0; i < 20000; ++i)
+            original << "line " << rng.nextInt (1000) << "\n";
+
+        const int blockSize = 10000;
+        const int numBlocks = (int) (original.getDataSize() + blockSize - 1) / blockSize;
+
+        for (int numThreads = 0; numThreads < 3; numThreads += 2)
+        {
+            ScopedPointer<ThreadPool> pool (numThreads > 0 ? new ThreadPool (numThreads) : nullptr);
+            MemoryOutputStream compressed;
+            compressed << "header";
+            Array<GZIPDecompressorInputStream::SeekPoint> seekPoints;
+
+            {
+                GZIPCompressorOutputStream zipper (&compressed, 6, false);
+                zipper.setBlockSize (blockSize, pool);
+                zipper.write (original.getData(), (int) original.getDataSize());
+                zipper.flush();
+                seekPoints = zipper.getSeekPoints();
+            }
+
+            expectEquals (seekPoints.size(), numBlocks);
+            compressed << "junk";
+
+            for (int useSeekPoints = 0; useSeekPoints < 3; ++useSeekPoints)
+            {
+                MemoryInputStream compressedInput (compressed.getData(), compressed.getDataSize(), false);
+                compressedInput.setPosition (6);
+                GZIPDecompressorInputStream unzipper (compressedInput);
+
+                if (useSeekPoints > 0)
+                    unzipper.setSeekPoints (seekPoints, useSeekPoints > 1 ? pool.get() : nullptr);
+
+                MemoryOutputStream uncompressed;
+                uncompressed << unzipper;
+
+                expect (uncompressed.getDataSize() == original.getDataSize()
+                         && memcmp (uncompressed.getData(), original.getData(), original.getDataSize()) == 0);
+
+                for (int i = 0; i < 20; ++i)
+                {
+                    const int pos = rng.nextInt ((int) original.getDataSize() - 100);
+                    char buffer[100];
+
+                    expect (unzipper.setPosition (pos));
+                    expectEquals (unzipper.read (buffer, sizeof (buffer)), (int) sizeof (buffer));
+                    expect (memcmp (buffer, static_cast <const char*> (original.getData()) + pos, sizeof (buffer)) == 0);
+                    expect (unzipper.getPosition() == pos + (int) sizeof (buffer));
+                }
+            }
+        }
+
+        beginTest ("Trailing data");
+
+        for (int noWrap = 0; noWrap < 2; ++noWrap)
+        {
+            MemoryOutputStream compressed;
+            compress (compressed, "hello world", noWrap != 0);
+            compressed << "ZZZZZZZZ";
+
+            expectEquals (decompress (compressed, noWrap != 0), String ("hello world"));
+        }
+
+        {
+            MemoryOutputStream compressed;
+            compress (compressed, "hello ", false);
+            compress (compressed, "world", false);
+
+            expectEquals (decompress (compressed, false), String ("hello world"));
+        }
     }
 };
 
@@ -29,6 +29,8 @@
 #include "../streams/juce_OutputStream.h"
 #include "../memory/juce_OptionalScopedPointer.h"
 #include "../memory/juce_HeapBlock.h"
+#include "../memory/juce_MemoryBlock.h"
+#include "juce_GZIPDecompressorInputStream.h"
 
 
 //==============================================================================
@@ -79,6 +81,35 @@ public:
     bool setPosition (int64 newPosition);
     bool write (const void* destBuffer, int howMany);
 
+    //==============================================================================
+    /** Makes the stream compress its data as a series of independent blocks.
+
+        Each block of blockSizeBytes of input is written as a complete compressed stream
+        of its own, one after the other. This makes the output slightly bigger, but means
+        that a GZIPDecompressorInputStream can jump straight to any of the blocks (see
+        getSeekPoints()), and that the blocks can be compressed and decompressed on
+        several threads at once.
+
+        If a ThreadPool is supplied, the stream will collect enough data for several blocks
+        before compressing them all in parallel with it. The pool must not be deleted
+        before this stream has been flushed.
+
+        This must be called before any data has been written. Passing 0 turns blocks off.
+    */
+    void setBlockSize (int blockSizeBytes, ThreadPool* threadPool = nullptr);
+
+    /** If setBlockSize() has been used, this returns the position of each block that has
+        been written so far, ready to pass to GZIPDecompressorInputStream::setSeekPoints().
+        The compressed positions are relative to the position that the destination stream
+        was at when this object was created.
+    */
+    const Array<GZIPDecompressorInputStream::SeekPoint>& getSeekPoints() const noexcept     { return seekPoints; }
+
+    /** Changes the size of the buffer used to pass compressed data to the destination stream.
+        The default is 32K, and this must be called before any data has been written.
+    */
+    void setBufferSize (int numBytes);
+
     /** These are preset values that can be used for the constructor's windowBits paramter.
         For more info about this, see the zlib documentation for its windowBits parameter.
     */
@@ -91,11 +122,22 @@ public:
 private:
     //==============================================================================
     OptionalScopedPointer<OutputStream> destStream;
+    const int compressionLevel, windowBits;
+    int blockSize;
+    bool blocksFinished;
+    ThreadPool* threadPool;
+    const int64 originalDestPos;
+    int64 numBytesInWrittenBlocks;
+    MemoryBlock pendingData;
+    Array<GZIPDecompressorInputStream::SeekPoint> seekPoints;
 
     class GZIPCompressorHelper;
+    class BlockCompressor;
     friend class ScopedPointer <GZIPCompressorHelper>;
     ScopedPointer <GZIPCompressorHelper> helper;
 
+    bool writePendingBlocks (bool isFinalBatch);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GZIPCompressorOutputStream);
 };
 
@@ -75,6 +75,9 @@ public:
           needsDictionary (false),
           error (true),
           streamIsValid (false),
+          reachedTrailingData (false),
+          isFirstMember (true),
+          atStartOfMember (true),
           data (nullptr),
           dataSize (0)
     {
@@ -99,6 +102,19 @@ public:
         dataSize = size;
     }
 
+    /* Gets ready to decompress another stream that follows the one that has finished. */
+    bool startNextMember()
+    {
+        if (! streamIsValid || error || reachedTrailingData
+             || zlibNamespace::inflateReset (&stream) != Z_OK)
+            return false;
+
+        finished = false;
+        isFirstMember = false;
+        atStartOfMember = true;
+        return true;
+    }
+
     int doNextBlock (uint8* const dest, const int destSize)
     {
         using namespace zlibNamespace;
@@ -117,6 +133,7 @@ public:
             case Z_OK:
                 data += dataSize - stream.avail_in;
                 dataSize = (z_uInt) stream.avail_in;
+                atStartOfMember = atStartOfMember && stream.avail_out == (z_uInt) destSize && ! finished;
                 return (int) (destSize - stream.avail_out);
 
             case Z_NEED_DICT:
@@ -126,6 +143,14 @@ public:
                 break;
 
             case Z_DATA_ERROR:
+                // (if the data that follows a stream isn't another stream, it's just ignored)
+                if (atStartOfMember && ! isFirstMember)
+                {
+                    finished = true;
+                    reachedTrailingData = true;
+                    break;
+                }
+                // deliberate fall-through
             case Z_MEM_ERROR:
                 error = true;
 
@@ -137,18 +162,187 @@ public:
         return 0;
     }
 
-    bool finished, needsDictionary, error, streamIsValid;
+    bool finished, needsDictionary, error, streamIsValid, reachedTrailingData;
 
     enum { gzipDecompBufferSize = 32768 };
 
 private:
     zlibNamespace::z_stream stream;
+    bool isFirstMember, atStartOfMember;
     uint8* data;
     size_t dataSize;
 
     JUCE_DECLARE_NON_COPYABLE (GZIPDecompressHelper);
 };
 
+//==============================================================================
+/*  Reads a batch of blocks from the source stream, and decompresses them all at
+    once with a ThreadPool.
+*/
+class GZIPDecompressorInputStream::ParallelDecoder  : public ThreadPool::ParallelForBody
+{
+public:
+    ParallelDecoder (GZIPDecompressorInputStream& owner_, ThreadPool& pool_)
+        : owner (owner_), pool (pool_),
+          batchStartIndex (0), nextIndexInBatch (0), positionInBlock (0),
+          failed (false)
+    {
+    }
+
+    int read (uint8* dest, int howMany)
+    {
+        int numRead = 0;
+
+        while (howMany > 0)
+        {
+            if (nextIndexInBatch >= batch.size() && ! decodeBatch (batchStartIndex + batch.size()))
+                break;
+
+            const Block& block = *batch.getUnchecked (nextIndexInBatch);
+            const int num = (int) jmin ((size_t) howMany, block.decodedSize - positionInBlock);
+
+            memcpy (dest, static_cast <const char*> (block.decoded.getData()) + positionInBlock, (size_t) num);
+            dest += num;
+            howMany -= num;
+            numRead += num;
+            positionInBlock += (size_t) num;
+
+            if (positionInBlock >= block.decodedSize)
+            {
+                ++nextIndexInBatch;
+                positionInBlock = 0;
+            }
+        }
+
+        return numRead;
+    }
+
+    bool isExhausted() const noexcept
+    {
+        return failed || (nextIndexInBatch >= batch.size()
+                            && batchStartIndex + batch.size() >= owner.seekPoints.size());
+    }
+
+    void setPosition (const int64 newPos)
+    {
+        const Array<SeekPoint>& points = owner.seekPoints;
+        int index = 0;
+
+        while (index + 1 < points.size() && points.getReference (index + 1).uncompressedPosition <= newPos)
+            ++index;
+
+        if (index < batchStartIndex || index >= batchStartIndex + batch.size())
+            decodeBatch (index);
+
+        nextIndexInBatch = index - batchStartIndex;
+
+        if (isPositiveAndBelow (nextIndexInBatch, batch.size()))
+            positionInBlock = (size_t) jmin (newPos - points.getReference (index).uncompressedPosition,
+                                             (int64) batch.getUnchecked (nextIndexInBatch)->decodedSize);
+    }
+
+    void processRange (const int startIndex, const int endIndex)
+    {
+        for (int i = startIndex; i < endIndex; ++i)
+            if (! decodeBlock (*batch.getUnchecked (i)))
+                failed = true;
+    }
+
+private:
+    struct Block
+    {
+        Block() : expectedSize (-1), decodedSize (0) {}
+
+        MemoryBlock compressed, decoded;
+        int64 expectedSize;
+        size_t decodedSize;
+    };
+
+    GZIPDecompressorInputStream& owner;
+    ThreadPool& pool;
+    OwnedArray<Block> batch;
+    int batchStartIndex, nextIndexInBatch;
+    size_t positionInBlock;
+    bool failed;
+
+    bool decodeBatch (const int firstIndex)
+    {
+        const Array<SeekPoint>& points = owner.seekPoints;
+
+        batch.clear();
+        batchStartIndex = firstIndex;
+        nextIndexInBatch = 0;
+        positionInBlock = 0;
+
+        if (failed || firstIndex >= points.size())
+            return false;
+
+        InputStream& source = *owner.sourceStream;
+        const int numBlocks = jmin (points.size() - firstIndex, jmax (2, SystemStats::getNumCpus() * 2));
+
+        if (! source.setPosition (owner.originalSourcePos + points.getReference (firstIndex).compressedPosition))
+            return false;
+
+        for (int i = firstIndex; i < firstIndex + numBlocks; ++i)
+        {
+            Block* const block = new Block();
+            batch.add (block);
+
+            if (i + 1 < points.size())
+            {
+                const SeekPoint& start = points.getReference (i);
+                const SeekPoint& end = points.getReference (i + 1);
+
+                block->expectedSize = end.uncompressedPosition - start.uncompressedPosition;
+                const int64 compressedSize = end.compressedPosition - start.compressedPosition;
+
+                if ((int64) source.readIntoMemoryBlock (block->compressed, (ssize_t) compressedSize) != compressedSize)
+                    failed = true;
+            }
+            else
+            {
+                source.readIntoMemoryBlock (block->compressed);
+            }
+        }
+
+        if (numBlocks > 1)
+            pool.parallelFor (0, numBlocks, 1, *this);
+        else
+            processRange (0, numBlocks);
+
+        return ! failed;
+    }
+
+    bool decodeBlock (Block& block) const
+    {
+        GZIPDecompressHelper helper (owner.noWrap);
+        helper.setInput (static_cast <uint8*> (block.compressed.getData()), block.compressed.getSize());
+
+        block.decoded.setSize ((size_t) (block.expectedSize >= 0 ? block.expectedSize + 1
+                                                                 : (int64) block.compressed.getSize() * 4 + 1024));
+
+        for (;;)
+        {
+            if (block.decodedSize >= block.decoded.getSize())
+                block.decoded.setSize (block.decoded.getSize() * 2);
+
+            const int n = helper.doNextBlock (static_cast <uint8*> (block.decoded.getData()) + block.decodedSize,
+                                              (int) jmin ((size_t) 0x7fffffff, block.decoded.getSize() - block.decodedSize));
+            block.decodedSize += (size_t) n;
+
+            if (helper.error || helper.needsDictionary)
+                return false;
+
+            if (n == 0 && (helper.finished || helper.needsInput()))
+                break;
+        }
+
+        return helper.finished && (block.expectedSize < 0 || (int64) block.decodedSize == block.expectedSize);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelDecoder);
+};
+
 //==============================================================================
 GZIPDecompressorInputStream::GZIPDecompressorInputStream (InputStream* const sourceStream_,
                                                           const bool deleteSourceWhenDestroyed,
@@ -159,6 +353,7 @@ GZIPDecompressorInputStream::GZIPDecompressorInputStream (InputStream* const sou
     noWrap (noWrap_),
     isEof (false),
     activeBufferSize (0),
+    bufferSize ((int) GZIPDecompressHelper::gzipDecompBufferSize),
     originalSourcePos (sourceStream_->getPosition()),
     currentPos (0),
     buffer ((size_t) GZIPDecompressHelper::gzipDecompBufferSize),
@@ -172,6 +367,7 @@ GZIPDecompressorInputStream::GZIPDecompressorInputStream (InputStream& sourceStr
     noWrap (false),
     isEof (false),
     activeBufferSize (0),
+    bufferSize ((int) GZIPDecompressHelper::gzipDecompBufferSize),
     originalSourcePos (sourceStream_.getPosition()),
     currentPos (0),
     buffer ((size_t) GZIPDecompressHelper::gzipDecompBufferSize),
@@ -183,6 +379,31 @@ GZIPDecompressorInputStream::~GZIPDecompressorInputStream()
 {
 }
 
+void GZIPDecompressorInputStream::setSeekPoints (const Array<SeekPoint>& newSeekPoints, ThreadPool* const pool)
+{
+    // This can't be changed once you've started reading!
+    jassert (currentPos == 0 && activeBufferSize == 0);
+
+    seekPoints = newSeekPoints;
+
+    if (seekPoints.size() == 0 || seekPoints.getReference (0).uncompressedPosition != 0)
+    {
+        const SeekPoint start = { 0, 0 };
+        seekPoints.insert (0, start);
+    }
+
+    parallelDecoder = pool != nullptr ? new ParallelDecoder (*this, *pool) : nullptr;
+}
+
+void GZIPDecompressorInputStream::setBufferSize (const int numBytes)
+{
+    // This can't be changed once you've started reading!
+    jassert (currentPos == 0 && activeBufferSize == 0);
+
+    bufferSize = jmax (256, numBytes);
+    buffer.malloc ((size_t) bufferSize);
+}
+
 int64 GZIPDecompressorInputStream::getTotalLength()
 {
     return uncompressedStreamLength;
@@ -192,6 +413,13 @@ int GZIPDecompressorInputStream::read (void* destBuffer, int howMany)
 {
     jassert (destBuffer != nullptr && howMany >= 0);
 
+    if (parallelDecoder != nullptr)
+    {
+        const int numRead = parallelDecoder->read (static_cast <uint8*> (destBuffer), howMany);
+        currentPos += numRead;
+        return numRead;
+    }
+
     if (howMany > 0 && ! isEof)
     {
         int numRead = 0;
@@ -206,13 +434,15 @@ int GZIPDecompressorInputStream::read (void* destBuffer, int howMany)
             {
                 if (helper->finished || helper->needsDictionary)
                 {
-                    isEof = true;
-                    return numRead;
+                    if (helper->needsDictionary || ! startNextMember())
+                    {
+                        isEof = true;
+                        return numRead;
+                    }
                 }
-
-                if (helper->needsInput())
+                else if (helper->needsInput())
                 {
-                    activeBufferSize = sourceStream->read (buffer, (int) GZIPDecompressHelper::gzipDecompBufferSize);
+                    activeBufferSize = sourceStream->read (buffer, bufferSize);
 
                     if (activeBufferSize > 0)
                     {
@@ -240,8 +470,31 @@ int GZIPDecompressorInputStream::read (void* destBuffer, int howMany)
     return 0;
 }
 
+bool GZIPDecompressorInputStream::startNextMember()
+{
+    // A raw deflate stream has no header that could tell another stream apart from whatever
+    // data follows it, so it's only continued if the seek points say that there's more.
+    if (noWrap && seekPoints.size() == 0)
+        return false;
+
+    if (helper->needsInput())
+    {
+        activeBufferSize = sourceStream->read (buffer, bufferSize);
+
+        if (activeBufferSize <= 0)
+            return false;
+
+        helper->setInput (buffer, (size_t) activeBufferSize);
+    }
+
+    return helper->startNextMember();
+}
+
 bool GZIPDecompressorInputStream::isExhausted()
 {
+    if (parallelDecoder != nullptr)
+        return parallelDecoder->isExhausted();
+
     return helper->error || isEof;
 }
 
@@ -252,21 +505,64 @@ int64 GZIPDecompressorInputStream::getPosition()
 
 bool GZIPDecompressorInputStream::setPosition (int64 newPos)
 {
-    if (newPos < currentPos)
+    if (parallelDecoder != nullptr)
     {
-        // to go backwards, reset the stream and start again..
-        isEof = false;
-        activeBufferSize = 0;
-        currentPos = 0;
-        helper = new GZIPDecompressHelper (noWrap);
+        parallelDecoder->setPosition (newPos);
+        currentPos = newPos;
+        return true;
+    }
 
-        sourceStream->setPosition (originalSourcePos);
+    // find the last block that starts before the new position..
+    int seekPointIndex = -1;
+
+    for (int start = 0, end = seekPoints.size(); start < end;)
+    {
+        const int mid = (start + end) / 2;
+
+        if (seekPoints.getReference (mid).uncompressedPosition <= newPos)
+        {
+            seekPointIndex = mid;
+            start = mid + 1;
+        }
+        else
+        {
+            end = mid;
+        }
+    }
+
+    if (seekPointIndex >= 0 && (newPos < currentPos || seekPoints.getReference (seekPointIndex).uncompressedPosition > currentPos))
+    {
+        restartAt (seekPoints.getReference (seekPointIndex));
+    }
+    else if (newPos < currentPos)
+    {
+        // to go backwards, reset the stream and start again..
+        const SeekPoint start = { 0, 0 };
+        restartAt (start);
     }
 
-    skipNextBytes (newPos - currentPos);
+    InputStream::skipNextBytes (newPos - currentPos);
     return true;
 }
 
+void GZIPDecompressorInputStream::skipNextBytes (const int64 numBytesToSkip)
+{
+    if (seekPoints.size() > 0)
+        setPosition (currentPos + numBytesToSkip);
+    else
+        InputStream::skipNextBytes (numBytesToSkip);
+}
+
+void GZIPDecompressorInputStream::restartAt (const SeekPoint& seekPoint)
+{
+    isEof = false;
+    activeBufferSize = 0;
+    currentPos = seekPoint.uncompressedPosition;
+    helper = new GZIPDecompressHelper (noWrap);
+
+    sourceStream->setPosition (originalSourcePos + seekPoint.compressedPosition);
+}
+
 // (This is used as a way for the zip file code to use the crc32 function without including zlib)
 unsigned long juce_crc32 (unsigned long, const unsigned char*, unsigned);
 unsigned long juce_crc32 (unsigned long crc, const unsigned char* buf, unsigned len)
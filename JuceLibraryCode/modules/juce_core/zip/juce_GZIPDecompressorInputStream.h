@@ -29,6 +29,8 @@
 #include "../streams/juce_InputStream.h"
 #include "../memory/juce_OptionalScopedPointer.h"
 #include "../memory/juce_HeapBlock.h"
+#include "../containers/juce_Array.h"
+#include "../threads/juce_ThreadPool.h"
 
 
 //==============================================================================
@@ -39,6 +41,10 @@
          can increase the performance enormously by passing it through a
          BufferedInputStream, so that it has to read larger blocks less often.
 
+    If the source contains several compressed streams one after another (which is what
+    GZIPCompressorOutputStream::setBlockSize() produces), they're all decompressed, as
+    if they were one stream.
+
     @see GZIPCompressorOutputStream
 */
 class JUCE_API  GZIPDecompressorInputStream  : public InputStream
@@ -71,13 +77,47 @@ public:
     /** Destructor. */
     ~GZIPDecompressorInputStream();
 
+    //==============================================================================
+    /** Describes the start of one of the independently-compressed blocks in a stream
+        that was written using GZIPCompressorOutputStream::setBlockSize().
+        @see setSeekPoints, GZIPCompressorOutputStream::getSeekPoints
+    */
+    struct SeekPoint
+    {
+        /** The position of the start of the block in the uncompressed data. */
+        int64 uncompressedPosition;
+
+        /** The position of the start of the block in the compressed data, relative to the
+            position of the source stream when this decompressor was created. */
+        int64 compressedPosition;
+    };
+
+    /** Gives the stream a list of the blocks that the compressed data is made of.
+
+        When it has this, setPosition() can jump straight to the block that contains the
+        new position instead of decompressing all the data before it (the source stream
+        must be seekable for this to work).
+
+        If a ThreadPool is provided, the stream will also decompress several blocks at
+        once using the pool's threads, and will keep them in memory until they've been
+        read. The pool must not be deleted before this stream.
+
+        This must be called before any data has been read.
+    */
+    void setSeekPoints (const Array<SeekPoint>& seekPoints, ThreadPool* poolForParallelDecoding = nullptr);
+
+    /** Changes the size of the buffer used to read from the source stream.
+        The default is 32K, and this must be called before any data has been read.
+    */
+    void setBufferSize (int numBytes);
+
     //==============================================================================
     int64 getPosition();
     bool setPosition (int64 pos);
     int64 getTotalLength();
     bool isExhausted();
     int read (void* destBuffer, int maxBytesToRead);
-
+    void skipNextBytes (int64 numBytesToSkip);
 
     //==============================================================================
 private:
@@ -85,13 +125,20 @@ private:
     const int64 uncompressedStreamLength;
     const bool noWrap;
     bool isEof;
-    int activeBufferSize;
+    int activeBufferSize, bufferSize;
     int64 originalSourcePos, currentPos;
     HeapBlock <uint8> buffer;
+    Array<SeekPoint> seekPoints;
 
     class GZIPDecompressHelper;
+    class ParallelDecoder;
     friend class ScopedPointer <GZIPDecompressHelper>;
+    friend class ScopedPointer <ParallelDecoder>;
     ScopedPointer <GZIPDecompressHelper> helper;
+    ScopedPointer <ParallelDecoder> parallelDecoder;
+
+    bool startNextMember();
+    void restartAt (const SeekPoint&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GZIPDecompressorInputStream);
 };
@@ -29,6 +29,7 @@ public:
     ZipEntryHolder (const char* const buffer, const int fileNameLen)
     {
         entry.filename = String::fromUTF8 (buffer + 46, fileNameLen);
+        hash = entry.filename.hashCode();
 
         const int time = ByteOrder::littleEndianShort (buffer + 12);
         const int date = ByteOrder::littleEndianShort (buffer + 14);
@@ -50,6 +51,7 @@ public:
     };
 
     ZipEntry entry;
+    int hash;
     size_t streamOffset;
     size_t compressedSize;
     bool compressed;
@@ -174,7 +176,12 @@ public:
         }
         else
         {
-            inputStream->setPosition (pos + zipEntryHolder.streamOffset + headerSize);
+            // (this stream isn't shared, so it only needs to seek after setPosition() has been called)
+            const int64 streamPos = pos + zipEntryHolder.streamOffset + headerSize;
+
+            if (inputStream->getPosition() != streamPos)
+                inputStream->setPosition (streamPos);
+
             num = inputStream->read (buffer, howMany);
         }
 
@@ -212,7 +219,7 @@ private:
 
 //==============================================================================
 ZipFile::ZipFile (InputStream* const stream, const bool deleteStreamWhenDestroyed)
-   : inputStream (stream)
+   : nameIndexSize (0), inputStream (stream)
 {
     if (deleteStreamWhenDestroyed)
         streamToDelete = inputStream;
@@ -221,20 +228,34 @@ ZipFile::ZipFile (InputStream* const stream, const bool deleteStreamWhenDestroye
 }
 
 ZipFile::ZipFile (InputStream& stream)
-   : inputStream (&stream)
+   : nameIndexSize (0), inputStream (&stream)
 {
     init();
 }
 
 ZipFile::ZipFile (const File& file)
-    : inputStream (nullptr),
-      inputSource (new FileInputSource (file))
+    : nameIndexSize (0),
+      inputStream (nullptr),
+      mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly))
 {
+    if (mappedFile->getData() != nullptr)
+    {
+        // (this is only used for reading the directory - the entries' streams read
+        // straight from the mapped data)
+        streamToDelete = inputStream = new MemoryInputStream (mappedFile->getData(), mappedFile->getSize(), false);
+    }
+    else
+    {
+        mappedFile = nullptr;
+        inputSource = new FileInputSource (file);
+    }
+
     init();
 }
 
 ZipFile::ZipFile (InputSource* const inputSource_)
-    : inputStream (nullptr),
+    : nameIndexSize (0),
+      inputStream (nullptr),
       inputSource (inputSource_)
 {
     init();
@@ -271,9 +292,23 @@ const ZipFile::ZipEntry* ZipFile::getEntry (const int index) const noexcept
 
 int ZipFile::getIndexOfFileName (const String& fileName) const noexcept
 {
-    for (int i = 0; i < entries.size(); ++i)
-        if (entries.getUnchecked (i)->entry.filename == fileName)
-            return i;
+    if (nameIndexSize > 0)
+    {
+        const int hash = fileName.hashCode();
+
+        for (int slot = hash & (nameIndexSize - 1);; slot = (slot + 1) & (nameIndexSize - 1))
+        {
+            const int index = nameIndex [slot];
+
+            if (index < 0)
+                break;
+
+            const ZipEntryHolder* const zei = entries.getUnchecked (index);
+
+            if (zei->hash == hash && zei->entry.filename == fileName)
+                return index;
+        }
+    }
 
     return -1;
 }
@@ -290,7 +325,19 @@ InputStream* ZipFile::createStreamForEntry (const int index)
 
     if (zei != nullptr)
     {
-        stream = new ZipInputStream (*this, *zei);
+        if (mappedFile != nullptr)
+        {
+            const char* const data = getMappedData (*zei);
+
+            if (data == nullptr)
+                return nullptr;
+
+            stream = new MemoryInputStream (data, zei->compressedSize, false);
+        }
+        else
+        {
+            stream = new ZipInputStream (*this, *zei);
+        }
 
         if (zei->compressed)
         {
@@ -305,10 +352,72 @@ InputStream* ZipFile::createStreamForEntry (const int index)
     return stream;
 }
 
+const void* ZipFile::getMappedDataForEntry (const int index) const noexcept
+{
+    const ZipEntryHolder* const zei = entries [index];
+
+    if (zei == nullptr || mappedFile == nullptr || zei->compressed
+         || zei->compressedSize != zei->entry.uncompressedSize)
+        return nullptr;
+
+    return getMappedData (*zei);
+}
+
+const char* ZipFile::getMappedData (const ZipEntryHolder& zei) const noexcept
+{
+    const char* const data = static_cast <const char*> (mappedFile->getData());
+    const size_t size = mappedFile->getSize();
+
+    if (zei.streamOffset + 30 > size
+         || ByteOrder::littleEndianInt (data + zei.streamOffset) != 0x04034b50)
+        return nullptr;
+
+    const size_t start = zei.streamOffset + 30
+                           + ByteOrder::littleEndianShort (data + zei.streamOffset + 26)
+                           + ByteOrder::littleEndianShort (data + zei.streamOffset + 28);
+
+    if (start > size || zei.compressedSize > size - start)
+        return nullptr;
+
+    return data + start;
+}
+
 void ZipFile::sortEntriesByFilename()
 {
     ZipEntryHolder::FileNameComparator sorter;
     entries.sort (sorter);
+    buildNameIndex();
+}
+
+void ZipFile::buildNameIndex()
+{
+    nameIndexSize = entries.size() > 0 ? nextPowerOfTwo (entries.size() * 2) : 0;
+    nameIndex.malloc ((size_t) nameIndexSize);
+
+    for (int i = 0; i < nameIndexSize; ++i)
+        nameIndex[i] = -1;
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        const ZipEntryHolder* const zei = entries.getUnchecked (i);
+
+        for (int slot = zei->hash & (nameIndexSize - 1);; slot = (slot + 1) & (nameIndexSize - 1))
+        {
+            const int index = nameIndex [slot];
+
+            if (index < 0)
+            {
+                nameIndex [slot] = i;
+                break;
+            }
+
+            const ZipEntryHolder* const other = entries.getUnchecked (index);
+
+            // (if there are duplicate names, the first one is the one that gets found)
+            if (other->hash == zei->hash && other->entry.filename == zei->entry.filename)
+                break;
+        }
+    }
 }
 
 //==============================================================================
@@ -360,6 +469,8 @@ void ZipFile::init()
             }
         }
     }
+
+    buildNameIndex();
 }
 
 Result ZipFile::uncompressTo (const File& targetDirectory,
@@ -429,38 +540,65 @@ public:
     Item (const File& file_, const int compressionLevel_, const String& storedPathName_)
         : file (file_),
           storedPathname (storedPathName_.isEmpty() ? file_.getFileName() : storedPathName_),
-          compressionLevel (compressionLevel_),
+          compressionLevel (isAlreadyCompressed (file_) ? 0 : compressionLevel_),
           compressedSize (0),
-          headerStart (0)
+          uncompressedSize (0),
+          headerStart (0),
+          checksum (0)
     {
     }
 
-    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    int64 getSourceSize() const
     {
-        MemoryOutputStream compressedData;
+        return file.getSize();
+    }
+
+    /* Reads the file and compresses it into memory. This can be called on any thread. */
+    bool compressData()
+    {
+        MemoryBlock sourceData;
+
+        if (! file.loadFileAsData (sourceData))
+            return false;
+
+        uncompressedSize = (int) sourceData.getSize();
+        checksum = juce_crc32 (0, static_cast <const unsigned char*> (sourceData.getData()),
+                               (unsigned int) sourceData.getSize());
 
         if (compressionLevel > 0)
         {
-            GZIPCompressorOutputStream compressor (&compressedData, compressionLevel, false,
-                                                   GZIPCompressorOutputStream::windowBitsRaw);
-            if (! writeSource (compressor))
-                return false;
-        }
-        else
-        {
-            if (! writeSource (compressedData))
-                return false;
+            {
+                MemoryOutputStream out (data, false);
+                GZIPCompressorOutputStream compressor (&out, compressionLevel, false,
+                                                       GZIPCompressorOutputStream::windowBitsRaw);
+
+                compressor.write (sourceData.getData(), (int) sourceData.getSize());
+            }
+
+            if (data.getSize() < sourceData.getSize())
+                return true;
+
+            // (it didn't get any smaller, so it'll be stored instead)
+            compressionLevel = 0;
         }
 
-        compressedSize = (int) compressedData.getDataSize();
+        data.swapWith (sourceData);
+        return true;
+    }
+
+    /* Writes the data that compressData() created, and then frees it. */
+    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    {
+        compressedSize = (int) data.getSize();
         headerStart = (int) (target.getPosition() - overallStartPosition);
 
         target.writeInt (0x04034b50);
         writeFlagsAndSizes (target);
-        target << storedPathname
-               << compressedData;
+        target << storedPathname;
 
-        return true;
+        const bool ok = target.write (data.getData(), compressedSize);
+        data.setSize (0);
+        return ok;
     }
 
     bool writeDirectoryEntry (OutputStream& target)
@@ -481,8 +619,14 @@ public:
 private:
     const File file;
     String storedPathname;
-    int compressionLevel, compressedSize, headerStart;
+    int compressionLevel, compressedSize, uncompressedSize, headerStart;
     unsigned long checksum;
+    MemoryBlock data;
+
+    static bool isAlreadyCompressed (const File& f)
+    {
+        return f.hasFileExtension ("png;jpg;jpeg;gif;webp;zip;jar;gz;tgz;bz2;xz;7z;mp3;m4a;aac;ogg;flac;mp4;m4v;mov");
+    }
 
     void writeTimeAndDate (OutputStream& target) const
     {
@@ -491,31 +635,6 @@ private:
         target.writeShort ((short) (t.getDayOfMonth() + ((t.getMonth() + 1) << 5) + ((t.getYear() - 1980) << 9)));
     }
 
-    bool writeSource (OutputStream& target)
-    {
-        checksum = 0;
-        FileInputStream input (file);
-
-        if (input.failedToOpen())
-            return false;
-
-        const int bufferSize = 2048;
-        HeapBlock<unsigned char> buffer (bufferSize);
-
-        while (! input.isExhausted())
-        {
-            const int bytesRead = input.read (buffer, bufferSize);
-
-            if (bytesRead < 0)
-                return false;
-
-            checksum = juce_crc32 (checksum, buffer, (unsigned int) bytesRead);
-            target.write (buffer, bytesRead);
-        }
-
-        return true;
-    }
-
     void writeFlagsAndSizes (OutputStream& target) const
     {
         target.writeShort (10); // version needed
@@ -524,7 +643,7 @@ private:
         writeTimeAndDate (target);
         target.writeInt ((int) checksum);
         target.writeInt (compressedSize);
-        target.writeInt ((int) file.getSize());
+        target.writeInt (uncompressedSize);
         target.writeShort ((short) storedPathname.toUTF8().sizeInBytes() - 1);
         target.writeShort (0); // extra field length
     }
@@ -532,6 +651,26 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Item);
 };
 
+//=============================================================================
+class ZipFile::Builder::Compressor  : public ThreadPool::ParallelForBody
+{
+public:
+    Compressor (const OwnedArray<Item>& items_) : items (items_) {}
+
+    void processRange (const int startIndex, const int endIndex)
+    {
+        for (int i = startIndex; i < endIndex; ++i)
+            if (! items.getUnchecked (i)->compressData())
+                failed = 1;
+    }
+
+    const OwnedArray<Item>& items;
+    Atomic<int> failed;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Compressor);
+};
+
 //=============================================================================
 ZipFile::Builder::Builder() {}
 ZipFile::Builder::~Builder() {}
@@ -541,17 +680,49 @@ void ZipFile::Builder::addFile (const File& fileToAdd, const int compressionLeve
     items.add (new Item (fileToAdd, compressionLevel, storedPathName));
 }
 
-bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress) const
+bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress, ThreadPool* threadPool) const
 {
+    ScopedPointer<ThreadPool> poolToDelete;
+
+    if (threadPool == nullptr && items.size() > 1 && SystemStats::getNumCpus() > 1)
+        threadPool = poolToDelete = new ThreadPool (SystemStats::getNumCpus());
+
+    Compressor compressor (items);
     const int64 fileStart = target.getPosition();
 
-    for (int i = 0; i < items.size(); ++i)
+    // The items are compressed in batches, which are then written out in order, so
+    // that there's a limit on how much compressed data has to be kept in memory..
+    const int64 maxBytesPerBatch = 64 * 1024 * 1024;
+    const int maxItemsPerBatch = 1024;
+
+    for (int batchStart = 0; batchStart < items.size();)
     {
-        if (progress != nullptr)
-            *progress = (i + 0.5) / items.size();
+        int batchEnd = batchStart;
+        int64 batchBytes = 0;
+
+        while (batchEnd < items.size()
+                && batchEnd < batchStart + maxItemsPerBatch
+                && (batchEnd == batchStart || batchBytes < maxBytesPerBatch))
+            batchBytes += items.getUnchecked (batchEnd++)->getSourceSize();
 
-        if (! items.getUnchecked (i)->writeData (target, fileStart))
+        if (threadPool != nullptr)
+            threadPool->parallelFor (batchStart, batchEnd, 1, compressor);
+        else
+            compressor.processRange (batchStart, batchEnd);
+
+        if (compressor.failed.get() != 0)
             return false;
+
+        for (int i = batchStart; i < batchEnd; ++i)
+        {
+            if (progress != nullptr)
+                *progress = (i + 0.5) / items.size();
+
+            if (! items.getUnchecked (i)->writeData (target, fileStart))
+                return false;
+        }
+
+        batchStart = batchEnd;
     }
 
     const int64 directoryStart = target.getPosition();
@@ -576,3 +747,121 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
 
     return true;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ZipFileTests  : public UnitTest
+{
+public:
+    ZipFileTests()   : UnitTest ("ZipFile") {}
+
+    static String getContent (const int index)
+    {
+        return "File number " + String (index) + " " + String::repeatedString ("abcd", index * 10);
+    }
+
+    void checkEntries (ZipFile& zip, const int numEntries)
+    {
+        expectEquals (zip.getNumEntries(), numEntries);
+        expectEquals (zip.getIndexOfFileName ("missing.txt"), -1);
+
+        for (int i = 0; i < numEntries - 2; ++i)
+        {
+            const String name ("dir/file" + String (i) + ".txt");
+            const int index = zip.getIndexOfFileName (name);
+
+            expect (index >= 0 && zip.getEntry (index)->filename == name);
+
+            const ScopedPointer<InputStream> in (zip.createStreamForEntry (index));
+            expect (in != nullptr && in->readEntireStreamAsString() == getContent (i));
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("ZipFile");
+
+        const File dir (File::createTempFile ("zip"));
+        dir.createDirectory();
+
+        const int numFiles = 200;
+        ZipFile::Builder builder;
+
+        for (int i = 0; i < numFiles; ++i)
+        {
+            const File f (dir.getChildFile (String (i)));
+            f.replaceWithText (getContent (i));
+            builder.addFile (f, (i & 1) * 6, "dir/file" + String (i) + ".txt");
+        }
+
+        // (these should both be stored without compression)
+        const File pngFile (dir.getChildFile ("image.png"));
+        pngFile.replaceWithText (getContent (100));
+        builder.addFile (pngFile, 9, "image.png");
+
+        Random rng (1);
+        MemoryBlock randomData (5000);
+
+        for (int i = 0; i < (int) randomData.getSize(); ++i)
+            randomData[i] = (char) rng.nextInt (256);
+
+        const File randomFile (dir.getChildFile ("random.dat"));
+        randomFile.replaceWithData (randomData.getData(), randomData.getSize());
+        builder.addFile (randomFile, 9, "random.dat");
+
+        const File zipFile (dir.getChildFile ("test.zip"));
+        const File serialZipFile (dir.getChildFile ("serial.zip"));
+
+        {
+            ThreadPool pool (3);
+            FileOutputStream out (zipFile);
+            expect (builder.writeToStream (out, nullptr, &pool));
+        }
+
+        {
+            ThreadPool pool (1);
+            FileOutputStream out (serialZipFile);
+            expect (builder.writeToStream (out, nullptr, &pool));
+        }
+
+        MemoryBlock zipData, serialZipData;
+        zipFile.loadFileAsData (zipData);
+        serialZipFile.loadFileAsData (serialZipData);
+        expect (zipData == serialZipData);
+
+        const int numEntries = numFiles + 2;
+
+        {
+            ZipFile zip (zipFile);
+            checkEntries (zip, numEntries);
+            expect (zip.getMappedDataForEntry (zip.getIndexOfFileName ("image.png")) != nullptr);
+
+            const void* const mappedRandomData = zip.getMappedDataForEntry (zip.getIndexOfFileName ("random.dat"));
+            expect (mappedRandomData != nullptr && memcmp (mappedRandomData, randomData.getData(), randomData.getSize()) == 0);
+
+            const int storedIndex = zip.getIndexOfFileName ("dir/file10.txt");
+            const void* const storedData = zip.getMappedDataForEntry (storedIndex);
+
+            expect (storedData != nullptr
+                     && memcmp (storedData, getContent (10).toUTF8().getAddress(), zip.getEntry (storedIndex)->uncompressedSize) == 0);
+            expect (zip.getMappedDataForEntry (zip.getIndexOfFileName ("dir/file11.txt")) == nullptr);
+
+            zip.sortEntriesByFilename();
+            checkEntries (zip, numEntries);
+        }
+
+        {
+            FileInputStream in (zipFile);
+            ZipFile zip (in);
+            checkEntries (zip, numEntries);
+            expect (zip.getMappedDataForEntry (0) == nullptr);
+        }
+
+        dir.deleteRecursively();
+    }
+};
+
+static ZipFileTests zipFileTests;
+
+#endif
@@ -30,6 +30,8 @@
 #include "../streams/juce_InputSource.h"
 #include "../threads/juce_CriticalSection.h"
 #include "../containers/juce_OwnedArray.h"
+#include "../files/juce_MemoryMappedFile.h"
+#include "../threads/juce_ThreadPool.h"
 
 
 //==============================================================================
@@ -38,11 +40,20 @@
 
     This can enumerate the items in a ZIP file and can create suitable stream objects
     to read each one.
+
+    Looking up an entry by name uses a hash table, so it's quick even for archives
+    with many thousands of entries.
 */
 class JUCE_API  ZipFile
 {
 public:
-    /** Creates a ZipFile based for a file. */
+    /** Creates a ZipFile based for a file.
+
+        If possible, the file is memory-mapped, which means that the streams for its
+        entries can be read on several threads at once without blocking each other,
+        and that the data for uncompressed entries can be used without being copied
+        (see getMappedDataForEntry()). The file is kept open until the ZipFile is deleted.
+    */
     explicit ZipFile (const File& file);
 
     //==============================================================================
@@ -105,6 +116,9 @@ public:
         This uses a case-sensitive comparison to look for a filename in the
         list of entries. It might return -1 if no match is found.
 
+        The entries are indexed by a hash table when the file is opened, so this
+        doesn't have to search through them all.
+
         @see ZipFile::ZipEntry
     */
     int getIndexOfFileName (const String& fileName) const noexcept;
@@ -130,6 +144,11 @@ public:
 
         The stream must not be used after the ZipFile object that created
         has been deleted.
+
+        If the ZipFile was created from a File or an InputSource, each stream reads
+        independently, so different streams can be used on different threads at the
+        same time. If it was created from an InputStream, the streams all have to take
+        turns at reading from it.
     */
     InputStream* createStreamForEntry (int index);
 
@@ -143,6 +162,16 @@ public:
     */
     InputStream* createStreamForEntry (ZipEntry& entry);
 
+    /** If the zip file is memory-mapped, and an entry is stored without compression,
+        this returns a pointer to the entry's data inside the mapped file.
+
+        The data is the entry's uncompressedSize bytes long, and remains valid until the
+        ZipFile is deleted. If the entry is compressed, or the ZipFile wasn't created from
+        a File that could be memory-mapped, this returns nullptr, and you'll need to use
+        createStreamForEntry() instead.
+    */
+    const void* getMappedDataForEntry (int index) const noexcept;
+
     //==============================================================================
     /** Uncompresses all of the files in the zip file.
 
@@ -176,10 +205,10 @@ public:
     /** Used to create a new zip file.
 
         Create a ZipFile::Builder object, and call its addFile() method to add some files,
-        then you can write it to a stream with write().
+        then you can write it to a stream with writeToStream().
 
-        Currently this just stores the files with no compression.. That will be added
-        soon!
+        The files are compressed on several threads at once, and then written out in
+        the order in which they were added.
     */
     class Builder
     {
@@ -192,6 +221,10 @@ public:
             method is called.
 
             The compressionLevel can be between 0 (no compression), and 9 (maximum compression).
+            Files which are already compressed, like PNGs, JPEGs or other zip files, are always
+            stored without compression (based on their file extension), and so is any file that
+            doesn't get any smaller when it's compressed.
+
             If the storedPathName parameter is specified, you can customise the partial pathname that
             will be stored for this file.
         */
@@ -199,14 +232,21 @@ public:
                       const String& storedPathName = String::empty);
 
         /** Generates the zip file, writing it to the specified stream.
+
             If the progress parameter is non-null, it will be updated with an approximate
             progress status between 0 and 1.0
+
+            The files are compressed using the thread pool that's passed in, or if this is
+            nullptr, a temporary pool with a thread for each CPU. Only a limited amount of
+            compressed data is kept in memory before being written to the stream.
         */
-        bool writeToStream (OutputStream& target, double* progress) const;
+        bool writeToStream (OutputStream& target, double* progress,
+                            ThreadPool* threadPool = nullptr) const;
 
         //==============================================================================
     private:
         class Item;
+        class Compressor;
         friend class OwnedArray<Item>;
         OwnedArray<Item> items;
 
@@ -221,10 +261,13 @@ private:
     friend class ZipEntryHolder;
 
     OwnedArray <ZipEntryHolder> entries;
+    HeapBlock <int> nameIndex;
+    int nameIndexSize;
     CriticalSection lock;
     InputStream* inputStream;
     ScopedPointer <InputStream> streamToDelete;
     ScopedPointer <InputSource> inputSource;
+    ScopedPointer <MemoryMappedFile> mappedFile;
 
    #if JUCE_DEBUG
     struct OpenStreamCounter
@@ -239,6 +282,8 @@ private:
    #endif
 
     void init();
+    void buildNameIndex();
+    const char* getMappedData (const ZipEntryHolder&) const noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ZipFile);
 };
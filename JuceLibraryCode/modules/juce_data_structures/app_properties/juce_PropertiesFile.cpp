@@ -27,6 +27,7 @@ namespace PropertyFileConstants
 {
     static const int magicNumber            = (int) ByteOrder::littleEndianInt ("PROP");
     static const int magicNumberCompressed  = (int) ByteOrder::littleEndianInt ("CPRP");
+    static const int magicNumberJournal     = (int) ByteOrder::littleEndianInt ("JPRP");
 
     static const char* const fileTag        = "PROPERTIES";
     static const char* const valueTag       = "VALUE";
@@ -40,6 +41,7 @@ PropertiesFile::Options::Options()
       ignoreCaseOfKeyNames (false),
       millisecondsBeforeSaving (3000),
       storageFormat (PropertiesFile::storeAsXML),
+      saveOnBackgroundThread (true),
       processLock (nullptr)
 {
 }
@@ -102,11 +104,169 @@ File PropertiesFile::Options::getDefaultFile() const
 }
 
 
+//==============================================================================
+/*  The storeAsJournal format starts like the binary format, but with a different
+    magic number, and is followed by any number of records. Each record contains
+    the changes from one save, and is written as:
+
+        int32       the size of the data that follows
+        data:       int32 number of changes, then for each change a byte which is 1 for
+                    a new value or 0 for a removal, the key, and (for a new value) the value
+        int32       a checksum of the data
+
+    Loading stops at the first record that's incomplete or has the wrong checksum, and
+    the next save will overwrite it.
+*/
+namespace PropertyFileHelpers
+{
+    static int getChecksum (const void* const data, const size_t numBytes) noexcept
+    {
+        const uint8* const d = static_cast <const uint8*> (data);
+        uint32 hash = 2166136261u;
+
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ d[i]) * 16777619u;
+
+        return (int) hash;
+    }
+
+    /* When the number of changes that have been appended to a journal goes beyond this,
+       the next save rewrites the whole file.
+    */
+    static int getMaxNumJournalledChanges (const int numProperties) noexcept
+    {
+        return jmax (64, numProperties / 2);
+    }
+}
+
+//==============================================================================
+/*  A set of values to be written to the file - either all of them, or just the
+    ones that have changed since the last save.
+*/
+struct PropertiesFile::Snapshot
+{
+    Snapshot (const bool isFullRewrite_) noexcept
+        : isFullRewrite (isFullRewrite_)
+    {
+    }
+
+    void addChange (const String& key, const String* const newValue)
+    {
+        keys.add (key);
+        values.add (newValue != nullptr ? *newValue : String::empty);
+        removed.add (newValue == nullptr);
+    }
+
+    const bool isFullRewrite;
+    StringArray keys, values;
+    Array<bool> removed;
+
+    JUCE_DECLARE_NON_COPYABLE (Snapshot);
+};
+
+//==============================================================================
+class PropertiesFile::Writer  : public Thread
+{
+public:
+    Writer (PropertiesFile& owner_)
+        : Thread ("PropertiesFile writer"),
+          owner (owner_), isWriting (false), allSucceeded (true)
+    {
+        startThread();
+    }
+
+    ~Writer()
+    {
+        waitUntilIdle();
+        stopThread (10000);
+    }
+
+    void add (Snapshot* const snapshot)
+    {
+        {
+            const ScopedLock sl (queueLock);
+            queue.add (snapshot);
+        }
+
+        notify();
+    }
+
+    bool waitUntilIdle()
+    {
+        for (;;)
+        {
+            {
+                const ScopedLock sl (queueLock);
+
+                if (queue.size() == 0 && ! isWriting)
+                {
+                    const bool ok = allSucceeded;
+                    allSucceeded = true;
+                    return ok;
+                }
+            }
+
+            finished.wait (100);
+        }
+    }
+
+    void run()
+    {
+        // (after a failure, any changes that follow are dropped until the owner sends
+        // a snapshot of all the values)
+        bool droppingChanges = false;
+
+        while (! threadShouldExit())
+        {
+            ScopedPointer<Snapshot> snapshot;
+
+            {
+                const ScopedLock sl (queueLock);
+                snapshot = queue.removeAndReturn (0);
+                isWriting = (snapshot != nullptr);
+            }
+
+            if (snapshot == nullptr)
+            {
+                finished.signal();
+                wait (-1);
+                continue;
+            }
+
+            if (snapshot->isFullRewrite)
+                droppingChanges = false;
+
+            const bool ok = (! droppingChanges) && owner.writeSnapshot (*snapshot);
+
+            if (! ok)
+            {
+                droppingChanges = true;
+                owner.backgroundSaveFailed = 1;
+            }
+
+            const ScopedLock sl (queueLock);
+            isWriting = false;
+            allSucceeded = allSucceeded && ok;
+        }
+    }
+
+private:
+    PropertiesFile& owner;
+    OwnedArray<Snapshot> queue;
+    CriticalSection queueLock;
+    WaitableEvent finished;
+    bool isWriting, allSucceeded;
+
+    JUCE_DECLARE_NON_COPYABLE (Writer);
+};
+
 //==============================================================================
 PropertiesFile::PropertiesFile (const File& file_, const Options& options_)
     : PropertySet (options_.ignoreCaseOfKeyNames),
       file (file_), options (options_),
-      loadedOk (false), needsWriting (false)
+      loadedOk (false), needsWriting (false),
+      needsFullRewrite (true), isChangingOneValue (false),
+      numJournalledChanges (0), journalEnd (0)
 {
     initialise();
 }
@@ -114,7 +274,9 @@ PropertiesFile::PropertiesFile (const File& file_, const Options& options_)
 PropertiesFile::PropertiesFile (const Options& options_)
     : PropertySet (options_.ignoreCaseOfKeyNames),
       file (options_.getDefaultFile()), options (options_),
-      loadedOk (false), needsWriting (false)
+      loadedOk (false), needsWriting (false),
+      needsFullRewrite (true), isChangingOneValue (false),
+      numJournalledChanges (0), journalEnd (0)
 {
     initialise();
 }
@@ -133,7 +295,12 @@ void PropertiesFile::initialise()
     {
         int magicNumber = fileStream->readInt();
 
-        if (magicNumber == PropertyFileConstants::magicNumberCompressed)
+        if (magicNumber == PropertyFileConstants::magicNumberJournal)
+        {
+            fileStream = nullptr;
+            loadedOk = loadJournal();
+        }
+        else if (magicNumber == PropertyFileConstants::magicNumberCompressed)
         {
             fileStream = new GZIPDecompressorInputStream (new SubregionStream (fileStream.release(), 4, -1, true), true);
             magicNumber = PropertyFileConstants::magicNumber;
@@ -142,7 +309,7 @@ void PropertiesFile::initialise()
         if (magicNumber == PropertyFileConstants::magicNumber)
         {
             loadedOk = true;
-            BufferedInputStream in (fileStream.release(), 2048, true);
+            BufferedInputStream in (fileStream.release(), 32768, true);
 
             int numValues = in.readInt();
 
@@ -156,7 +323,7 @@ void PropertiesFile::initialise()
                     getAllProperties().set (key, value);
             }
         }
-        else
+        else if (fileStream != nullptr)
         {
             // Not a binary props file - let's see if it's XML..
             fileStream = nullptr;
@@ -201,10 +368,72 @@ void PropertiesFile::initialise()
     }
 }
 
+bool PropertiesFile::loadJournal()
+{
+    MemoryBlock data;
+
+    if (! file.loadFileAsData (data))
+        return false;
+
+    MemoryInputStream in (data, false);
+    in.readInt(); // (the magic number)
+
+    int numValues = in.readInt();
+
+    while (--numValues >= 0 && ! in.isExhausted())
+    {
+        const String key (in.readString());
+        const String value (in.readString());
+
+        jassert (key.isNotEmpty());
+        if (key.isNotEmpty())
+            getAllProperties().set (key, value);
+    }
+
+    journalEnd = in.getPosition();
+
+    for (;;)
+    {
+        const int recordSize = in.readInt();
+
+        if (recordSize <= 0 || recordSize > in.getNumBytesRemaining() - (int64) sizeof (int))
+            break;
+
+        const char* const record = static_cast <const char*> (data.getData()) + in.getPosition();
+        in.skipNextBytes (recordSize);
+
+        if (in.readInt() != PropertyFileHelpers::getChecksum (record, (size_t) recordSize))
+            break;
+
+        MemoryInputStream changes (record, (size_t) recordSize, false);
+        int numChanges = changes.readInt();
+
+        while (--numChanges >= 0 && ! changes.isExhausted())
+        {
+            const bool isNewValue = changes.readByte() != 0;
+            const String key (changes.readString());
+
+            if (isNewValue)
+                getAllProperties().set (key, changes.readString());
+            else
+                getAllProperties().remove (key);
+
+            ++numJournalledChanges;
+        }
+
+        journalEnd = in.getPosition();
+    }
+
+    needsFullRewrite = (options.storageFormat != storeAsJournal);
+    return true;
+}
+
 PropertiesFile::~PropertiesFile()
 {
     if (! saveIfNeeded())
         jassertfalse;
+
+    writer = nullptr;
 }
 
 InterProcessLock::ScopedLockType* PropertiesFile::createProcessLock() const
@@ -215,13 +444,13 @@ InterProcessLock::ScopedLockType* PropertiesFile::createProcessLock() const
 bool PropertiesFile::saveIfNeeded()
 {
     const ScopedLock sl (getLock());
-    return (! needsWriting) || save();
+    return (! needsToBeSaved()) || save();
 }
 
 bool PropertiesFile::needsToBeSaved() const
 {
     const ScopedLock sl (getLock());
-    return needsWriting;
+    return needsWriting || backgroundSaveFailed.get() != 0;
 }
 
 void PropertiesFile::setNeedsToBeSaved (const bool needsToBeSaved_)
@@ -236,98 +465,244 @@ bool PropertiesFile::save()
 
     stopTimer();
 
+    if (writer != nullptr)
+        writer->waitUntilIdle();
+
+    const ScopedPointer<Snapshot> snapshot (createSnapshot());
+
+    if (writeSnapshot (*snapshot))
+        return true;
+
+    needsWriting = true;
+    needsFullRewrite = true;
+    return false;
+}
+
+void PropertiesFile::saveInBackground()
+{
+    const ScopedLock sl (getLock());
+
+    stopTimer();
+
+    if (needsToBeSaved())
+    {
+        if (writer == nullptr)
+            writer = new Writer (*this);
+
+        writer->add (createSnapshot());
+    }
+}
+
+bool PropertiesFile::waitForBackgroundSave()
+{
+    return writer == nullptr || writer->waitUntilIdle();
+}
+
+PropertiesFile::Snapshot* PropertiesFile::createSnapshot()
+{
+    const ScopedLock sl (getLock());
+
+    const StringPairArray& props = getAllProperties();
+    needsWriting = false;
+
+    if (backgroundSaveFailed.exchange (0) != 0)
+        needsFullRewrite = true;
+
+    if (journalChanges != nullptr && ! needsFullRewrite
+         && numJournalledChanges + journalChanges->keys.size()
+              <= PropertyFileHelpers::getMaxNumJournalledChanges (props.size()))
+    {
+        numJournalledChanges += journalChanges->keys.size();
+        return journalChanges.release();
+    }
+
+    Snapshot* const snapshot = new Snapshot (true);
+    snapshot->keys = props.getAllKeys();
+    snapshot->values = props.getAllValues();
+
+    journalChanges = nullptr;
+    needsFullRewrite = (options.storageFormat != storeAsJournal);
+    numJournalledChanges = 0;
+
+    return snapshot;
+}
+
+bool PropertiesFile::writeSnapshot (const Snapshot& snapshot)
+{
     if (file == File::nonexistent
          || file.isDirectory()
          || ! file.getParentDirectory().createDirectory())
         return false;
 
+    if (! snapshot.isFullRewrite)
+        return appendToJournal (snapshot);
+
     if (options.storageFormat == storeAsXML)
+        return writeAsXml (snapshot);
+
+    return writeAsBinary (snapshot);
+}
+
+bool PropertiesFile::writeAsXml (const Snapshot& snapshot)
+{
+    XmlElement doc (PropertyFileConstants::fileTag);
+
+    for (int i = 0; i < snapshot.keys.size(); ++i)
     {
-        XmlElement doc (PropertyFileConstants::fileTag);
+        XmlElement* const e = doc.createNewChildElement (PropertyFileConstants::valueTag);
+        e->setAttribute (PropertyFileConstants::nameAttribute, snapshot.keys[i]);
 
-        for (int i = 0; i < getAllProperties().size(); ++i)
-        {
-            XmlElement* const e = doc.createNewChildElement (PropertyFileConstants::valueTag);
-            e->setAttribute (PropertyFileConstants::nameAttribute, getAllProperties().getAllKeys() [i]);
+        // if the value seems to contain xml, store it as such..
+        XmlElement* const childElement = XmlDocument::parse (snapshot.values[i]);
 
-            // if the value seems to contain xml, store it as such..
-            XmlElement* const childElement = XmlDocument::parse (getAllProperties().getAllValues() [i]);
+        if (childElement != nullptr)
+            e->addChildElement (childElement);
+        else
+            e->setAttribute (PropertyFileConstants::valueAttribute, snapshot.values[i]);
+    }
 
-            if (childElement != nullptr)
-                e->addChildElement (childElement);
-            else
-                e->setAttribute (PropertyFileConstants::valueAttribute,
-                                 getAllProperties().getAllValues() [i]);
-        }
+    ProcessScopedLock pl (createProcessLock());
 
-        ProcessScopedLock pl (createProcessLock());
+    if (pl != nullptr && ! pl->isLocked())
+        return false; // locking failure..
 
-        if (pl != nullptr && ! pl->isLocked())
-            return false; // locking failure..
+    return doc.writeToFile (file, String::empty);
+}
 
-        if (doc.writeToFile (file, String::empty))
-        {
-            needsWriting = false;
-            return true;
-        }
+bool PropertiesFile::writeAsBinary (const Snapshot& snapshot)
+{
+    ProcessScopedLock pl (createProcessLock());
+
+    if (pl != nullptr && ! pl->isLocked())
+        return false; // locking failure..
+
+    TemporaryFile tempFile (file);
+    ScopedPointer <OutputStream> out (tempFile.getFile().createOutputStream());
+
+    if (out == nullptr)
+        return false;
+
+    if (options.storageFormat == storeAsCompressedBinary)
+    {
+        out->writeInt (PropertyFileConstants::magicNumberCompressed);
+        out->flush();
+
+        out = new GZIPCompressorOutputStream (out.release(), 9, true);
+    }
+    else if (options.storageFormat == storeAsJournal)
+    {
+        out->writeInt (PropertyFileConstants::magicNumberJournal);
     }
     else
     {
-        ProcessScopedLock pl (createProcessLock());
+        // have you set up the storage option flags correctly?
+        jassert (options.storageFormat == storeAsBinary);
 
-        if (pl != nullptr && ! pl->isLocked())
-            return false; // locking failure..
+        out->writeInt (PropertyFileConstants::magicNumber);
+    }
 
-        TemporaryFile tempFile (file);
-        ScopedPointer <OutputStream> out (tempFile.getFile().createOutputStream());
+    const int numProperties = snapshot.keys.size();
 
-        if (out != nullptr)
-        {
-            if (options.storageFormat == storeAsCompressedBinary)
-            {
-                out->writeInt (PropertyFileConstants::magicNumberCompressed);
-                out->flush();
+    out->writeInt (numProperties);
 
-                out = new GZIPCompressorOutputStream (out.release(), 9, true);
-            }
-            else
-            {
-                // have you set up the storage option flags correctly?
-                jassert (options.storageFormat == storeAsBinary);
+    for (int i = 0; i < numProperties; ++i)
+    {
+        out->writeString (snapshot.keys[i]);
+        out->writeString (snapshot.values[i]);
+    }
 
-                out->writeInt (PropertyFileConstants::magicNumber);
-            }
+    const int64 size = out->getPosition();
+    out = nullptr;
 
-            const int numProperties = getAllProperties().size();
+    if (! tempFile.overwriteTargetFileWithTemporary())
+        return false;
 
-            out->writeInt (numProperties);
+    journalEnd = size;
+    return true;
+}
 
-            for (int i = 0; i < numProperties; ++i)
-            {
-                out->writeString (getAllProperties().getAllKeys() [i]);
-                out->writeString (getAllProperties().getAllValues() [i]);
-            }
+bool PropertiesFile::appendToJournal (const Snapshot& changes)
+{
+    MemoryOutputStream data;
+    data.writeInt (changes.keys.size());
 
-            out = nullptr;
+    for (int i = 0; i < changes.keys.size(); ++i)
+    {
+        data.writeByte (changes.removed.getUnchecked (i) ? 0 : 1);
+        data.writeString (changes.keys[i]);
 
-            if (tempFile.overwriteTargetFileWithTemporary())
-            {
-                needsWriting = false;
-                return true;
-            }
-        }
+        if (! changes.removed.getUnchecked (i))
+            data.writeString (changes.values[i]);
     }
 
-    return false;
+    MemoryOutputStream record ((size_t) data.getDataSize() + 8);
+    record.writeInt ((int) data.getDataSize());
+    record << data;
+    record.writeInt (PropertyFileHelpers::getChecksum (data.getData(), data.getDataSize()));
+
+    ProcessScopedLock pl (createProcessLock());
+
+    if (pl != nullptr && ! pl->isLocked())
+        return false; // locking failure..
+
+    // (if the file has been deleted or replaced, it'll need to be rewritten from scratch)
+    if (file.getSize() < journalEnd)
+        return false;
+
+    FileOutputStream out (file);
+
+    if (out.failedToOpen()
+         || ! out.setPosition (journalEnd)
+         || out.truncate().failed()
+         || ! out.write (record.getData(), (int) record.getDataSize()))
+        return false;
+
+    out.flush();
+
+    if (out.getStatus().failed())
+        return false;
+
+    journalEnd = out.getPosition();
+    return true;
 }
 
 void PropertiesFile::timerCallback()
 {
-    saveIfNeeded();
+    if (options.saveOnBackgroundThread)
+        saveInBackground();
+    else
+        saveIfNeeded();
+}
+
+void PropertiesFile::valueChanged (const String& keyName, const String* const newValue)
+{
+    if (options.storageFormat == storeAsJournal && ! needsFullRewrite)
+    {
+        if (journalChanges == nullptr)
+            journalChanges = new Snapshot (false);
+
+        journalChanges->addChange (keyName, newValue);
+
+        // (if this many changes have built up, it'll be quicker to rewrite the whole file)
+        if (journalChanges->keys.size() > PropertyFileHelpers::getMaxNumJournalledChanges (getAllProperties().size()))
+        {
+            journalChanges = nullptr;
+            needsFullRewrite = true;
+        }
+    }
+
+    const ScopedValueSetter<bool> svs (isChangingOneValue, true);
+    PropertySet::valueChanged (keyName, newValue);
 }
 
 void PropertiesFile::propertyChanged()
 {
+    if (! isChangingOneValue)
+    {
+        journalChanges = nullptr;
+        needsFullRewrite = true;
+    }
+
     sendChangeMessage();
 
     needsWriting = true;
@@ -337,3 +712,129 @@ void PropertiesFile::propertyChanged()
     else if (options.millisecondsBeforeSaving == 0)
         saveIfNeeded();
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PropertiesFileTests  : public UnitTest
+{
+public:
+    PropertiesFileTests() : UnitTest ("PropertiesFile") {}
+
+    static PropertiesFile::Options createOptions (const PropertiesFile::StorageFormat format)
+    {
+        PropertiesFile::Options options;
+        options.millisecondsBeforeSaving = -1;
+        options.storageFormat = format;
+        return options;
+    }
+
+    void expectValues (const File& file, const PropertiesFile::Options& options,
+                       const int numValues, const String& changedValue)
+    {
+        PropertiesFile props (file, options);
+        expect (props.isValidFile());
+        expectEquals (props.getAllProperties().size(), numValues);
+        expectEquals (props.getValue ("key5"), changedValue);
+        expectEquals (props.getIntValue ("key99"), 99);
+    }
+
+    void runTest()
+    {
+        const TemporaryFile temp (".settings");
+        const File& file = temp.getFile();
+        const PropertiesFile::Options options (createOptions (PropertiesFile::storeAsJournal));
+
+        beginTest ("Journal");
+
+        int64 fullSize = 0;
+
+        {
+            PropertiesFile props (file, options);
+
+            for (int i = 0; i < 100; ++i)
+                props.setValue ("key" + String (i), i);
+
+            expect (props.save());
+            fullSize = file.getSize();
+
+            props.setValue ("key5", "changed");
+            props.removeValue ("key6");
+            expect (props.save());
+            expect (file.getSize() > fullSize && file.getSize() < fullSize + 64);
+        }
+
+        expectValues (file, options, 99, "changed");
+
+        beginTest ("Journal recovery");
+
+        {
+            const int64 size = file.getSize();
+
+            {
+                PropertiesFile props (file, options);
+                props.setValue ("key5", "lost");
+            }
+
+            // (this simulates a crash while the last change was being written)
+            FileOutputStream out (file);
+            out.setPosition (size + 10);
+            out.truncate();
+        }
+
+        expectValues (file, options, 99, "changed");
+
+        {
+            PropertiesFile props (file, options);
+            props.setValue ("key5", "kept");
+        }
+
+        expectValues (file, options, 99, "kept");
+
+        beginTest ("Compaction");
+
+        {
+            PropertiesFile props (file, options);
+
+            for (int i = 0; i < 500; ++i)
+            {
+                props.setValue ("key5", i);
+                expect (props.save());
+            }
+
+            expect (file.getSize() < fullSize * 3);
+        }
+
+        expectValues (file, options, 99, "499");
+
+        beginTest ("Background saves");
+
+        const int formats[] = { PropertiesFile::storeAsXML, PropertiesFile::storeAsCompressedBinary, PropertiesFile::storeAsJournal };
+
+        for (int i = 0; i < numElementsInArray (formats); ++i)
+        {
+            const PropertiesFile::Options formatOptions (createOptions ((PropertiesFile::StorageFormat) formats[i]));
+
+            {
+                PropertiesFile props (file, formatOptions);
+
+                for (int j = 0; j < 50; ++j)
+                {
+                    props.setValue ("key5", j);
+                    props.saveInBackground();
+                }
+
+                props.setValue ("key5", "background");
+                props.saveInBackground();
+                expect (props.waitForBackgroundSave());
+                expect (! props.needsToBeSaved());
+            }
+
+            expectValues (file, formatOptions, 99, "background");
+        }
+    }
+};
+
+static PropertiesFileTests propertiesFileTests;
+
+#endif
@@ -36,6 +36,10 @@
     Not designed for very large amounts of data, as it keeps all the values in
     memory and writes them out to disk lazily when they are changed.
 
+    Saves that are triggered by the timer are normally done on a background thread
+    (see Options::saveOnBackgroundThread), and if the storeAsJournal format is used,
+    a save only has to append the values that have changed since the last one.
+
     Because this class derives from ChangeBroadcaster, ChangeListeners can be registered
     with it, and these will be signalled when a value changes.
 
@@ -51,7 +55,14 @@ public:
     {
         storeAsBinary,
         storeAsCompressedBinary,
-        storeAsXML
+        storeAsXML,
+
+        /** A binary format to which each save appends just the values that have changed.
+            Every so often, the whole file is rewritten so that it doesn't keep growing.
+            If the app crashes while appending to the file, the last complete save will
+            be loaded next time.
+        */
+        storeAsJournal
     };
 
     //==============================================================================
@@ -123,6 +134,13 @@ public:
         */
         StorageFormat storageFormat;
 
+        /** If true, saves that are triggered by the millisecondsBeforeSaving timer will take a
+            snapshot of the values, and then write the file on a background thread, so that the
+            message thread isn't held up. Calls to save() and saveIfNeeded() are always synchronous.
+            The default constructor sets this to true.
+        */
+        bool saveOnBackgroundThread;
+
         /** An optional InterprocessLock object that will be used to prevent multiple threads or
             processes from writing to the file at the same time. The PropertiesFile will keep a
             pointer to this object but will not take ownership of it - the caller is responsible for
@@ -210,6 +228,22 @@ public:
     */
     void setNeedsToBeSaved (bool needsToBeSaved);
 
+    /** If the values have changed since the last save, this takes a snapshot of them and
+        returns immediately, leaving a background thread to write the file.
+
+        Any later call to save() or saveIfNeeded() will wait for the background thread to
+        finish before writing the file. If a background save fails, needsToBeSaved() will
+        return true again.
+
+        @see waitForBackgroundSave
+    */
+    void saveInBackground();
+
+    /** Blocks until any saves which were started by saveInBackground() have finished.
+        Returns false if any of them failed.
+    */
+    bool waitForBackgroundSave();
+
     //==============================================================================
     /** Returns the file that's being used. */
     File getFile() const                              { return file; }
@@ -218,18 +252,35 @@ public:
 protected:
     /** @internal */
     virtual void propertyChanged();
+    /** @internal */
+    void valueChanged (const String&, const String*);
 
 private:
     //==============================================================================
+    struct Snapshot;
+    class Writer;
+    friend class Writer;
+
     File file;
     Options options;
-    bool loadedOk, needsWriting;
+    bool loadedOk, needsWriting, needsFullRewrite, isChangingOneValue;
+    ScopedPointer<Snapshot> journalChanges;
+    int numJournalledChanges;
+    int64 journalEnd;
+    Atomic<int> backgroundSaveFailed;
+    ScopedPointer<Writer> writer;
 
     typedef const ScopedPointer<InterProcessLock::ScopedLockType> ProcessScopedLock;
     InterProcessLock::ScopedLockType* createProcessLock() const;
 
     void timerCallback();
     void initialise();
+    bool loadJournal();
+    Snapshot* createSnapshot();
+    bool writeSnapshot (const Snapshot&);
+    bool writeAsXml (const Snapshot&);
+    bool writeAsBinary (const Snapshot&);
+    bool appendToJournal (const Snapshot&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PropertiesFile);
 };
@@ -23,24 +23,421 @@
   ==============================================================================
 */
 
+//==============================================================================
+/*  The format used by ValueTree::writeToCompactStream() is:
+
+    - the header "JVT1"
+    - the nodes, each of which is written after all of its children:
+        varint: the node's type, as an index into the string table
+        varint: the number of properties, followed by each property's name (as a
+                string table index) and its value
+        varint: the number of children, followed by the distance in bytes from the
+                start of each child to the start of this node
+    - the string table: a varint count, then each string as a varint byte count and
+      its UTF-8 data
+    - the footer: the positions of the string table and of the root node, as
+      little-endian int64s, and then "JVT1" again
+
+    Varints are stored as 7 bits per byte, least significant first, with the top bit
+    set on all but the last byte. Values are stored as a tag byte followed by:
+        - an int or int64: a varint holding the number zigzag-encoded (0, -1, 1, -2..)
+        - a bool: nothing (the tag says whether it's true or false)
+        - a double: its 8 bytes, little-endian
+        - a string: a varint byte count and its UTF-8 data
+        - an array: a varint count, then each value
+        - anything else: a varint byte count and the data from var::writeToStream()
+*/
+namespace ValueTreeCompactFormat
+{
+    static const char magic[] = "JVT1";
+    enum { magicSize = 4, footerSize = 8 + 8 + magicSize };
+
+    enum ValueTags
+    {
+        tagVoid = 0,
+        tagInt,
+        tagInt64,
+        tagBoolTrue,
+        tagBoolFalse,
+        tagDouble,
+        tagString,
+        tagArray,
+        tagOther
+    };
+
+    inline uint64 zigzagEncode (const int64 n) noexcept    { return (((uint64) n) << 1) ^ (uint64) (n >> 63); }
+    inline int64 zigzagDecode (const uint64 n) noexcept    { return ((int64) (n >> 1)) ^ -((int64) (n & 1)); }
+
+    static Identifier createIdentifier (const char* const start, const char* const end)
+    {
+       #if JUCE_STRING_UTF_TYPE == 8
+        return Identifier (String::CharPointerType (start), String::CharPointerType (end));
+       #else
+        return Identifier (String (CharPointer_UTF8 (start), CharPointer_UTF8 (end)));
+       #endif
+    }
+
+    //==============================================================================
+    class Writer
+    {
+    public:
+        Writer (OutputStream& out_)
+            : out (out_), startPosition (out_.getPosition())
+        {
+        }
+
+        int64 getPosition() const                   { return out.getPosition() - startPosition; }
+
+        void writeVarint (uint64 n)
+        {
+            uint8 data [10];
+            int numBytes = 0;
+
+            while (n >= 0x80)
+            {
+                data [numBytes++] = (uint8) (n | 0x80);
+                n >>= 7;
+            }
+
+            data [numBytes++] = (uint8) n;
+            out.write (data, (size_t) numBytes);
+        }
+
+        void writeIdentifier (const Identifier& name)
+        {
+            const var* const existing = identifierIndexes.getVarPointer (name);
+
+            if (existing != nullptr)
+            {
+                writeVarint ((uint64) static_cast <int> (*existing));
+            }
+            else
+            {
+                identifierIndexes.set (name, identifiers.size());
+                writeVarint ((uint64) identifiers.size());
+                identifiers.add (name);
+            }
+        }
+
+        void writeString (const String& s)
+        {
+            const size_t numBytes = s.getNumBytesAsUTF8();
+            writeVarint (numBytes);
+            out.write (s.toUTF8().getAddress(), numBytes);
+        }
+
+        void writeValue (const var& v)
+        {
+            if (v.isVoid())             { out.writeByte (tagVoid); }
+            else if (v.isInt())         { out.writeByte (tagInt);   writeVarint (zigzagEncode (static_cast <int> (v))); }
+            else if (v.isInt64())       { out.writeByte (tagInt64); writeVarint (zigzagEncode (static_cast <int64> (v))); }
+            else if (v.isBool())        { out.writeByte (static_cast <bool> (v) ? tagBoolTrue : tagBoolFalse); }
+            else if (v.isDouble())      { out.writeByte (tagDouble); out.writeDouble (static_cast <double> (v)); }
+            else if (v.isString())      { out.writeByte (tagString); writeString (v.toString()); }
+            else if (v.isArray())
+            {
+                const Array<var>& array = *v.getArray();
+                out.writeByte (tagArray);
+                writeVarint ((uint64) array.size());
+
+                for (int i = 0; i < array.size(); ++i)
+                    writeValue (array.getReference (i));
+            }
+            else
+            {
+                MemoryOutputStream mo;
+                v.writeToStream (mo);
+                out.writeByte (tagOther);
+                writeVarint (mo.getDataSize());
+                out.write (mo.getData(), mo.getDataSize());
+            }
+        }
+
+        void writeFooter (const int64 rootPosition)
+        {
+            const int64 stringTablePosition = getPosition();
+            writeVarint ((uint64) identifiers.size());
+
+            for (int i = 0; i < identifiers.size(); ++i)
+                writeString (identifiers.getReference (i).toString());
+
+            out.writeInt64 (stringTablePosition);
+            out.writeInt64 (rootPosition);
+            out.write (magic, magicSize);
+        }
+
+        OutputStream& out;
+
+    private:
+        const int64 startPosition;
+        Array<Identifier> identifiers;
+        NamedValueSet identifierIndexes;
+
+        JUCE_DECLARE_NON_COPYABLE (Writer);
+    };
+
+    //==============================================================================
+    /* Reads values from a block of data, and keeps track of whether it's gone past the end. */
+    class Reader
+    {
+    public:
+        Reader (const uint8* const start, const uint8* const end_) noexcept
+            : p (start), end (end_), failed (false)
+        {
+        }
+
+        uint64 readVarint() noexcept
+        {
+            uint64 n = 0;
+
+            for (int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                const uint8 byte = *p++;
+                n |= ((uint64) (byte & 0x7f)) << shift;
+
+                if (byte < 0x80)
+                    return n;
+            }
+
+            failed = true;
+            return 0;
+        }
+
+        /* Returns a count, which can't be more than the number of bytes left, since each
+           item takes at least one byte.
+        */
+        int readCount() noexcept
+        {
+            const uint64 n = readVarint();
+
+            if (n <= (uint64) (end - p))
+                return (int) n;
+
+            failed = true;
+            return 0;
+        }
+
+        const char* readBytes (const size_t numBytes) noexcept
+        {
+            if (numBytes > (size_t) (end - p))
+            {
+                failed = true;
+                return nullptr;
+            }
+
+            const uint8* const start = p;
+            p += numBytes;
+            return reinterpret_cast <const char*> (start);
+        }
+
+        String readString()
+        {
+            const size_t numBytes = (size_t) readCount();
+            const char* const start = readBytes (numBytes);
+
+            return (start != nullptr && numBytes > 0) ? String (CharPointer_UTF8 (start), CharPointer_UTF8 (start + numBytes))
+                                                      : String::empty;
+        }
+
+        var readValue (const int depth = 0)
+        {
+            const char* const tag = readBytes (1);
+
+            if (tag == nullptr)
+                return var::null;
+
+            switch (*tag)
+            {
+                case tagVoid:       return var::null;
+                case tagInt:        return (int) zigzagDecode (readVarint());
+                case tagInt64:      return zigzagDecode (readVarint());
+                case tagBoolTrue:   return var (true);
+                case tagBoolFalse:  return var (false);
+                case tagString:     return readString();
+
+                case tagDouble:
+                {
+                    const char* const data = readBytes (8);
+
+                    if (data == nullptr)
+                        return var::null;
+
+                    union { uint64 asInt; double asDouble; } n;
+                    memcpy (&n.asInt, data, 8);
+                    n.asInt = ByteOrder::swapIfBigEndian (n.asInt);
+                    return n.asDouble;
+                }
+
+                case tagArray:
+                {
+                    const int num = readCount();
+                    var v;
+
+                    if (depth < 100)
+                    {
+                        Array<var> values;
+                        values.ensureStorageAllocated (num);
+
+                        for (int i = 0; i < num && ! failed; ++i)
+                            values.add (readValue (depth + 1));
+
+                        v = values;
+                    }
+                    else
+                    {
+                        failed = true;
+                    }
+
+                    return v;
+                }
+
+                case tagOther:
+                {
+                    const size_t numBytes = (size_t) readCount();
+                    const char* const data = readBytes (numBytes);
+
+                    if (data == nullptr)
+                        return var::null;
+
+                    MemoryInputStream in (data, numBytes, false);
+                    return var::readFromStream (in);
+                }
+
+                default:
+                    failed = true;
+                    return var::null;
+            }
+        }
+
+        const uint8* p;
+        const uint8* end;
+        bool failed;
+    };
+
+    //==============================================================================
+    /* Holds the data that a lazily-loaded tree is being read from. Each node that hasn't
+       been loaded yet keeps a reference to this, so that it stays around for as long as
+       it's needed.
+    */
+    class Data  : public ReferenceCountedObject
+    {
+    public:
+        typedef ReferenceCountedObjectPtr<Data> Ptr;
+
+        Data (MemoryMappedFile* const file)
+            : rootPosition (0), stringTablePosition (0), mappedFile (file)
+        {
+            data = static_cast <const uint8*> (file->getData());
+            size = file->getSize();
+        }
+
+        Data (const void* const sourceData, const size_t numBytes)
+            : rootPosition (0), stringTablePosition (0), block (sourceData, numBytes)
+        {
+            data = static_cast <const uint8*> (block.getData());
+            size = block.getSize();
+        }
+
+        /* Checks the header and footer, and reads the string table. */
+        bool initialise()
+        {
+            if (data == nullptr || size < magicSize + footerSize
+                 || memcmp (data, magic, magicSize) != 0
+                 || memcmp (data + size - magicSize, magic, magicSize) != 0)
+                return false;
+
+            const uint8* const footer = data + size - footerSize;
+            uint64 positions[2];
+            memcpy (positions, footer, sizeof (positions));
+            const uint64 stringTable = ByteOrder::swapIfBigEndian (positions[0]);
+            const uint64 root = ByteOrder::swapIfBigEndian (positions[1]);
+
+            if (stringTable > (uint64) (size - footerSize) || root < magicSize || root >= stringTable)
+                return false;
+
+            stringTablePosition = (size_t) stringTable;
+            rootPosition = (size_t) root;
+
+            Reader reader (data + stringTablePosition, footer);
+            const int numStrings = reader.readCount();
+            identifiers.ensureStorageAllocated (numStrings);
+
+            for (int i = 0; i < numStrings; ++i)
+            {
+                const size_t numBytes = (size_t) reader.readCount();
+                const char* const start = reader.readBytes (numBytes);
+
+                if (start == nullptr || numBytes == 0)
+                    return false;
+
+                identifiers.add (createIdentifier (start, start + numBytes));
+            }
+
+            return ! reader.failed;
+        }
+
+        /* Returns a reader that starts at the given position, and stops at the end of the nodes. */
+        Reader createReader (const size_t position) const noexcept
+        {
+            return Reader (data + jmin (position, stringTablePosition), data + stringTablePosition);
+        }
+
+        Identifier getIdentifier (const uint64 index) const
+        {
+            if (index < (uint64) identifiers.size())
+                return identifiers.getReference ((int) index);
+
+            jassertfalse; // corrupted data!
+            return Identifier();
+        }
+
+        const uint8* data;
+        size_t size, rootPosition, stringTablePosition;
+
+    private:
+        ScopedPointer<MemoryMappedFile> mappedFile;
+        MemoryBlock block;
+        Array<Identifier> identifiers;
+
+        JUCE_DECLARE_NON_COPYABLE (Data);
+    };
+}
+
+//==============================================================================
 class ValueTree::SharedObject  : public ReferenceCountedObject
 {
 public:
     typedef ReferenceCountedObjectPtr<SharedObject> Ptr;
 
     explicit SharedObject (const Identifier& type_) noexcept
-        : type (type_), parent (nullptr)
+        : type (type_), parent (nullptr), compactDataPosition (0)
+    {
+    }
+
+    /* Creates an object whose properties and children will be read from the compact data
+       the first time they're needed.
+    */
+    SharedObject (const ValueTreeCompactFormat::Data::Ptr& data, const size_t position)
+        : type (readCompactType (*data, position)), parent (nullptr),
+          compactData (data), compactDataPosition (position)
     {
     }
 
     SharedObject (const SharedObject& other)
-        : type (other.type), properties (other.properties), parent (nullptr)
+        : type (other.type), parent (nullptr),
+          compactData (other.compactData), compactDataPosition (other.compactDataPosition)
     {
-        for (int i = 0; i < other.children.size(); ++i)
+        // (if the other object hasn't been loaded yet, this one can just share its data)
+        if (compactData == nullptr)
         {
-            SharedObject* const child = new SharedObject (*other.children.getObjectPointerUnchecked(i));
-            child->parent = this;
-            children.add (child);
+            properties = other.properties;
+
+            for (int i = 0; i < other.children.size(); ++i)
+            {
+                SharedObject* const child = new SharedObject (*other.children.getObjectPointerUnchecked(i));
+                child->parent = this;
+                children.add (child);
+            }
         }
     }
 
@@ -131,8 +528,6 @@ public:
 
     void sendParentChangeMessage()
     {
-        ValueTree tree (this);
-
         for (int j = children.size(); --j >= 0;)
         {
             SharedObject* const child = children.getObjectPointer (j);
@@ -140,6 +535,13 @@ public:
                 child->sendParentChangeMessage();
         }
 
+        // (this avoids creating a ValueTree when there are no listeners, because that
+        // would load the object if it came from compact data)
+        if (valueTreesWithListeners.size() == 0)
+            return;
+
+        ValueTree tree (this);
+
         for (int i = valueTreesWithListeners.size(); --i >= 0;)
         {
             ValueTree* const v = valueTreesWithListeners[i];
@@ -251,6 +653,7 @@ public:
         for (int i = 0; i < children.size(); ++i)
         {
             SharedObject* const s = children.getObjectPointerUnchecked (i);
+            s->loadIfNeeded();
             if (s->getProperty (propertyName) == propertyValue)
                 return ValueTree (s);
         }
@@ -400,6 +803,9 @@ public:
 
     bool isEquivalentTo (const SharedObject& other) const
     {
+        loadIfNeeded();
+        other.loadIfNeeded();
+
         if (type != other.type
              || properties.size() != other.properties.size()
              || children.size() != other.children.size()
@@ -415,6 +821,7 @@ public:
 
     XmlElement* createXml() const
     {
+        loadIfNeeded();
         XmlElement* const xml = new XmlElement (type.toString());
         properties.copyToXmlAttributes (*xml);
 
@@ -426,6 +833,7 @@ public:
 
     void writeToStream (OutputStream& output) const
     {
+        loadIfNeeded();
         output.writeString (type.toString());
         output.writeCompressedInt (properties.size());
 
@@ -455,6 +863,48 @@ public:
         }
     }
 
+    // Writes this object and its children, and returns the position of this object in the data.
+    int64 writeToCompactStream (ValueTreeCompactFormat::Writer& writer) const
+    {
+        loadIfNeeded();
+
+        Array<int64> childPositions;
+        childPositions.ensureStorageAllocated (children.size());
+
+        for (int i = 0; i < children.size(); ++i)
+            childPositions.add (children.getObjectPointerUnchecked(i)->writeToCompactStream (writer));
+
+        const int64 position = writer.getPosition();
+        writer.writeIdentifier (type);
+        writer.writeVarint ((uint64) properties.size());
+
+        for (int i = 0; i < properties.size(); ++i)
+        {
+            writer.writeIdentifier (properties.getName (i));
+            writer.writeValue (properties.getValueAt (i));
+        }
+
+        writer.writeVarint ((uint64) children.size());
+
+        for (int i = 0; i < childPositions.size(); ++i)
+            writer.writeVarint ((uint64) (position - childPositions.getUnchecked (i)));
+
+        return position;
+    }
+
+    //==============================================================================
+    /* If this object was created from compact data and hasn't been used yet, this reads
+       its properties, and creates (unloaded) objects for its children.
+
+       Any object that a ValueTree refers to has always been loaded, so this only needs
+       to be called when looking at the properties or children of an object's children.
+    */
+    void loadIfNeeded() const
+    {
+        if (compactData != nullptr)
+            const_cast <SharedObject*> (this)->loadFromCompactData();
+    }
+
     //==============================================================================
     class SetPropertyAction  : public UndoableAction
     {
@@ -624,6 +1074,54 @@ public:
     SharedObject* parent;
 
 private:
+    ValueTreeCompactFormat::Data::Ptr compactData;
+    size_t compactDataPosition;
+
+    static Identifier readCompactType (const ValueTreeCompactFormat::Data& data, const size_t position)
+    {
+        ValueTreeCompactFormat::Reader reader (data.createReader (position));
+        return data.getIdentifier (reader.readVarint());
+    }
+
+    void loadFromCompactData()
+    {
+        const ValueTreeCompactFormat::Data::Ptr data (compactData);
+        compactData = nullptr;
+
+        ValueTreeCompactFormat::Reader reader (data->createReader (compactDataPosition));
+        reader.readVarint(); // (the type, which has already been read)
+
+        const int numProperties = reader.readCount();
+
+        for (int i = 0; i < numProperties && ! reader.failed; ++i)
+        {
+            const Identifier name (data->getIdentifier (reader.readVarint()));
+            const var value (reader.readValue());
+            properties.set (name, value);
+        }
+
+        const int numChildren = reader.readCount();
+        children.ensureStorageAllocated (numChildren);
+
+        for (int i = 0; i < numChildren && ! reader.failed; ++i)
+        {
+            const uint64 distance = reader.readVarint();
+
+            // (children always come before their parent, so corrupted data can't create a loop)
+            if (distance == 0 || distance > compactDataPosition)
+            {
+                reader.failed = true;
+                break;
+            }
+
+            SharedObject* const child = new SharedObject (data, compactDataPosition - (size_t) distance);
+            child->parent = this;
+            children.add (child);
+        }
+
+        jassert (! reader.failed); // trying to read corrupted data!
+    }
+
     SharedObject& operator= (const SharedObject&);
     JUCE_LEAK_DETECTOR (SharedObject);
 };
@@ -644,6 +1142,8 @@ ValueTree::ValueTree (const Identifier& type_)
 ValueTree::ValueTree (SharedObject* const object_)
     : object (object_)
 {
+    if (object_ != nullptr)
+        object_->loadIfNeeded();
 }
 
 ValueTree::ValueTree (const ValueTree& other)
@@ -1012,7 +1512,54 @@ ValueTree ValueTree::readFromGZIPData (const void* const data, const size_t numB
 {
     MemoryInputStream in (data, numBytes, false);
     GZIPDecompressorInputStream gzipStream (in);
-    return readFromStream (gzipStream);
+    BufferedInputStream bufferedStream (gzipStream, 32768);
+    return readFromStream (bufferedStream);
+}
+
+//==============================================================================
+void ValueTree::writeToCompactStream (OutputStream& output) const
+{
+    jassert (object != nullptr); // an invalid tree can't be written!
+
+    if (object != nullptr)
+    {
+        ValueTreeCompactFormat::Writer writer (output);
+        writer.out.write (ValueTreeCompactFormat::magic, ValueTreeCompactFormat::magicSize);
+        writer.writeFooter (object->writeToCompactStream (writer));
+    }
+}
+
+ValueTree ValueTree::readFromCompactFile (const File& file)
+{
+    ScopedPointer<MemoryMappedFile> mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+    ValueTreeCompactFormat::Data::Ptr data;
+
+    if (mappedFile->getData() != nullptr)
+    {
+        data = new ValueTreeCompactFormat::Data (mappedFile.release());
+    }
+    else
+    {
+        MemoryBlock block;
+
+        if (file.loadFileAsData (block))
+            data = new ValueTreeCompactFormat::Data (block.getData(), block.getSize());
+    }
+
+    if (data == nullptr || ! data->initialise())
+        return ValueTree::invalid;
+
+    return ValueTree (new SharedObject (data, data->rootPosition));
+}
+
+ValueTree ValueTree::readFromCompactData (const void* const data, const size_t numBytes)
+{
+    ValueTreeCompactFormat::Data::Ptr compactData (new ValueTreeCompactFormat::Data (data, numBytes));
+
+    if (! compactData->initialise())
+        return ValueTree::invalid;
+
+    return ValueTree (new SharedObject (compactData, compactData->rootPosition));
 }
 
 //==============================================================================
@@ -1099,6 +1646,37 @@ public:
             ValueTree v4 = v2.createCopy();
             expect (v1.isEquivalentTo (v4));
         }
+
+        beginTest ("Compact format");
+
+        for (int i = 10; --i >= 0;)
+        {
+            ValueTree v1 (createRandomTree (nullptr, 0));
+            v1.setProperty ("int64", (int64) -1234567890123, nullptr);
+
+            var array;
+            array.append (1);
+            array.append ("two");
+            v1.setProperty ("array", array, nullptr);
+
+            MemoryOutputStream mo;
+            v1.writeToCompactStream (mo);
+
+            // (a copy of an unloaded tree should share its data)
+            const ValueTree v2 (ValueTree::readFromCompactData (mo.getData(), mo.getDataSize()).createCopy());
+            expect (v1.isEquivalentTo (v2));
+            expect (v2 ["int64"] == v1 ["int64"]);
+            expect (v2 ["array"][1].toString() == "two");
+
+            for (int j = 0; j < v1.getNumChildren(); ++j)
+                expect (v2.getChild (j).getParent() == v2 && v1.getChild (j).isEquivalentTo (v2.getChild (j)));
+        }
+
+        {
+            const char garbage[] = "JVT1 this isn't a tree JVT1";
+            expect (! ValueTree::readFromCompactData (garbage, sizeof (garbage) - 1).isValid());
+            expect (! ValueTree::readFromCompactData (nullptr, 0).isValid());
+        }
     }
 };
 
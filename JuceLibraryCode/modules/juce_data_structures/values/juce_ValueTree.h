@@ -350,6 +350,42 @@ public:
     */
     static ValueTree readFromGZIPData (const void* data, size_t numBytes);
 
+    //==============================================================================
+    /** Stores this tree (and all its children) in a compact binary format which can be
+        loaded lazily.
+
+        Unlike writeToStream(), this format keeps each type and property name just once,
+        in a table at the end of the data, and stores the position of each node's children,
+        so that a node can be read without reading any of the rest of the tree. The tree
+        is written as it's traversed, so it's never copied, and the stream doesn't need
+        to be seekable.
+
+        Once written, the data can be read back with readFromCompactData() or
+        readFromCompactFile().
+    */
+    void writeToCompactStream (OutputStream& output) const;
+
+    /** Loads a tree from a file that was written with writeToCompactStream().
+
+        The file is memory-mapped, and only the root node's type is read immediately - the
+        properties and children of each node are only read when they're first used. So
+        opening even a very large file is almost instant, and parts of the tree that are
+        never looked at don't cost anything. The file is kept open until all of the tree's
+        nodes have been loaded or deleted, so you shouldn't modify it while a tree that
+        came from it is still in use.
+
+        If the file isn't in the right format, this returns ValueTree::invalid.
+    */
+    static ValueTree readFromCompactFile (const File& file);
+
+    /** Loads a tree from a block of data that was written with writeToCompactStream().
+
+        This makes a copy of the data, and reads it lazily in the same way as
+        readFromCompactFile(). If the data isn't in the right format, this returns
+        ValueTree::invalid.
+    */
+    static ValueTree readFromCompactData (const void* data, size_t numBytes);
+
     //==============================================================================
     /** Listener class for events that happen to a ValueTree.
 
@@ -25,13 +25,13 @@
 
 
 LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image& image)
-    : savedState (new RenderingHelpers::SoftwareRendererSavedState (image, image.getBounds()))
+    : savedState (new RenderingHelpers::SoftwareRendererSavedState (image, image.getBounds(), &regionPool))
 {
 }
 
 LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image& image, const Point<int>& origin,
                                                                     const RectangleList& initialClip)
-    : savedState (new RenderingHelpers::SoftwareRendererSavedState (image, initialClip, origin.x, origin.y))
+    : savedState (new RenderingHelpers::SoftwareRendererSavedState (image, initialClip, origin.x, origin.y, &regionPool))
 {
 }
 
@@ -148,3 +148,139 @@ void LowLevelGraphicsSoftwareRenderer::drawGlyph (int glyphNumber, const AffineT
 
 void LowLevelGraphicsSoftwareRenderer::setFont (const Font& newFont)    { savedState->font = newFont; }
 const Font& LowLevelGraphicsSoftwareRenderer::getFont()                 { return savedState->font; }
+
+LowLevelGraphicsSoftwareRenderer::GlyphCacheStatistics LowLevelGraphicsSoftwareRenderer::getGlyphCacheStatistics()
+{
+    using namespace RenderingHelpers;
+
+    GlyphCacheStatistics stats;
+    GlyphCache <CachedGlyphEdgeTable <SoftwareRendererSavedState>, SoftwareRendererSavedState>::getInstance()
+        .getStatistics (stats.numGlyphSlots, stats.numHits, stats.numMisses);
+    return stats;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SoftwareRendererTests  : public UnitTest
+{
+public:
+    SoftwareRendererTests() : UnitTest ("LowLevelGraphicsSoftwareRenderer") {}
+
+    enum { cellSize = 20, numCells = 10 };
+
+    static Colour getCellColour (const int x, const int y) noexcept
+    {
+        return Colour ((uint8) (x * 20), (uint8) (y * 20), (uint8) 100);
+    }
+
+    // Paints a grid of cells, each one clipped the way that a component's would be.
+    static void paintGrid (LowLevelGraphicsSoftwareRenderer& renderer)
+    {
+        renderer.saveState();
+
+        {
+            Graphics g (&renderer);
+            g.fillAll (Colours::white);
+
+            for (int y = 0; y < numCells; ++y)
+            {
+                for (int x = 0; x < numCells; ++x)
+                {
+                    g.saveState();
+                    g.setOrigin (x * cellSize, y * cellSize);
+                    g.reduceClipRegion (0, 0, cellSize, cellSize);
+                    g.excludeClipRegion (Rectangle<int> (5, 5, 4, 4));
+                    g.setColour (getCellColour (x, y));
+                    g.fillRect (0, 0, cellSize, cellSize);
+
+                    g.saveState();
+                    g.reduceClipRegion (10, 10, 5, 5);
+                    g.setColour (Colours::black);
+                    g.fillAll();
+                    g.restoreState();
+
+                    g.restoreState();
+                }
+            }
+        }
+
+        renderer.restoreState();
+    }
+
+    void runTest()
+    {
+        beginTest ("Saving and restoring clip regions");
+
+        Image image (Image::RGB, cellSize * numCells, cellSize * numCells, true, SoftwareImageType());
+        LowLevelGraphicsSoftwareRenderer renderer (image);
+        paintGrid (renderer);
+
+        for (int y = 0; y < numCells; ++y)
+        {
+            for (int x = 0; x < numCells; ++x)
+            {
+                const int left = x * cellSize, top = y * cellSize;
+                expect (image.getPixelAt (left + 1, top + 1) == getCellColour (x, y));
+                expect (image.getPixelAt (left + 6, top + 6) == Colours::white);
+                expect (image.getPixelAt (left + 12, top + 12) == Colours::black);
+                expect (image.getPixelAt (left + 16, top + 16) == getCellColour (x, y));
+            }
+        }
+
+        expect (renderer.getClipBounds() == image.getBounds());
+
+        beginTest ("Filling paths within a path clip");
+
+        {
+            // While a path clip is alive, the arena can't start again from scratch, so the
+            // tables made for each fill have to be re-used rather than piling up..
+            RenderingHelpers::ClipRegions::RegionPool pool;
+
+            {
+                RenderingHelpers::SoftwareRendererSavedState state (image, image.getBounds(), &pool);
+                state.fillType = FillType (Colours::red);
+
+                Path clipPath;
+                clipPath.addEllipse (0.0f, 0.0f, (float) image.getWidth(), (float) image.getHeight());
+                state.clipToPath (clipPath, AffineTransform::identity);
+
+                Path star;
+                star.addStar (Point<float> (100.0f, 100.0f), 12, 30.0f, 90.0f);
+
+                for (int i = 0; i < 64; ++i)
+                    state.fillPath (star, AffineTransform::rotation (i * 0.1f, 100.0f, 100.0f));
+
+                const size_t bytesAfterWarmUp = pool.getNumBytesReserved();
+
+                for (int i = 0; i < 1000; ++i)
+                    state.fillPath (star, AffineTransform::rotation ((i % 64) * 0.1f, 100.0f, 100.0f));
+
+                expect (pool.getNumBytesReserved() <= bytesAfterWarmUp);
+                expect (image.getPixelAt (100, 100) == Colours::red);
+                expect (image.getPixelAt (1, 1) != Colours::red);
+            }
+        }
+
+        if (AllocationHooks::isEnabled())
+        {
+            beginTest ("Steady-state allocations");
+
+            // Once the renderer has built up its saved states and clip regions, painting
+            // the same thing again should re-use them rather than going back to the heap.
+            paintGrid (renderer);
+            expect (AllocationHooks::getNumAllocations() > 0);
+
+            const int64 numAllocationsBefore = AllocationHooks::getNumAllocations();
+
+            for (int i = 0; i < 10; ++i)
+                paintGrid (renderer);
+
+            expectEquals ((int) (AllocationHooks::getNumAllocations() - numAllocationsBefore), 0);
+        }
+    }
+};
+
+static SoftwareRendererTests softwareRendererTests;
+
+#endif
@@ -83,7 +83,22 @@ public:
     void drawGlyph (int glyphNumber, float x, float y);
     void drawGlyph (int glyphNumber, const AffineTransform&);
 
+    //==============================================================================
+    /** Describes the state of the glyph cache that all software renderers share.
+        @see getGlyphCacheStatistics
+    */
+    struct GlyphCacheStatistics
+    {
+        int numGlyphSlots;      /**< The number of glyphs that the cache currently has room for. */
+        int64 numHits;          /**< The number of glyphs drawn that were already in the cache. */
+        int64 numMisses;        /**< The number of glyphs drawn that had to be rendered into the cache first. */
+    };
+
+    /** Returns some numbers about the glyph cache, which can be handy when profiling text drawing. */
+    static GlyphCacheStatistics getGlyphCacheStatistics();
+
 protected:
+    RenderingHelpers::ClipRegions::RegionPool regionPool;
     RenderingHelpers::SavedStateStack <RenderingHelpers::SoftwareRendererSavedState> savedState;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LowLevelGraphicsSoftwareRenderer);
@@ -27,13 +27,16 @@ const int juce_edgeTableDefaultEdgesPerLine = 32;
 
 //==============================================================================
 EdgeTable::EdgeTable (const Rectangle<int>& bounds_,
-                      const Path& path, const AffineTransform& transform)
-   : bounds (bounds_),
+                      const Path& path, const AffineTransform& transform,
+                      MemoryArena* const arenaToUse)
+   : table (nullptr),
+     arena (arenaToUse),
+     bounds (bounds_),
      maxEdgesPerLine (juce_edgeTableDefaultEdgesPerLine),
      lineStrideElements ((juce_edgeTableDefaultEdgesPerLine << 1) + 1),
      needToCheckEmptinesss (true)
 {
-    table.malloc ((size_t) ((bounds.getHeight() + 1) * lineStrideElements));
+    table = allocateTable ((bounds.getHeight() + 1) * lineStrideElements);
     int* t = table;
 
     for (int i = bounds.getHeight(); --i >= 0;)
@@ -101,13 +104,15 @@ EdgeTable::EdgeTable (const Rectangle<int>& bounds_,
     sanitiseLevels (path.isUsingNonZeroWinding());
 }
 
-EdgeTable::EdgeTable (const Rectangle<int>& rectangleToAdd)
-   : bounds (rectangleToAdd),
+EdgeTable::EdgeTable (const Rectangle<int>& rectangleToAdd, MemoryArena* const arenaToUse)
+   : table (nullptr),
+     arena (arenaToUse),
+     bounds (rectangleToAdd),
      maxEdgesPerLine (juce_edgeTableDefaultEdgesPerLine),
      lineStrideElements ((juce_edgeTableDefaultEdgesPerLine << 1) + 1),
      needToCheckEmptinesss (true)
 {
-    table.malloc ((size_t) jmax (1, bounds.getHeight()) * lineStrideElements);
+    table = allocateTable (jmax (1, bounds.getHeight()) * lineStrideElements);
     table[0] = 0;
 
     const int x1 = rectangleToAdd.getX() << 8;
@@ -125,13 +130,15 @@ EdgeTable::EdgeTable (const Rectangle<int>& rectangleToAdd)
     }
 }
 
-EdgeTable::EdgeTable (const RectangleList& rectanglesToAdd)
-   : bounds (rectanglesToAdd.getBounds()),
+EdgeTable::EdgeTable (const RectangleList& rectanglesToAdd, MemoryArena* const arenaToUse)
+   : table (nullptr),
+     arena (arenaToUse),
+     bounds (rectanglesToAdd.getBounds()),
      maxEdgesPerLine (juce_edgeTableDefaultEdgesPerLine),
      lineStrideElements ((juce_edgeTableDefaultEdgesPerLine << 1) + 1),
      needToCheckEmptinesss (true)
 {
-    table.malloc ((size_t) jmax (1, bounds.getHeight()) * lineStrideElements);
+    table = allocateTable (jmax (1, bounds.getHeight()) * lineStrideElements);
 
     int* t = table;
     for (int i = bounds.getHeight(); --i >= 0;)
@@ -159,8 +166,10 @@ EdgeTable::EdgeTable (const RectangleList& rectanglesToAdd)
     sanitiseLevels (true);
 }
 
-EdgeTable::EdgeTable (const Rectangle<float>& rectangleToAdd)
-   : bounds (Rectangle<int> ((int) std::floor (rectangleToAdd.getX()),
+EdgeTable::EdgeTable (const Rectangle<float>& rectangleToAdd, MemoryArena* const arenaToUse)
+   : table (nullptr),
+     arena (arenaToUse),
+     bounds (Rectangle<int> ((int) std::floor (rectangleToAdd.getX()),
                              roundToInt (rectangleToAdd.getY() * 256.0f) >> 8,
                              2 + (int) rectangleToAdd.getWidth(),
                              2 + (int) rectangleToAdd.getHeight())),
@@ -169,7 +178,7 @@ EdgeTable::EdgeTable (const Rectangle<float>& rectangleToAdd)
      needToCheckEmptinesss (true)
 {
     jassert (! rectangleToAdd.isEmpty());
-    table.malloc ((size_t) jmax (1, bounds.getHeight()) * lineStrideElements);
+    table = allocateTable (jmax (1, bounds.getHeight()) * lineStrideElements);
     table[0] = 0;
 
     const int x1 = roundToInt (rectangleToAdd.getX() * 256.0f);
@@ -238,6 +247,13 @@ EdgeTable::EdgeTable (const Rectangle<float>& rectangleToAdd)
 }
 
 EdgeTable::EdgeTable (const EdgeTable& other)
+   : table (nullptr), arena (nullptr)
+{
+    operator= (other);
+}
+
+EdgeTable::EdgeTable (const EdgeTable& other, MemoryArena* const arenaToUse)
+   : table (nullptr), arena (arenaToUse)
 {
     operator= (other);
 }
@@ -249,13 +265,35 @@ EdgeTable& EdgeTable::operator= (const EdgeTable& other)
     lineStrideElements = other.lineStrideElements;
     needToCheckEmptinesss = other.needToCheckEmptinesss;
 
-    table.malloc ((size_t) jmax (1, bounds.getHeight()) * lineStrideElements);
-    copyEdgeTableData (table, lineStrideElements, other.table, lineStrideElements, bounds.getHeight());
+    int* const newTable = allocateTable (jmax (1, bounds.getHeight()) * lineStrideElements);
+    copyEdgeTableData (newTable, lineStrideElements, other.table, lineStrideElements, bounds.getHeight());
+    freeTable (table);
+    table = newTable;
     return *this;
 }
 
 EdgeTable::~EdgeTable()
 {
+    freeTable (table);
+}
+
+//==============================================================================
+int* EdgeTable::allocateTable (const int numElements) const
+{
+    const size_t numBytes = (size_t) numElements * sizeof (int);
+
+    if (arena != nullptr)
+        return static_cast <int*> (arena->allocate (numBytes));
+
+    return static_cast <int*> (std::malloc (numBytes));
+}
+
+void EdgeTable::freeTable (int* const t) const noexcept
+{
+    if (arena != nullptr)
+        arena->release (t);
+    else
+        std::free (t);
 }
 
 //==============================================================================
@@ -329,11 +367,12 @@ void EdgeTable::remapTableForNumEdges (const int newNumEdgesPerLine)
         jassert (bounds.getHeight() > 0);
         const int newLineStrideElements = maxEdgesPerLine * 2 + 1;
 
-        HeapBlock <int> newTable ((size_t) (bounds.getHeight() * newLineStrideElements));
+        int* const newTable = allocateTable (bounds.getHeight() * newLineStrideElements);
 
         copyEdgeTableData (newTable, newLineStrideElements, table, lineStrideElements, bounds.getHeight());
 
-        table.swapWith (newTable);
+        freeTable (table);
+        table = newTable;
         lineStrideElements = newLineStrideElements;
     }
 }
@@ -51,24 +51,33 @@ public:
         @param clipLimits               only the region of the path that lies within this area will be added
         @param pathToAdd                the path to add to the table
         @param transform                a transform to apply to the path being added
+        @param arenaToUse               if this is non-null, the table's storage will be allocated from
+                                        this arena instead of the heap, in which case the arena must
+                                        outlive the table
     */
     EdgeTable (const Rectangle<int>& clipLimits,
                const Path& pathToAdd,
-               const AffineTransform& transform);
+               const AffineTransform& transform,
+               MemoryArena* arenaToUse = nullptr);
 
     /** Creates an edge table containing a rectangle. */
-    explicit EdgeTable (const Rectangle<int>& rectangleToAdd);
+    explicit EdgeTable (const Rectangle<int>& rectangleToAdd, MemoryArena* arenaToUse = nullptr);
 
     /** Creates an edge table containing a rectangle list. */
-    explicit EdgeTable (const RectangleList& rectanglesToAdd);
+    explicit EdgeTable (const RectangleList& rectanglesToAdd, MemoryArena* arenaToUse = nullptr);
 
     /** Creates an edge table containing a rectangle. */
-    explicit EdgeTable (const Rectangle<float>& rectangleToAdd);
+    explicit EdgeTable (const Rectangle<float>& rectangleToAdd, MemoryArena* arenaToUse = nullptr);
 
-    /** Creates a copy of another edge table. */
+    /** Creates a copy of another edge table, whose storage comes from the heap. */
     EdgeTable (const EdgeTable& other);
 
-    /** Copies from another edge table. */
+    /** Creates a copy of another edge table, allocating its storage from the given arena. */
+    EdgeTable (const EdgeTable& other, MemoryArena* arenaToUse);
+
+    /** Copies from another edge table.
+        If this table was created with an arena, it'll carry on using it.
+    */
     EdgeTable& operator= (const EdgeTable& other);
 
     /** Destructor. */
@@ -192,11 +201,14 @@ public:
 private:
     //==============================================================================
     // table line format: number of points; point0 x, point0 levelDelta, point1 x, point1 levelDelta, etc
-    HeapBlock<int> table;
+    int* table;
+    MemoryArena* arena;
     Rectangle<int> bounds;
     int maxEdgesPerLine, lineStrideElements;
     bool needToCheckEmptinesss;
 
+    int* allocateTable (int numElements) const;
+    void freeTable (int*) const noexcept;
     void addEdgePoint (int x, int y, int winding);
     void remapTableForNumEdges (int newNumEdgesPerLine);
     void intersectWithEdgeTableLine (int y, const int* otherLine);
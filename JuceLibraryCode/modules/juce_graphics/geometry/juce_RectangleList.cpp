@@ -39,7 +39,13 @@ RectangleList::RectangleList (const RectangleList& other)
 
 RectangleList& RectangleList::operator= (const RectangleList& other)
 {
-    rects = other.rects;
+    if (this != &other)
+    {
+        // (re-uses our existing storage rather than making a fresh copy of the array)
+        rects.clearQuick();
+        rects.addArray (other.rects);
+    }
+
     return *this;
 }
 
@@ -410,6 +416,80 @@ void RectangleList::consolidate()
     }
 }
 
+namespace RectangleListHelpers
+{
+    struct TopLeftComparator
+    {
+        static int compareElements (const Rectangle<int>& r1, const Rectangle<int>& r2) noexcept
+        {
+            if (r1.getY() != r2.getY())
+                return r1.getY() < r2.getY() ? -1 : 1;
+
+            return r1.getX() < r2.getX() ? -1 : (r1.getX() > r2.getX() ? 1 : 0);
+        }
+    };
+
+    int64 getExtraPixelsIfMerged (const Rectangle<int>& r1, const Rectangle<int>& r2) noexcept
+    {
+        const Rectangle<int> merged (r1.getUnion (r2));
+        const Rectangle<int> overlap (r1.getIntersection (r2));
+
+        return merged.getWidth() * (int64) merged.getHeight()
+                 - r1.getWidth() * (int64) r1.getHeight()
+                 - r2.getWidth() * (int64) r2.getHeight()
+                 + overlap.getWidth() * (int64) overlap.getHeight();
+    }
+}
+
+void RectangleList::mergeWithinCost (const int costPerRectangle)
+{
+    if (rects.size() < 2)
+        return;
+
+    // The rectangles are sorted by position, and each one is only compared with the
+    // last few of the merged ones, which are the only ones likely to be near it. That
+    // keeps this linear in the number of rectangles, as it's called for every frame.
+    enum { numNeighboursToCheck = 4 };
+
+    RectangleListHelpers::TopLeftComparator comparator;
+    rects.sort (comparator);
+
+    Array<Rectangle<int> > merged;
+    merged.ensureStorageAllocated (rects.size());
+
+    for (int i = 0; i < rects.size(); ++i)
+    {
+        const Rectangle<int>& r = rects.getReference (i);
+        int j = merged.size();
+
+        while (--j >= jmax (0, merged.size() - numNeighboursToCheck))
+        {
+            Rectangle<int>& m = merged.getReference (j);
+
+            if (RectangleListHelpers::getExtraPixelsIfMerged (m, r) <= costPerRectangle)
+            {
+                m = m.getUnion (r);
+                break;
+            }
+        }
+
+        if (j < jmax (0, merged.size() - numNeighboursToCheck))
+            merged.add (r);
+    }
+
+    if (merged.size() < rects.size())
+    {
+        // the bounding boxes may now overlap some of the other rectangles, so
+        // re-adding them all makes sure the list stays non-overlapping..
+        RectangleList tidied;
+
+        for (int i = 0; i < merged.size(); ++i)
+            tidied.add (merged.getReference (i));
+
+        swapWith (tidied);
+    }
+}
+
 //==============================================================================
 bool RectangleList::containsPoint (const int x, const int y) const noexcept
 {
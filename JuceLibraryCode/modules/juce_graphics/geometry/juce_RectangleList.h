@@ -209,6 +209,19 @@ public:
     */
     void consolidate();
 
+    /** Merges together any rectangles that would be cheaper to handle as a single block.
+
+        Each pair of nearby rectangles whose bounding box adds no more than costPerRectangle
+        extra pixels to the total area gets replaced by that bounding box. (To keep this
+        quick, each rectangle is only compared with its neighbours in top-to-bottom order,
+        so some pairs that could be merged may be left separate). This is handy
+        for things like repaint regions, where the overhead of dealing with an extra
+        rectangle is worth more than drawing a few unneeded pixels.
+
+        The rectangles in the list will still be non-overlapping after this is called.
+    */
+    void mergeWithinCost (int costPerRectangle);
+
     /** Adds an x and y value to all the co-ordinates. */
     void offsetAll (int dx, int dy) noexcept;
 
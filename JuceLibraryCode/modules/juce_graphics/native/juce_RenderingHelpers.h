@@ -146,6 +146,7 @@ class GlyphCache  : private DeletedAtShutdown
 {
 public:
     GlyphCache()
+        : totalHits (0), totalMisses (0)
     {
         addNewGlyphSlots (120);
     }
@@ -195,6 +196,8 @@ public:
                 if (misses.value * 2 > hits.value)
                     addNewGlyphSlots (32);
 
+                totalHits += hits.value;
+                totalMisses += misses.value;
                 hits.set (0);
                 misses.set (0);
                 glyph = glyphs.getLast();
@@ -212,10 +215,20 @@ public:
         glyph->draw (target, x, y);
     }
 
+    /** Returns the number of glyph slots, and the number of hits and misses since the cache was created. */
+    void getStatistics (int& numSlots, int64& numHits, int64& numMisses) const
+    {
+        const ScopedReadLock srl (lock);
+        numSlots = glyphs.size();
+        numHits = totalHits + hits.value;
+        numMisses = totalMisses + misses.value;
+    }
+
 private:
     friend class OwnedArray <CachedGlyphType>;
     OwnedArray <CachedGlyphType> glyphs;
     Atomic<int> accessCounter, hits, misses;
+    int64 totalHits, totalMisses;
     ReadWriteLock lock;
 
     void addNewGlyphSlots (int num)
@@ -1509,14 +1522,20 @@ namespace EdgeTableFillers
 //==============================================================================
 namespace ClipRegions
 {
-    class Base  : public SingleThreadedReferenceCountedObject
+    class RegionPool;
+
+    class Base
     {
     public:
-        Base() {}
+        Base() noexcept : refCount (0), pool (nullptr), nextSpare (nullptr), isInArena (false) {}
         virtual ~Base() {}
 
         typedef ReferenceCountedObjectPtr<Base> Ptr;
 
+        inline void incReferenceCount() noexcept         { ++refCount; }
+        inline int getReferenceCount() const noexcept    { return refCount; }
+        void decReferenceCount() noexcept;
+
         virtual Ptr clone() const = 0;
         virtual Ptr applyClipTo (const Ptr& target) const = 0;
 
@@ -1537,20 +1556,33 @@ namespace ClipRegions
         virtual void fillAllWithGradient (Image::BitmapData& destData, ColourGradient&, const AffineTransform&, bool isIdentity) const = 0;
         virtual void renderImageTransformed (const Image::BitmapData& destData, const Image::BitmapData& srcData, const int alpha, const AffineTransform&, bool betterQuality, bool tiledFill) const = 0;
         virtual void renderImageUntransformed (const Image::BitmapData& destData, const Image::BitmapData& srcData, const int alpha, int x, int y, bool tiledFill) const = 0;
+
+    protected:
+        int refCount;
+        RegionPool* pool; // if non-null, the pool that this region goes back to when it's released
+        Base* nextSpare;
+        bool isInArena;   // true if the pool placed this object in its arena
+
+        friend class RegionPool;
+
+    private:
+        Base (const Base&);
+        Base& operator= (const Base&);
     };
 
     //==============================================================================
     class EdgeTableRegion  : public Base
     {
     public:
-        EdgeTableRegion (const EdgeTable& e)        : edgeTable (e) {}
-        EdgeTableRegion (const Rectangle<int>& r)   : edgeTable (r) {}
-        EdgeTableRegion (const Rectangle<float>& r) : edgeTable (r) {}
-        EdgeTableRegion (const RectangleList& r)    : edgeTable (r) {}
-        EdgeTableRegion (const Rectangle<int>& bounds, const Path& p, const AffineTransform& t) : edgeTable (bounds, p, t) {}
-        EdgeTableRegion (const EdgeTableRegion& other) : edgeTable (other.edgeTable) {}
-
-        Ptr clone() const                           { return new EdgeTableRegion (*this); }
+        EdgeTableRegion (const EdgeTable& e, MemoryArena* arena = nullptr)        : edgeTable (e, arena) {}
+        EdgeTableRegion (const Rectangle<int>& r, MemoryArena* arena = nullptr)   : edgeTable (r, arena) {}
+        EdgeTableRegion (const Rectangle<float>& r, MemoryArena* arena = nullptr) : edgeTable (r, arena) {}
+        EdgeTableRegion (const RectangleList& r, MemoryArena* arena = nullptr)    : edgeTable (r, arena) {}
+        EdgeTableRegion (const Rectangle<int>& bounds, const Path& p, const AffineTransform& t, MemoryArena* arena = nullptr)
+            : edgeTable (bounds, p, t, arena) {}
+        EdgeTableRegion (const EdgeTableRegion& other) : Base(), edgeTable (other.edgeTable) {}
+
+        Ptr clone() const;
         Ptr applyClipTo (const Ptr& target) const   { return target->clipToEdgeTable (edgeTable); }
 
         Ptr clipToRectangle (const Rectangle<int>& r)
@@ -1744,9 +1776,9 @@ namespace ClipRegions
     public:
         RectangleListRegion (const Rectangle<int>& r) : clip (r) {}
         RectangleListRegion (const RectangleList& r)  : clip (r) {}
-        RectangleListRegion (const RectangleListRegion& other) : clip (other.clip) {}
+        RectangleListRegion (const RectangleListRegion& other) : Base(), clip (other.clip) {}
 
-        Ptr clone() const                           { return new RectangleListRegion (*this); }
+        Ptr clone() const;
         Ptr applyClipTo (const Ptr& target) const   { return target->clipToRectangleList (clip); }
 
         Ptr clipToRectangle (const Rectangle<int>& r)
@@ -1996,27 +2028,157 @@ namespace ClipRegions
             JUCE_DECLARE_NON_COPYABLE (SubRectangleIteratorFloat);
         };
 
-        inline Ptr toEdgeTable() const   { return new EdgeTableRegion (clip); }
+        Ptr toEdgeTable() const;
 
         RectangleListRegion& operator= (const RectangleListRegion&);
     };
+
+    //==============================================================================
+    /** Provides a renderer with clip regions that don't need to go back to the heap
+        every time a saved state's clip gets copied or thrown away.
+
+        Released rectangle-list regions (and the storage inside their RectangleLists)
+        are kept on a list of spares, and edge-table regions are placed, along with
+        their tables, in a MemoryArena, which re-uses the space of any that get
+        released while others are still alive (e.g. all the temporary tables made
+        while a path clip is active), and gets recycled wholesale whenever all of
+        them have been released - i.e. at the end of each paint.
+
+        Regions created by a pool must all have been released before it's deleted.
+    */
+    class RegionPool
+    {
+    public:
+        RegionPool() noexcept : spareRegions (nullptr) {}
+
+        ~RegionPool()
+        {
+            while (spareRegions != nullptr)
+            {
+                Base* const next = spareRegions->nextSpare;
+                delete spareRegions;
+                spareRegions = next;
+            }
+        }
+
+        Base::Ptr createRectangleListRegion (const RectangleList& clip)
+        {
+            RectangleListRegion* r = static_cast <RectangleListRegion*> (spareRegions);
+
+            if (r != nullptr)
+            {
+                spareRegions = r->nextSpare;
+                r->nextSpare = nullptr;
+                r->clip = clip;
+            }
+            else
+            {
+                r = new RectangleListRegion (clip);
+                r->pool = this;
+            }
+
+            return r;
+        }
+
+        template <typename SourceType>
+        EdgeTableRegion* createEdgeTableRegion (const SourceType& source)
+        {
+            return placedInArena (new (arena.allocate (sizeof (EdgeTableRegion))) EdgeTableRegion (source, &arena));
+        }
+
+        EdgeTableRegion* createEdgeTableRegion (const Rectangle<int>& bounds, const Path& p, const AffineTransform& t)
+        {
+            return placedInArena (new (arena.allocate (sizeof (EdgeTableRegion))) EdgeTableRegion (bounds, p, t, &arena));
+        }
+
+        /** Returns the number of bytes the pool's arena has got from the heap. */
+        size_t getNumBytesReserved() const noexcept     { return arena.getTotalSize(); }
+
+        void recycle (Base* const region) noexcept
+        {
+            jassert (region->pool == this && region->getReferenceCount() == 0);
+
+            if (region->isInArena)
+            {
+                region->~Base();
+                arena.release (region);
+            }
+            else
+            {
+                region->nextSpare = spareRegions;
+                spareRegions = region;
+            }
+        }
+
+    private:
+        MemoryArena arena;
+        Base* spareRegions; // (only ever contains RectangleListRegions)
+
+        EdgeTableRegion* placedInArena (EdgeTableRegion* const r) noexcept
+        {
+            r->pool = this;
+            r->isInArena = true;
+            return r;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (RegionPool);
+    };
+
+    inline void Base::decReferenceCount() noexcept
+    {
+        jassert (refCount > 0);
+
+        if (--refCount == 0)
+        {
+            if (pool != nullptr)
+                pool->recycle (this);
+            else
+                delete this;
+        }
+    }
+
+    inline Base::Ptr RectangleListRegion::clone() const
+    {
+        if (pool != nullptr)
+            return pool->createRectangleListRegion (clip);
+
+        return new RectangleListRegion (*this);
+    }
+
+    inline Base::Ptr RectangleListRegion::toEdgeTable() const
+    {
+        if (pool != nullptr)
+            return pool->createEdgeTableRegion (clip);
+
+        return new EdgeTableRegion (clip);
+    }
+
+    inline Base::Ptr EdgeTableRegion::clone() const
+    {
+        if (pool != nullptr)
+            return pool->createEdgeTableRegion (edgeTable);
+
+        return new EdgeTableRegion (*this);
+    }
 }
 
 //==============================================================================
 class SoftwareRendererSavedState
 {
 public:
-    SoftwareRendererSavedState (const Image& image_, const Rectangle<int>& clip_)
-        : image (image_), clip (new ClipRegions::RectangleListRegion (clip_)),
-          transform (0, 0),
+    SoftwareRendererSavedState (const Image& image_, const Rectangle<int>& clip_,
+                                ClipRegions::RegionPool* const regionPool = nullptr)
+        : image (image_), clip (createClipRegion (clip_, regionPool)),
+          transform (0, 0), pool (regionPool),
           interpolationQuality (Graphics::mediumResamplingQuality),
           transparencyLayerAlpha (1.0f)
     {
     }
 
-    SoftwareRendererSavedState (const Image& image_, const RectangleList& clip_, const int xOffset_, const int yOffset_)
-        : image (image_), clip (new ClipRegions::RectangleListRegion (clip_)),
-          transform (xOffset_, yOffset_),
+    SoftwareRendererSavedState (const Image& image_, const RectangleList& clip_, const int xOffset_, const int yOffset_,
+                                ClipRegions::RegionPool* const regionPool = nullptr)
+        : image (image_), clip (createClipRegion (clip_, regionPool)),
+          transform (xOffset_, yOffset_), pool (regionPool),
           interpolationQuality (Graphics::mediumResamplingQuality),
           transparencyLayerAlpha (1.0f)
     {
@@ -2024,7 +2186,7 @@ public:
 
     SoftwareRendererSavedState (const SoftwareRendererSavedState& other)
         : image (other.image), clip (other.clip), transform (other.transform),
-          font (other.font), fillType (other.fillType),
+          pool (other.pool), font (other.font), fillType (other.fillType),
           interpolationQuality (other.interpolationQuality),
           transparencyLayerAlpha (other.transparencyLayerAlpha)
     {
@@ -2220,7 +2382,7 @@ public:
                     const Rectangle<float> clipped (totalClip.getIntersection (transform.translated (r)));
 
                     if (! clipped.isEmpty())
-                        fillShape (new ClipRegions::EdgeTableRegion (clipped), false);
+                        fillShape (createEdgeTableRegion (clipped), false);
                 }
             }
             else
@@ -2235,7 +2397,13 @@ public:
     void fillPath (const Path& path, const AffineTransform& t)
     {
         if (clip != nullptr)
-            fillShape (new ClipRegions::EdgeTableRegion (clip->getClipBounds(), path, transform.getTransformWith (t)), false);
+        {
+            const Rectangle<int> bounds (clip->getClipBounds());
+            const AffineTransform fullTransform (transform.getTransformWith (t));
+
+            fillShape (pool != nullptr ? pool->createEdgeTableRegion (bounds, path, fullTransform)
+                                       : new ClipRegions::EdgeTableRegion (bounds, path, fullTransform), false);
+        }
     }
 
     void fillEdgeTable (const EdgeTable& edgeTable, const float x, const int y)
@@ -2244,7 +2412,7 @@ public:
 
         if (clip != nullptr)
         {
-            ClipRegions::EdgeTableRegion* edgeTableClip = new ClipRegions::EdgeTableRegion (edgeTable);
+            ClipRegions::EdgeTableRegion* edgeTableClip = createEdgeTableRegion (edgeTable);
             edgeTableClip->edgeTable.translate (x + transform.xOffset,
                                                 y + transform.yOffset);
             fillShape (edgeTableClip, false);
@@ -2258,7 +2426,7 @@ public:
             const ScopedPointer<EdgeTable> et (f.getTypeface()->getEdgeTableForGlyph (glyphNumber, transform.getTransformWith (t)));
 
             if (et != nullptr)
-                fillShape (new ClipRegions::EdgeTableRegion (*et), false);
+                fillShape (createEdgeTableRegion (*et), false);
         }
     }
 
@@ -2336,7 +2504,7 @@ public:
 
                     if (! area.isEmpty())
                     {
-                        ClipRegions::Base::Ptr c (clip->applyClipTo (new ClipRegions::EdgeTableRegion (area)));
+                        ClipRegions::Base::Ptr c (clip->applyClipTo (createEdgeTableRegion (area)));
 
                         if (c != nullptr)
                             c->renderImageUntransformed (destData, srcData, alpha, tx, ty, false);
@@ -2371,6 +2539,7 @@ public:
     Image image;
     ClipRegions::Base::Ptr clip;
     RenderingHelpers::TranslationOrTransform transform;
+    ClipRegions::RegionPool* pool; // the renderer's pool that new clip regions come from (may be null)
     Font font;
     FillType fillType;
     Graphics::ResamplingQuality interpolationQuality;
@@ -2384,57 +2553,121 @@ private:
             clip = clip->clone();
     }
 
+    static ClipRegions::Base::Ptr createClipRegion (const RectangleList& r, ClipRegions::RegionPool* const regionPool)
+    {
+        if (regionPool != nullptr)
+            return regionPool->createRectangleListRegion (r);
+
+        return new ClipRegions::RectangleListRegion (r);
+    }
+
+    template <typename SourceType>
+    ClipRegions::EdgeTableRegion* createEdgeTableRegion (const SourceType& source) const
+    {
+        if (pool != nullptr)
+            return pool->createEdgeTableRegion (source);
+
+        return new ClipRegions::EdgeTableRegion (source);
+    }
+
     SoftwareRendererSavedState& operator= (const SoftwareRendererSavedState&);
 };
 
 //==============================================================================
+/*  Keeps a stack of saved renderer states.
+
+    The saved states are copy-constructed into blocks of memory that the stack keeps
+    hold of after they've been restored, so once a renderer has reached its deepest
+    nesting level, saving and restoring doesn't touch the heap any more.
+*/
 template <class StateObjectType>
 class SavedStateStack
 {
 public:
     SavedStateStack (StateObjectType* const initialState) noexcept
-        : currentState (initialState)
+        : currentState (initialState), numSavedStates (0)
     {}
 
+    ~SavedStateStack()
+    {
+        for (int i = numSavedStates; --i >= 0;)
+            static_cast <StateObjectType*> (blocks.getUnchecked (i))->~StateObjectType();
+
+        deleteState (currentState);
+
+        for (int i = blocks.size(); --i >= 0;)
+            ::operator delete (blocks.getUnchecked (i));
+    }
+
     inline StateObjectType* operator->() const noexcept     { return currentState; }
     inline StateObjectType& operator*()  const noexcept     { return *currentState; }
 
     void save()
     {
-        stack.add (new StateObjectType (*currentState));
+        if (numSavedStates == blocks.size())
+            blocks.add (::operator new (sizeof (StateObjectType)));
+
+        new (blocks.getUnchecked (numSavedStates)) StateObjectType (*currentState);
+        ++numSavedStates;
     }
 
     void restore()
     {
-        StateObjectType* const top = stack.getLast();
+        StateObjectType* const finishedState = pop();
 
-        if (top != nullptr)
-        {
-            currentState = top;
-            stack.removeLast (1, false);
-        }
-        else
-        {
-            jassertfalse; // trying to pop with an empty stack!
-        }
+        if (finishedState != nullptr)
+            recycle (finishedState);
     }
 
     void beginTransparencyLayer (float opacity)
     {
         save();
-        currentState = currentState->beginTransparencyLayer (opacity);
+        StateObjectType* const layer = currentState->beginTransparencyLayer (opacity);
+        deleteState (currentState);
+        currentState = layer;
     }
 
     void endTransparencyLayer()
     {
-        const ScopedPointer<StateObjectType> finishedTransparencyLayer (currentState);
-        restore();
-        currentState->endTransparencyLayer (*finishedTransparencyLayer);
+        StateObjectType* const finishedTransparencyLayer = pop();
+
+        if (finishedTransparencyLayer != nullptr)
+        {
+            currentState->endTransparencyLayer (*finishedTransparencyLayer);
+            recycle (finishedTransparencyLayer);
+        }
     }
 
 private:
-    ScopedPointer<StateObjectType> currentState;
-    OwnedArray<StateObjectType> stack;
+    StateObjectType* currentState;
+    Array<void*> blocks; // the first numSavedStates blocks hold the saved states, the rest are spare
+    int numSavedStates;
+
+    StateObjectType* pop() noexcept
+    {
+        if (numSavedStates <= 0)
+        {
+            jassertfalse; // trying to pop with an empty stack!
+            return nullptr;
+        }
+
+        StateObjectType* const oldState = currentState;
+        currentState = static_cast <StateObjectType*> (blocks.getUnchecked (--numSavedStates));
+        return oldState;
+    }
+
+    void recycle (StateObjectType* const finishedState)
+    {
+        // The finished state's memory replaces the block that the new current state came from.
+        finishedState->~StateObjectType();
+        blocks.set (numSavedStates, finishedState);
+    }
+
+    static void deleteState (StateObjectType* const state)
+    {
+        state->~StateObjectType();
+        ::operator delete (state);
+    }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SavedStateStack);
 };
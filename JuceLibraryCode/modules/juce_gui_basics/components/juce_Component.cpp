@@ -1943,6 +1943,8 @@ void Component::paintComponentAndChildren (Graphics& g)
 
 void Component::paintEntireComponent (Graphics& g, const bool ignoreAlphaLevel)
 {
+    const PaintProfiler::ScopedEvent profilerEvent (*this, g);
+
    #if JUCE_DEBUG
     flags.isInsidePaintCall = true;
    #endif
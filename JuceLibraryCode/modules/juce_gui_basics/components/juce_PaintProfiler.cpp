@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+namespace PaintProfilerHelpers
+{
+    enum { maxPendingEvents = 16384 };
+
+    struct EventBuffer
+    {
+        EventBuffer() : fifo (maxPendingEvents) {}
+
+        AbstractFifo fifo;
+        PaintProfiler::Event events [maxPendingEvents];
+        Atomic<int> numDropped;
+
+        JUCE_DECLARE_NON_COPYABLE (EventBuffer);
+    };
+
+    static EventBuffer& getBuffer()
+    {
+        static EventBuffer buffer;
+        return buffer;
+    }
+
+    // these are only touched by the painting thread
+    static int currentDepth = 0;
+    static uint32 currentFrame = 0;
+
+    // Turns a compiler's typeid name into something more readable. This only
+    // handles simple (possibly namespaced) class names, which covers most components.
+    static String getReadableTypeName (const char* typeName)
+    {
+        String name (typeName);
+
+        if (name.startsWith ("class "))   return name.substring (6);
+        if (name.startsWith ("struct "))  return name.substring (7);
+
+        String::CharPointerType t (name.getCharPointer());
+        const bool isNested = (*t == 'N');
+
+        if (isNested)
+            ++t;
+
+        String result;
+
+        while (t.isDigit())
+        {
+            const int length = CharacterFunctions::getIntValue <int, String::CharPointerType> (t);
+
+            while (t.isDigit())
+                ++t;
+
+            if (result.isNotEmpty())
+                result << "::";
+
+            for (int i = 0; i < length && ! t.isEmpty(); ++i)
+                result << t.getAndAdvance();
+        }
+
+        if (result.isEmpty() || (isNested ? (*t != 'E') : ! t.isEmpty()))
+            return name;
+
+        return result;
+    }
+}
+
+//==============================================================================
+bool PaintProfiler::enabled = false;
+
+PaintProfiler::Event::Event() noexcept
+    : label (nullptr), frameNumber (0), depth (0),
+      startTicks (0), endTicks (0), numPixels (0)
+{
+}
+
+double PaintProfiler::Event::getDurationMs() const noexcept
+{
+    return Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1000.0;
+}
+
+String PaintProfiler::Event::getDescription() const
+{
+    String s (label != nullptr ? PaintProfilerHelpers::getReadableTypeName (label) : String::empty);
+
+    if (componentName.isNotEmpty())
+        s << " \"" << componentName << '"';
+
+    return s;
+}
+
+//==============================================================================
+void PaintProfiler::setEnabled (const bool shouldBeEnabled)
+{
+    PaintProfilerHelpers::getBuffer(); // makes sure the buffer exists before any events arrive
+    enabled = shouldBeEnabled;
+}
+
+int PaintProfiler::readEvents (Array<Event>& destArray)
+{
+    PaintProfilerHelpers::EventBuffer& buffer = PaintProfilerHelpers::getBuffer();
+
+    int start1, size1, start2, size2;
+    buffer.fifo.prepareToRead (buffer.fifo.getNumReady(), start1, size1, start2, size2);
+
+    destArray.ensureStorageAllocated (destArray.size() + size1 + size2);
+
+    for (int i = 0; i < size1; ++i)
+        destArray.add (buffer.events [start1 + i]);
+
+    for (int i = 0; i < size2; ++i)
+        destArray.add (buffer.events [start2 + i]);
+
+    buffer.fifo.finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+void PaintProfiler::clear()
+{
+    PaintProfilerHelpers::EventBuffer& buffer = PaintProfilerHelpers::getBuffer();
+    buffer.fifo.finishedRead (buffer.fifo.getNumReady());
+}
+
+int PaintProfiler::getNumEventsDropped() noexcept
+{
+    return PaintProfilerHelpers::getBuffer().numDropped.get();
+}
+
+void PaintProfiler::writeChromeTrace (OutputStream& output)
+{
+    Array<Event> events;
+    readEvents (events);
+
+    output << "{\"traceEvents\":[";
+
+    for (int i = 0; i < events.size(); ++i)
+    {
+        const Event& e = events.getReference (i);
+
+        DynamicObject* const args = new DynamicObject();
+        const var argsHolder (args);
+        args->setProperty ("frame", (int) e.frameNumber);
+        args->setProperty ("depth", e.depth);
+        args->setProperty ("pixels", e.numPixels);
+
+        DynamicObject* const traceEvent = new DynamicObject();
+        const var traceEventHolder (traceEvent);
+        traceEvent->setProperty ("name", e.getDescription());
+        traceEvent->setProperty ("cat", "paint");
+        traceEvent->setProperty ("ph", "X");
+        traceEvent->setProperty ("ts", Time::highResolutionTicksToSeconds (e.startTicks) * 1000000.0);
+        traceEvent->setProperty ("dur", e.getDurationMs() * 1000.0);
+        traceEvent->setProperty ("pid", 1);
+        traceEvent->setProperty ("tid", 1);
+        traceEvent->setProperty ("args", argsHolder);
+
+        if (i > 0)
+            output << ',';
+
+        output << newLine;
+        JSON::writeToStream (output, traceEventHolder, true);
+    }
+
+    output << newLine << "]}" << newLine;
+    output.flush();
+}
+
+//==============================================================================
+void PaintProfiler::ScopedEvent::begin (const Component* const component, const char* const label,
+                                        const Graphics& g) noexcept
+{
+    using namespace PaintProfilerHelpers;
+
+    if (currentDepth == 0)
+        ++currentFrame;
+
+    event.frameNumber = currentFrame;
+    event.depth = currentDepth++;
+
+    Rectangle<int> area (g.getClipBounds());
+
+    if (component != nullptr)
+    {
+        event.label = typeid (*component).name();
+        event.componentName = component->getName();
+        area = area.getIntersection (component->getLocalBounds());
+    }
+    else
+    {
+        event.label = label;
+    }
+
+    event.numPixels = area.getWidth() * (int64) area.getHeight();
+    event.startTicks = Time::getHighResolutionTicks();
+}
+
+void PaintProfiler::ScopedEvent::end() noexcept
+{
+    using namespace PaintProfilerHelpers;
+
+    event.endTicks = Time::getHighResolutionTicks();
+    --currentDepth;
+
+    EventBuffer& buffer = getBuffer();
+
+    int start1, size1, start2, size2;
+    buffer.fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+    {
+        buffer.events [start1] = event;
+        buffer.fifo.finishedWrite (1);
+    }
+    else
+    {
+        ++buffer.numDropped;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PaintProfilerTests  : public UnitTest
+{
+public:
+    PaintProfilerTests() : UnitTest ("PaintProfiler") {}
+
+    struct TestComponent  : public Component
+    {
+        TestComponent (const String& name) : Component (name) {}
+
+        void paint (Graphics& g)
+        {
+            const PaintProfiler::ScopedEvent e ("drawing", g);
+            g.fillAll (Colours::red);
+        }
+    };
+
+    static int countEvents (const Array<PaintProfiler::Event>& events, const String& componentName)
+    {
+        int n = 0;
+
+        for (int i = 0; i < events.size(); ++i)
+            if (events.getReference (i).componentName == componentName)
+                ++n;
+
+        return n;
+    }
+
+    static const PaintProfiler::Event* findEvent (const Array<PaintProfiler::Event>& events, const String& componentName)
+    {
+        for (int i = 0; i < events.size(); ++i)
+            if (events.getReference (i).componentName == componentName)
+                return &events.getReference (i);
+
+        return nullptr;
+    }
+
+    void runTest()
+    {
+        beginTest ("Event tree");
+
+        TestComponent parent ("parent"), child1 ("child1"), child2 ("child2");
+        parent.setBounds (0, 0, 100, 100);
+        child1.setBounds (0, 0, 50, 20);
+        child2.setBounds (10, 50, 30, 40);
+        parent.addAndMakeVisible (&child1);
+        parent.addAndMakeVisible (&child2);
+
+        Image image (Image::RGB, 100, 100, true, SoftwareImageType());
+
+        PaintProfiler::setEnabled (true);
+        PaintProfiler::clear();
+
+        {
+            Graphics g (image);
+            parent.paintEntireComponent (g, false);
+        }
+
+        Array<PaintProfiler::Event> events;
+        expectEquals (PaintProfiler::readEvents (events), 6);  // (3 components, each with a "drawing" event)
+
+        const PaintProfiler::Event* const parentEvent = findEvent (events, "parent");
+        const PaintProfiler::Event* const child1Event = findEvent (events, "child1");
+        const PaintProfiler::Event* const child2Event = findEvent (events, "child2");
+
+        expect (parentEvent != nullptr && child1Event != nullptr && child2Event != nullptr);
+
+        if (parentEvent != nullptr && child1Event != nullptr && child2Event != nullptr)
+        {
+            expectEquals (parentEvent->depth, 0);
+            expectEquals (child1Event->depth, 1);
+            expectEquals (child2Event->depth, 1);
+            expect (child1Event->frameNumber == parentEvent->frameNumber);
+            expect (child1Event->numPixels == 50 * 20);
+            expect (child2Event->numPixels == 30 * 40);
+            expect (child1Event->startTicks >= parentEvent->startTicks && child2Event->endTicks <= parentEvent->endTicks);
+            expect (child1Event->endTicks <= child2Event->startTicks);
+            expect (parentEvent->getDescription().endsWith ("\"parent\""));
+        }
+
+        int numDrawingEvents = 0;
+
+        for (int i = 0; i < events.size(); ++i)
+        {
+            const PaintProfiler::Event& e = events.getReference (i);
+
+            if (e.componentName.isEmpty())
+            {
+                ++numDrawingEvents;
+                expect (e.getDescription() == "drawing");
+                expect (e.depth == 1 || e.depth == 2);
+            }
+        }
+
+        expectEquals (numDrawingEvents, 3);
+
+        beginTest ("Buffered components");
+
+        child2.setBufferedToImage (true);
+
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            Graphics g (image);
+            parent.paintEntireComponent (g, false);
+        }
+
+        events.clearQuick();
+        PaintProfiler::readEvents (events);
+
+        // the cached child only gets painted once, and copying its image isn't logged as a paint
+        expectEquals (countEvents (events, "parent"), 3);
+        expectEquals (countEvents (events, "child1"), 3);
+        expectEquals (countEvents (events, "child2"), 1);
+
+        child2.setBufferedToImage (false);
+
+        beginTest ("Chrome trace");
+
+        {
+            Graphics g (image);
+            parent.paintEntireComponent (g, false);
+        }
+
+        MemoryOutputStream out;
+        PaintProfiler::writeChromeTrace (out);
+        expectEquals (PaintProfiler::readEvents (events), 0);
+
+        const var trace (JSON::parse (out.toString()));
+        const var traceEventsVar (trace ["traceEvents"]);
+        const Array<var>* const traceEvents = traceEventsVar.getArray();
+        expect (traceEvents != nullptr);
+
+        if (traceEvents != nullptr)
+        {
+            expectEquals (traceEvents->size(), 6);
+
+            for (int i = 0; i < traceEvents->size(); ++i)
+            {
+                const var& e = traceEvents->getReference (i);
+                expect (e ["ph"].toString() == "X");
+                expect (e ["cat"].toString() == "paint");
+                expect ((double) e ["dur"] >= 0);
+                expect (e ["args"]["depth"].isInt());
+            }
+
+            const String lastName (traceEvents->getReference (traceEvents->size() - 1) ["name"].toString());
+            expect (lastName.endsWith ("\"parent\""));
+            expect (traceEvents->getReference (0) ["name"].toString() == "drawing");
+        }
+
+        PaintProfiler::setEnabled (false);
+
+        {
+            Graphics g (image);
+            parent.paintEntireComponent (g, false);
+        }
+
+        expectEquals (PaintProfiler::readEvents (events), 0);
+    }
+};
+
+static PaintProfilerTests paintProfilerTests;
+
+#endif
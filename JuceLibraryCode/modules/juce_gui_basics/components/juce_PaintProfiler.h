@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_PAINTPROFILER_JUCEHEADER__
+#define __JUCE_PAINTPROFILER_JUCEHEADER__
+
+class Component;
+
+
+//==============================================================================
+/**
+    Records how long each component takes to paint itself.
+
+    When the profiler is enabled, Component::paintEntireComponent() logs an Event
+    for every component it paints, holding the time it took, the number of pixels it
+    covered and its depth in the tree of nested paint calls. (A component that's
+    buffered to an image only gets an event when its image is redrawn, not each
+    time the image is copied into its parent). The events from one frame can be turned back
+    into a tree of which components (and their children) used up the frame time.
+
+    Events are pushed into a fixed-size lock-free FIFO, so the painting code never
+    blocks, and another thread can collect them with readEvents() or dump them in
+    the Chrome trace format with writeChromeTrace(). If the FIFO fills up before it's
+    read, new events are dropped and counted.
+
+    When the profiler is disabled, the only overhead is a check of a single flag
+    for each component painted, so it's fine to leave this compiled into release builds.
+
+    You can also time sections of your own drawing code, such as LookAndFeel methods,
+    by creating a ScopedEvent on the stack.
+
+    e.g. @code
+    PaintProfiler::setEnabled (true);
+
+    // ..let the app paint a few frames, then:
+
+    FileOutputStream out (File ("~/paint_trace.json"));
+    PaintProfiler::writeChromeTrace (out);
+    @endcode
+
+    Painting is expected to happen on the message thread, and only one thread
+    at a time should read the events.
+*/
+class JUCE_API  PaintProfiler
+{
+public:
+    //==============================================================================
+    /** Holds the details of one timed paint call. */
+    struct JUCE_API  Event
+    {
+        Event() noexcept;
+
+        /** Returns the length of the call in milliseconds. */
+        double getDurationMs() const noexcept;
+
+        /** Returns a readable name for the event, based on its label or component type. */
+        String getDescription() const;
+
+        const char* label;          /**< The name passed to a ScopedEvent, or the compiler's type name of the component. */
+        String componentName;       /**< The Component::getName() of the component, if there was one. */
+        uint32 frameNumber;         /**< Incremented each time a top-level paint call begins. */
+        int depth;                  /**< How deeply this call was nested inside other timed calls. */
+        int64 startTicks;           /**< The start of the call, in Time::getHighResolutionTicks() units. */
+        int64 endTicks;             /**< The end of the call, in Time::getHighResolutionTicks() units. */
+        int64 numPixels;            /**< The area of the clip region that the call could draw into. */
+    };
+
+    //==============================================================================
+    /** Turns the profiler on or off. */
+    static void setEnabled (bool shouldBeEnabled);
+
+    /** Returns true if the profiler is currently recording events. */
+    static bool isEnabled() noexcept                    { return enabled; }
+
+    /** Moves any events that have been recorded into the given array.
+        Returns the number of events that were added.
+    */
+    static int readEvents (Array<Event>& destArray);
+
+    /** Discards any events that haven't yet been read. */
+    static void clear();
+
+    /** Returns the number of events that were thrown away because nobody read them in time. */
+    static int getNumEventsDropped() noexcept;
+
+    /** Reads all the pending events and writes them to a stream as a Chrome trace.
+
+        The output can be loaded into chrome://tracing or a similar viewer.
+    */
+    static void writeChromeTrace (OutputStream& output);
+
+    //==============================================================================
+    /**
+        Times a paint operation for as long as this object exists.
+
+        Component uses these internally, but you can create your own ones to measure
+        parts of your painting code. If the profiler is disabled, they do nothing.
+    */
+    class JUCE_API  ScopedEvent
+    {
+    public:
+        /** Starts timing a component that's being painted into the given context. */
+        ScopedEvent (const Component& component, const Graphics& g) noexcept
+            : isActive (enabled)
+        {
+            if (isActive)
+                begin (&component, nullptr, g);
+        }
+
+        /** Starts timing a named block of drawing code.
+            The label must be a string literal or some other string which will outlive the profiler.
+        */
+        ScopedEvent (const char* label, const Graphics& g) noexcept
+            : isActive (enabled)
+        {
+            if (isActive)
+                begin (nullptr, label, g);
+        }
+
+        /** Destructor. */
+        ~ScopedEvent()
+        {
+            if (isActive)
+                end();
+        }
+
+    private:
+        Event event;
+        const bool isActive;
+
+        void begin (const Component*, const char* label, const Graphics&) noexcept;
+        void end() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedEvent);
+    };
+
+private:
+    //==============================================================================
+    static bool enabled;
+
+    PaintProfiler();
+    JUCE_DECLARE_NON_COPYABLE (PaintProfiler);
+};
+
+
+#endif   // __JUCE_PAINTPROFILER_JUCEHEADER__
@@ -172,29 +172,34 @@ void DirectoryContentsList::changed()
 int DirectoryContentsList::useTimeSlice()
 {
     const uint32 startTime = Time::getApproximateMillisecondCounter();
-    bool hasChanged = false;
+    OwnedArray<FileInfo> newFiles;
+    bool isFinished = false;
 
-    for (int i = 100; --i >= 0;)
+    // The files are collected in chunks and merged into the list in one go, so that the list
+    // only gets locked and broadcasts a change once per chunk, rather than once per file.
+    // The chunks start small so that the first few files appear quickly, and grow with the list..
+    const int maxFilesInChunk = jlimit (100, 2000, files.size());
+
+    while (! shouldStop)
     {
-        if (! checkNextFile (hasChanged))
+        if (! checkNextFile (newFiles))
         {
-            if (hasChanged)
-                changed();
-
-            return 500;
+            isFinished = true;
+            break;
         }
 
-        if (shouldStop || (Time::getApproximateMillisecondCounter() > startTime + 150))
+        if (newFiles.size() >= maxFilesInChunk
+             || Time::getApproximateMillisecondCounter() > startTime + 150)
             break;
     }
 
-    if (hasChanged)
+    if (addFiles (newFiles))
         changed();
 
-    return 0;
+    return isFinished ? 500 : 0;
 }
 
-bool DirectoryContentsList::checkNextFile (bool& hasChanged)
+bool DirectoryContentsList::checkNextFile (OwnedArray<FileInfo>& newFiles)
 {
     if (fileFindHandle != nullptr)
     {
@@ -205,10 +210,21 @@ bool DirectoryContentsList::checkNextFile (bool& hasChanged)
         if (fileFindHandle->next (&fileFoundIsDir, &isHidden, &fileSize,
                                   &modTime, &creationTime, &isReadOnly))
         {
-            if (addFile (fileFindHandle->getFile(), fileFoundIsDir,
-                         fileSize, modTime, creationTime, isReadOnly))
+            const File& file = fileFindHandle->getFile();
+
+            if (fileFilter == nullptr
+                 || ((! fileFoundIsDir) && fileFilter->isFileSuitable (file))
+                 || (fileFoundIsDir && fileFilter->isDirectorySuitable (file)))
             {
-                hasChanged = true;
+                FileInfo* const info = new FileInfo();
+                newFiles.add (info);
+
+                info->filename = file.getFileName();
+                info->fileSize = fileSize;
+                info->modificationTime = modTime;
+                info->creationTime = creationTime;
+                info->isDirectory = fileFoundIsDir;
+                info->isReadOnly = isReadOnly;
             }
 
             return true;
@@ -233,35 +249,77 @@ int DirectoryContentsList::compareElements (const DirectoryContentsList::FileInf
     return first->filename.compareIgnoreCase (second->filename);
 }
 
-bool DirectoryContentsList::addFile (const File& file,
-                                     const bool isDir,
-                                     const int64 fileSize,
-                                     const Time& modTime,
-                                     const Time& creationTime,
-                                     const bool isReadOnly)
+bool DirectoryContentsList::addFiles (OwnedArray<FileInfo>& newFiles)
 {
-    if (fileFilter == nullptr
-         || ((! isDir) && fileFilter->isFileSuitable (file))
-         || (isDir && fileFilter->isDirectorySuitable (file)))
+    if (newFiles.size() == 0)
+        return false;
+
+    newFiles.sort (*this);
+
+    const ScopedLock sl (fileListLock);
+
+    OwnedArray<FileInfo> merged;
+    merged.ensureStorageAllocated (files.size() + newFiles.size());
+
+    bool anyAdded = false;
+    int numOldFilesMerged = 0;
+
+    for (int i = 0; i < newFiles.size(); ++i)
     {
-        ScopedPointer <FileInfo> info (new FileInfo());
+        FileInfo* const info = newFiles.getUnchecked (i);
 
-        info->filename = file.getFileName();
-        info->fileSize = fileSize;
-        info->modificationTime = modTime;
-        info->creationTime = creationTime;
-        info->isDirectory = isDir;
-        info->isReadOnly = isReadOnly;
+        // find where this one goes among the files we already had, and copy across
+        // the ones before it..
+        int start = numOldFilesMerged, end = files.size();
 
-        const ScopedLock sl (fileListLock);
+        while (start < end)
+        {
+            const int mid = (start + end) / 2;
 
-        for (int i = files.size(); --i >= 0;)
-            if (files.getUnchecked(i)->filename == info->filename)
-                return false;
+            if (compareElements (files.getUnchecked (mid), info) <= 0)
+                start = mid + 1;
+            else
+                end = mid;
+        }
 
-        files.addSorted (*this, info.release());
-        return true;
+        while (numOldFilesMerged < start)
+            merged.add (files.getUnchecked (numOldFilesMerged++));
+
+        // ..and any files that compare as equal to it will now be just before it, so
+        // that's where to look for a duplicate.
+        bool isDuplicate = false;
+
+        for (int j = merged.size(); --j >= 0;)
+        {
+            const FileInfo* const other = merged.getUnchecked (j);
+
+            if (compareElements (other, info) != 0)
+                break;
+
+            if (other->filename == info->filename)
+            {
+                isDuplicate = true;
+                break;
+            }
+        }
+
+        if (isDuplicate)
+        {
+            delete info;
+        }
+        else
+        {
+            merged.add (info);
+            anyAdded = true;
+        }
     }
 
-    return false;
+    while (numOldFilesMerged < files.size())
+        merged.add (files.getUnchecked (numOldFilesMerged++));
+
+    newFiles.clear (false);
+    files.clear (false);
+    files.swapWithArray (merged);
+
+    return anyAdded;
 }
@@ -205,10 +205,8 @@ private:
 
     void stopSearching();
     void changed();
-    bool checkNextFile (bool& hasChanged);
-    bool addFile (const File& file, bool isDir,
-                  const int64 fileSize, const Time& modTime,
-                  const Time& creationTime, bool isReadOnly);
+    bool checkNextFile (OwnedArray<FileInfo>& newFiles);
+    bool addFiles (OwnedArray<FileInfo>& newFiles);
     void setTypeFlags (int newFlags);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectoryContentsList);
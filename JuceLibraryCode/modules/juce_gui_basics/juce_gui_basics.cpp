@@ -138,6 +138,7 @@ namespace juce
 #include "components/juce_ComponentListener.cpp"
 #include "components/juce_Desktop.cpp"
 #include "components/juce_ModalComponentManager.cpp"
+#include "components/juce_PaintProfiler.cpp"
 #include "mouse/juce_ComponentDragger.cpp"
 #include "mouse/juce_DragAndDropContainer.cpp"
 #include "mouse/juce_MouseCursor.cpp"
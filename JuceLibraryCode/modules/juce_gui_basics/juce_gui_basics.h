@@ -91,6 +91,9 @@ namespace juce
 #ifndef __JUCE_MODALCOMPONENTMANAGER_JUCEHEADER__
  #include "components/juce_ModalComponentManager.h"
 #endif
+#ifndef __JUCE_PAINTPROFILER_JUCEHEADER__
+ #include "components/juce_PaintProfiler.h"
+#endif
 #ifndef __JUCE_COMPONENTDRAGGER_JUCEHEADER__
  #include "mouse/juce_ComponentDragger.h"
 #endif
@@ -1702,7 +1702,7 @@ private:
     public:
         LinuxRepaintManager (LinuxComponentPeer* const peer_)
             : peer (peer_),
-              lastTimeImageUsed (0)
+              firstFrameTime (Time::getMillisecondCounterHiRes())
         {
            #if JUCE_USE_XSHM
             shmCompletedDrawing = true;
@@ -1724,18 +1724,23 @@ private:
            #endif
         }
 
+        // The timer is either waiting for the next frame tick, when there are regions
+        // that need repainting, or otherwise for the time to release the image.
         void timerCallback()
         {
            #if JUCE_USE_XSHM
             if (! shmCompletedDrawing)
+            {
+                startTimer (getMillisecondsUntilNextFrame());
                 return;
+            }
            #endif
+
             if (! regionsNeedingRepaint.isEmpty())
             {
-                stopTimer();
                 performAnyPendingRepaintsNow();
             }
-            else if (Time::getApproximateMillisecondCounter() > lastTimeImageUsed + 3000)
+            else
             {
                 stopTimer();
                 image = Image::null;
@@ -1744,8 +1749,10 @@ private:
 
         void repaint (const Rectangle<int>& area)
         {
-            if (! isTimerRunning())
-                startTimer (repaintTimerPeriod);
+            // repaints are collected until the next frame tick, so that a component that
+            // calls repaint() many times between frames only gets painted once..
+            if (regionsNeedingRepaint.isEmpty())
+                startTimer (getMillisecondsUntilNextFrame());
 
             regionsNeedingRepaint.add (area);
         }
@@ -1755,15 +1762,18 @@ private:
            #if JUCE_USE_XSHM
             if (! shmCompletedDrawing)
             {
-                startTimer (repaintTimerPeriod);
+                startTimer (getMillisecondsUntilNextFrame());
                 return;
             }
            #endif
 
+            const double paintStartTime = Time::getMillisecondCounterHiRes();
+
             peer->clearMaskedRegion();
 
             RectangleList originalRepaintRegion (regionsNeedingRepaint);
             regionsNeedingRepaint.clear();
+            originalRepaintRegion.mergeWithinCost (costPerRectangleInPixels);
             const Rectangle<int> totalArea (originalRepaintRegion.getBounds());
 
             if (! totalArea.isEmpty())
@@ -1782,8 +1792,6 @@ private:
                                                      false, peer->depth, peer->visual));
                 }
 
-                startTimer (repaintTimerPeriod);
-
                 RectangleList adjustedList (originalRepaintRegion);
                 adjustedList.offsetAll (-totalArea.getX(), -totalArea.getY());
 
@@ -1804,22 +1812,32 @@ private:
                 if (! peer->maskedRegion.isEmpty())
                     originalRepaintRegion.subtract (peer->maskedRegion);
 
+                int64 numPixels = 0;
+
                 for (RectangleList::Iterator i (originalRepaintRegion); i.next();)
                 {
                    #if JUCE_USE_XSHM
                     shmCompletedDrawing = false;
                    #endif
                     const Rectangle<int>& r = *i.getRectangle();
+                    numPixels += r.getWidth() * (int64) r.getHeight();
 
                     static_cast<XBitmapImage*> (image.getPixelData())
                         ->blitToWindow (peer->windowH,
                                         r.getX(), r.getY(), r.getWidth(), r.getHeight(),
                                         r.getX() - totalArea.getX(), r.getY() - totalArea.getY());
                 }
+
+                FrameStatistics& stats = peer->lastFrameStatistics;
+                ++stats.frameNumber;
+                stats.paintTimeMs = Time::getMillisecondCounterHiRes() - paintStartTime;
+                stats.numRectangles = originalRepaintRegion.getNumRectangles();
+                stats.numPixelsPainted = numPixels;
             }
 
-            lastTimeImageUsed = Time::getApproximateMillisecondCounter();
-            startTimer (repaintTimerPeriod);
+            // (something may have been repainted while painting, which will need another frame)
+            startTimer (regionsNeedingRepaint.isEmpty() ? (int) imageReleaseDelayMs
+                                                        : getMillisecondsUntilNextFrame());
         }
 
        #if JUCE_USE_XSHM
@@ -1827,12 +1845,32 @@ private:
        #endif
 
     private:
-        enum { repaintTimerPeriod = 1000 / 100 };
+        enum
+        {
+            framesPerSecond = 60,
+
+            // How long the image is kept after the last paint, in case it's needed again.
+            imageReleaseDelayMs = 3000,
+
+            /* The number of pixels that it's worth painting unnecessarily to avoid having
+               to render and blit an extra rectangle. */
+            costPerRectangleInPixels = 64 * 64
+        };
 
         LinuxComponentPeer* const peer;
         Image image;
-        uint32 lastTimeImageUsed;
         RectangleList regionsNeedingRepaint;
+        const double firstFrameTime;
+
+        // Frames are painted on a steady clock, so this finds the time until the next tick.
+        int getMillisecondsUntilNextFrame() const
+        {
+            const double frameLength = 1000.0 / framesPerSecond;
+            const double elapsed = Time::getMillisecondCounterHiRes() - firstFrameTime;
+            const double nextFrameTime = (std::floor (elapsed / frameLength) + 1.0) * frameLength;
+
+            return jmax (1, roundToInt (nextFrameTime - elapsed));
+        }
 
        #if JUCE_USE_XSHM
         bool useARGBImagesForRendering, shmCompletedDrawing;
@@ -23,6 +23,68 @@
   ==============================================================================
 */
 
+// Reads one of a component's coordinates for an Expression::Program, without looking up the symbol's name
+class ComponentPositionReader  : public Expression::Scope::SymbolReader
+{
+public:
+    ComponentPositionReader (Component& component_, const RelativeCoordinate::StandardStrings::Type type_)
+        : component (&component_), type (type_)
+    {
+    }
+
+    double getValue() const
+    {
+        const Component* const c = component;
+
+        if (c != nullptr)
+        {
+            switch (type)
+            {
+                case RelativeCoordinate::StandardStrings::x:
+                case RelativeCoordinate::StandardStrings::left:   return (double) c->getX();
+                case RelativeCoordinate::StandardStrings::y:
+                case RelativeCoordinate::StandardStrings::top:    return (double) c->getY();
+                case RelativeCoordinate::StandardStrings::width:  return (double) c->getWidth();
+                case RelativeCoordinate::StandardStrings::height: return (double) c->getHeight();
+                case RelativeCoordinate::StandardStrings::right:  return (double) c->getRight();
+                case RelativeCoordinate::StandardStrings::bottom: return (double) c->getBottom();
+                default: jassertfalse; break;
+            }
+        }
+
+        return 0.0;
+    }
+
+private:
+    const Component::SafePointer<Component> component;
+    const RelativeCoordinate::StandardStrings::Type type;
+
+    JUCE_DECLARE_NON_COPYABLE (ComponentPositionReader);
+};
+
+// Evaluates a marker's position with a pre-compiled copy of its expression
+class MarkerPositionReader  : public Expression::Scope::SymbolReader
+{
+public:
+    MarkerPositionReader() {}
+
+    double getValue() const     { return program.evaluate(); }
+
+    static MarkerPositionReader* create (const MarkerList::Marker& marker, const Expression::Scope& scope)
+    {
+        ScopedPointer<MarkerPositionReader> reader (new MarkerPositionReader());
+
+        return reader->program.compile (marker.position.getExpression(), scope) ? reader.release()
+                                                                                 : nullptr;
+    }
+
+private:
+    Expression::Program program;
+
+    JUCE_DECLARE_NON_COPYABLE (MarkerPositionReader);
+};
+
+//==============================================================================
 class MarkerListScope  : public Expression::Scope
 {
 public:
@@ -46,6 +108,20 @@ public:
         return Expression::Scope::getSymbolValue (symbol);
     }
 
+    SymbolReader* createSymbolReader (const String& symbol) const
+    {
+        const RelativeCoordinate::StandardStrings::Type type = RelativeCoordinate::StandardStrings::getTypeOf (symbol);
+
+        if (type == RelativeCoordinate::StandardStrings::width || type == RelativeCoordinate::StandardStrings::height)
+            return new ComponentPositionReader (component, type);
+
+        MarkerList* list;
+        const MarkerList::Marker* const marker = findMarker (component, symbol, list);
+
+        return marker != nullptr ? MarkerPositionReader::create (*marker, *this)
+                                 : nullptr;
+    }
+
     void visitRelativeScope (const String& scopeName, Visitor& visitor) const
     {
         if (scopeName == RelativeCoordinate::Strings::parent)
@@ -130,6 +206,27 @@ Expression RelativeCoordinatePositionerBase::ComponentScope::getSymbolValue (con
     return Expression::Scope::getSymbolValue (symbol);
 }
 
+Expression::Scope::SymbolReader* RelativeCoordinatePositionerBase::ComponentScope::createSymbolReader (const String& symbol) const
+{
+    const RelativeCoordinate::StandardStrings::Type type = RelativeCoordinate::StandardStrings::getTypeOf (symbol);
+
+    if (type != RelativeCoordinate::StandardStrings::unknown && type != RelativeCoordinate::StandardStrings::parent)
+        return new ComponentPositionReader (component, type);
+
+    Component* const parent = component.getParentComponent();
+
+    if (parent != nullptr)
+    {
+        MarkerList* list;
+        const MarkerList::Marker* const marker = MarkerListScope::findMarker (*parent, symbol, list);
+
+        if (marker != nullptr)
+            return MarkerPositionReader::create (*marker, MarkerListScope (*parent));
+    }
+
+    return nullptr;
+}
+
 void RelativeCoordinatePositionerBase::ComponentScope::visitRelativeScope (const String& scopeName, Visitor& visitor) const
 {
     Component* const targetComp = (scopeName == RelativeCoordinate::Strings::parent)
@@ -189,7 +286,9 @@ public:
 
                     if (marker != nullptr)
                     {
-                        positioner.registerMarkerListListener (list);
+                        // (both lists are watched, because the marker's own position may refer to markers in either of them)
+                        positioner.registerMarkerListListener (parent->getMarkers (true));
+                        positioner.registerMarkerListListener (parent->getMarkers (false));
                     }
                     else
                     {
@@ -253,13 +352,19 @@ void RelativeCoordinatePositionerBase::componentMovedOrResized (Component&, bool
 
 void RelativeCoordinatePositionerBase::componentParentHierarchyChanged (Component&)
 {
+    symbolBindingsChanged();
     apply();
 }
 
 void RelativeCoordinatePositionerBase::componentChildrenChanged (Component& changed)
 {
-    if (getComponent().getParentComponent() == &changed && ! registeredOk)
-        apply();
+    if (getComponent().getParentComponent() == &changed)
+    {
+        symbolBindingsChanged();
+
+        if (! registeredOk)
+            apply();
+    }
 }
 
 void RelativeCoordinatePositionerBase::componentBeingDeleted (Component& comp)
@@ -267,10 +372,12 @@ void RelativeCoordinatePositionerBase::componentBeingDeleted (Component& comp)
     jassert (sourceComponents.contains (&comp));
     sourceComponents.removeValue (&comp);
     registeredOk = false;
+    symbolBindingsChanged();
 }
 
 void RelativeCoordinatePositionerBase::markersChanged (MarkerList*)
 {
+    symbolBindingsChanged();
     apply();
 }
 
@@ -278,6 +385,7 @@ void RelativeCoordinatePositionerBase::markerListBeingDeleted (MarkerList* marke
 {
     jassert (sourceMarkerLists.contains (markerList));
     sourceMarkerLists.removeValue (markerList);
+    symbolBindingsChanged();
 }
 
 void RelativeCoordinatePositionerBase::apply()
@@ -286,6 +394,7 @@ void RelativeCoordinatePositionerBase::apply()
     {
         unregisterListeners();
         registeredOk = registerCoordinates();
+        symbolBindingsChanged();
     }
 
     applyToComponentBounds();
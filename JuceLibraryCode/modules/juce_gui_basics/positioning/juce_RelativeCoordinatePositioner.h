@@ -63,6 +63,7 @@ public:
         ComponentScope (Component& component_);
 
         Expression getSymbolValue (const String& symbol) const;
+        SymbolReader* createSymbolReader (const String& symbol) const;
         void visitRelativeScope (const String& scopeName, Visitor& visitor) const;
         String getScopeUID() const;
 
@@ -79,6 +80,12 @@ protected:
     virtual bool registerCoordinates() = 0;
     virtual void applyToComponentBounds() = 0;
 
+    /** Called when something has changed that could make the symbols in the coordinates refer
+        to different components or markers, so any Expression::Program objects that were compiled
+        from them using a ComponentScope will need to be compiled again.
+    */
+    virtual void symbolBindingsChanged() {}
+
 private:
     class DependencyFinderScope;
     friend class DependencyFinderScope;
@@ -189,7 +189,8 @@ class RelativeRectangleComponentPositioner  : public RelativeCoordinatePositione
 public:
     RelativeRectangleComponentPositioner (Component& component_, const RelativeRectangle& rectangle_)
         : RelativeCoordinatePositionerBase (component_),
-          rectangle (rectangle_)
+          rectangle (rectangle_),
+          programsNeedCompiling (true)
     {
     }
 
@@ -211,8 +212,7 @@ public:
     {
         for (int i = 4; --i >= 0;)
         {
-            ComponentScope scope (getComponent());
-            const Rectangle<int> newBounds (rectangle.resolve (&scope).getSmallestIntegerContainer());
+            const Rectangle<int> newBounds (resolveRectangle().getSmallestIntegerContainer());
 
             if (newBounds == getComponent().getBounds())
                 return;
@@ -229,13 +229,50 @@ public:
         {
             ComponentScope scope (getComponent());
             rectangle.moveToAbsolute (newBounds.toFloat(), &scope);
+            programsNeedCompiling = true;
 
             applyToComponentBounds();
         }
     }
 
+    void symbolBindingsChanged()
+    {
+        programsNeedCompiling = true;
+    }
+
 private:
     RelativeRectangle rectangle;
+    Expression::Program left, right, top, bottom;
+    bool programsNeedCompiling;
+
+    // Uses compiled versions of the coordinates, which only need re-building when the components
+    // or markers that they refer to change, rather than every time the component is laid out.
+    Rectangle<float> resolveRectangle()
+    {
+        if (programsNeedCompiling)
+        {
+            programsNeedCompiling = false;
+
+            ComponentScope scope (getComponent());
+            left.compile (rectangle.left.getExpression(), scope);
+            right.compile (rectangle.right.getExpression(), scope);
+            top.compile (rectangle.top.getExpression(), scope);
+            bottom.compile (rectangle.bottom.getExpression(), scope);
+        }
+
+        if (left.isCompiled() && right.isCompiled() && top.isCompiled() && bottom.isCompiled())
+        {
+            const double l = left.evaluate();
+            const double r = right.evaluate();
+            const double t = top.evaluate();
+            const double b = bottom.evaluate();
+
+            return Rectangle<float> ((float) l, (float) t, (float) jmax (0.0, r - l), (float) jmax (0.0, b - t));
+        }
+
+        ComponentScope scope (getComponent());
+        return rectangle.resolve (&scope);
+    }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RelativeRectangleComponentPositioner);
 };
@@ -39,7 +39,7 @@ public:
             owner.getModel()->paintListBoxItem (row, g, getWidth(), getHeight(), selected);
     }
 
-    void update (const int row_, const bool selected_)
+    void update (const int row_, const bool selected_, const bool refreshIfUnchanged)
     {
         if (row != row_ || selected != selected_)
         {
@@ -47,6 +47,10 @@ public:
             row = row_;
             selected = selected_;
         }
+        else if (! refreshIfUnchanged)
+        {
+            return;
+        }
 
         if (owner.getModel() != nullptr)
         {
@@ -147,7 +151,9 @@ class ListBox::ListViewport  : public Viewport
 {
 public:
     ListViewport (ListBox& owner_)
-        : owner (owner_)
+        : owner (owner_), firstIndex (0), firstWholeIndex (0), lastWholeIndex (0),
+          firstPrefetchedRow (0), lastPrefetchedRow (0),
+          hasUpdated (false), rowsNeedRefreshing (true)
     {
         setWantsKeyboardFocus (false);
 
@@ -206,6 +212,12 @@ public:
             updateContents();
     }
 
+    // Makes the next update call refreshComponentForRow() for every row, even those that haven't changed
+    void refreshAllRows() noexcept
+    {
+        rowsNeedRefreshing = true;
+    }
+
     void updateContents()
     {
         hasUpdated = true;
@@ -217,19 +229,33 @@ public:
             const int w = getViewedComponent()->getWidth();
 
             const int numNeeded = 2 + getMaximumVisibleHeight() / rowHeight;
-            rows.removeRange (numNeeded, rows.size());
+
+            // (rows that aren't needed any more are kept, along with their custom components,
+            // so that they can be re-used if the list gets bigger again)
+            while (rows.size() > numNeeded)
+            {
+                ListBoxRowComponent* const oldRow = rows.removeAndReturn (rows.size() - 1);
+                oldRow->setVisible (false);
+                spareRows.add (oldRow);
+                rowsNeedRefreshing = true;
+            }
 
             while (numNeeded > rows.size())
             {
-                ListBoxRowComponent* newRow = new ListBoxRowComponent (owner);
+                ListBoxRowComponent* const newRow = spareRows.size() > 0 ? spareRows.removeAndReturn (spareRows.size() - 1)
+                                                                         : new ListBoxRowComponent (owner);
                 rows.add (newRow);
                 getViewedComponent()->addAndMakeVisible (newRow);
+                rowsNeedRefreshing = true;
             }
 
             firstIndex = y / rowHeight;
             firstWholeIndex = (y + rowHeight - 1) / rowHeight;
             lastWholeIndex = (y + getMaximumVisibleHeight() - 1) / rowHeight;
 
+            const bool refreshAll = rowsNeedRefreshing;
+            rowsNeedRefreshing = false;
+
             for (int i = 0; i < numNeeded; ++i)
             {
                 const int row = i + firstIndex;
@@ -238,9 +264,23 @@ public:
                 if (rowComp != nullptr)
                 {
                     rowComp->setBounds (0, row * rowHeight, w, rowHeight);
-                    rowComp->update (row, owner.isRowSelected (row));
+                    rowComp->update (row, owner.isRowSelected (row), refreshAll);
                 }
             }
+
+            // let the model know which rows are likely to be scrolled into view next
+            const int firstToPrefetch = jmax (0, firstIndex - numNeeded);
+            const int lastToPrefetch = jmin (owner.totalItems, firstIndex + numNeeded * 2);
+
+            if (owner.model != nullptr
+                 && (refreshAll || firstToPrefetch != firstPrefetchedRow || lastToPrefetch != lastPrefetchedRow))
+            {
+                firstPrefetchedRow = firstToPrefetch;
+                lastPrefetchedRow = lastToPrefetch;
+
+                if (lastToPrefetch > firstToPrefetch)
+                    owner.model->prefetchRows (firstToPrefetch, lastToPrefetch - firstToPrefetch);
+            }
         }
 
         if (owner.headerComponent != nullptr)
@@ -320,9 +360,10 @@ public:
 
 private:
     ListBox& owner;
-    OwnedArray<ListBoxRowComponent> rows;
+    OwnedArray<ListBoxRowComponent> rows, spareRows;
     int firstIndex, firstWholeIndex, lastWholeIndex;
-    bool hasUpdated;
+    int firstPrefetchedRow, lastPrefetchedRow;
+    bool hasUpdated, rowsNeedRefreshing;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ListViewport);
 };
@@ -430,6 +471,7 @@ void ListBox::updateContent()
         selectionChanged = true;
     }
 
+    viewport->refreshAllRows();
     viewport->updateVisibleArea (isVisible());
     viewport->resized();
 
@@ -954,5 +996,6 @@ void ListBoxModel::selectedRowsChanged (int) {}
 void ListBoxModel::deleteKeyPressed (int) {}
 void ListBoxModel::returnKeyPressed (int) {}
 void ListBoxModel::listWasScrolled() {}
+void ListBoxModel::prefetchRows (int, int) {}
 var ListBoxModel::getDragSourceDescription (const SparseSet<int>&)      { return var::null; }
 String ListBoxModel::getTooltipForRow (int)                             { return String::empty; }
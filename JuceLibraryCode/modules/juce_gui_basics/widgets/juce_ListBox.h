@@ -62,7 +62,8 @@ public:
         and handle mouse clicks with listBoxItemClicked().
 
         This method will be called whenever a custom component might need to be updated - e.g.
-        when the table is changed, or TableListBox::updateContent() is called.
+        when the table is changed, or TableListBox::updateContent() is called. Rows that stay
+        on-screen while the list is scrolled aren't refreshed again unless their selection changes.
 
         If you don't need a custom component for the specified row, then return nullptr.
         (Bear in mind that even if you're not creating a new component, you may still need to
@@ -142,6 +143,18 @@ public:
     */
     virtual void listWasScrolled();
 
+    /** Override this to be told which rows are likely to be scrolled into view next.
+
+        Whenever the list's contents are updated, this is called with a range of rows
+        that covers the visible ones and about a screenful either side of them. If your
+        data is slow to fetch, you can use this to start loading those rows on a background
+        thread, and then call ListBox::updateContent() or ListBox::repaintRow() when they
+        arrive, so that they're ready before they're shown.
+
+        It's called often, so it needs to return quickly.
+    */
+    virtual void prefetchRows (int firstRow, int numRows);
+
     /** To allow rows from your list to be dragged-and-dropped, implement this method.
 
         If this returns a non-null variant then when the user drags a row, the listbox will
@@ -48,7 +48,8 @@ private:
 
 //==============================================================================
 TableHeaderComponent::TableHeaderComponent()
-    : columnsChanged (false),
+    : columnGeometryNeedsUpdating (true),
+      columnsChanged (false),
       columnsResized (false),
       sortChanged (false),
       menuActive (true),
@@ -79,13 +80,8 @@ int TableHeaderComponent::getNumColumns (const bool onlyCountVisibleColumns) con
 {
     if (onlyCountVisibleColumns)
     {
-        int num = 0;
-
-        for (int i = columns.size(); --i >= 0;)
-            if (columns.getUnchecked(i)->isVisible())
-                ++num;
-
-        return num;
+        updateColumnGeometryIfNeeded();
+        return visibleColumnIndexes.size();
     }
     else
     {
@@ -135,6 +131,7 @@ void TableHeaderComponent::addColumn (const String& columnName,
     ci->propertyFlags = propertyFlags;
 
     columns.insert (insertIndex, ci);
+    columnGeometryChanged();
     sendColumnsChanged();
 }
 
@@ -145,6 +142,7 @@ void TableHeaderComponent::removeColumn (const int columnIdToRemove)
     if (index >= 0)
     {
         columns.remove (index);
+        columnGeometryChanged();
         sortChanged = true;
         sendColumnsChanged();
     }
@@ -155,6 +153,7 @@ void TableHeaderComponent::removeAllColumns()
     if (columns.size() > 0)
     {
         columns.clear();
+        columnGeometryChanged();
         sendColumnsChanged();
     }
 }
@@ -167,6 +166,7 @@ void TableHeaderComponent::moveColumn (const int columnId, int newIndex)
     if (columns [currentIndex] != 0 && currentIndex != newIndex)
     {
         columns.move (currentIndex, newIndex);
+        columnGeometryChanged();
         sendColumnsChanged();
     }
 }
@@ -188,6 +188,8 @@ void TableHeaderComponent::setColumnWidth (const int columnId, const int newWidt
         ci->lastDeliberateWidth = ci->width
             = jlimit (ci->minimumWidth, ci->maximumWidth, newWidth);
 
+        columnGeometryChanged();
+
         if (stretchToFit)
         {
             const int index = getIndexOfColumnId (columnId, true) + 1;
@@ -212,17 +214,19 @@ void TableHeaderComponent::setColumnWidth (const int columnId, const int newWidt
 //==============================================================================
 int TableHeaderComponent::getIndexOfColumnId (const int columnId, const bool onlyCountVisibleColumns) const
 {
-    int n = 0;
+    if (onlyCountVisibleColumns)
+    {
+        updateColumnGeometryIfNeeded();
 
-    for (int i = 0; i < columns.size(); ++i)
+        for (int i = 0; i < visibleColumnIndexes.size(); ++i)
+            if (columns.getUnchecked (visibleColumnIndexes.getUnchecked(i))->id == columnId)
+                return i;
+    }
+    else
     {
-        if ((! onlyCountVisibleColumns) || columns.getUnchecked(i)->isVisible())
-        {
+        for (int i = 0; i < columns.size(); ++i)
             if (columns.getUnchecked(i)->id == columnId)
-                return n;
-
-            ++n;
-        }
+                return i;
     }
 
     return -1;
@@ -239,46 +243,40 @@ int TableHeaderComponent::getColumnIdOfIndex (int index, const bool onlyCountVis
 
 Rectangle<int> TableHeaderComponent::getColumnPosition (const int index) const
 {
-    int x = 0, width = 0, n = 0;
+    updateColumnGeometryIfNeeded();
 
-    for (int i = 0; i < columns.size(); ++i)
+    if (isPositiveAndBelow (index, visibleColumnIndexes.size()))
     {
-        x += width;
-
-        if (columns.getUnchecked(i)->isVisible())
-        {
-            width = columns.getUnchecked(i)->width;
-
-            if (n++ == index)
-                break;
-        }
-        else
-        {
-            width = 0;
-        }
+        const int x = visibleColumnStarts.getUnchecked (index);
+        return Rectangle<int> (x, 0, visibleColumnStarts.getUnchecked (index + 1) - x, getHeight());
     }
 
-    return Rectangle<int> (x, 0, width, getHeight());
+    // (for an index that's out of range, this returns the last column if it's visible,
+    // or a zero-width rectangle at the right-hand edge if it isn't)
+    const ColumnInfo* const last = columns.getLast();
+    const int width = (last != nullptr && last->isVisible()) ? last->width : 0;
+
+    return Rectangle<int> (getTotalWidth() - width, 0, width, getHeight());
 }
 
 int TableHeaderComponent::getColumnIdAtX (const int xToFind) const
 {
-    if (xToFind >= 0)
+    if (xToFind >= 0 && xToFind < getTotalWidth())
     {
-        int x = 0;
+        // find the first column whose right-hand edge is beyond the position
+        int start = 0, end = visibleColumnIndexes.size() - 1;
 
-        for (int i = 0; i < columns.size(); ++i)
+        while (start < end)
         {
-            const ColumnInfo* const ci = columns.getUnchecked(i);
-
-            if (ci->isVisible())
-            {
-                x += ci->width;
+            const int mid = (start + end) / 2;
 
-                if (xToFind < x)
-                    return ci->id;
-            }
+            if (visibleColumnStarts.getUnchecked (mid + 1) > xToFind)
+                end = mid;
+            else
+                start = mid + 1;
         }
+
+        return columns.getUnchecked (visibleColumnIndexes.getUnchecked (start))->id;
     }
 
     return 0;
@@ -286,13 +284,8 @@ int TableHeaderComponent::getColumnIdAtX (const int xToFind) const
 
 int TableHeaderComponent::getTotalWidth() const
 {
-    int w = 0;
-
-    for (int i = columns.size(); --i >= 0;)
-        if (columns.getUnchecked(i)->isVisible())
-            w += columns.getUnchecked(i)->width;
-
-    return w;
+    updateColumnGeometryIfNeeded();
+    return visibleColumnStarts.getLast();
 }
 
 void TableHeaderComponent::setStretchToFitActive (const bool shouldStretchToFit)
@@ -346,6 +339,7 @@ void TableHeaderComponent::resizeColumnsToFit (int firstColumnIndex, int targetT
             if (newWidth != ci->width)
             {
                 ci->width = newWidth;
+                columnGeometryChanged();
                 repaint();
                 columnsResized = true;
                 triggerAsyncUpdate();
@@ -365,6 +359,7 @@ void TableHeaderComponent::setColumnVisible (const int columnId, const bool shou
         else
             ci->propertyFlags &= ~visible;
 
+        columnGeometryChanged();
         sendColumnsChanged();
         resized();
     }
@@ -458,6 +453,7 @@ void TableHeaderComponent::restoreFromString (const String& storedVersion)
             {
                 columns.move (columns.indexOf (ci), index);
                 ci->width = col->getIntAttribute ("width");
+                columnGeometryChanged();
                 setColumnVisible (tabId, col->getBoolAttribute ("visible"));
             }
 
@@ -801,20 +797,41 @@ TableHeaderComponent::ColumnInfo* TableHeaderComponent::getInfoForId (const int
 
 int TableHeaderComponent::visibleIndexToTotalIndex (const int visibleIndex) const
 {
-    int n = 0;
+    updateColumnGeometryIfNeeded();
 
-    for (int i = 0; i < columns.size(); ++i)
+    return isPositiveAndBelow (visibleIndex, visibleColumnIndexes.size())
+            ? visibleColumnIndexes.getUnchecked (visibleIndex) : -1;
+}
+
+void TableHeaderComponent::columnGeometryChanged() noexcept
+{
+    columnGeometryNeedsUpdating = true;
+}
+
+void TableHeaderComponent::updateColumnGeometryIfNeeded() const
+{
+    if (columnGeometryNeedsUpdating)
     {
-        if (columns.getUnchecked(i)->isVisible())
+        columnGeometryNeedsUpdating = false;
+        visibleColumnIndexes.clearQuick();
+        visibleColumnStarts.clearQuick();
+
+        int x = 0;
+
+        for (int i = 0; i < columns.size(); ++i)
         {
-            if (n == visibleIndex)
-                return i;
+            const ColumnInfo* const ci = columns.getUnchecked(i);
 
-            ++n;
+            if (ci->isVisible())
+            {
+                visibleColumnIndexes.add (i);
+                visibleColumnStarts.add (x);
+                x += ci->width;
+            }
         }
-    }
 
-    return -1;
+        visibleColumnStarts.add (x);
+    }
 }
 
 void TableHeaderComponent::sendColumnsChanged()
@@ -408,12 +408,18 @@ private:
     Array <Listener*> listeners;
     ScopedPointer <Component> dragOverlayComp;
 
+    // the indexes and x positions of the visible columns, which are recalculated when needed
+    mutable Array <int> visibleColumnIndexes, visibleColumnStarts;
+    mutable bool columnGeometryNeedsUpdating;
+
     bool columnsChanged, columnsResized, sortChanged, menuActive, stretchToFit;
     int columnIdBeingResized, columnIdBeingDragged, initialColumnWidth;
     int columnIdUnderMouse, draggingColumnOffset, draggingColumnOriginalIndex, lastDeliberateWidth;
 
     ColumnInfo* getInfoForId (int columnId) const;
     int visibleIndexToTotalIndex (int visibleIndex) const;
+    void columnGeometryChanged() noexcept;
+    void updateColumnGeometryIfNeeded() const;
     void sendColumnsChanged();
     void handleAsyncUpdate();
     void beginDrag (const MouseEvent&);
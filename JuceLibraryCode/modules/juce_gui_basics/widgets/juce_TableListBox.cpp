@@ -42,14 +42,22 @@ public:
 
             const TableHeaderComponent& header = owner.getHeader();
             const int numColumns = header.getNumColumns (true);
+            const Rectangle<int> clip (g.getClipBounds());
 
             for (int i = 0; i < numColumns; ++i)
             {
                 if (columnComponents[i] == nullptr)
                 {
-                    const int columnId = header.getColumnIdOfIndex (i, true);
                     const Rectangle<int> columnRect (header.getColumnPosition(i).withHeight (getHeight()));
 
+                    if (columnRect.getX() >= clip.getRight())
+                        break;
+
+                    if (columnRect.getRight() <= clip.getX())
+                        continue;
+
+                    const int columnId = header.getColumnIdOfIndex (i, true);
+
                     Graphics::ScopedSaveState ss (g);
 
                     g.reduceClipRegion (columnRect);
@@ -75,37 +83,54 @@ public:
 
         if (model != nullptr && row < owner.getNumRows())
         {
-            const Identifier columnProperty ("_tableColumnId");
-            const int numColumns = owner.getHeader().getNumColumns (true);
+            const TableHeaderComponent& header = owner.getHeader();
+            const int numColumns = header.getNumColumns (true);
 
-            for (int i = 0; i < numColumns; ++i)
+            // Any components whose columns have moved or been hidden are put aside, so that they
+            // can be handed back to the model when their columns are next shown..
+            for (int i = columnComponents.size(); --i >= 0;)
             {
-                const int columnId = owner.getHeader().getColumnIdOfIndex (i, true);
-                Component* comp = columnComponents[i];
+                Component* const comp = columnComponents.getUnchecked(i);
 
-                if (comp != nullptr && columnId != (int) comp->getProperties() [columnProperty])
+                if (comp != nullptr && (i >= numColumns || getColumnIdOfComponent (comp) != header.getColumnIdOfIndex (i, true)))
                 {
-                    columnComponents.set (i, nullptr);
-                    comp = nullptr;
+                    comp->setVisible (false);
+                    spareColumnComponents.add (comp);
+                    columnComponents.set (i, nullptr, false);
                 }
+            }
+
+            columnComponents.removeRange (numColumns, columnComponents.size());
+
+            for (int i = 0; i < numColumns; ++i)
+            {
+                const int columnId = header.getColumnIdOfIndex (i, true);
+                Component* comp = columnComponents[i];
+
+                if (comp == nullptr)
+                    comp = removeSpareComponentForColumn (columnId);
 
                 comp = model->refreshComponentForCell (row, columnId, isSelected, comp);
                 columnComponents.set (i, comp, false);
 
                 if (comp != nullptr)
                 {
-                    comp->getProperties().set (columnProperty, columnId);
+                    comp->getProperties().set (getColumnIdProperty(), columnId);
 
                     addAndMakeVisible (comp);
                     resizeCustomComp (i);
                 }
             }
 
-            columnComponents.removeRange (numColumns, columnComponents.size());
+            // ..and those whose columns have been removed from the table are deleted.
+            for (int i = spareColumnComponents.size(); --i >= 0;)
+                if (header.getIndexOfColumnId (getColumnIdOfComponent (spareColumnComponents.getUnchecked(i)), false) < 0)
+                    spareColumnComponents.remove (i);
         }
         else
         {
             columnComponents.clear();
+            spareColumnComponents.clear();
         }
     }
 
@@ -204,10 +229,30 @@ public:
 
 private:
     TableListBox& owner;
-    OwnedArray<Component> columnComponents;
+    OwnedArray<Component> columnComponents, spareColumnComponents;
     int row;
     bool isSelected, isDragging, selectRowOnMouseUp;
 
+    static const Identifier& getColumnIdProperty()
+    {
+        static const Identifier columnProperty ("_tableColumnId");
+        return columnProperty;
+    }
+
+    static int getColumnIdOfComponent (Component* const comp)
+    {
+        return comp->getProperties() [getColumnIdProperty()];
+    }
+
+    Component* removeSpareComponentForColumn (const int columnId)
+    {
+        for (int i = spareColumnComponents.size(); --i >= 0;)
+            if (getColumnIdOfComponent (spareColumnComponents.getUnchecked(i)) == columnId)
+                return spareColumnComponents.removeAndReturn (i);
+
+        return nullptr;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TableListRowComp);
 };
 
@@ -415,11 +460,17 @@ void TableListBox::listWasScrolled()
         model->listWasScrolled();
 }
 
+void TableListBox::prefetchRows (int firstRow, int numRows)
+{
+    if (model != nullptr)
+        model->prefetchRows (firstRow, numRows);
+}
+
 void TableListBox::tableColumnsChanged (TableHeaderComponent*)
 {
     setMinimumContentWidth (header->getTotalWidth());
     repaint();
-    updateColumnComponents();
+    updateContent();
 }
 
 void TableListBox::tableColumnsResized (TableHeaderComponent*)
@@ -473,6 +524,7 @@ void TableListBoxModel::selectedRowsChanged (int)                       {}
 void TableListBoxModel::deleteKeyPressed (int)                          {}
 void TableListBoxModel::returnKeyPressed (int)                          {}
 void TableListBoxModel::listWasScrolled()                               {}
+void TableListBoxModel::prefetchRows (int, int)                         {}
 
 String TableListBoxModel::getCellTooltip (int /*rowNumber*/, int /*columnId*/)    { return String::empty; }
 var TableListBoxModel::getDragSourceDescription (const SparseSet<int>&)           { return var::null; }
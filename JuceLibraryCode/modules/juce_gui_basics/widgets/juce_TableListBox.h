@@ -84,7 +84,8 @@ public:
         and handle mouse clicks with cellClicked().
 
         This method will be called whenever a custom component might need to be updated - e.g.
-        when the table is changed, or TableListBox::updateContent() is called.
+        when the table is changed, or TableListBox::updateContent() is called. Rows that stay
+        on-screen while the table is scrolled aren't refreshed again unless their selection changes.
 
         If you don't need a custom component for the specified cell, then return nullptr.
         (Bear in mind that even if you're not creating a new component, you may still need to
@@ -96,7 +97,8 @@ public:
         If the existingComponentToUpdate is non-null, it will be a pointer to a component previously created
         by this method. In this case, the method must either update it to make sure it's correctly representing
         the given cell (which may be different from the one that the component was created for), or it can
-        delete this component and return a new one.
+        delete this component and return a new one. It will always be a component that was created for the
+        same columnId, even if the columns have been moved or hidden since then.
     */
     virtual Component* refreshComponentForCell (int rowNumber, int columnId, bool isRowSelected,
                                                 Component* existingComponentToUpdate);
@@ -176,6 +178,11 @@ public:
     */
     virtual void listWasScrolled();
 
+    /** Override this to be told which rows are likely to be scrolled into view next.
+        @see ListBoxModel::prefetchRows
+    */
+    virtual void prefetchRows (int firstRow, int numRows);
+
     /** To allow rows from your table to be dragged-and-dropped, implement this method.
 
         If this returns a non-null variant then when the user drags a row, the table will try to
@@ -311,6 +318,8 @@ public:
     /** @internal */
     void listWasScrolled();
     /** @internal */
+    void prefetchRows (int firstRow, int numRows);
+    /** @internal */
     void tableColumnsChanged (TableHeaderComponent*);
     /** @internal */
     void tableColumnsResized (TableHeaderComponent*);
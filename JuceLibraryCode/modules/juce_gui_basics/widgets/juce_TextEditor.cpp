@@ -232,6 +232,39 @@ public:
         return total;
     }
 
+    bool endsWithNewLine() const
+    {
+        return atoms.size() > 0 && atoms.getLast()->isNewLine();
+    }
+
+    bool hasNewLineBeforeEnd() const
+    {
+        for (int i = atoms.size() - 1; --i >= 0;)
+            if (getAtom(i)->isNewLine())
+                return true;
+
+        return false;
+    }
+
+    // Moves all the atoms into new sections that each end after a new-line (apart from the last one)
+    void moveLinesTo (Array <UniformTextSection*>& dest)
+    {
+        int lineStart = 0;
+
+        for (int i = 0; i < atoms.size(); ++i)
+        {
+            if (getAtom(i)->isNewLine() || i == atoms.size() - 1)
+            {
+                UniformTextSection* const line = new UniformTextSection (String::empty, font, colour, 0);
+                line->atoms.addArray (atoms, lineStart, i + 1 - lineStart);
+                dest.add (line);
+                lineStart = i + 1;
+            }
+        }
+
+        atoms.clear();
+    }
+
     void setFont (const Font& newFont,
                   const juce_wchar passwordCharacter)
     {
@@ -322,6 +355,7 @@ class TextEditor::Iterator
 {
 public:
     //==============================================================================
+    // Iterates the sections of a single paragraph
     Iterator (const Array <UniformTextSection*>& sections_,
               const float wordWrapWidth_,
               const juce_wchar passwordCharacter_)
@@ -333,23 +367,26 @@ public:
         atomRight (0),
         atom (0),
         currentSection (nullptr),
-        sections (sections_),
+        sections (&sections_),
+        paragraphs (nullptr),
+        paragraphIndex (0),
         sectionIndex (0),
         atomIndex (0),
         wordWrapWidth (wordWrapWidth_),
         passwordCharacter (passwordCharacter_)
     {
         jassert (wordWrapWidth_ > 0);
-
-        if (sections.size() > 0)
-        {
-            currentSection = sections.getUnchecked (sectionIndex);
-
-            if (currentSection != nullptr)
-                beginNewLine();
-        }
+        begin();
     }
 
+    // Iterates from the start of a paragraph to the end of the text
+    Iterator (const ParagraphList& paragraphs_,
+              const int paragraphIndex_,
+              const int paragraphStart,
+              const float paragraphTop,
+              const float wordWrapWidth_,
+              const juce_wchar passwordCharacter_);
+
     Iterator (const Iterator& other)
       : indexInText (other.indexInText),
         lineY (other.lineY),
@@ -357,9 +394,11 @@ public:
         maxDescent (other.maxDescent),
         atomX (other.atomX),
         atomRight (other.atomRight),
-        atom (other.atom),
+        atom (other.atom == &(other.tempAtom) ? &tempAtom : other.atom),
         currentSection (other.currentSection),
         sections (other.sections),
+        paragraphs (other.paragraphs),
+        paragraphIndex (other.paragraphIndex),
         sectionIndex (other.sectionIndex),
         atomIndex (other.atomIndex),
         wordWrapWidth (other.wordWrapWidth),
@@ -406,7 +445,7 @@ public:
 
         bool forceNewLine = false;
 
-        if (sectionIndex >= sections.size())
+        if (sectionIndex >= sections->size())
         {
             moveToEndOfLastAtom();
             return false;
@@ -415,20 +454,20 @@ public:
         {
             if (atomIndex >= currentSection->getNumAtoms())
             {
-                if (++sectionIndex >= sections.size())
+                if (++sectionIndex >= sections->size() && ! moveToNextParagraph())
                 {
                     moveToEndOfLastAtom();
                     return false;
                 }
 
                 atomIndex = 0;
-                currentSection = sections.getUnchecked (sectionIndex);
+                currentSection = sections->getUnchecked (sectionIndex);
             }
             else
             {
                 const TextAtom* const lastAtom = currentSection->getAtom (atomIndex);
 
-                if (! lastAtom->isWhitespace())
+                if (! (lastAtom->isWhitespace() || atom == nullptr || atom->isNewLine()))
                 {
                     // handle the case where the last atom in a section is actually part of the same
                     // word as the first atom of the next section...
@@ -436,9 +475,9 @@ public:
                     float lineHeight2 = lineHeight;
                     float maxDescent2 = maxDescent;
 
-                    for (int section = sectionIndex + 1; section < sections.size(); ++section)
+                    for (int section = sectionIndex + 1; section < sections->size(); ++section)
                     {
-                        const UniformTextSection* const s = sections.getUnchecked (section);
+                        const UniformTextSection* const s = sections->getUnchecked (section);
 
                         if (s->getNumAtoms() == 0)
                             break;
@@ -521,27 +560,27 @@ public:
 
         int tempSectionIndex = sectionIndex;
         int tempAtomIndex = atomIndex;
-        const UniformTextSection* section = sections.getUnchecked (tempSectionIndex);
+        const UniformTextSection* section = sections->getUnchecked (tempSectionIndex);
 
         lineHeight = section->font.getHeight();
         maxDescent = section->font.getDescent();
 
-        float x = (atom != nullptr) ? atom->width : 0;
+        float x = (atom != nullptr && ! atom->isNewLine()) ? atom->width : 0;
 
         while (! shouldWrap (x))
         {
-            if (tempSectionIndex >= sections.size())
+            if (tempSectionIndex >= sections->size())
                 break;
 
             bool checkSize = false;
 
             if (tempAtomIndex >= section->getNumAtoms())
             {
-                if (++tempSectionIndex >= sections.size())
+                if (++tempSectionIndex >= sections->size())
                     break;
 
                 tempAtomIndex = 0;
-                section = sections.getUnchecked (tempSectionIndex);
+                section = sections->getUnchecked (tempSectionIndex);
                 checkSize = true;
             }
 
@@ -693,59 +732,864 @@ public:
     {
         while (next())
         {
-            if (indexInText + atom->numChars > index)
+            if (indexInText + atom->numChars > index)
+            {
+                cx = indexToX (index);
+                cy = lineY;
+                lineHeight_ = lineHeight;
+                return true;
+            }
+        }
+
+        cx = atomX;
+        cy = lineY;
+        lineHeight_ = lineHeight;
+        return false;
+    }
+
+    //==============================================================================
+    int indexInText;
+    float lineY, lineHeight, maxDescent;
+    float atomX, atomRight;
+    const TextAtom* atom;
+    const UniformTextSection* currentSection;
+
+private:
+    const Array <UniformTextSection*>* sections;
+    const ParagraphList* paragraphs;
+    int paragraphIndex, sectionIndex, atomIndex;
+    const float wordWrapWidth;
+    const juce_wchar passwordCharacter;
+    TextAtom tempAtom;
+
+    Iterator& operator= (const Iterator&);
+
+    void begin()
+    {
+        if (sections->size() > 0)
+        {
+            currentSection = sections->getUnchecked (sectionIndex);
+
+            if (currentSection != nullptr)
+                beginNewLine();
+        }
+    }
+
+    bool moveToNextParagraph();
+
+    void moveToEndOfLastAtom()
+    {
+        if (atom != nullptr)
+        {
+            atomX = atomRight;
+
+            if (atom->isNewLine())
+            {
+                atomX = 0.0f;
+                lineY += lineHeight;
+            }
+        }
+    }
+
+    bool shouldWrap (const float x) const
+    {
+        return (x - 0.0001f) >= wordWrapWidth;
+    }
+
+    JUCE_LEAK_DETECTOR (Iterator);
+};
+
+
+//==============================================================================
+/*  Holds the text as a list of paragraphs, in blocks of up to maxParagraphsPerBlock.
+
+    A paragraph is the run of sections up to and including a new-line, and as it always
+    starts on a new line, its word-wrapped layout doesn't depend on the text before it.
+    Each paragraph caches its height and width, and each block keeps the totals of its
+    paragraphs, with Fenwick trees of these totals letting the paragraph that holds a
+    character index or y position be found without visiting all the ones before it.
+    An edit only needs to rebuild and lay out the paragraphs that it touches.
+*/
+class TextEditor::ParagraphList
+{
+public:
+    //==============================================================================
+    class Paragraph
+    {
+    public:
+        Paragraph() noexcept
+            : numChars (0), height (0), lastLineHeight (0), width (0)
+        {
+        }
+
+        ~Paragraph()
+        {
+            for (int i = sections.size(); --i >= 0;)
+            {
+                UniformTextSection* const section = sections.getUnchecked (i);
+                section->clear();
+                delete section;
+            }
+        }
+
+        void updateLayout (const float wordWrapWidth, const juce_wchar passwordCharacter)
+        {
+            height = lastLineHeight = width = 0;
+
+            if (wordWrapWidth > 0)
+            {
+                Iterator i (sections, wordWrapWidth, passwordCharacter);
+
+                while (i.next())
+                    width = jmax (width, i.atomRight);
+
+                height = i.lineY;
+                lastLineHeight = i.lineHeight;
+            }
+        }
+
+        Array <UniformTextSection*> sections;
+        int numChars;
+        float height;          // the distance from the top of this paragraph to the top of the next one
+        float lastLineHeight;
+        float width;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (Paragraph);
+    };
+
+    //==============================================================================
+    ParagraphList (const juce_wchar passwordCharacter_) noexcept
+        : numParagraphs (0), numCharacters (0), totalHeight (0),
+          wordWrapWidth (0), passwordCharacter (passwordCharacter_)
+    {
+    }
+
+    ~ParagraphList()
+    {
+        clear();
+    }
+
+    int size() const noexcept                   { return numParagraphs; }
+    int getNumCharacters() const noexcept       { return numCharacters; }
+
+    const Paragraph& getUnchecked (int index) const noexcept
+    {
+        jassert (isPositiveAndBelow (index, numParagraphs));
+        const int blockIndex = findBlock (paragraphTree, index);
+        return *blocks.getUnchecked (blockIndex)->paragraphs.getUnchecked (index);
+    }
+
+    // Finds the paragraph that contains a character, or the last one if the index is beyond the end.
+    int findParagraphContaining (const int charIndex, int& paragraphStart, float& paragraphTop) const noexcept
+    {
+        paragraphStart = 0;
+        paragraphTop = 0;
+
+        if (numParagraphs == 0)
+            return 0;
+
+        int offset = jlimit (0, numCharacters - 1, charIndex);
+        const int blockIndex = findBlock (charTree, offset);
+        const Block& b = *blocks.getUnchecked (blockIndex);
+
+        const int firstInBlock = getPrefixSum (paragraphTree, blockIndex);
+        paragraphStart = getPrefixSum (charTree, blockIndex);
+        double top = getPrefixSum (heightTree, blockIndex);
+
+        for (int i = 0;; ++i)
+        {
+            const Paragraph& p = *b.paragraphs.getUnchecked (i);
+
+            if (offset < p.numChars || i == b.paragraphs.size() - 1)
+            {
+                paragraphTop = (float) top;
+                return firstInBlock + i;
+            }
+
+            offset -= p.numChars;
+            paragraphStart += p.numChars;
+            top += p.height;
+        }
+    }
+
+    // Finds the paragraph that covers a y position, clipping the position to the text's extent.
+    int findParagraphAt (const float y, int& paragraphStart, float& paragraphTop) const noexcept
+    {
+        paragraphStart = 0;
+        paragraphTop = 0;
+
+        if (numParagraphs == 0)
+            return 0;
+
+        if (y >= totalHeight)
+        {
+            const Paragraph& last = *blocks.getLast()->paragraphs.getLast();
+            paragraphStart = numCharacters - last.numChars;
+            paragraphTop = (float) (totalHeight - last.height);
+            return numParagraphs - 1;
+        }
+
+        double offset = jmax (0.0, (double) y);
+        const int blockIndex = findBlock (heightTree, offset);
+        const Block& b = *blocks.getUnchecked (blockIndex);
+
+        const int firstInBlock = getPrefixSum (paragraphTree, blockIndex);
+        paragraphStart = getPrefixSum (charTree, blockIndex);
+        double top = getPrefixSum (heightTree, blockIndex);
+
+        for (int i = 0;; ++i)
+        {
+            const Paragraph& p = *b.paragraphs.getUnchecked (i);
+
+            if (offset < p.height || i == b.paragraphs.size() - 1)
+            {
+                paragraphTop = (float) top;
+                return firstInBlock + i;
+            }
+
+            offset -= p.height;
+            paragraphStart += p.numChars;
+            top += p.height;
+        }
+    }
+
+    // Returns the height of all the text, including the last line.
+    float getTotalHeight() const noexcept
+    {
+        return numParagraphs > 0 ? (float) (totalHeight + blocks.getLast()->paragraphs.getLast()->lastLineHeight)
+                                 : 0.0f;
+    }
+
+    float getMaximumWidth() noexcept
+    {
+        float maxWidth = 0;
+
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            if (b.maximumWidth < 0)
+            {
+                b.maximumWidth = 0;
+
+                for (int j = b.paragraphs.size(); --j >= 0;)
+                    b.maximumWidth = jmax (b.maximumWidth, b.paragraphs.getUnchecked (j)->width);
+            }
+
+            maxWidth = jmax (maxWidth, b.maximumWidth);
+        }
+
+        return maxWidth;
+    }
+
+    //==============================================================================
+    // Lays out all the paragraphs again if the width has changed.
+    void setWordWrapWidth (const float newWidth)
+    {
+        if (wordWrapWidth != newWidth)
+        {
+            wordWrapWidth = newWidth;
+            updateAllLayouts();
+        }
+    }
+
+    void applyFont (const Font& newFont, const Colour& newColour, const juce_wchar newPasswordCharacter)
+    {
+        passwordCharacter = newPasswordCharacter;
+
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            const Block& b = *blocks.getUnchecked (i);
+
+            for (int j = b.paragraphs.size(); --j >= 0;)
+            {
+                Array <UniformTextSection*>& sections = b.paragraphs.getUnchecked (j)->sections;
+
+                for (int k = sections.size(); --k >= 0;)
+                {
+                    UniformTextSection* const uts = sections.getUnchecked (k);
+                    uts->setFont (newFont, passwordCharacter);
+                    uts->colour = newColour;
+                }
+
+                coalesceSimilarSections (sections);
+            }
+        }
+
+        updateAllLayouts();
+    }
+
+    // Inserts some sections at a character index, taking ownership of them.
+    void insert (const int index, const Array <UniformTextSection*>& newSections)
+    {
+        const int insertIndex = jlimit (0, numCharacters, index);
+        int firstParagraph = 0, startIndex = 0;
+        float top;
+
+        if (numParagraphs > 0)
+            firstParagraph = findParagraphContaining (insertIndex, startIndex, top);
+
+        replace (firstParagraph, jmin (1, numParagraphs), startIndex,
+                 Range<int>::emptyRange (insertIndex), newSections);
+    }
+
+    void remove (const Range<int>& range)
+    {
+        const Range<int> r (range.getIntersectionWith (Range<int> (0, numCharacters)));
+
+        if (! r.isEmpty())
+        {
+            // (this includes the paragraph after the range, which has to be joined
+            // on to the previous one if the range ends with a new-line)
+            int startIndex, lastStartIndex;
+            float top;
+            const int firstParagraph = findParagraphContaining (r.getStart(), startIndex, top);
+            const int lastParagraph = findParagraphContaining (r.getEnd(), lastStartIndex, top);
+
+            replace (firstParagraph, lastParagraph + 1 - firstParagraph, startIndex,
+                     r, Array <UniformTextSection*>());
+        }
+    }
+
+    // Adds copies of the sections that hold a range of characters, split where needed to fit it exactly.
+    void copySections (const Range<int>& range, Array <UniformTextSection*>& dest) const
+    {
+        const Range<int> r (range.getIntersectionWith (Range<int> (0, numCharacters)));
+
+        if (r.isEmpty())
+            return;
+
+        int index;
+        float top;
+
+        for (int i = findParagraphContaining (r.getStart(), index, top); index < r.getEnd(); ++i)
+        {
+            const Array <UniformTextSection*>& sections = getUnchecked (i).sections;
+
+            for (int j = 0; j < sections.size() && index < r.getEnd(); ++j)
+            {
+                const UniformTextSection* const section = sections.getUnchecked (j);
+                const int nextIndex = index + section->getTotalLength();
+
+                if (r.getStart() < nextIndex)
+                {
+                    UniformTextSection* copy = new UniformTextSection (*section);
+
+                    if (r.getEnd() < nextIndex)
+                        deleteSection (copy->split (r.getEnd() - index, passwordCharacter));
+
+                    if (r.getStart() > index)
+                    {
+                        UniformTextSection* const end = copy->split (r.getStart() - index, passwordCharacter);
+                        deleteSection (copy);
+                        copy = end;
+                    }
+
+                    dest.add (copy);
+                }
+
+                index = nextIndex;
+            }
+        }
+    }
+
+    void appendText (MemoryOutputStream& mo, const Range<int>& range) const
+    {
+        const Range<int> r (range.getIntersectionWith (Range<int> (0, numCharacters)));
+
+        if (r.isEmpty())
+            return;
+
+        int index;
+        float top;
+
+        for (int i = findParagraphContaining (r.getStart(), index, top); index < r.getEnd(); ++i)
+        {
+            const Array <UniformTextSection*>& sections = getUnchecked (i).sections;
+
+            for (int j = 0; j < sections.size() && index < r.getEnd(); ++j)
+            {
+                const UniformTextSection* const section = sections.getUnchecked (j);
+                const int nextIndex = index + section->getTotalLength();
+
+                if (r.getStart() <= index && r.getEnd() >= nextIndex)
+                    section->appendAllText (mo);
+                else if (r.getStart() < nextIndex)
+                    section->appendSubstring (mo, r - index);
+
+                index = nextIndex;
+            }
+        }
+    }
+
+    void clear()
+    {
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            const Block& b = *blocks.getUnchecked (i);
+
+            for (int j = b.paragraphs.size(); --j >= 0;)
+                delete b.paragraphs.getUnchecked (j);
+        }
+
+        blocks.clear();
+        rebuildTrees();
+    }
+
+private:
+    //==============================================================================
+    struct Block
+    {
+        Block() noexcept : numCharacters (0), height (0), maximumWidth (0) {}
+
+        Array <Paragraph*> paragraphs;
+        int numCharacters;
+        double height;
+        float maximumWidth;  // (-1 when it needs recalculating)
+    };
+
+    enum { maxParagraphsPerBlock = 128 };
+
+    OwnedArray <Block> blocks;
+    Array <int> paragraphTree, charTree;  // Fenwick trees of the blocks' sizes, indexed from 1
+    Array <double> heightTree;
+    int numParagraphs, numCharacters;
+    double totalHeight;
+    float wordWrapWidth;
+    juce_wchar passwordCharacter;
+
+    static void deleteSection (UniformTextSection* const section)
+    {
+        section->clear();
+        delete section;
+    }
+
+    void coalesceSimilarSections (Array <UniformTextSection*>& sections) const
+    {
+        for (int i = 0; i < sections.size() - 1; ++i)
+        {
+            UniformTextSection* const s1 = sections.getUnchecked (i);
+            UniformTextSection* const s2 = sections.getUnchecked (i + 1);
+
+            if (s1->font == s2->font
+                 && s1->colour == s2->colour)
+            {
+                s1->append (*s2, passwordCharacter);
+                sections.remove (i + 1);
+                delete s2;
+                --i;
+            }
+        }
+    }
+
+    // Splits the section that contains a character, returning the index of the section that begins with it.
+    int splitSections (Array <UniformTextSection*>& sections, const int charIndex) const
+    {
+        int index = 0;
+
+        for (int i = 0; i < sections.size(); ++i)
+        {
+            if (charIndex <= index)
+                return i;
+
+            UniformTextSection* const section = sections.getUnchecked (i);
+            const int nextIndex = index + section->getTotalLength();
+
+            if (charIndex < nextIndex)
+            {
+                sections.insert (i + 1, section->split (charIndex - index, passwordCharacter));
+                return i + 1;
+            }
+
+            index = nextIndex;
+        }
+
+        return sections.size();
+    }
+
+    /*  Replaces some paragraphs with new ones, built from their old text with a range of
+        characters taken out and some new sections put in its place.
+    */
+    void replace (const int firstParagraph, const int numToReplace, const int startIndex,
+                  const Range<int>& charsToRemove, const Array <UniformTextSection*>& sectionsToInsert)
+    {
+        Array <UniformTextSection*> sections;
+
+        for (int i = 0; i < numToReplace; ++i)
+        {
+            int indexInBlock = firstParagraph + i;
+            Array <UniformTextSection*>& oldSections = blocks.getUnchecked (findBlock (paragraphTree, indexInBlock))
+                                                         ->paragraphs.getUnchecked (indexInBlock)->sections;
+            sections.addArray (oldSections);
+            oldSections.clearQuick();
+        }
+
+        removeParagraphs (firstParagraph, numToReplace);
+
+        const int removeStart = splitSections (sections, charsToRemove.getStart() - startIndex);
+        const int removeEnd = splitSections (sections, charsToRemove.getEnd() - startIndex);
+
+        for (int i = removeEnd; --i >= removeStart;)
+            deleteSection (sections.getUnchecked (i));
+
+        sections.removeRange (removeStart, removeEnd - removeStart);
+        sections.insertArray (removeStart, sectionsToInsert.begin(), sectionsToInsert.size());
+
+        Array <Paragraph*> newParagraphs;
+        createParagraphs (sections, newParagraphs);
+        insertParagraphs (firstParagraph, newParagraphs);
+    }
+
+    // Gathers some sections into paragraphs, splitting them after each new-line.
+    void createParagraphs (Array <UniformTextSection*>& sections, Array <Paragraph*>& newParagraphs) const
+    {
+        coalesceSimilarSections (sections);
+
+        Array <UniformTextSection*> lines;
+        Paragraph* paragraph = nullptr;
+
+        for (int i = 0; i < sections.size(); ++i)
+        {
+            UniformTextSection* const section = sections.getUnchecked (i);
+            lines.clearQuick();
+
+            if (section->hasNewLineBeforeEnd())
+            {
+                section->moveLinesTo (lines);
+                delete section;
+            }
+            else
+            {
+                lines.add (section);
+            }
+
+            for (int j = 0; j < lines.size(); ++j)
+            {
+                UniformTextSection* const line = lines.getUnchecked (j);
+
+                if (line->getNumAtoms() == 0)
+                {
+                    delete line;
+                    continue;
+                }
+
+                if (paragraph == nullptr)
+                    newParagraphs.add (paragraph = new Paragraph());
+
+                paragraph->sections.add (line);
+                paragraph->numChars += line->getTotalLength();
+
+                if (line->endsWithNewLine())
+                    paragraph = nullptr;
+            }
+        }
+
+        for (int i = newParagraphs.size(); --i >= 0;)
+            newParagraphs.getUnchecked (i)->updateLayout (wordWrapWidth, passwordCharacter);
+    }
+
+    void updateAllLayouts()
+    {
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+            b.height = 0;
+            b.maximumWidth = -1;
+
+            for (int j = b.paragraphs.size(); --j >= 0;)
+            {
+                Paragraph& p = *b.paragraphs.getUnchecked (j);
+                p.updateLayout (wordWrapWidth, passwordCharacter);
+                b.height += p.height;
+            }
+        }
+
+        rebuildTrees();
+    }
+
+    //==============================================================================
+    template <typename Type>
+    static Type getPrefixSum (const Array<Type>& tree, int numBlocks) noexcept
+    {
+        Type total = 0;
+
+        for (; numBlocks > 0; numBlocks &= numBlocks - 1)
+            total += tree.getUnchecked (numBlocks);
+
+        return total;
+    }
+
+    // Finds the block containing the given offset, and changes the offset to be relative to its start
+    template <typename Type>
+    int findBlock (const Array<Type>& tree, Type& offset) const noexcept
+    {
+        const int numBlocks = blocks.size();
+        int blockIndex = 0;
+
+        for (int step = nextPowerOfTwo (numBlocks + 1) / 2; step > 0; step >>= 1)
+        {
+            const int next = blockIndex + step;
+
+            if (next <= numBlocks && tree.getUnchecked (next) <= offset)
+            {
+                blockIndex = next;
+                offset -= tree.getUnchecked (next);
+            }
+        }
+
+        return jmin (blockIndex, numBlocks - 1);
+    }
+
+    void addToTrees (const int blockIndex, const int paragraphDelta, const int charDelta, const double heightDelta) noexcept
+    {
+        numParagraphs += paragraphDelta;
+        numCharacters += charDelta;
+        totalHeight += heightDelta;
+
+        for (int i = blockIndex + 1; i < paragraphTree.size(); i += (i & -i))
+        {
+            paragraphTree.getReference (i) += paragraphDelta;
+            charTree.getReference (i) += charDelta;
+            heightTree.getReference (i) += heightDelta;
+        }
+    }
+
+    void rebuildTrees()
+    {
+        const int numBlocks = blocks.size();
+        paragraphTree.clearQuick();
+        paragraphTree.insertMultiple (0, 0, numBlocks + 1);
+        charTree = paragraphTree;
+        heightTree.clearQuick();
+        heightTree.insertMultiple (0, 0.0, numBlocks + 1);
+        numParagraphs = numCharacters = 0;
+        totalHeight = 0;
+
+        for (int i = 1; i <= numBlocks; ++i)
+        {
+            const Block& b = *blocks.getUnchecked (i - 1);
+            numParagraphs += b.paragraphs.size();
+            numCharacters += b.numCharacters;
+            totalHeight += b.height;
+
+            paragraphTree.getReference (i) += b.paragraphs.size();
+            charTree.getReference (i) += b.numCharacters;
+            heightTree.getReference (i) += b.height;
+
+            const int parent = i + (i & -i);
+
+            if (parent <= numBlocks)
+            {
+                paragraphTree.getReference (parent) += paragraphTree.getUnchecked (i);
+                charTree.getReference (parent) += charTree.getUnchecked (i);
+                heightTree.getReference (parent) += heightTree.getUnchecked (i);
+            }
+        }
+    }
+
+    // Inserts some paragraphs, taking ownership of them.
+    void insertParagraphs (int index, const Array <Paragraph*>& newParagraphs)
+    {
+        jassert (isPositiveAndNotGreaterThan (index, numParagraphs));
+
+        if (newParagraphs.size() == 0)
+            return;
+
+        int blockIndex;
+        bool needsRebuilding = false;
+
+        if (blocks.size() == 0)
+        {
+            blocks.add (new Block());
+            blockIndex = index = 0;
+            needsRebuilding = true;
+        }
+        else if (index >= numParagraphs)
+        {
+            blockIndex = blocks.size() - 1;
+            index = blocks.getUnchecked (blockIndex)->paragraphs.size();
+        }
+        else
+        {
+            blockIndex = findBlock (paragraphTree, index);
+        }
+
+        Block& b = *blocks.getUnchecked (blockIndex);
+        b.paragraphs.insertArray (index, newParagraphs.begin(), newParagraphs.size());
+
+        int numChars = 0;
+        double height = 0;
+
+        for (int i = newParagraphs.size(); --i >= 0;)
+        {
+            const Paragraph& p = *newParagraphs.getUnchecked (i);
+            numChars += p.numChars;
+            height += p.height;
+
+            if (b.maximumWidth >= 0)
+                b.maximumWidth = jmax (b.maximumWidth, p.width);
+        }
+
+        b.numCharacters += numChars;
+        b.height += height;
+
+        if (b.paragraphs.size() > maxParagraphsPerBlock || needsRebuilding)
+        {
+            splitBlock (blockIndex);
+            rebuildTrees();
+        }
+        else
+        {
+            addToTrees (blockIndex, newParagraphs.size(), numChars, height);
+        }
+    }
+
+    void removeParagraphs (const int startIndex, int numToRemove)
+    {
+        numToRemove = jmin (numToRemove, numParagraphs - startIndex);
+
+        if (numToRemove <= 0)
+            return;
+
+        int indexInBlock = startIndex;
+        int blockIndex = findBlock (paragraphTree, indexInBlock);
+        bool needsRebuilding = false;
+
+        while (numToRemove > 0)
+        {
+            Block& b = *blocks.getUnchecked (blockIndex);
+            const int num = jmin (numToRemove, b.paragraphs.size() - indexInBlock);
+            int numChars = 0;
+            double height = 0;
+
+            for (int i = indexInBlock + num; --i >= indexInBlock;)
             {
-                cx = indexToX (index);
-                cy = lineY;
-                lineHeight_ = lineHeight;
-                return true;
+                const Paragraph* const p = b.paragraphs.getUnchecked (i);
+                numChars += p->numChars;
+                height += p->height;
+                delete p;
             }
-        }
 
-        cx = atomX;
-        cy = lineY;
-        lineHeight_ = lineHeight;
-        return false;
-    }
+            b.paragraphs.removeRange (indexInBlock, num);
+            b.numCharacters -= numChars;
+            b.height -= height;
+            b.maximumWidth = -1;
+            numToRemove -= num;
 
-    //==============================================================================
-    int indexInText;
-    float lineY, lineHeight, maxDescent;
-    float atomX, atomRight;
-    const TextAtom* atom;
-    const UniformTextSection* currentSection;
+            if (b.paragraphs.size() < maxParagraphsPerBlock / 4)
+                needsRebuilding = true;
+            else
+                addToTrees (blockIndex, -num, -numChars, -height);
 
-private:
-    const Array <UniformTextSection*>& sections;
-    int sectionIndex, atomIndex;
-    const float wordWrapWidth;
-    const juce_wchar passwordCharacter;
-    TextAtom tempAtom;
+            ++blockIndex;
+            indexInBlock = 0;
+        }
 
-    Iterator& operator= (const Iterator&);
+        if (needsRebuilding)
+        {
+            mergeSmallBlocks();
+            rebuildTrees();
+        }
+    }
 
-    void moveToEndOfLastAtom()
+    // Breaks up a block that has grown too big into half-full ones
+    void splitBlock (const int blockIndex)
     {
-        if (atom != nullptr)
+        Block& b = *blocks.getUnchecked (blockIndex);
+        const int paragraphsPerBlock = maxParagraphsPerBlock / 2;
+        int insertIndex = blockIndex + 1;
+
+        for (int start = paragraphsPerBlock; start < b.paragraphs.size(); start += paragraphsPerBlock)
         {
-            atomX = atomRight;
+            Block* const newBlock = new Block();
+            newBlock->paragraphs.addArray (b.paragraphs, start, paragraphsPerBlock);
+            newBlock->maximumWidth = -1;
 
-            if (atom->isNewLine())
+            for (int i = newBlock->paragraphs.size(); --i >= 0;)
             {
-                atomX = 0.0f;
-                lineY += lineHeight;
+                const Paragraph& p = *newBlock->paragraphs.getUnchecked (i);
+                newBlock->numCharacters += p.numChars;
+                newBlock->height += p.height;
             }
+
+            b.numCharacters -= newBlock->numCharacters;
+            b.height -= newBlock->height;
+            blocks.insert (insertIndex++, newBlock);
+        }
+
+        if (b.paragraphs.size() > paragraphsPerBlock)
+        {
+            b.paragraphs.removeRange (paragraphsPerBlock, b.paragraphs.size() - paragraphsPerBlock);
+            b.maximumWidth = -1;
         }
     }
 
-    bool shouldWrap (const float x) const
+    void mergeSmallBlocks()
     {
-        return (x - 0.0001f) >= wordWrapWidth;
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            if (b.paragraphs.size() == 0)
+            {
+                blocks.remove (i);
+            }
+            else if (b.paragraphs.size() < maxParagraphsPerBlock / 4 && i > 0)
+            {
+                Block& previous = *blocks.getUnchecked (i - 1);
+
+                if (previous.paragraphs.size() + b.paragraphs.size() <= maxParagraphsPerBlock)
+                {
+                    previous.paragraphs.addArray (b.paragraphs);
+                    previous.numCharacters += b.numCharacters;
+                    previous.height += b.height;
+                    previous.maximumWidth = -1;
+                    blocks.remove (i);
+                }
+            }
+        }
     }
 
-    JUCE_LEAK_DETECTOR (Iterator);
+    JUCE_DECLARE_NON_COPYABLE (ParagraphList);
 };
 
+//==============================================================================
+TextEditor::Iterator::Iterator (const ParagraphList& paragraphs_,
+                                const int paragraphIndex_,
+                                const int paragraphStart,
+                                const float paragraphTop,
+                                const float wordWrapWidth_,
+                                const juce_wchar passwordCharacter_)
+  : indexInText (paragraphStart),
+    lineY (paragraphTop),
+    lineHeight (0),
+    maxDescent (0),
+    atomX (0),
+    atomRight (0),
+    atom (0),
+    currentSection (nullptr),
+    sections (&(paragraphs_.getUnchecked (paragraphIndex_).sections)),
+    paragraphs (&paragraphs_),
+    paragraphIndex (paragraphIndex_),
+    sectionIndex (0),
+    atomIndex (0),
+    wordWrapWidth (wordWrapWidth_),
+    passwordCharacter (passwordCharacter_)
+{
+    jassert (wordWrapWidth_ > 0);
+    begin();
+}
+
+bool TextEditor::Iterator::moveToNextParagraph()
+{
+    if (paragraphs == nullptr || paragraphIndex >= paragraphs->size() - 1)
+        return false;
+
+    sections = &(paragraphs->getUnchecked (++paragraphIndex).sections);
+    sectionIndex = 0;
+    return true;
+}
 
 //==============================================================================
 class TextEditor::InsertAction  : public UndoableAction
@@ -975,8 +1819,8 @@ TextEditor::TextEditor (const String& name,
       topIndent (4),
       lastTransactionTime (0),
       currentFont (14.0f),
-      totalNumChars (0),
       caretPosition (0),
+      paragraphs (new ParagraphList (passwordCharacter_)),
       passwordCharacter (passwordCharacter_),
       dragType (notDragging)
 {
@@ -1124,16 +1968,8 @@ void TextEditor::applyFontToAllText (const Font& newFont)
 {
     currentFont = newFont;
 
-    const Colour overallColour (findColour (textColourId));
-
-    for (int i = sections.size(); --i >= 0;)
-    {
-        UniformTextSection* const uts = sections.getUnchecked (i);
-        uts->setFont (newFont, passwordCharacter);
-        uts->colour = overallColour;
-    }
+    paragraphs->applyFont (newFont, findColour (textColourId), passwordCharacter);
 
-    coalesceSimilarSections();
     updateTextHolderSize();
     scrollToMakeSureCursorIsVisible();
     repaint();
@@ -1327,9 +2163,7 @@ void TextEditor::repaintText (const Range<int>& range)
 
         if (wordWrapWidth > 0)
         {
-            Iterator i (sections, wordWrapWidth, passwordCharacter);
-
-            i.getCharPosition (range.getStart(), x, y, lh);
+            getCharPosition (range.getStart(), x, y, lh);
 
             const int y1 = (int) y;
             int y2;
@@ -1340,7 +2174,7 @@ void TextEditor::repaintText (const Range<int>& range)
             }
             else
             {
-                i.getCharPosition (range.getEnd(), x, y, lh);
+                getCharPosition (range.getEnd(), x, y, lh);
                 y2 = (int) (y + lh * 2.0f);
             }
 
@@ -1438,15 +2272,10 @@ void TextEditor::updateTextHolderSize()
 
     if (wordWrapWidth > 0)
     {
-        float maxWidth = 0.0f;
-
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->setWordWrapWidth (wordWrapWidth);
 
-        while (i.next())
-            maxWidth = jmax (maxWidth, i.atomRight);
-
-        const int w = leftIndent + roundToInt (maxWidth);
-        const int h = topIndent + roundToInt (jmax (i.lineY + i.lineHeight,
+        const int w = leftIndent + roundToInt (paragraphs->getMaximumWidth());
+        const int h = topIndent + roundToInt (jmax (paragraphs->getTotalHeight(),
                                                     currentFont.getHeight()));
 
         textHolder->setSize (w + 2, h + 1); // (the +2 allows a bit of space for the cursor to be at the right-hand-edge)
@@ -1664,7 +2493,17 @@ void TextEditor::drawContent (Graphics& g)
         const Rectangle<int> clip (g.getClipBounds());
         Colour selectedTextColour;
 
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->setWordWrapWidth (wordWrapWidth);
+
+        if (paragraphs->size() == 0)
+            return;
+
+        // (only the paragraphs from the one at the top of the clip region onwards need laying out)
+        int firstIndex;
+        float firstY;
+        const int firstParagraph = paragraphs->findParagraphAt ((float) clip.getY(), firstIndex, firstY);
+
+        Iterator i (*paragraphs, firstParagraph, firstIndex, firstY, wordWrapWidth, passwordCharacter);
 
         while (i.lineY + 200.0 < clip.getY() && i.next())
         {}
@@ -1709,7 +2548,7 @@ void TextEditor::drawContent (Graphics& g)
         {
             const Range<int>& underlinedSection = underlinedSections.getReference (j);
 
-            Iterator i2 (sections, wordWrapWidth, passwordCharacter);
+            Iterator i2 (*paragraphs, firstParagraph, firstIndex, firstY, wordWrapWidth, passwordCharacter);
 
             while (i2.next() && i2.lineY < clip.getBottom())
             {
@@ -1824,13 +2663,17 @@ void TextEditor::mouseDoubleClick (const MouseEvent& e)
     }
     else
     {
-        const String t (getText());
-        const int totalLength = getTotalNumChars();
+        // (words and lines never extend beyond the paragraph that was clicked)
+        int paragraphStart = 0;
+        float paragraphTop;
+        const int paragraph = paragraphs->findParagraphContaining (tokenEnd, paragraphStart, paragraphTop);
+        const int totalLength = paragraphs->size() > 0 ? paragraphStart + paragraphs->getUnchecked (paragraph).numChars : 0;
+        const String t (getTextInRange (Range<int> (paragraphStart, totalLength)));
 
         while (tokenEnd < totalLength)
         {
             // (note the slight bodge here - it's because iswalnum only checks for alphabetic chars in the current locale)
-            const juce_wchar c = t [tokenEnd];
+            const juce_wchar c = t [tokenEnd - paragraphStart];
             if (CharacterFunctions::isLetterOrDigit (c) || c > 128)
                 ++tokenEnd;
             else
@@ -1839,10 +2682,10 @@ void TextEditor::mouseDoubleClick (const MouseEvent& e)
 
         tokenStart = tokenEnd;
 
-        while (tokenStart > 0)
+        while (tokenStart > paragraphStart)
         {
             // (note the slight bodge here - it's because iswalnum only checks for alphabetic chars in the current locale)
-            const juce_wchar c = t [tokenStart - 1];
+            const juce_wchar c = t [tokenStart - 1 - paragraphStart];
             if (CharacterFunctions::isLetterOrDigit (c) || c > 128)
                 --tokenStart;
             else
@@ -1853,16 +2696,16 @@ void TextEditor::mouseDoubleClick (const MouseEvent& e)
         {
             while (tokenEnd < totalLength)
             {
-                const juce_wchar c = t [tokenEnd];
+                const juce_wchar c = t [tokenEnd - paragraphStart];
                 if (c != '\r' && c != '\n')
                     ++tokenEnd;
                 else
                     break;
             }
 
-            while (tokenStart > 0)
+            while (tokenStart > paragraphStart)
             {
-                const juce_wchar c = t [tokenStart - 1];
+                const juce_wchar c = t [tokenStart - 1 - paragraphStart];
                 if (c != '\r' && c != '\n')
                     --tokenStart;
                 else
@@ -2264,39 +3107,10 @@ void TextEditor::insert (const String& text,
             repaintText (Range<int> (insertIndex, getTotalNumChars())); // must do this before and after changing the data, in case
                                                                         // a line gets moved due to word wrap
 
-            int index = 0;
-            int nextIndex = 0;
-
-            for (int i = 0; i < sections.size(); ++i)
-            {
-                nextIndex = index + sections.getUnchecked (i)->getTotalLength();
-
-                if (insertIndex == index)
-                {
-                    sections.insert (i, new UniformTextSection (text,
-                                                                font, colour,
-                                                                passwordCharacter));
-                    break;
-                }
-                else if (insertIndex > index && insertIndex < nextIndex)
-                {
-                    splitSection (i, insertIndex - index);
-                    sections.insert (i + 1, new UniformTextSection (text,
-                                                                    font, colour,
-                                                                    passwordCharacter));
-                    break;
-                }
-
-                index = nextIndex;
-            }
-
-            if (nextIndex == insertIndex)
-                sections.add (new UniformTextSection (text,
-                                                      font, colour,
-                                                      passwordCharacter));
+            Array <UniformTextSection*> newSections;
+            newSections.add (new UniformTextSection (text, font, colour, passwordCharacter));
+            paragraphs->insert (insertIndex, newSections);
 
-            coalesceSimilarSections();
-            totalNumChars = -1;
             valueTextNeedsUpdating = true;
 
             updateTextHolderSize();
@@ -2310,41 +3124,12 @@ void TextEditor::insert (const String& text,
 void TextEditor::reinsert (const int insertIndex,
                            const Array <UniformTextSection*>& sectionsToInsert)
 {
-    int index = 0;
-    int nextIndex = 0;
-
-    for (int i = 0; i < sections.size(); ++i)
-    {
-        nextIndex = index + sections.getUnchecked (i)->getTotalLength();
-
-        if (insertIndex == index)
-        {
-            for (int j = sectionsToInsert.size(); --j >= 0;)
-                sections.insert (i, new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-
-            break;
-        }
-        else if (insertIndex > index && insertIndex < nextIndex)
-        {
-            splitSection (i, insertIndex - index);
-
-            for (int j = sectionsToInsert.size(); --j >= 0;)
-                sections.insert (i + 1, new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-
-            break;
-        }
+    Array <UniformTextSection*> newSections;
 
-        index = nextIndex;
-    }
-
-    if (nextIndex == insertIndex)
-    {
-        for (int j = 0; j < sectionsToInsert.size(); ++j)
-            sections.add (new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-    }
+    for (int i = 0; i < sectionsToInsert.size(); ++i)
+        newSections.add (new UniformTextSection (*sectionsToInsert.getUnchecked (i)));
 
-    coalesceSimilarSections();
-    totalNumChars = -1;
+    paragraphs->insert (insertIndex, newSections);
     valueTextNeedsUpdating = true;
 }
 
@@ -2354,51 +3139,10 @@ void TextEditor::remove (const Range<int>& range,
 {
     if (! range.isEmpty())
     {
-        int index = 0;
-
-        for (int i = 0; i < sections.size(); ++i)
-        {
-            const int nextIndex = index + sections.getUnchecked(i)->getTotalLength();
-
-            if (range.getStart() > index && range.getStart() < nextIndex)
-            {
-                splitSection (i, range.getStart() - index);
-                --i;
-            }
-            else if (range.getEnd() > index && range.getEnd() < nextIndex)
-            {
-                splitSection (i, range.getEnd() - index);
-                --i;
-            }
-            else
-            {
-                index = nextIndex;
-
-                if (index > range.getEnd())
-                    break;
-            }
-        }
-
-        index = 0;
-
         if (um != nullptr)
         {
             Array <UniformTextSection*> removedSections;
-
-            for (int i = 0; i < sections.size(); ++i)
-            {
-                if (range.getEnd() <= range.getStart())
-                    break;
-
-                UniformTextSection* const section = sections.getUnchecked (i);
-
-                const int nextIndex = index + section->getTotalLength();
-
-                if (range.getStart() <= index && range.getEnd() >= nextIndex)
-                    removedSections.add (new UniformTextSection (*section));
-
-                index = nextIndex;
-            }
+            paragraphs->copySections (range, removedSections);
 
             if (um->getNumActionsInCurrentTransaction() > TextEditorDefs::maxActionsPerTransaction)
                 newTransaction();
@@ -2408,34 +3152,7 @@ void TextEditor::remove (const Range<int>& range,
         }
         else
         {
-            Range<int> remainingRange (range);
-
-            for (int i = 0; i < sections.size(); ++i)
-            {
-                UniformTextSection* const section = sections.getUnchecked (i);
-
-                const int nextIndex = index + section->getTotalLength();
-
-                if (remainingRange.getStart() <= index && remainingRange.getEnd() >= nextIndex)
-                {
-                    sections.remove(i);
-                    section->clear();
-                    delete section;
-
-                    remainingRange.setEnd (remainingRange.getEnd() - (nextIndex - index));
-                    if (remainingRange.isEmpty())
-                        break;
-
-                    --i;
-                }
-                else
-                {
-                    index = nextIndex;
-                }
-            }
-
-            coalesceSimilarSections();
-            totalNumChars = -1;
+            paragraphs->remove (range);
             valueTextNeedsUpdating = true;
 
             moveCaretTo (caretPositionToMoveTo, false);
@@ -2451,8 +3168,7 @@ String TextEditor::getText() const
     MemoryOutputStream mo;
     mo.preallocate ((size_t) getTotalNumChars());
 
-    for (int i = 0; i < sections.size(); ++i)
-        sections.getUnchecked (i)->appendAllText (mo);
+    paragraphs->appendText (mo, Range<int> (0, getTotalNumChars()));
 
     return mo.toString();
 }
@@ -2465,23 +3181,7 @@ String TextEditor::getTextInRange (const Range<int>& range) const
     MemoryOutputStream mo;
     mo.preallocate ((size_t) jmin (getTotalNumChars(), range.getLength()));
 
-    int index = 0;
-
-    for (int i = 0; i < sections.size(); ++i)
-    {
-        const UniformTextSection* const s = sections.getUnchecked (i);
-        const int nextIndex = index + s->getTotalLength();
-
-        if (range.getStart() < nextIndex)
-        {
-            if (range.getEnd() <= index)
-                break;
-
-            s->appendSubstring (mo, range - index);
-        }
-
-        index = nextIndex;
-    }
+    paragraphs->appendText (mo, range);
 
     return mo.toString();
 }
@@ -2493,15 +3193,7 @@ String TextEditor::getHighlightedText() const
 
 int TextEditor::getTotalNumChars() const
 {
-    if (totalNumChars < 0)
-    {
-        totalNumChars = 0;
-
-        for (int i = sections.size(); --i >= 0;)
-            totalNumChars += sections.getUnchecked (i)->getTotalLength();
-    }
-
-    return totalNumChars;
+    return paragraphs->getNumCharacters();
 }
 
 bool TextEditor::isEmpty() const
@@ -2513,9 +3205,15 @@ void TextEditor::getCharPosition (const int index, float& cx, float& cy, float&
 {
     const float wordWrapWidth = getWordWrapWidth();
 
-    if (wordWrapWidth > 0 && sections.size() > 0)
+    if (wordWrapWidth > 0 && paragraphs->size() > 0)
     {
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->setWordWrapWidth (wordWrapWidth);
+
+        int paragraphStart;
+        float paragraphTop;
+        const int paragraph = paragraphs->findParagraphContaining (index, paragraphStart, paragraphTop);
+
+        Iterator i (*paragraphs, paragraph, paragraphStart, paragraphTop, wordWrapWidth, passwordCharacter);
 
         i.getCharPosition (index, cx, cy, lineHeight);
     }
@@ -2530,9 +3228,15 @@ int TextEditor::indexAtPosition (const float x, const float y)
 {
     const float wordWrapWidth = getWordWrapWidth();
 
-    if (wordWrapWidth > 0)
+    if (wordWrapWidth > 0 && paragraphs->size() > 0)
     {
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->setWordWrapWidth (wordWrapWidth);
+
+        int paragraphStart;
+        float paragraphTop;
+        const int paragraph = paragraphs->findParagraphAt (y, paragraphStart, paragraphTop);
+
+        Iterator i (*paragraphs, paragraph, paragraphStart, paragraphTop, wordWrapWidth, passwordCharacter);
 
         while (i.next())
         {
@@ -2600,34 +3304,6 @@ int TextEditor::findWordBreakBefore (const int position) const
 }
 
 
-//==============================================================================
-void TextEditor::splitSection (const int sectionIndex,
-                               const int charToSplitAt)
-{
-    jassert (sections[sectionIndex] != nullptr);
-
-    sections.insert (sectionIndex + 1,
-                     sections.getUnchecked (sectionIndex)->split (charToSplitAt, passwordCharacter));
-}
-
-void TextEditor::coalesceSimilarSections()
-{
-    for (int i = 0; i < sections.size() - 1; ++i)
-    {
-        UniformTextSection* const s1 = sections.getUnchecked (i);
-        UniformTextSection* const s2 = sections.getUnchecked (i + 1);
-
-        if (s1->font == s2->font
-             && s1->colour == s2->colour)
-        {
-            s1->append (*s2, passwordCharacter);
-            sections.remove (i + 1);
-            delete s2;
-            --i;
-        }
-    }
-}
-
 void TextEditor::Listener::textEditorTextChanged (TextEditor&) {}
 void TextEditor::Listener::textEditorReturnKeyPressed (TextEditor&) {}
 void TextEditor::Listener::textEditorEscapeKeyPressed (TextEditor&) {}
@@ -2661,3 +3337,226 @@ void TextEditor::refreshFromValueTree (const ValueTree& state, ComponentBuilder&
 
     setText (state [Ids::text].toString());
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TextEditorTests  : public UnitTest
+{
+public:
+    TextEditorTests() : UnitTest ("TextEditor") {}
+
+    static void setUpWrappedEditor (TextEditor& editor, const Font& font, const int width)
+    {
+        editor.setMultiLine (true, true);
+        editor.setScrollbarsShown (false);
+        editor.setScrollToShowCursor (false);
+        editor.setIndents (0, 0);
+        editor.setBorder (BorderSize<int> (0));
+        editor.setFont (font);
+        editor.setSize (width, 100000);
+    }
+
+    static Rectangle<int> getCaretRectangleAt (TextEditor& editor, const int index)
+    {
+        editor.setCaretPosition (index);
+        return editor.getCaretRectangle();
+    }
+
+    static String createRandomText (Random& r, const int numWords)
+    {
+        String s;
+
+        for (int i = 0; i < numWords; ++i)
+        {
+            const int wordLength = r.nextInt (20) == 0 ? 40 : r.nextInt (10) + 1;
+
+            for (int j = 0; j < wordLength; ++j)
+                s << (juce_wchar) ('a' + r.nextInt (26));
+
+            s << (r.nextInt (4) == 0 ? '\n' : ' ');
+        }
+
+        return s;
+    }
+
+    // checks that the position of each character maps back to its index
+    void expectPositionsMapToIndexes (TextEditor& editor)
+    {
+        for (int i = 0; i <= editor.getTotalNumChars(); ++i)
+        {
+            const Rectangle<int> r (getCaretRectangleAt (editor, i));
+            expectEquals (editor.getTextIndexAt (r.getX(), r.getCentreY()), i);
+        }
+    }
+
+    // checks that an editor which has been edited lays out the same as one that's been given all its text at once
+    void expectSameLayoutAsNewEditor (TextEditor& editor)
+    {
+        TextEditor reference;
+        setUpWrappedEditor (reference, editor.getFont(), editor.getWidth());
+        reference.setText (editor.getText());
+
+        expectEquals (editor.getTextHeight(), reference.getTextHeight());
+        expectEquals (editor.getTextWidth(), reference.getTextWidth());
+
+        for (int i = 0; i <= editor.getTotalNumChars(); ++i)
+            expect (getCaretRectangleAt (editor, i) == getCaretRectangleAt (reference, i));
+    }
+
+    void runTest()
+    {
+        beginTest ("Word wrap");
+
+        const Font font (15.0f), bigFont (30.0f);
+        const float wordWidth = font.getStringWidthFloat ("abcd");
+        const float spaceWidth = font.getStringWidthFloat (" ");
+        const float lineHeight = font.getHeight();
+
+        // (wide enough for exactly five of these words on each line)
+        TextEditor editor;
+        setUpWrappedEditor (editor, font, roundToInt (5 * (wordWidth + spaceWidth) + wordWidth / 2));
+
+        editor.setText (String::repeatedString ("abcd ", 23));
+        expectEquals (editor.getTextHeight(), roundToInt (5 * lineHeight) + 1);
+
+        for (int i = 0; i < 23; ++i)
+        {
+            const Rectangle<int> r (getCaretRectangleAt (editor, i * 5));
+            expectEquals (r.getY(), roundToInt ((i / 5) * lineHeight));
+            expect (std::abs (r.getX() - (i % 5) * (wordWidth + spaceWidth)) < 1.0f);
+        }
+
+        expectPositionsMapToIndexes (editor);
+
+        // a word that's too long for a line gets broken up, starting on a new line, with no empty lines in it..
+        editor.setText ("ab " + String::repeatedString ("m", 100));
+        expect (getCaretRectangleAt (editor, 3).getPosition() == Point<int> (0, roundToInt (lineHeight)));
+
+        int lastY = 0;
+
+        for (int i = 4; i <= editor.getTotalNumChars(); ++i)
+        {
+            const int y = getCaretRectangleAt (editor, i).getY();
+            expect (y == lastY || y == roundToInt (lastY + lineHeight));
+            lastY = y;
+        }
+
+        expectEquals (editor.getTextHeight(), roundToInt (lastY + lineHeight) + 1);
+        expectPositionsMapToIndexes (editor);
+
+        beginTest ("New-lines");
+
+        editor.clear();
+        editor.setFont (bigFont);
+        editor.insertTextAtCaret ("abcd abcd\n");
+        editor.setFont (font);
+        editor.insertTextAtCaret ("abcd abcd abcd abcd abcd abcd abcd\n\nabcd");
+        editor.setFont (bigFont);
+        editor.insertTextAtCaret (" abcd");
+
+        // each line after a new-line starts from scratch, and is only as high as its own text..
+        expect (getCaretRectangleAt (editor, 10) == Rectangle<int> (0, roundToInt (bigFont.getHeight()), 2, roundToInt (lineHeight)));
+        expectEquals (getCaretRectangleAt (editor, 35).getY(), roundToInt (bigFont.getHeight() + lineHeight));
+        expectEquals (getCaretRectangleAt (editor, 46).getY(), roundToInt (bigFont.getHeight() + 3 * lineHeight));
+        expectEquals (editor.getTextHeight(), roundToInt (2 * bigFont.getHeight() + 3 * lineHeight) + 1);
+        expectPositionsMapToIndexes (editor);
+
+        // ..so a paragraph is laid out the same as it would be on its own
+        {
+            TextEditor paragraph;
+            setUpWrappedEditor (paragraph, font, editor.getWidth());
+            paragraph.setText ("abcd abcd abcd abcd abcd abcd abcd\n");
+
+            for (int i = 0; i <= paragraph.getTotalNumChars(); ++i)
+                expect (getCaretRectangleAt (paragraph, i) + Point<int> (0, roundToInt (bigFont.getHeight()))
+                          == getCaretRectangleAt (editor, i + 10));
+        }
+
+        beginTest ("Words that span several sections");
+
+        // a word with parts in different colours that doesn't fit at the end of a line moves to the next one..
+        editor.clear();
+        editor.setFont (font);
+        editor.setColour (TextEditor::textColourId, Colours::red);
+        editor.insertTextAtCaret ("abcd abcd abcd abcd ab");
+        editor.setColour (TextEditor::textColourId, Colours::blue);
+        editor.insertTextAtCaret ("cdabcd abcd");
+
+        expect (getCaretRectangleAt (editor, 20).getPosition() == Point<int> (0, roundToInt (lineHeight)));
+        expectEquals (editor.getTextHeight(), roundToInt (2 * lineHeight) + 1);
+        expectPositionsMapToIndexes (editor);
+
+        // ..but if it's already at the start of a line and is too long to fit, it's broken up there,
+        // rather than leaving an empty line before it
+        editor.clear();
+        editor.setColour (TextEditor::textColourId, Colours::red);
+        editor.insertTextAtCaret ("abcdabcdabcdabcd");
+        editor.setColour (TextEditor::textColourId, Colours::blue);
+        editor.insertTextAtCaret ("abcdabcdabcdabcdabcd");
+
+        expect (getCaretRectangleAt (editor, 0).getPosition() == Point<int>());
+        expect (getCaretRectangleAt (editor, 16).getPosition() == Point<int> (0, roundToInt (lineHeight)));
+        expectEquals (editor.getTextHeight(), roundToInt (2 * lineHeight) + 1);
+        expectPositionsMapToIndexes (editor);
+
+        editor.setCaretPosition (0);
+        editor.setColour (TextEditor::textColourId, Colours::green);
+        editor.insertTextAtCaret ("ab\n");
+
+        expect (getCaretRectangleAt (editor, 3).getPosition() == Point<int> (0, roundToInt (lineHeight)));
+        expectEquals (editor.getTextHeight(), roundToInt (3 * lineHeight) + 1);
+        expectPositionsMapToIndexes (editor);
+
+        editor.removeColour (TextEditor::textColourId);
+
+        beginTest ("Editing");
+
+        Random r;
+        const String originalText (createRandomText (r, 1000));  // (enough paragraphs to need several blocks)
+        String expectedText (originalText);
+
+        editor.setText (originalText);
+        expectSameLayoutAsNewEditor (editor);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const int start = r.nextInt (expectedText.length() + 1);
+            const int end = jmin (expectedText.length(), start + r.nextInt (50));
+            const String newText (r.nextBool() ? createRandomText (r, r.nextInt (8)) : String::empty);
+
+            editor.setHighlightedRegion (Range<int> (start, end));
+            editor.insertTextAtCaret (newText);
+            expectedText = expectedText.substring (0, start) + newText + expectedText.substring (end);
+
+            expect (editor.getText() == expectedText);
+            expectEquals (editor.getTotalNumChars(), expectedText.length());
+            expectEquals (editor.getCaretPosition(), start + newText.length());
+
+            if (i % 50 == 0)
+                expectSameLayoutAsNewEditor (editor);
+        }
+
+        expectSameLayoutAsNewEditor (editor);
+
+        while (editor.undo())
+        {}
+
+        expect (editor.getText() == originalText);
+        expectSameLayoutAsNewEditor (editor);
+
+        while (editor.redo())
+        {}
+
+        expect (editor.getText() == expectedText);
+        expectSameLayoutAsNewEditor (editor);
+
+        // changing the width lays everything out again..
+        editor.setSize (editor.getWidth() / 2, editor.getHeight());
+        expectSameLayoutAsNewEditor (editor);
+    }
+};
+
+static TextEditorTests textEditorTests;
+
+#endif
@@ -635,6 +635,7 @@ private:
     //==============================================================================
     class Iterator;
     class UniformTextSection;
+    class ParagraphList;
     class TextHolderComponent;
     class InsertAction;
     class RemoveAction;
@@ -665,9 +666,8 @@ private:
     int leftIndent, topIndent;
     unsigned int lastTransactionTime;
     Font currentFont;
-    mutable int totalNumChars;
     int caretPosition;
-    Array <UniformTextSection*> sections;
+    ScopedPointer <ParagraphList> paragraphs;
     String textToShowWhenEmpty;
     Colour colourForTextWhenEmpty;
     juce_wchar passwordCharacter;
@@ -684,8 +684,6 @@ private:
     ListenerList <Listener> listeners;
     Array <Range<int> > underlinedSections;
 
-    void coalesceSimilarSections();
-    void splitSection (int sectionIndex, int charToSplitAt);
     void clearInternal (UndoManager* um);
     void insert (const String& text, int insertIndex, const Font& font,
                  const Colour& colour, UndoManager* um, int caretPositionToMoveTo);
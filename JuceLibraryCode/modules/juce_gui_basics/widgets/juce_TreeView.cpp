@@ -187,6 +187,16 @@ public:
             TreeViewItem* item = owner.rootItem;
             int y = (item != nullptr && ! owner.rootItemVisible) ? -item->itemHeight : 0;
 
+            // (skip straight to the first item that reaches the top of the visible area)
+            if (item != nullptr && visibleTop > y)
+            {
+                owner.updateItemTotalsIfNeeded();
+                item = item->findItemRecursively (visibleTop - 1 - y);
+
+                if (item != nullptr)
+                    y = item->getY();
+            }
+
             while (item != nullptr && y < visibleBottom)
             {
                 y += item->itemHeight;
@@ -495,7 +505,10 @@ void TreeView::setRootItem (TreeViewItem* const newRootItem)
         rootItem = newRootItem;
 
         if (newRootItem != nullptr)
+        {
             newRootItem->setOwnerView (this);
+            newRootItem->markAllTotalsAsChanged();
+        }
 
         needsRecalculating = true;
         recalculateIfNeeded();
@@ -524,7 +537,7 @@ void TreeView::setRootItemVisible (const bool shouldBeVisible)
         rootItem->setOpen (true);
     }
 
-    itemsChanged();
+    allItemsChanged();
 }
 
 void TreeView::colourChanged()
@@ -538,6 +551,7 @@ void TreeView::setIndentSize (const int newIndentSize)
     if (indentSize != newIndentSize)
     {
         indentSize = newIndentSize;
+        allItemsChanged();
         resized();
     }
 }
@@ -547,7 +561,7 @@ void TreeView::setDefaultOpenness (const bool isOpenByDefault)
     if (defaultOpenness != isOpenByDefault)
     {
         defaultOpenness = isOpenByDefault;
-        itemsChanged();
+        allItemsChanged();
     }
 }
 
@@ -561,7 +575,7 @@ void TreeView::setOpenCloseButtonsVisible (const bool shouldBeVisible)
     if (openCloseButtonsVisible != shouldBeVisible)
     {
         openCloseButtonsVisible = shouldBeVisible;
-        itemsChanged();
+        allItemsChanged();
     }
 }
 
@@ -590,7 +604,10 @@ TreeViewItem* TreeView::getSelectedItem (const int index) const noexcept
 int TreeView::getNumRowsInTree() const
 {
     if (rootItem != nullptr)
+    {
+        updateItemTotalsIfNeeded();
         return rootItem->getNumRows() - (rootItemVisible ? 0 : 1);
+    }
 
     return 0;
 }
@@ -601,7 +618,10 @@ TreeViewItem* TreeView::getItemOnRow (int index) const
         ++index;
 
     if (rootItem != nullptr && index >= 0)
+    {
+        updateItemTotalsIfNeeded();
         return rootItem->getItemOnRow (index);
+    }
 
     return nullptr;
 }
@@ -748,7 +768,7 @@ void TreeView::scrollToKeepItemVisible (TreeViewItem* item)
 
         item = item->getDeepestOpenParentItem();
 
-        const int y = item->y;
+        const int y = item->getY();
         const int viewTop = viewport->getViewPositionY();
 
         if (y < viewTop)
@@ -852,6 +872,26 @@ void TreeView::itemsChanged() noexcept
     viewport->getContentComp()->triggerAsyncUpdate();
 }
 
+void TreeView::allItemsChanged() noexcept
+{
+    if (rootItem != nullptr)
+    {
+        const ScopedLock sl (nodeAlterationLock);
+        rootItem->markAllTotalsAsChanged();
+    }
+
+    itemsChanged();
+}
+
+void TreeView::updateItemTotalsIfNeeded() const
+{
+    if (rootItem != nullptr && rootItem->totalsNeedUpdating)
+    {
+        const ScopedLock sl (nodeAlterationLock);
+        rootItem->updateTotals (rootItem->getIndentX());
+    }
+}
+
 void TreeView::recalculateIfNeeded()
 {
     if (needsRecalculating)
@@ -860,9 +900,7 @@ void TreeView::recalculateIfNeeded()
 
         const ScopedLock sl (nodeAlterationLock);
 
-        if (rootItem != nullptr)
-            rootItem->updatePositions (rootItemVisible ? 0 : -rootItem->itemHeight);
-
+        updateItemTotalsIfNeeded();
         viewport->updateComponents (false);
 
         if (rootItem != nullptr)
@@ -1134,16 +1172,77 @@ enum TreeViewOpenness
     opennessOpen = 2
 };
 
+namespace TreeViewHelpers
+{
+    static int calculateDepth (const TreeViewItem* item, const bool rootIsVisible) noexcept
+    {
+        jassert (item != nullptr);
+        int depth = rootIsVisible ? 0 : -1;
+
+        for (const TreeViewItem* p = item->getParentItem(); p != nullptr; p = p->getParentItem())
+            ++depth;
+
+        return depth;
+    }
+
+    /*  Each item keeps the row counts and heights of its sub-items in Fenwick trees (indexed
+        from 1), so that the rows or pixels above any one of them can be found without having
+        to add up all the sub-items that come before it.
+    */
+    static int getTotalBefore (const Array<int>& tree, int index) noexcept
+    {
+        int total = 0;
+
+        for (; index > 0; index &= index - 1)
+            total += tree.getUnchecked (index);
+
+        return total;
+    }
+
+    // Returns the index of the entry that contains an offset, and makes the offset relative to its start.
+    static int findIndexContaining (const Array<int>& tree, int& offset) noexcept
+    {
+        const int size = tree.size() - 1;
+        int index = 0;
+
+        for (int step = nextPowerOfTwo (size + 1) / 2; step > 0; step >>= 1)
+        {
+            const int next = index + step;
+
+            if (next <= size && tree.getUnchecked (next) <= offset)
+            {
+                index = next;
+                offset -= tree.getUnchecked (next);
+            }
+        }
+
+        return index;
+    }
+
+    static void addToTree (Array<int>& tree, int index, const int delta) noexcept
+    {
+        for (++index; index < tree.size(); index += (index & -index))
+            tree.getReference (index) += delta;
+    }
+}
+
 TreeViewItem::TreeViewItem()
     : ownerView (nullptr),
       parentItem (nullptr),
-      y (0),
       itemHeight (0),
       totalHeight (0),
+      itemWidth (0),
+      totalWidth (0),
+      numRows (1),
+      subItemsWidth (0),
+      numSubItemsWithMaximumWidth (0),
+      indexInParent (0),
       selected (false),
       redrawNeeded (true),
       drawLinesInside (true),
       drawsInLeftMargin (false),
+      totalsNeedUpdating (true),
+      subItemTreesNeedRebuilding (true),
       openness (opennessDefault)
 {
     static int nextUID = 0;
@@ -1181,11 +1280,12 @@ void TreeViewItem::clearSubItems()
         {
             const ScopedLock sl (ownerView->nodeAlterationLock);
             subItems.clear();
-            treeHasChanged();
+            subItemsChanged (0);
         }
         else
         {
             subItems.clear();
+            subItemsChanged (0);
         }
     }
 }
@@ -1194,9 +1294,11 @@ void TreeViewItem::addSubItem (TreeViewItem* const newItem, const int insertPosi
 {
     if (newItem != nullptr)
     {
+        const int index = isPositiveAndBelow (insertPosition, subItems.size()) ? insertPosition
+                                                                                : subItems.size();
         newItem->parentItem = this;
         newItem->setOwnerView (ownerView);
-        newItem->y = 0;
+        newItem->markAllTotalsAsChanged();
         newItem->itemHeight = newItem->getItemHeight();
         newItem->totalHeight = 0;
         newItem->itemWidth = newItem->getItemWidth();
@@ -1205,15 +1307,16 @@ void TreeViewItem::addSubItem (TreeViewItem* const newItem, const int insertPosi
         if (ownerView != nullptr)
         {
             const ScopedLock sl (ownerView->nodeAlterationLock);
-            subItems.insert (insertPosition, newItem);
-            treeHasChanged();
+            subItems.insert (index, newItem);
+            subItemsChanged (index);
 
             if (newItem->isOpen())
                 newItem->itemOpennessChanged (true);
         }
         else
         {
-            subItems.insert (insertPosition, newItem);
+            subItems.insert (index, newItem);
+            subItemsChanged (index);
 
             if (newItem->isOpen())
                 newItem->itemOpennessChanged (true);
@@ -1230,12 +1333,13 @@ void TreeViewItem::removeSubItem (const int index, const bool deleteItem)
         if (isPositiveAndBelow (index, subItems.size()))
         {
             subItems.remove (index, deleteItem);
-            treeHasChanged();
+            subItemsChanged (index);
         }
     }
-    else
+    else if (isPositiveAndBelow (index, subItems.size()))
     {
         subItems.remove (index, deleteItem);
+        subItemsChanged (index);
     }
 }
 
@@ -1253,7 +1357,7 @@ void TreeViewItem::setOpen (const bool shouldBeOpen)
     {
         openness = shouldBeOpen ? opennessOpen
                                 : opennessClosed;
-        treeHasChanged();
+        markTotalsAsChanged();
 
         itemOpennessChanged (isOpen());
     }
@@ -1351,7 +1455,7 @@ Rectangle<int> TreeViewItem::getItemPosition (const bool relativeToTreeViewTopLe
     if (ownerView != nullptr && width < 0)
         width = ownerView->viewport->getViewWidth() - indentX;
 
-    Rectangle<int> r (indentX, y, jmax (0, width), totalHeight);
+    Rectangle<int> r (indentX, getY(), jmax (0, width), totalHeight);
 
     if (relativeToTreeViewTopLeft)
         r -= ownerView->viewport->getViewPosition();
@@ -1362,7 +1466,7 @@ Rectangle<int> TreeViewItem::getItemPosition (const bool relativeToTreeViewTopLe
 void TreeViewItem::treeHasChanged() const noexcept
 {
     if (ownerView != nullptr)
-        ownerView->itemsChanged();
+        ownerView->allItemsChanged();
 }
 
 void TreeViewItem::repaintItem() const
@@ -1381,30 +1485,181 @@ bool TreeViewItem::areAllParentsOpen() const noexcept
             || (parentItem->isOpen() && parentItem->areAllParentsOpen());
 }
 
-void TreeViewItem::updatePositions (int newY)
+//==============================================================================
+// Marks the totals of this item and all its parents as needing to be updated.
+void TreeViewItem::markTotalsAsChanged() noexcept
+{
+    for (TreeViewItem* item = this; item != nullptr && ! item->totalsNeedUpdating; item = item->parentItem)
+    {
+        item->totalsNeedUpdating = true;
+
+        if (item->parentItem != nullptr && ! item->parentItem->subItemTreesNeedRebuilding)
+            item->parentItem->changedSubItems.add (item);
+    }
+
+    if (ownerView != nullptr)
+        ownerView->itemsChanged();
+}
+
+void TreeViewItem::markAllTotalsAsChanged() noexcept
 {
-    y = newY;
-    itemHeight = getItemHeight();
-    totalHeight = itemHeight;
-    itemWidth = getItemWidth();
-    totalWidth = jmax (itemWidth, 0) + getIndentX();
+    totalsNeedUpdating = true;
+    subItemTreesNeedRebuilding = true;
+    changedSubItems.clearQuick();
+
+    for (int i = subItems.size(); --i >= 0;)
+        subItems.getUnchecked(i)->markAllTotalsAsChanged();
+}
 
-    if (isOpen())
+void TreeViewItem::subItemsChanged (const int firstIndexChanged) noexcept
+{
+    for (int i = jmax (0, firstIndexChanged); i < subItems.size(); ++i)
+        subItems.getUnchecked(i)->indexInParent = i;
+
+    subItemTreesNeedRebuilding = true;
+    changedSubItems.clearQuick();
+    markTotalsAsChanged();
+}
+
+void TreeViewItem::updateTotals (const int indentX)
+{
+    if (totalsNeedUpdating)
     {
-        newY += totalHeight;
+        totalsNeedUpdating = false;
+        itemHeight = getItemHeight();
+        itemWidth = getItemWidth();
 
-        for (int i = 0; i < subItems.size(); ++i)
+        updateSubItemTotals (indentX + ownerView->getIndentSize());
+
+        numRows = 1;
+        totalHeight = itemHeight;
+        totalWidth = jmax (itemWidth, 0) + indentX;
+
+        if (isOpen() && subItems.size() > 0)
         {
-            TreeViewItem* const ti = subItems.getUnchecked(i);
+            numRows += TreeViewHelpers::getTotalBefore (subItemRows, subItems.size());
+            totalHeight += TreeViewHelpers::getTotalBefore (subItemHeights, subItems.size());
+            totalWidth = jmax (totalWidth, subItemsWidth);
+        }
+    }
+}
+
+void TreeViewItem::updateSubItemTotals (const int subItemIndentX)
+{
+    const int numSubItems = subItems.size();
+
+    if (subItemTreesNeedRebuilding)
+    {
+        subItemTreesNeedRebuilding = false;
+        changedSubItems.clearQuick();
+
+        subItemRows.clearQuick();
+        subItemRows.insertMultiple (0, 0, numSubItems + 1);
+        subItemHeights = subItemRows;
+        subItemsWidth = numSubItemsWithMaximumWidth = 0;
 
-            ti->updatePositions (newY);
-            newY += ti->totalHeight;
-            totalHeight += ti->totalHeight;
-            totalWidth = jmax (totalWidth, ti->totalWidth);
+        for (int i = 1; i <= numSubItems; ++i)
+        {
+            TreeViewItem* const ti = subItems.getUnchecked (i - 1);
+            ti->updateTotals (subItemIndentX);
+
+            subItemRows.getReference (i) += ti->numRows;
+            subItemHeights.getReference (i) += ti->totalHeight;
+
+            const int parent = i + (i & -i);
+
+            if (parent <= numSubItems)
+            {
+                subItemRows.getReference (parent) += subItemRows.getUnchecked (i);
+                subItemHeights.getReference (parent) += subItemHeights.getUnchecked (i);
+            }
+
+            if (ti->totalWidth > subItemsWidth)
+            {
+                subItemsWidth = ti->totalWidth;
+                numSubItemsWithMaximumWidth = 1;
+            }
+            else if (ti->totalWidth == subItemsWidth)
+            {
+                ++numSubItemsWithMaximumWidth;
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < changedSubItems.size(); ++i)
+        {
+            TreeViewItem* const ti = changedSubItems.getUnchecked (i);
+            const int oldRows = ti->numRows;
+            const int oldHeight = ti->totalHeight;
+            const int oldWidth = ti->totalWidth;
+
+            ti->updateTotals (subItemIndentX);
+
+            TreeViewHelpers::addToTree (subItemRows, ti->indexInParent, ti->numRows - oldRows);
+            TreeViewHelpers::addToTree (subItemHeights, ti->indexInParent, ti->totalHeight - oldHeight);
+
+            if (ti->totalWidth != oldWidth)
+            {
+                if (oldWidth == subItemsWidth)
+                    --numSubItemsWithMaximumWidth;
+
+                if (ti->totalWidth > subItemsWidth)
+                {
+                    subItemsWidth = ti->totalWidth;
+                    numSubItemsWithMaximumWidth = 1;
+                }
+                else if (ti->totalWidth == subItemsWidth)
+                {
+                    ++numSubItemsWithMaximumWidth;
+                }
+            }
+        }
+
+        changedSubItems.clearQuick();
+
+        // (only if the widest sub-items have all got narrower do they all need checking)
+        if (numSubItemsWithMaximumWidth <= 0)
+        {
+            subItemsWidth = numSubItemsWithMaximumWidth = 0;
+
+            for (int i = numSubItems; --i >= 0;)
+            {
+                const int w = subItems.getUnchecked(i)->totalWidth;
+
+                if (w > subItemsWidth)
+                {
+                    subItemsWidth = w;
+                    numSubItemsWithMaximumWidth = 1;
+                }
+                else if (w == subItemsWidth)
+                {
+                    ++numSubItemsWithMaximumWidth;
+                }
+            }
         }
     }
 }
 
+// Returns the item's position relative to the top of the root item.
+int TreeViewItem::getY() const
+{
+    if (ownerView != nullptr)
+        ownerView->updateItemTotalsIfNeeded();
+
+    int y = 0;
+    const TreeViewItem* item = this;
+
+    for (; item->parentItem != nullptr; item = item->parentItem)
+        y += item->parentItem->itemHeight
+               + TreeViewHelpers::getTotalBefore (item->parentItem->subItemHeights, item->indexInParent);
+
+    if (ownerView != nullptr && ! ownerView->rootItemVisible)
+        y -= item->itemHeight;
+
+    return y;
+}
+
 TreeViewItem* TreeViewItem::getDeepestOpenParentItem() noexcept
 {
     TreeViewItem* result = this;
@@ -1453,20 +1708,6 @@ void TreeViewItem::setDrawsInLeftMargin (bool canDrawInLeftMargin) noexcept
     drawsInLeftMargin = canDrawInLeftMargin;
 }
 
-namespace TreeViewHelpers
-{
-    static int calculateDepth (const TreeViewItem* item, const bool rootIsVisible) noexcept
-    {
-        jassert (item != nullptr);
-        int depth = rootIsVisible ? 0 : -1;
-
-        for (const TreeViewItem* p = item->getParentItem(); p != nullptr; p = p->getParentItem())
-            ++depth;
-
-        return depth;
-    }
-}
-
 void TreeViewItem::paintRecursively (Graphics& g, int width)
 {
     jassert (ownerView != nullptr);
@@ -1532,16 +1773,19 @@ void TreeViewItem::paintRecursively (Graphics& g, int width)
         }
     }
 
-    if (isOpen())
+    if (isOpen() && subItems.size() > 0)
     {
         const Rectangle<int> clip (g.getClipBounds());
 
-        for (int i = 0; i < subItems.size(); ++i)
+        // (start at the first sub-item that reaches the top of the clip region)
+        int offset = clip.getY() - itemHeight - 1;
+        int i = offset < 0 ? 0 : TreeViewHelpers::findIndexContaining (subItemHeights, offset);
+        int relY = itemHeight + TreeViewHelpers::getTotalBefore (subItemHeights, i);
+
+        for (; i < subItems.size(); ++i)
         {
             TreeViewItem* const ti = subItems.getUnchecked(i);
 
-            const int relY = ti->y - y;
-
             if (relY >= clip.getBottom())
                 break;
 
@@ -1554,6 +1798,8 @@ void TreeViewItem::paintRecursively (Graphics& g, int width)
                 if (g.reduceClipRegion (0, 0, width, ti->totalHeight))
                     ti->paintRecursively (g, width);
             }
+
+            relY += ti->totalHeight;
         }
     }
 }
@@ -1567,7 +1813,7 @@ bool TreeViewItem::isLastOfSiblings() const noexcept
 int TreeViewItem::getIndexInParent() const noexcept
 {
     return parentItem == nullptr ? 0
-                                 : parentItem->subItems.indexOf (this);
+                                 : indexInParent;
 }
 
 TreeViewItem* TreeViewItem::getTopLevelItem() noexcept
@@ -1578,15 +1824,7 @@ TreeViewItem* TreeViewItem::getTopLevelItem() noexcept
 
 int TreeViewItem::getNumRows() const noexcept
 {
-    int num = 1;
-
-    if (isOpen())
-    {
-        for (int i = subItems.size(); --i >= 0;)
-            num += subItems.getUnchecked(i)->getNumRows();
-    }
-
-    return num;
+    return numRows;
 }
 
 TreeViewItem* TreeViewItem::getItemOnRow (int index) noexcept
@@ -1597,21 +1835,10 @@ TreeViewItem* TreeViewItem::getItemOnRow (int index) noexcept
     if (index > 0 && isOpen())
     {
         --index;
+        const int i = TreeViewHelpers::findIndexContaining (subItemRows, index);
 
-        for (int i = 0; i < subItems.size(); ++i)
-        {
-            TreeViewItem* const item = subItems.getUnchecked(i);
-
-            if (index == 0)
-                return item;
-
-            const int numRows = item->getNumRows();
-
-            if (numRows > index)
-                return item->getItemOnRow (index);
-
-            index -= numRows;
-        }
+        if (i < subItems.size())
+            return subItems.getUnchecked(i)->getItemOnRow (index);
     }
 
     return nullptr;
@@ -1629,16 +1856,10 @@ TreeViewItem* TreeViewItem::findItemRecursively (int targetY) noexcept
         if (isOpen())
         {
             targetY -= h;
+            const int i = TreeViewHelpers::findIndexContaining (subItemHeights, targetY);
 
-            for (int i = 0; i < subItems.size(); ++i)
-            {
-                TreeViewItem* const ti = subItems.getUnchecked(i);
-
-                if (targetY < ti->totalHeight)
-                    return ti->findItemRecursively (targetY);
-
-                targetY -= ti->totalHeight;
-            }
+            if (i < subItems.size())
+                return subItems.getUnchecked(i)->findItemRecursively (targetY);
         }
     }
 
@@ -1688,13 +1909,10 @@ int TreeViewItem::getRowNumberInTree() const noexcept
 {
     if (parentItem != nullptr && ownerView != nullptr)
     {
-        int n = 1 + parentItem->getRowNumberInTree();
+        ownerView->updateItemTotalsIfNeeded();
 
-        int ourIndex = parentItem->subItems.indexOf (this);
-        jassert (ourIndex >= 0);
-
-        while (--ourIndex >= 0)
-            n += parentItem->subItems [ourIndex]->getNumRows();
+        int n = 1 + parentItem->getRowNumberInTree()
+                  + TreeViewHelpers::getTotalBefore (parentItem->subItemRows, indexInParent);
 
         if (parentItem->parentItem == nullptr
              && ! ownerView->rootItemVisible)
@@ -1720,7 +1938,7 @@ TreeViewItem* TreeViewItem::getNextVisibleItem (const bool recurse) const noexce
 
     if (parentItem != nullptr)
     {
-        const int nextIndex = parentItem->subItems.indexOf (this) + 1;
+        const int nextIndex = indexInParent + 1;
 
         if (nextIndex >= parentItem->subItems.size())
             return parentItem->getNextVisibleItem (false);
@@ -1843,3 +2061,221 @@ TreeViewItem::OpennessRestorer::~OpennessRestorer()
     if (oldOpenness != nullptr)
         treeViewItem.restoreOpennessState (*oldOpenness);
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TreeViewTests  : public UnitTest
+{
+public:
+    TreeViewTests() : UnitTest ("TreeView") {}
+
+    class ItemComponent  : public Component
+    {
+    public:
+        ItemComponent (TreeViewItem& item_) : item (item_) {}
+
+        TreeViewItem& item;
+    };
+
+    class TestItem  : public TreeViewItem
+    {
+    public:
+        TestItem (const int height_) : height (height_) {}
+
+        bool mightContainSubItems()         { return getNumSubItems() > 0; }
+        int getItemHeight() const           { return height; }
+        Component* createItemComponent()    { return new ItemComponent (*this); }
+
+        int height;
+    };
+
+    static TestItem* createRandomItem (Random& r, const int depth)
+    {
+        TestItem* const item = new TestItem (10 + 5 * r.nextInt (3));
+
+        if (depth > 0)
+        {
+            for (int i = r.nextInt (6); --i >= 0;)
+                item->addSubItem (createRandomItem (r, depth - 1));
+
+            item->setOpen (r.nextBool());
+        }
+
+        return item;
+    }
+
+    static void addAllItems (TreeViewItem* const item, Array<TreeViewItem*>& items)
+    {
+        items.add (item);
+
+        for (int i = 0; i < item->getNumSubItems(); ++i)
+            addAllItems (item->getSubItem (i), items);
+    }
+
+    static void addVisibleItems (TreeViewItem* const item, Array<TreeViewItem*>& rows)
+    {
+        rows.add (item);
+
+        if (item->isOpen())
+            for (int i = 0; i < item->getNumSubItems(); ++i)
+                addVisibleItems (item->getSubItem (i), rows);
+    }
+
+    static void getRows (TreeView& tree, Array<TreeViewItem*>& rows)
+    {
+        addVisibleItems (tree.getRootItem(), rows);
+
+        if (! tree.isRootItemVisible())
+            rows.remove (0);
+    }
+
+    // checks the tree's row and position lookups against the rows found by walking the whole tree
+    void checkRows (TreeView& tree)
+    {
+        Array<TreeViewItem*> rows;
+        getRows (tree, rows);
+
+        expectEquals (tree.getNumRowsInTree(), rows.size());
+        expect (tree.getItemOnRow (rows.size()) == nullptr);
+
+        int y = 0;
+
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            TreeViewItem* const item = rows.getUnchecked (i);
+
+            expect (tree.getItemOnRow (i) == item);
+            expectEquals (item->getRowNumberInTree(), i);
+            expectEquals (item->getItemPosition (false).getY(), y);
+            expect (tree.getItemAt (y + item->getItemHeight() / 2) == item);
+
+            y += item->getItemHeight();
+        }
+
+        expect (tree.getItemAt (y) == nullptr);
+    }
+
+    // checks that the tree has components for the items on screen, and none for any others
+    void checkComponents (TreeView& tree)
+    {
+        Array<TreeViewItem*> rows;
+        getRows (tree, rows);
+
+        Viewport* const viewport = tree.getViewport();
+        const int visibleTop = viewport->getViewPositionY();
+        const int visibleBottom = visibleTop + viewport->getViewHeight();
+
+        Array<TreeViewItem*> visibleItems;
+        int y = 0;
+
+        for (int i = 0; i < rows.size() && y < visibleBottom; ++i)
+        {
+            TreeViewItem* const item = rows.getUnchecked (i);
+            y += item->getItemHeight();
+
+            if (y >= visibleTop)
+                visibleItems.add (item);
+        }
+
+        Component* const content = viewport->getViewedComponent();
+        expectEquals (content->getNumChildComponents(), visibleItems.size());
+
+        for (int i = 0; i < content->getNumChildComponents(); ++i)
+        {
+            ItemComponent* const c = dynamic_cast <ItemComponent*> (content->getChildComponent (i));
+            expect (c != nullptr && visibleItems.contains (&(c->item)));
+
+            if (c != nullptr)
+                expect (c->getY() == c->item.getItemPosition (false).getY()
+                          && c->getHeight() == c->item.getItemHeight());
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Row lookups");
+
+        Random r;
+        TreeView tree;
+        tree.setSize (200, 300);
+
+        {
+            TestItem* const root = new TestItem (20);
+
+            for (int i = 0; i < 8; ++i)
+                root->addSubItem (createRandomItem (r, 4));
+
+            root->setOpen (true);
+            tree.setRootItem (root);
+        }
+
+        checkRows (tree);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            Array<TreeViewItem*> items;
+            addAllItems (tree.getRootItem(), items);
+            TreeViewItem* const item = items [r.nextInt (items.size())];
+
+            switch (r.nextInt (10))
+            {
+                case 0:
+                case 1:
+                case 2:     item->setOpen (! item->isOpen()); break;
+
+                case 3:
+                case 4:
+                case 5:     item->addSubItem (createRandomItem (r, 2), r.nextInt (item->getNumSubItems() + 1)); break;
+
+                case 6:
+                case 7:
+                case 8:     if (item->getNumSubItems() > 0)
+                                item->removeSubItem (r.nextInt (item->getNumSubItems()));
+                            break;
+
+                default:    if (r.nextBool())
+                            {
+                                tree.setRootItemVisible (! tree.isRootItemVisible());
+                            }
+                            else
+                            {
+                                static_cast <TestItem*> (item)->height = 10 + 5 * r.nextInt (3);
+                                item->treeHasChanged();
+                            }
+                            break;
+            }
+
+            checkRows (tree);
+        }
+
+        beginTest ("Item components");
+
+        tree.setRootItemVisible (true);
+        tree.getRootItem()->setOpen (true);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            if (r.nextBool())
+            {
+                Array<TreeViewItem*> rows;
+                getRows (tree, rows);
+                TreeViewItem* const item = rows [r.nextInt (rows.size())];
+                item->setOpen (! item->isOpen());
+
+                // (the components get updated asynchronously after a change)
+                MessageManager::getInstance()->runDispatchLoopUntil (5);
+            }
+
+            Viewport* const viewport = tree.getViewport();
+            viewport->setViewPosition (0, r.nextInt (jmax (1, viewport->getViewedComponent()->getHeight())));
+            checkComponents (tree);
+        }
+
+        tree.deleteRootItem();
+    }
+};
+
+static TreeViewTests treeViewTests;
+
+#endif
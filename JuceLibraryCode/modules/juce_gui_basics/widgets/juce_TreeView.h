@@ -499,18 +499,29 @@ private:
     TreeView* ownerView;
     TreeViewItem* parentItem;
     OwnedArray <TreeViewItem> subItems;
-    int y, itemHeight, totalHeight, itemWidth, totalWidth;
+    Array <int> subItemRows, subItemHeights;    // Fenwick trees of the sub-items' totals
+    Array <TreeViewItem*> changedSubItems;
+    int itemHeight, totalHeight, itemWidth, totalWidth, numRows;
+    int subItemsWidth, numSubItemsWithMaximumWidth;
+    int indexInParent;
     int uid;
     bool selected           : 1;
     bool redrawNeeded       : 1;
     bool drawLinesInside    : 1;
     bool drawsInLeftMargin  : 1;
+    bool totalsNeedUpdating : 1;
+    bool subItemTreesNeedRebuilding : 1;
     unsigned int openness   : 2;
 
     friend class TreeView;
     friend class TreeViewContentComponent;
 
-    void updatePositions (int newY);
+    void markTotalsAsChanged() noexcept;
+    void markAllTotalsAsChanged() noexcept;
+    void subItemsChanged (int firstIndexChanged) noexcept;
+    void updateTotals (int indentX);
+    void updateSubItemTotals (int subItemIndentX);
+    int getY() const;
     int getIndentX() const noexcept;
     void setOwnerView (TreeView*) noexcept;
     void paintRecursively (Graphics&, int width);
@@ -812,6 +823,8 @@ private:
     bool openCloseButtonsVisible : 1;
 
     void itemsChanged() noexcept;
+    void allItemsChanged() noexcept;
+    void updateItemTotalsIfNeeded() const;
     void recalculateIfNeeded();
     void moveSelectedRow (int delta);
     void updateButtonUnderMouse (const MouseEvent&);
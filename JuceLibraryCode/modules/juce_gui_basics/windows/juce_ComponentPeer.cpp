@@ -49,6 +49,14 @@ ComponentPeer::~ComponentPeer()
     Desktop::getInstance().triggerFocusCallback();
 }
 
+ComponentPeer::FrameStatistics::FrameStatistics() noexcept
+    : frameNumber (0),
+      paintTimeMs (0),
+      numRectangles (0),
+      numPixelsPainted (0)
+{
+}
+
 //==============================================================================
 int ComponentPeer::getNumPeers() noexcept
 {
@@ -302,6 +302,26 @@ public:
     */
     virtual void performAnyPendingRepaintsNow() = 0;
 
+    /** Holds some details about a frame that a peer has painted.
+        @see getLastFrameStatistics
+    */
+    struct JUCE_API  FrameStatistics
+    {
+        FrameStatistics() noexcept;
+
+        int64 frameNumber;          /**< The number of frames that the peer has painted, including this one. */
+        double paintTimeMs;         /**< The time taken to render and blit the frame, in milliseconds. */
+        int numRectangles;          /**< The number of separate rectangles that were painted. */
+        int64 numPixelsPainted;     /**< The total area of all the rectangles that were painted. */
+    };
+
+    /** Returns some details about the most recent frame that this window painted.
+
+        Peers on platforms that don't collect these numbers will just return an empty
+        set of statistics.
+    */
+    const FrameStatistics& getLastFrameStatistics() const noexcept      { return lastFrameStatistics; }
+
     /** Changes the window's transparency. */
     virtual void setAlpha (float newAlpha) = 0;
 
@@ -376,6 +396,7 @@ protected:
     Rectangle<int> lastNonFullscreenBounds;
     uint32 lastPaintTime;
     ComponentBoundsConstrainer* constrainer;
+    FrameStatistics lastFrameStatistics;
 
     static void updateCurrentModifiers() noexcept;
 
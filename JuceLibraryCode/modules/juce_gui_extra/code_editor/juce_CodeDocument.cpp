@@ -23,20 +23,47 @@
   ==============================================================================
 */
 
+// Each line refers to a range of characters within a string that may be shared with
+// many other lines, so that e.g. loading a file doesn't need an allocation for every line.
 class CodeDocumentLine
 {
 public:
-    CodeDocumentLine (const String::CharPointerType& line_,
+    CodeDocumentLine (const String& source_,
+                      const String::CharPointerType& start_,
+                      const String::CharPointerType& end_,
                       const int lineLength_,
-                      const int numNewLineChars,
-                      const int lineStartInFile_)
-        : line (line_, (size_t) lineLength_),
-          lineStartInFile (lineStartInFile_),
+                      const int numNewLineChars)
+        : source (source_),
+          start (start_),
+          end (end_),
           lineLength (lineLength_),
           lineLengthWithoutNewLines (lineLength_ - numNewLineChars)
     {
     }
 
+    explicit CodeDocumentLine (const String& text)
+        : source (text),
+          start (text.getCharPointer()),
+          end (text.getCharPointer()),
+          lineLength (0),
+          lineLengthWithoutNewLines (0)
+    {
+        for (;;)
+        {
+            const juce_wchar c = end.getAndAdvance();
+
+            if (c == 0)
+                break;
+
+            ++lineLength;
+
+            if (c != '\n' && c != '\r')
+                lineLengthWithoutNewLines = lineLength;
+        }
+
+        end = start + lineLength;
+    }
+
     static void createLines (Array <CodeDocumentLine*>& newLines, const String& text)
     {
         String::CharPointerType t (text.getCharPointer());
@@ -46,13 +73,12 @@ public:
         while (! (finished || t.isEmpty()))
         {
             String::CharPointerType startOfLine (t);
-            int startOfLineInFile = charNumInFile;
             int lineLength = 0;
             int numNewLineChars = 0;
 
             for (;;)
             {
-                const juce_wchar c = t.getAndAdvance();
+                const juce_wchar c = *t;
 
                 if (c == 0)
                 {
@@ -60,6 +86,7 @@ public:
                     break;
                 }
 
+                ++t;
                 ++charNumInFile;
                 ++lineLength;
 
@@ -85,8 +112,7 @@ public:
                 }
             }
 
-            newLines.add (new CodeDocumentLine (startOfLine, lineLength,
-                                                numNewLineChars, startOfLineInFile));
+            newLines.add (new CodeDocumentLine (text, startOfLine, t, lineLength, numNewLineChars));
         }
 
         jassert (charNumInFile == text.length());
@@ -97,43 +123,473 @@ public:
         return lineLengthWithoutNewLines != lineLength;
     }
 
-    void updateLength() noexcept
+    String getText() const
     {
-        lineLength = 0;
-        lineLengthWithoutNewLines = 0;
+        if (start == source.getCharPointer() && end.isEmpty())
+            return source;
 
-        String::CharPointerType t (line.getCharPointer());
+        return String (start, end);
+    }
 
-        for (;;)
+    String substring (const int startIndex, const int endIndex) const
+    {
+        const int s = jlimit (0, lineLength, startIndex);
+        const int e = jlimit (s, lineLength, endIndex);
+
+        return String (start + s, start + e);
+    }
+
+    juce_wchar getCharacter (const int index) const noexcept
+    {
+        jassert (index >= 0);
+        return index < lineLength ? *(start + index) : 0;
+    }
+
+    String source;
+    String::CharPointerType start, end;
+    int lineLength, lineLengthWithoutNewLines;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (CodeDocumentLine);
+};
+
+//==============================================================================
+/*  Holds the lines of a CodeDocument, in blocks of up to maxLinesPerBlock lines.
+
+    Each block keeps a count of its characters, and Fenwick trees of these counts and of
+    the blocks' sizes let a line or character position be located, and a line's start
+    position be found, without visiting all the lines that come before it. Editing a line
+    only has to update its own block and the trees, rather than every line that follows it.
+*/
+class CodeDocumentLineList
+{
+public:
+    CodeDocumentLineList() noexcept
+        : numLines (0), numCharacters (0)
+    {
+    }
+
+    ~CodeDocumentLineList()
+    {
+        clear();
+    }
+
+    int size() const noexcept                   { return numLines; }
+    int getNumCharacters() const noexcept       { return numCharacters; }
+
+    CodeDocumentLine* operator[] (const int index) const noexcept
+    {
+        return isPositiveAndBelow (index, numLines) ? getUnchecked (index) : nullptr;
+    }
+
+    CodeDocumentLine* getUnchecked (int index) const noexcept
+    {
+        jassert (isPositiveAndBelow (index, numLines));
+        const int blockIndex = findBlock (lineTree, index);
+        return blocks.getUnchecked (blockIndex)->lines.getUnchecked (index);
+    }
+
+    CodeDocumentLine* getLast() const noexcept
+    {
+        const Block* const b = blocks.getLast();
+        return b != nullptr ? b->lines.getLast() : nullptr;
+    }
+
+    // Returns the number of characters in the document before the start of a line.
+    int getLineStart (int index) const noexcept
+    {
+        if (index >= numLines)
+            return numCharacters;
+
+        const int blockIndex = findBlock (lineTree, index);
+        const Block& b = *blocks.getUnchecked (blockIndex);
+
+        int pos = getPrefixSum (charTree, blockIndex);
+
+        for (int i = 0; i < index; ++i)
+            pos += b.lines.getUnchecked (i)->lineLength;
+
+        return pos;
+    }
+
+    // Returns the line that contains a character position, or the last line if the
+    // position is beyond the end of the document.
+    int findLineContaining (int position) const noexcept
+    {
+        if (position >= numCharacters)
+            return numLines - 1;
+
+        const int blockIndex = findBlock (charTree, position);
+        const Block& b = *blocks.getUnchecked (blockIndex);
+        const int firstLineInBlock = getPrefixSum (lineTree, blockIndex);
+
+        for (int i = 0; i < b.lines.size(); ++i)
         {
-            const juce_wchar c = t.getAndAdvance();
+            position -= b.lines.getUnchecked (i)->lineLength;
 
-            if (c == 0)
-                break;
+            if (position < 0)
+                return firstLineInBlock + i;
+        }
 
-            ++lineLength;
+        jassertfalse;
+        return firstLineInBlock + b.lines.size() - 1;
+    }
 
-            if (c != '\n' && c != '\r')
-                lineLengthWithoutNewLines = lineLength;
+    int getMaximumLineLength() noexcept
+    {
+        int maxLength = 0;
+
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            if (b.maximumLineLength < 0)
+            {
+                b.maximumLineLength = 0;
+
+                for (int j = b.lines.size(); --j >= 0;)
+                    b.maximumLineLength = jmax (b.maximumLineLength, b.lines.getUnchecked (j)->lineLength);
+            }
+
+            maxLength = jmax (maxLength, b.maximumLineLength);
+        }
+
+        return maxLength;
+    }
+
+    //==============================================================================
+    // Inserts some lines, taking ownership of them.
+    void insertArray (int index, const Array <CodeDocumentLine*>& newLines)
+    {
+        jassert (isPositiveAndNotGreaterThan (index, numLines));
+
+        if (newLines.size() == 0)
+            return;
+
+        int blockIndex;
+        bool needsRebuilding = false;
+
+        if (blocks.size() == 0)
+        {
+            blocks.add (new Block());
+            blockIndex = index = 0;
+            needsRebuilding = true;
+        }
+        else if (index >= numLines)
+        {
+            blockIndex = blocks.size() - 1;
+            index = blocks.getUnchecked (blockIndex)->lines.size();
+        }
+        else
+        {
+            blockIndex = findBlock (lineTree, index);
+        }
+
+        Block& b = *blocks.getUnchecked (blockIndex);
+        b.lines.insertArray (index, newLines.begin(), newLines.size());
+
+        int numChars = 0;
+
+        for (int i = newLines.size(); --i >= 0;)
+        {
+            const int length = newLines.getUnchecked (i)->lineLength;
+            numChars += length;
+
+            if (b.maximumLineLength >= 0)
+                b.maximumLineLength = jmax (b.maximumLineLength, length);
+        }
+
+        b.numCharacters += numChars;
+
+        if (b.lines.size() > maxLinesPerBlock || needsRebuilding)
+        {
+            splitBlock (blockIndex);
+            rebuildTrees();
+        }
+        else
+        {
+            addToTrees (blockIndex, newLines.size(), numChars);
+        }
+    }
+
+    void insert (const int index, CodeDocumentLine* const newLine)
+    {
+        Array <CodeDocumentLine*> newLines;
+        newLines.add (newLine);
+        insertArray (index, newLines);
+    }
+
+    void add (CodeDocumentLine* const newLine)
+    {
+        insert (numLines, newLine);
+    }
+
+    // Replaces a line (or appends one if the index is the size of the list), deleting the old one.
+    void set (const int index, CodeDocumentLine* const newLine)
+    {
+        if (index >= numLines)
+        {
+            add (newLine);
+            return;
+        }
+
+        int indexInBlock = index;
+        const int blockIndex = findBlock (lineTree, indexInBlock);
+        Block& b = *blocks.getUnchecked (blockIndex);
+
+        const ScopedPointer<CodeDocumentLine> oldLine (b.lines.getUnchecked (indexInBlock));
+        b.lines.set (indexInBlock, newLine);
+
+        if (b.maximumLineLength >= 0)
+        {
+            if (newLine->lineLength >= b.maximumLineLength)
+                b.maximumLineLength = newLine->lineLength;
+            else if (oldLine->lineLength >= b.maximumLineLength)
+                b.maximumLineLength = -1;
+        }
+
+        const int delta = newLine->lineLength - oldLine->lineLength;
+        b.numCharacters += delta;
+        addToTrees (blockIndex, 0, delta);
+    }
+
+    void removeRange (const int startIndex, int numToRemove)
+    {
+        numToRemove = jmin (numToRemove, numLines - startIndex);
+
+        if (numToRemove <= 0)
+            return;
+
+        int indexInBlock = startIndex;
+        int blockIndex = findBlock (lineTree, indexInBlock);
+        bool needsRebuilding = false;
+
+        while (numToRemove > 0)
+        {
+            Block& b = *blocks.getUnchecked (blockIndex);
+            const int num = jmin (numToRemove, b.lines.size() - indexInBlock);
+            int numChars = 0;
+
+            for (int i = indexInBlock + num; --i >= indexInBlock;)
+            {
+                const CodeDocumentLine* const l = b.lines.getUnchecked (i);
+                numChars += l->lineLength;
+                delete l;
+            }
+
+            b.lines.removeRange (indexInBlock, num);
+            b.numCharacters -= numChars;
+            b.maximumLineLength = -1;
+            numToRemove -= num;
+
+            if (b.lines.size() < maxLinesPerBlock / 4)
+                needsRebuilding = true;
+            else
+                addToTrees (blockIndex, -num, -numChars);
+
+            ++blockIndex;
+            indexInBlock = 0;
+        }
+
+        if (needsRebuilding)
+        {
+            mergeSmallBlocks();
+            rebuildTrees();
+        }
+    }
+
+    void removeLast()
+    {
+        removeRange (numLines - 1, 1);
+    }
+
+    void clear()
+    {
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            for (int j = b.lines.size(); --j >= 0;)
+                delete b.lines.getUnchecked (j);
+        }
+
+        blocks.clear();
+        rebuildTrees();
+    }
+
+private:
+    //==============================================================================
+    struct Block
+    {
+        Block() noexcept : numCharacters (0), maximumLineLength (0) {}
+
+        Array <CodeDocumentLine*> lines;
+        int numCharacters;
+        int maximumLineLength;  // (-1 when it needs recalculating)
+    };
+
+    enum { maxLinesPerBlock = 128 };
+
+    OwnedArray <Block> blocks;
+    Array <int> lineTree, charTree; // Fenwick trees of the blocks' sizes, indexed from 1
+    int numLines, numCharacters;
+
+    static int getPrefixSum (const Array<int>& tree, int numBlocks) noexcept
+    {
+        int total = 0;
+
+        for (; numBlocks > 0; numBlocks &= numBlocks - 1)
+            total += tree.getUnchecked (numBlocks);
+
+        return total;
+    }
+
+    // Finds the block containing the given offset, and changes the offset to be relative to its start
+    int findBlock (const Array<int>& tree, int& offset) const noexcept
+    {
+        const int numBlocks = blocks.size();
+        int blockIndex = 0;
+
+        for (int step = nextPowerOfTwo (numBlocks + 1) / 2; step > 0; step >>= 1)
+        {
+            const int next = blockIndex + step;
+
+            if (next <= numBlocks && tree.getUnchecked (next) <= offset)
+            {
+                blockIndex = next;
+                offset -= tree.getUnchecked (next);
+            }
         }
+
+        return jmin (blockIndex, numBlocks - 1);
     }
 
-    String line;
-    int lineStartInFile, lineLength, lineLengthWithoutNewLines;
+    void addToTrees (const int blockIndex, const int lineDelta, const int charDelta) noexcept
+    {
+        numLines += lineDelta;
+        numCharacters += charDelta;
+
+        for (int i = blockIndex + 1; i < lineTree.size(); i += (i & -i))
+        {
+            lineTree.getReference (i) += lineDelta;
+            charTree.getReference (i) += charDelta;
+        }
+    }
+
+    void rebuildTrees()
+    {
+        const int numBlocks = blocks.size();
+        lineTree.clearQuick();
+        lineTree.insertMultiple (0, 0, numBlocks + 1);
+        charTree = lineTree;
+        numLines = numCharacters = 0;
+
+        for (int i = 1; i <= numBlocks; ++i)
+        {
+            const Block& b = *blocks.getUnchecked (i - 1);
+            numLines += b.lines.size();
+            numCharacters += b.numCharacters;
+
+            lineTree.getReference (i) += b.lines.size();
+            charTree.getReference (i) += b.numCharacters;
+
+            const int parent = i + (i & -i);
+
+            if (parent <= numBlocks)
+            {
+                lineTree.getReference (parent) += lineTree.getUnchecked (i);
+                charTree.getReference (parent) += charTree.getUnchecked (i);
+            }
+        }
+    }
+
+    // Breaks up a block that has grown too big into half-full ones
+    void splitBlock (const int blockIndex)
+    {
+        Block& b = *blocks.getUnchecked (blockIndex);
+        const int linesPerBlock = maxLinesPerBlock / 2;
+        int insertIndex = blockIndex + 1;
+
+        for (int start = linesPerBlock; start < b.lines.size(); start += linesPerBlock)
+        {
+            Block* const newBlock = new Block();
+            newBlock->lines.addArray (b.lines, start, linesPerBlock);
+            newBlock->maximumLineLength = -1;
+
+            for (int i = newBlock->lines.size(); --i >= 0;)
+                newBlock->numCharacters += newBlock->lines.getUnchecked (i)->lineLength;
+
+            b.numCharacters -= newBlock->numCharacters;
+            blocks.insert (insertIndex++, newBlock);
+        }
+
+        if (b.lines.size() > linesPerBlock)
+        {
+            b.lines.removeRange (linesPerBlock, b.lines.size() - linesPerBlock);
+            b.maximumLineLength = -1;
+        }
+    }
+
+    void mergeSmallBlocks()
+    {
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            if (b.lines.size() == 0)
+            {
+                blocks.remove (i);
+            }
+            else if (b.lines.size() < maxLinesPerBlock / 4 && i > 0)
+            {
+                Block& previous = *blocks.getUnchecked (i - 1);
+
+                if (previous.lines.size() + b.lines.size() <= maxLinesPerBlock)
+                {
+                    previous.lines.addArray (b.lines);
+                    previous.numCharacters += b.numCharacters;
+                    previous.maximumLineLength = -1;
+                    blocks.remove (i);
+                }
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (CodeDocumentLineList);
 };
 
 //==============================================================================
 CodeDocument::Iterator::Iterator (CodeDocument* const document_)
     : document (document_),
       charPointer (nullptr),
+      lineEnd (nullptr),
       line (0),
       position (0)
 {
 }
 
+CodeDocument::Iterator::Iterator (const CodeDocument::Position& startPosition)
+    : document (startPosition.getOwner()),
+      charPointer (nullptr),
+      lineEnd (nullptr),
+      line (startPosition.getLineNumber()),
+      position (startPosition.getPosition())
+{
+    jassert (document != nullptr);
+
+    const CodeDocumentLine* const l = (*document->lines) [line];
+
+    if (l != nullptr)
+    {
+        charPointer = l->start + startPosition.getIndexInLine();
+        lineEnd = l->end;
+    }
+}
+
 CodeDocument::Iterator::Iterator (const CodeDocument::Iterator& other)
     : document (other.document),
       charPointer (other.charPointer),
+      lineEnd (other.lineEnd),
       line (other.line),
       position (other.position)
 {
@@ -143,6 +599,7 @@ CodeDocument::Iterator& CodeDocument::Iterator::operator= (const CodeDocument::I
 {
     document = other.document;
     charPointer = other.charPointer;
+    lineEnd = other.lineEnd;
     line = other.line;
     position = other.position;
 
@@ -159,17 +616,16 @@ juce_wchar CodeDocument::Iterator::nextChar()
     {
         if (charPointer.getAddress() == nullptr)
         {
-            CodeDocumentLine* const l = document->lines[line];
+            const CodeDocumentLine* const l = (*document->lines)[line];
 
             if (l == nullptr)
                 return 0;
 
-            charPointer = l->line.getCharPointer();
+            charPointer = l->start;
+            lineEnd = l->end;
         }
 
-        const juce_wchar result = charPointer.getAndAdvance();
-
-        if (result == 0)
+        if (charPointer == lineEnd)
         {
             ++line;
             charPointer = nullptr;
@@ -177,7 +633,7 @@ juce_wchar CodeDocument::Iterator::nextChar()
         else
         {
             ++position;
-            return result;
+            return charPointer.getAndAdvance();
         }
     }
 }
@@ -191,15 +647,16 @@ void CodeDocument::Iterator::skipToEndOfLine()
 {
     if (charPointer.getAddress() == nullptr)
     {
-        CodeDocumentLine* const l = document->lines[line];
+        const CodeDocumentLine* const l = (*document->lines)[line];
 
         if (l == nullptr)
             return;
 
-        charPointer = l->line.getCharPointer();
+        charPointer = l->start;
+        lineEnd = l->end;
     }
 
-    position += (int) charPointer.length();
+    position += (int) charPointer.lengthUpTo (lineEnd);
     ++line;
     charPointer = nullptr;
 }
@@ -208,21 +665,20 @@ juce_wchar CodeDocument::Iterator::peekNextChar() const
 {
     if (charPointer.getAddress() == nullptr)
     {
-        CodeDocumentLine* const l = document->lines[line];
+        const CodeDocumentLine* const l = (*document->lines)[line];
 
         if (l == nullptr)
             return 0;
 
-        charPointer = l->line.getCharPointer();
+        charPointer = l->start;
+        lineEnd = l->end;
     }
 
-    const juce_wchar c = *charPointer;
+    if (charPointer != lineEnd)
+        return *charPointer;
 
-    if (c != 0)
-        return c;
-
-    CodeDocumentLine* const l = document->lines [line + 1];
-    return l == nullptr ? 0 : l->line[0];
+    const CodeDocumentLine* const l = (*document->lines) [line + 1];
+    return l == nullptr ? 0 : l->getCharacter (0);
 }
 
 void CodeDocument::Iterator::skipWhitespace()
@@ -233,7 +689,7 @@ void CodeDocument::Iterator::skipWhitespace()
 
 bool CodeDocument::Iterator::isEOF() const noexcept
 {
-    return charPointer.getAddress() == nullptr && line >= document->lines.size();
+    return charPointer.getAddress() == nullptr && line >= document->lines->size();
 }
 
 //==============================================================================
@@ -312,7 +768,9 @@ void CodeDocument::Position::setLineAndIndex (const int newLineNum, const int ne
 {
     jassert (owner != nullptr);
 
-    if (owner->lines.size() == 0)
+    const CodeDocumentLineList& lines = *owner->lines;
+
+    if (lines.size() == 0)
     {
         line = 0;
         indexInLine = 0;
@@ -320,30 +778,29 @@ void CodeDocument::Position::setLineAndIndex (const int newLineNum, const int ne
     }
     else
     {
-        if (newLineNum >= owner->lines.size())
+        if (newLineNum >= lines.size())
         {
-            line = owner->lines.size() - 1;
+            line = lines.size() - 1;
 
-            CodeDocumentLine* const l = owner->lines.getUnchecked (line);
+            const CodeDocumentLine* const l = lines.getUnchecked (line);
             jassert (l != nullptr);
 
             indexInLine = l->lineLengthWithoutNewLines;
-            characterPos = l->lineStartInFile + indexInLine;
         }
         else
         {
             line = jmax (0, newLineNum);
 
-            CodeDocumentLine* const l = owner->lines.getUnchecked (line);
+            const CodeDocumentLine* const l = lines.getUnchecked (line);
             jassert (l != nullptr);
 
             if (l->lineLengthWithoutNewLines > 0)
                 indexInLine = jlimit (0, l->lineLengthWithoutNewLines, newIndexInLine);
             else
                 indexInLine = 0;
-
-            characterPos = l->lineStartInFile + indexInLine;
         }
+
+        characterPos = lines.getLineStart (line) + indexInLine;
     }
 }
 
@@ -355,42 +812,17 @@ void CodeDocument::Position::setPosition (const int newPosition)
     indexInLine = 0;
     characterPos = 0;
 
-    if (newPosition > 0)
-    {
-        int lineStart = 0;
-        int lineEnd = owner->lines.size();
+    const CodeDocumentLineList& lines = *owner->lines;
 
-        for (;;)
-        {
-            if (lineEnd - lineStart < 4)
-            {
-                for (int i = lineStart; i < lineEnd; ++i)
-                {
-                    CodeDocumentLine* const l = owner->lines.getUnchecked (i);
-
-                    int index = newPosition - l->lineStartInFile;
-
-                    if (index >= 0 && (index < l->lineLength || i == lineEnd - 1))
-                    {
-                        line = i;
-                        indexInLine = jmin (l->lineLengthWithoutNewLines, index);
-                        characterPos = l->lineStartInFile + indexInLine;
-                    }
-                }
+    if (newPosition > 0 && lines.size() > 0)
+    {
+        line = lines.findLineContaining (newPosition);
 
-                break;
-            }
-            else
-            {
-                const int midIndex = (lineStart + lineEnd + 1) / 2;
-                CodeDocumentLine* const mid = owner->lines.getUnchecked (midIndex);
+        const CodeDocumentLine* const l = lines.getUnchecked (line);
+        const int lineStart = lines.getLineStart (line);
 
-                if (newPosition >= mid->lineStartInFile)
-                    lineStart = midIndex;
-                else
-                    lineEnd = midIndex;
-            }
-        }
+        indexInLine = jmin (l->lineLengthWithoutNewLines, newPosition - lineStart);
+        characterPos = lineStart + indexInLine;
     }
 }
 
@@ -403,9 +835,9 @@ void CodeDocument::Position::moveBy (int characterDelta)
         setPosition (getPosition());
 
         // If moving right, make sure we don't get stuck between the \r and \n characters..
-        if (line < owner->lines.size())
+        if (line < owner->lines->size())
         {
-            CodeDocumentLine* const l = owner->lines.getUnchecked (line);
+            const CodeDocumentLine* const l = owner->lines->getUnchecked (line);
             if (indexInLine + characterDelta < l->lineLength
                  && indexInLine + characterDelta >= l->lineLengthWithoutNewLines + 1)
                 ++characterDelta;
@@ -431,14 +863,14 @@ const CodeDocument::Position CodeDocument::Position::movedByLines (const int del
 
 const juce_wchar CodeDocument::Position::getCharacter() const
 {
-    const CodeDocumentLine* const l = owner->lines [line];
-    return l == nullptr ? 0 : l->line [getIndexInLine()];
+    const CodeDocumentLine* const l = (*owner->lines) [line];
+    return l == nullptr ? 0 : l->getCharacter (getIndexInLine());
 }
 
 String CodeDocument::Position::getLineText() const
 {
-    const CodeDocumentLine* const l = owner->lines [line];
-    return l == nullptr ? String::empty : l->line;
+    const CodeDocumentLine* const l = (*owner->lines) [line];
+    return l == nullptr ? String::empty : l->getText();
 }
 
 void CodeDocument::Position::setPositionMaintained (const bool isMaintained)
@@ -466,10 +898,10 @@ void CodeDocument::Position::setPositionMaintained (const bool isMaintained)
 
 //==============================================================================
 CodeDocument::CodeDocument()
-    : undoManager (std::numeric_limits<int>::max(), 10000),
+    : lines (new CodeDocumentLineList()),
+      undoManager (std::numeric_limits<int>::max(), 10000),
       currentActionIndex (0),
       indexOfSavedState (-1),
-      maximumLineLength (-1),
       newLineChars ("\r\n")
 {
 }
@@ -481,7 +913,7 @@ CodeDocument::~CodeDocument()
 String CodeDocument::getAllContent() const
 {
     return getTextBetween (Position (this, 0),
-                           Position (this, lines.size(), 0));
+                           Position (this, lines->size(), 0));
 }
 
 String CodeDocument::getTextBetween (const Position& start, const Position& end) const
@@ -494,33 +926,33 @@ String CodeDocument::getTextBetween (const Position& start, const Position& end)
 
     if (startLine == endLine)
     {
-        CodeDocumentLine* const line = lines [startLine];
-        return (line == nullptr) ? String::empty : line->line.substring (start.getIndexInLine(), end.getIndexInLine());
+        const CodeDocumentLine* const line = (*lines) [startLine];
+        return (line == nullptr) ? String::empty : line->substring (start.getIndexInLine(), end.getIndexInLine());
     }
 
     MemoryOutputStream mo;
     mo.preallocate ((size_t) (end.getPosition() - start.getPosition() + 4));
 
-    const int maxLine = jmin (lines.size() - 1, endLine);
+    const int maxLine = jmin (lines->size() - 1, endLine);
 
     for (int i = jmax (0, startLine); i <= maxLine; ++i)
     {
-        const CodeDocumentLine* line = lines.getUnchecked(i);
+        const CodeDocumentLine* line = lines->getUnchecked(i);
         int len = line->lineLength;
 
         if (i == startLine)
         {
             const int index = start.getIndexInLine();
-            mo << line->line.substring (index, len);
+            mo << line->substring (index, len);
         }
         else if (i == endLine)
         {
             len = end.getIndexInLine();
-            mo << line->line.substring (0, len);
+            mo << line->substring (0, len);
         }
         else
         {
-            mo << line->line;
+            mo << line->getText();
         }
     }
 
@@ -529,27 +961,23 @@ String CodeDocument::getTextBetween (const Position& start, const Position& end)
 
 int CodeDocument::getNumCharacters() const noexcept
 {
-    const CodeDocumentLine* const lastLine = lines.getLast();
-    return (lastLine == nullptr) ? 0 : lastLine->lineStartInFile + lastLine->lineLength;
+    return lines->getNumCharacters();
+}
+
+int CodeDocument::getNumLines() const noexcept
+{
+    return lines->size();
 }
 
 String CodeDocument::getLine (const int lineIndex) const noexcept
 {
-    const CodeDocumentLine* const line = lines [lineIndex];
-    return (line == nullptr) ? String::empty : line->line;
+    const CodeDocumentLine* const line = (*lines) [lineIndex];
+    return (line == nullptr) ? String::empty : line->getText();
 }
 
 int CodeDocument::getMaximumLineLength() noexcept
 {
-    if (maximumLineLength < 0)
-    {
-        maximumLineLength = 0;
-
-        for (int i = lines.size(); --i >= 0;)
-            maximumLineLength = jmax (maximumLineLength, lines.getUnchecked(i)->lineLength);
-    }
-
-    return maximumLineLength;
+    return lines->getMaximumLineLength();
 }
 
 void CodeDocument::deleteSection (const Position& startPosition, const Position& endPosition)
@@ -579,13 +1007,20 @@ bool CodeDocument::loadFromStream (InputStream& stream)
 
 bool CodeDocument::writeToStream (OutputStream& stream)
 {
-    for (int i = 0; i < lines.size(); ++i)
+    for (int i = 0; i < lines->size(); ++i)
     {
-        String temp (lines.getUnchecked(i)->line); // use a copy to avoid bloating the memory footprint of the stored string.
+        const CodeDocumentLine* const l = lines->getUnchecked(i);
+
+       #if JUCE_STRING_UTF_TYPE == 8
+        if (! stream.write (l->start.getAddress(), (int) (l->end.getAddress() - l->start.getAddress())))
+            return false;
+       #else
+        String temp (l->getText()); // use a copy to avoid bloating the memory footprint of the stored string.
         const char* utf8 = temp.toUTF8();
 
         if (! stream.write (utf8, (int) strlen (utf8)))
             return false;
+       #endif
     }
 
     return true;
@@ -718,20 +1153,20 @@ const CodeDocument::Position CodeDocument::findWordBreakBefore (const Position&
 
 void CodeDocument::checkLastLineStatus()
 {
-    while (lines.size() > 0
-            && lines.getLast()->lineLength == 0
-            && (lines.size() == 1 || ! lines.getUnchecked (lines.size() - 2)->endsWithLineBreak()))
+    while (lines->size() > 0
+            && lines->getLast()->lineLength == 0
+            && (lines->size() == 1 || ! lines->getUnchecked (lines->size() - 2)->endsWithLineBreak()))
     {
         // remove any empty lines at the end if the preceding line doesn't end in a newline.
-        lines.removeLast();
+        lines->removeLast();
     }
 
-    const CodeDocumentLine* const lastLine = lines.getLast();
+    const CodeDocumentLine* const lastLine = lines->getLast();
 
     if (lastLine != nullptr && lastLine->endsWithLineBreak())
     {
         // check that there's an empty line at the end if the preceding one ends in a newline..
-        lines.add (new CodeDocumentLine (String::empty.getCharPointer(), 0, 0, lastLine->lineStartInFile + lastLine->lineLength));
+        lines->add (new CodeDocumentLine (String::empty));
     }
 }
 
@@ -804,49 +1239,34 @@ void CodeDocument::insert (const String& text, const int insertPos, const bool u
         const int firstAffectedLine = pos.getLineNumber();
         int lastAffectedLine = firstAffectedLine + 1;
 
-        CodeDocumentLine* const firstLine = lines [firstAffectedLine];
+        const CodeDocumentLine* const firstLine = (*lines) [firstAffectedLine];
         String textInsideOriginalLine (text);
 
         if (firstLine != nullptr)
         {
             const int index = pos.getIndexInLine();
-            textInsideOriginalLine = firstLine->line.substring (0, index)
+            textInsideOriginalLine = firstLine->substring (0, index)
                                      + textInsideOriginalLine
-                                     + firstLine->line.substring (index);
+                                     + firstLine->substring (index, firstLine->lineLength);
         }
 
-        maximumLineLength = -1;
         Array <CodeDocumentLine*> newLines;
         CodeDocumentLine::createLines (newLines, textInsideOriginalLine);
         jassert (newLines.size() > 0);
 
-        CodeDocumentLine* const newFirstLine = newLines.getUnchecked (0);
-        newFirstLine->lineStartInFile = firstLine != nullptr ? firstLine->lineStartInFile : 0;
-        lines.set (firstAffectedLine, newFirstLine);
+        lines->set (firstAffectedLine, newLines.getUnchecked (0));
 
         if (newLines.size() > 1)
         {
-            for (int i = 1; i < newLines.size(); ++i)
-            {
-                CodeDocumentLine* const l = newLines.getUnchecked (i);
-                lines.insert (firstAffectedLine + i, l);
-            }
-
-            lastAffectedLine = lines.size();
-        }
-
-        int i, lineStart = newFirstLine->lineStartInFile;
-        for (i = firstAffectedLine; i < lines.size(); ++i)
-        {
-            CodeDocumentLine* const l = lines.getUnchecked (i);
-            l->lineStartInFile = lineStart;
-            lineStart += l->lineLength;
+            newLines.remove (0);
+            lines->insertArray (firstAffectedLine + 1, newLines);
+            lastAffectedLine = lines->size();
         }
 
         checkLastLineStatus();
 
         const int newTextLength = text.length();
-        for (i = 0; i < positionsToMaintain.size(); ++i)
+        for (int i = 0; i < positionsToMaintain.size(); ++i)
         {
             CodeDocument::Position* const p = positionsToMaintain.getUnchecked(i);
 
@@ -909,46 +1329,37 @@ void CodeDocument::remove (const int startPos, const int endPos, const bool undo
         Position startPosition (this, startPos);
         Position endPosition (this, endPos);
 
-        maximumLineLength = -1;
         const int firstAffectedLine = startPosition.getLineNumber();
         const int endLine = endPosition.getLineNumber();
         int lastAffectedLine = firstAffectedLine + 1;
-        CodeDocumentLine* const firstLine = lines.getUnchecked (firstAffectedLine);
+        const CodeDocumentLine* const firstLine = lines->getUnchecked (firstAffectedLine);
 
         if (firstAffectedLine == endLine)
         {
-            firstLine->line = firstLine->line.substring (0, startPosition.getIndexInLine())
-                            + firstLine->line.substring (endPosition.getIndexInLine());
-            firstLine->updateLength();
+            lines->set (firstAffectedLine,
+                        new CodeDocumentLine (firstLine->substring (0, startPosition.getIndexInLine())
+                                               + firstLine->substring (endPosition.getIndexInLine(), firstLine->lineLength)));
         }
         else
         {
-            lastAffectedLine = lines.size();
+            lastAffectedLine = lines->size();
 
-            CodeDocumentLine* const lastLine = lines.getUnchecked (endLine);
+            const CodeDocumentLine* const lastLine = lines->getUnchecked (endLine);
             jassert (lastLine != nullptr);
 
-            firstLine->line = firstLine->line.substring (0, startPosition.getIndexInLine())
-                                + lastLine->line.substring (endPosition.getIndexInLine());
-            firstLine->updateLength();
+            lines->set (firstAffectedLine,
+                        new CodeDocumentLine (firstLine->substring (0, startPosition.getIndexInLine())
+                                               + lastLine->substring (endPosition.getIndexInLine(), lastLine->lineLength)));
 
             int numLinesToRemove = endLine - firstAffectedLine;
-            lines.removeRange (firstAffectedLine + 1, numLinesToRemove);
-        }
-
-        int i;
-        for (i = firstAffectedLine + 1; i < lines.size(); ++i)
-        {
-            CodeDocumentLine* const l = lines.getUnchecked (i);
-            const CodeDocumentLine* const previousLine = lines.getUnchecked (i - 1);
-            l->lineStartInFile = previousLine->lineStartInFile + previousLine->lineLength;
+            lines->removeRange (firstAffectedLine + 1, numLinesToRemove);
         }
 
         checkLastLineStatus();
 
         const int totalChars = getNumCharacters();
 
-        for (i = 0; i < positionsToMaintain.size(); ++i)
+        for (int i = 0; i < positionsToMaintain.size(); ++i)
         {
             CodeDocument::Position* p = positionsToMaintain.getUnchecked(i);
 
@@ -962,3 +1373,111 @@ void CodeDocument::remove (const int startPos, const int endPos, const bool undo
         sendListenerChangeMessage (firstAffectedLine, lastAffectedLine);
     }
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class CodeDocumentTests  : public UnitTest
+{
+public:
+    CodeDocumentTests()   : UnitTest ("CodeDocument") {}
+
+    static String createRandomText (Random& r, const int numChars)
+    {
+        static const char* const fragments[] = { "a", "bc", " ", "\t", "\n", "\r\n", "\r", "foo(x);", "\n\n" };
+
+        String s;
+        while (s.length() < numChars)
+            s << fragments [r.nextInt (numElementsInArray (fragments))];
+
+        return s;
+    }
+
+    void checkDocument (CodeDocument& doc, const String& expected, Random& r)
+    {
+        expect (doc.getAllContent() == expected);
+        expectEquals (doc.getNumCharacters(), expected.length());
+
+        String joinedLines;
+        for (int i = 0; i < doc.getNumLines(); ++i)
+            joinedLines << doc.getLine (i);
+
+        expect (joinedLines == expected);
+
+        String iterated;
+        CodeDocument::Iterator iter (&doc);
+        while (! iter.isEOF())
+            iterated << String::charToString (iter.nextChar());
+
+        expect (iterated == expected);
+        expectEquals (iter.getPosition(), expected.length());
+
+        for (int i = 0; i < 20; ++i)
+        {
+            const CodeDocument::Position pos (&doc, r.nextInt (expected.length() + 1));
+            const CodeDocument::Position fromLine (&doc, pos.getLineNumber(), pos.getIndexInLine());
+
+            expect (pos == fromLine);
+            expect (pos.getPosition() <= expected.length());
+            expect (pos.getCharacter() == expected [pos.getPosition()]);
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Edits");
+
+        Random r (1);
+        CodeDocument doc;
+        const String original (createRandomText (r, 20000));
+        String expected (original);
+
+        MemoryInputStream in (expected.toUTF8(), strlen (expected.toUTF8()), false);
+        doc.loadFromStream (in);
+        checkDocument (doc, expected, r);
+
+        CodeDocument::Position caret (&doc, expected.length() / 2);
+        caret.setPositionMaintained (true);
+
+        for (int i = 0; i < 300; ++i)
+        {
+            doc.newTransaction();
+
+            if (r.nextInt (3) != 0)
+            {
+                // (a position between a \r and \n gets moved to the start of the line break)
+                const CodeDocument::Position pos (&doc, r.nextInt (expected.length() + 1));
+                const String text (createRandomText (r, r.nextBool() ? 1 + r.nextInt (3) : r.nextInt (2000)));
+
+                doc.insertText (pos, text);
+                expected = expected.substring (0, pos.getPosition()) + text + expected.substring (pos.getPosition());
+            }
+            else
+            {
+                const CodeDocument::Position start (&doc, r.nextInt (expected.length() + 1));
+                const CodeDocument::Position end (&doc, start.getPosition() + (r.nextBool() ? 1 : r.nextInt (3000)));
+
+                doc.deleteSection (start, end);
+                expected = expected.substring (0, start.getPosition()) + expected.substring (jmax (start.getPosition(), end.getPosition()));
+            }
+
+            checkDocument (doc, expected, r);
+            expect (caret.getPosition() <= expected.length());
+        }
+
+        beginTest ("Undo");
+
+        while (doc.getUndoManager().canUndo())
+            doc.undo();
+
+        checkDocument (doc, original, r);
+
+        doc.replaceAllContent (String::empty);
+        checkDocument (doc, String::empty, r);
+        expectEquals (doc.getNumLines(), 0);
+    }
+};
+
+static CodeDocumentTests codeDocumentTests;
+
+#endif
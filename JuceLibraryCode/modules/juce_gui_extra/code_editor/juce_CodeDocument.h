@@ -27,6 +27,7 @@
 #define __JUCE_CODEDOCUMENT_JUCEHEADER__
 
 class CodeDocumentLine;
+class CodeDocumentLineList;
 
 
 //==============================================================================
@@ -35,8 +36,9 @@ class CodeDocumentLine;
 
     When using a CodeEditorComponent, it takes one of these as its source object.
 
-    The CodeDocument stores its content as an array of lines, which makes it
-    quick to insert and delete.
+    The CodeDocument stores its content as a list of lines, which share the text that
+    they were created from, and are indexed so that finding a line or a character
+    position stays quick in very large documents.
 
     @see CodeEditorComponent
 */
@@ -141,6 +143,9 @@ public:
         */
         int getIndexInLine() const noexcept         { return indexInLine; }
 
+        /** Returns the document that this position refers to. */
+        CodeDocument* getOwner() const noexcept     { return owner; }
+
         /** Allows the position to be automatically updated when the document changes.
 
             If this is set to true, the positon will register with its document so that
@@ -198,7 +203,7 @@ public:
     int getNumCharacters() const noexcept;
 
     /** Returns the number of lines in the document. */
-    int getNumLines() const noexcept                    { return lines.size(); }
+    int getNumLines() const noexcept;
 
     /** Returns the number of characters in the longest line of the document. */
     int getMaximumLineLength() noexcept;
@@ -335,6 +340,10 @@ public:
     {
     public:
         Iterator (CodeDocument* document);
+
+        /** Creates an iterator whose next character will be the one at the given position. */
+        explicit Iterator (const Position& startPosition);
+
         Iterator (const Iterator& other);
         Iterator& operator= (const Iterator& other) noexcept;
         ~Iterator() noexcept;
@@ -369,7 +378,7 @@ public:
 
     private:
         CodeDocument* document;
-        mutable String::CharPointerType charPointer;
+        mutable String::CharPointerType charPointer, lineEnd;
         int line, position;
     };
 
@@ -380,11 +389,10 @@ private:
     friend class Iterator;
     friend class Position;
 
-    OwnedArray <CodeDocumentLine> lines;
+    ScopedPointer <CodeDocumentLineList> lines;
     Array <Position*> positionsToMaintain;
     UndoManager undoManager;
     int currentActionIndex, indexOfSavedState;
-    int maximumLineLength;
     ListenerList <Listener> listeners;
     String newLineChars;
 
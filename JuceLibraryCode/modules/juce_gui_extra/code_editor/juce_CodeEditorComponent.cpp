@@ -23,189 +23,619 @@
   ==============================================================================
 */
 
-class CodeEditorComponent::CodeEditorLine
+/*  Keeps a checkpoint of the tokeniser's state at the start of each line of the
+    document, so that any line can be tokenised without reading what comes before it.
+
+    A CodeTokeniser has no state apart from its position, so a line's checkpoint is
+    described by the token that's running when the line begins: its type, and where
+    the first token that starts inside the line begins. After an edit, the lines are
+    re-read from the last checkpoint before it, but only until their new states match
+    the old ones again.
+
+    Lines past the last valid checkpoint are read on a background thread, a chunk at
+    a time, using copies of the document's text.
+*/
+class CodeEditorComponent::LineTokeniser  : public TimeSliceClient,
+                                            private AsyncUpdater
 {
 public:
-    CodeEditorLine() noexcept
-       : highlightColumnStart (0), highlightColumnEnd (0)
+    LineTokeniser (CodeEditorComponent& owner_, CodeTokeniser& tokeniser_)
+        : owner (owner_), document (owner_.document), tokeniser (tokeniser_),
+          numLinesTokenised (0), staleStart (0), staleEnd (0),
+          jobInProgress (false), firstLineChangedSinceJob (std::numeric_limits<int>::max()),
+          linesPerJob (defaultLinesPerJob),
+          hasPendingJob (false), hasFinishedJob (false),
+          thread ("CodeEditor Tokeniser")
     {
+        states.insertMultiple (0, LineState(), document.getNumLines());
+        numLinesTokenised = staleStart = staleEnd = jmin (1, states.size());
     }
 
-    bool update (CodeDocument& document, int lineNum,
-                 CodeDocument::Iterator& source,
-                 CodeTokeniser* analyser, const int spacesPerTab,
-                 const CodeDocument::Position& selectionStart,
-                 const CodeDocument::Position& selectionEnd)
+    ~LineTokeniser()
     {
-        Array <SyntaxToken> newTokens;
-        newTokens.ensureStorageAllocated (8);
+        thread.removeTimeSliceClient (this);
+        thread.stopThread (10000);
+    }
 
-        if (analyser == nullptr)
+    //==============================================================================
+    struct Token
+    {
+        Token (const int start_, const int end_, const int tokenType_) noexcept
+            : start (start_), end (end_), tokenType (tokenType_)
         {
-            newTokens.add (SyntaxToken (document.getLine (lineNum), -1));
         }
-        else if (lineNum < document.getNumLines())
+
+        bool operator== (const Token& other) const noexcept
         {
-            const CodeDocument::Position pos (&document, lineNum, 0);
-            createTokens (pos.getPosition(), pos.getLineText(),
-                          source, analyser, newTokens);
+            return start == other.start && end == other.end && tokenType == other.tokenType;
         }
 
-        replaceTabsWithSpaces (newTokens, spacesPerTab);
+        int start, end, tokenType;
+    };
 
-        int newHighlightStart = 0;
-        int newHighlightEnd = 0;
+    /** Appends the tokens in a line, as ranges of indexes within the line. */
+    void readTokens (const int lineNum, const int lineLength, Array <Token>& tokens)
+    {
+        const LineState state (lineNum < numLinesTokenised ? states.getReference (lineNum)
+                                                           : LineState());
 
-        if (selectionStart.getLineNumber() <= lineNum && selectionEnd.getLineNumber() >= lineNum)
+        if (state.firstTokenStart != 0)
+            tokens.add (Token (0, state.firstTokenStart < 0 ? lineLength : state.firstTokenStart,
+                               state.tokenType));
+
+        if (state.firstTokenStart >= 0)
         {
-            const String line (document.getLine (lineNum));
+            const int lineStart = CodeDocument::Position (&document, lineNum, 0).getPosition();
+            const int lineEnd = lineStart + lineLength;
+            CodeDocument::Iterator source (CodeDocument::Position (&document, lineStart + state.firstTokenStart));
 
-            CodeDocument::Position lineStart (&document, lineNum, 0), lineEnd (&document, lineNum + 1, 0);
-            newHighlightStart = indexToColumn (jmax (0, selectionStart.getPosition() - lineStart.getPosition()),
-                                               line, spacesPerTab);
-            newHighlightEnd = indexToColumn (jmin (lineEnd.getPosition() - lineStart.getPosition(), selectionEnd.getPosition() - lineStart.getPosition()),
-                                             line, spacesPerTab);
+            const ScopedLock sl (tokeniserLock);
+
+            for (;;)
+            {
+                const int tokenStart = source.getPosition();
+                const int tokenType = tokeniser.readNextToken (source);
+                const int tokenEnd = jmin (lineEnd, source.getPosition());
+
+                if (tokenEnd <= tokenStart)
+                    break;
+
+                tokens.add (Token (tokenStart - lineStart, tokenEnd - lineStart, tokenType));
+
+                if (tokenEnd >= lineEnd)
+                    break;
+            }
         }
+    }
 
-        if (newHighlightStart != highlightColumnStart || newHighlightEnd != highlightColumnEnd)
+    /** Makes sure the checkpoints are valid up to the given line, if that can be done
+        quickly. Otherwise, those lines are tokenised as if nothing before them was
+        running, until the background thread catches up.
+    */
+    void prepareLines (int endLine)
+    {
+        endLine = jmin (endLine, states.size());
+
+        if (endLine > numLinesTokenised && endLine - numLinesTokenised <= maxLinesToReadSynchronously)
+            readStates (numLinesTokenised - 1, -1, endLine);
+
+        startBackgroundJob();
+    }
+
+    /** Called after every change to the document, to shift the checkpoints after the changed
+        line and re-read the lines from there until their states converge again.
+    */
+    void documentChanged (const int firstChangedLine, const int lastVisibleLine)
+    {
+        const int delta = document.getNumLines() - states.size();
+
+        if (delta > 0)
+            states.insertMultiple (firstChangedLine + 1, LineState(), delta);
+        else if (delta < 0)
+            states.removeRange (jmin (firstChangedLine + 1, states.size() + delta), -delta);
+
+        firstLineChangedSinceJob = jmin (firstLineChangedSinceJob, firstChangedLine);
+
+        const int lastChangedLine = firstChangedLine + jmax (0, delta);
+        const bool wasTokenised = firstChangedLine < numLinesTokenised;
+
+        numLinesTokenised = shiftLine (numLinesTokenised, firstChangedLine, delta);
+        staleStart = shiftLine (staleStart, firstChangedLine, delta);
+        staleEnd = shiftLine (staleEnd, firstChangedLine, delta);
+
+        // (the first line's state is always known)
+        setNumLinesTokenised (jmax (numLinesTokenised, jmin (1, states.size())));
+
+        if (wasTokenised && states.size() > 0)
         {
-            highlightColumnStart = newHighlightStart;
-            highlightColumnEnd = newHighlightEnd;
+            readStates (jmax (0, firstChangedLine - 1), lastChangedLine,
+                        jmax (lastChangedLine, lastVisibleLine) + maxLinesToReadSynchronously);
         }
         else
         {
-            if (tokens.size() == newTokens.size())
+            // the old states of the lines just before the change may no longer be comparable
+            staleEnd = jmin (staleEnd, firstChangedLine - 1);
+            setNumLinesTokenised (numLinesTokenised);
+        }
+
+        startBackgroundJob();
+    }
+
+    //==============================================================================
+    int useTimeSlice()
+    {
+        Job job;
+
+        {
+            const ScopedLock sl (jobLock);
+
+            if (! hasPendingJob)
+                return 500;
+
+            job.swapWith (pendingJob);
+            hasPendingJob = false;
+        }
+
+        {
+            MemoryInputStream in (job.text.toUTF8(), job.text.getNumBytesAsUTF8(), false);
+            snapshot.loadFromStream (in);
+        }
+
+        const int numChars = snapshot.getNumCharacters();
+
+        {
+            const ScopedLock sl (tokeniserLock);
+            StateReader reader (snapshot, tokeniser, 0, 0);
+            LineState state;
+
+            while (reader.read (state)
+                    && (job.reachesEndOfDocument || reader.getTokenEnd() < numChars))
+                job.states.add (state);
+        }
+
+        {
+            const ScopedLock sl (jobLock);
+            finishedJob.swapWith (job);
+            hasFinishedJob = true;
+        }
+
+        triggerAsyncUpdate();
+        return 500;
+    }
+
+    void handleAsyncUpdate()
+    {
+        Job job;
+
+        {
+            const ScopedLock sl (jobLock);
+
+            if (! hasFinishedJob)
+                return;
+
+            job.swapWith (finishedJob);
+            hasFinishedJob = false;
+        }
+
+        jobInProgress = false;
+
+        const int oldNumLinesTokenised = numLinesTokenised;
+        const int endLine = jmin (states.size(), job.startLine + 1 + job.states.size(),
+                                  firstLineChangedSinceJob - 1);
+
+        if (job.startLine < numLinesTokenised)
+        {
+            for (int line = numLinesTokenised; line < endLine; ++line)
             {
-                bool allTheSame = true;
+                const LineState& state = job.states.getReference (line - job.startLine - 1);
 
-                for (int i = newTokens.size(); --i >= 0;)
+                if (state.firstTokenStart >= 0 && line >= staleStart && line < staleEnd
+                     && state == states.getReference (line))
                 {
-                    if (tokens.getReference(i) != newTokens.getReference(i))
-                    {
-                        allTheSame = false;
-                        break;
-                    }
+                    setNumLinesTokenised (staleEnd);
+                    break;
                 }
 
-                if (allTheSame)
-                    return false;
+                states.getReference (line) = state;
+                setNumLinesTokenised (line + 1);
             }
         }
 
-        tokens.swapWithArray (newTokens);
-        return true;
+        if (numLinesTokenised > oldNumLinesTokenised)
+        {
+            linesPerJob = defaultLinesPerJob;
+
+            if (owner.firstLineOnScreen < numLinesTokenised
+                 && owner.firstLineOnScreen + owner.linesOnScreen + 1 > oldNumLinesTokenised)
+                owner.triggerAsyncUpdate();
+        }
+        else if (firstLineChangedSinceJob > job.startLine + job.states.size() + 1)
+        {
+            // nothing in the chunk could be used because a token ran off the end of it
+            linesPerJob = jmin (linesPerJob * 2, 1 << 22);
+        }
+
+        startBackgroundJob();
     }
 
-    void draw (CodeEditorComponent& owner, Graphics& g, const Font& font,
-               float x, const int y, const int baselineOffset, const int lineHeight,
-               const Colour& highlightColour) const
+private:
+    //==============================================================================
+    struct LineState
     {
-        if (highlightColumnStart < highlightColumnEnd)
+        LineState() noexcept  : firstTokenStart (0), tokenType (0) {}
+
+        LineState (const int firstTokenStart_, const int tokenType_) noexcept
+            : firstTokenStart (firstTokenStart_), tokenType (tokenType_)
         {
-            g.setColour (highlightColour);
-            g.fillRect (roundToInt (x + highlightColumnStart * owner.getCharWidth()), y,
-                        roundToInt ((highlightColumnEnd - highlightColumnStart) * owner.getCharWidth()), lineHeight);
         }
 
-        int lastType = std::numeric_limits<int>::min();
+        bool operator== (const LineState& other) const noexcept
+        {
+            return firstTokenStart == other.firstTokenStart && tokenType == other.tokenType;
+        }
 
-        for (int i = 0; i < tokens.size(); ++i)
+        int firstTokenStart;  // index in the line of the first token that starts in it, or -1 if none does
+        int tokenType;        // the type of the token that's running when the line starts, if it began before it
+    };
+
+    //==============================================================================
+    /*  Reads tokens from a checkpoint onwards, returning the state at the start of
+        each line that follows it.
+    */
+    class StateReader
+    {
+    public:
+        StateReader (CodeDocument& document_, CodeTokeniser& tokeniser_,
+                     const int line, const int startPosition)
+            : document (document_), tokeniser (tokeniser_),
+              source (CodeDocument::Position (&document_, startPosition)),
+              tokenStart (startPosition), tokenEnd (startPosition), tokenType (0),
+              nextLine (line + 1),
+              nextLineStart (CodeDocument::Position (&document_, line + 1, 0).getPosition())
         {
-            SyntaxToken& token = tokens.getReference(i);
+        }
 
-            if (lastType != token.tokenType)
+        int getNextLine() const noexcept        { return nextLine; }
+        int getTokenEnd() const noexcept        { return tokenEnd; }
+
+        bool read (LineState& state)
+        {
+            if (nextLine >= document.getNumLines())
+                return false;
+
+            while (tokenEnd <= nextLineStart)
             {
-                lastType = token.tokenType;
-                g.setColour (owner.getColourForTokenType (lastType));
+                tokenStart = source.getPosition();
+                tokenType = tokeniser.readNextToken (source);
+                tokenEnd = source.getPosition();
+
+                if (tokenEnd <= tokenStart)
+                {
+                    tokenEnd = tokenStart;
+                    break;
+                }
             }
 
-            g.drawSingleLineText (token.text, roundToInt (x), y + baselineOffset);
+            const int followingLineStart = CodeDocument::Position (&document, nextLine + 1, 0).getPosition();
+
+            // (a line's state mustn't depend on anything after its first token starts,
+            // because an edit could change the type of a token from there onwards)
+            if (tokenEnd <= nextLineStart || tokenStart == nextLineStart)
+                state = LineState();
+            else
+                state = LineState (tokenEnd < followingLineStart ? tokenEnd - nextLineStart : -1, tokenType);
+
+            ++nextLine;
+            nextLineStart = followingLineStart;
+            return true;
+        }
+
+    private:
+        CodeDocument& document;
+        CodeTokeniser& tokeniser;
+        CodeDocument::Iterator source;
+        int tokenStart, tokenEnd, tokenType, nextLine, nextLineStart;
+
+        JUCE_DECLARE_NON_COPYABLE (StateReader);
+    };
+
+    //==============================================================================
+    struct Job
+    {
+        Job() noexcept  : startLine (0), reachesEndOfDocument (false) {}
+
+        void swapWith (Job& other) noexcept
+        {
+            std::swap (startLine, other.startLine);
+            std::swap (reachesEndOfDocument, other.reachesEndOfDocument);
+            text.swapWith (other.text);
+            states.swapWithArray (other.states);
+        }
+
+        int startLine;
+        bool reachesEndOfDocument;
+        String text;               // the document's text from the checkpoint in startLine onwards
+        Array <LineState> states;  // the states of the lines after startLine
+    };
+
+    //==============================================================================
+    enum
+    {
+        maxLinesToReadSynchronously = 1000,
+        defaultLinesPerJob = 2000
+    };
+
+    CodeEditorComponent& owner;
+    CodeDocument& document;
+    CodeTokeniser& tokeniser;
+    CriticalSection tokeniserLock;
+
+    // The states of the lines below numLinesTokenised are valid. After an edit that
+    // couldn't be followed to convergence straight away, the lines from staleStart to
+    // staleEnd still hold their states from before it, which are only compared against.
+    Array <LineState> states;
+    int numLinesTokenised, staleStart, staleEnd;
+
+    bool jobInProgress;
+    int firstLineChangedSinceJob, linesPerJob;
+
+    CriticalSection jobLock;
+    Job pendingJob, finishedJob;
+    bool hasPendingJob, hasFinishedJob;
+
+    CodeDocument snapshot;
+    TimeSliceThread thread;
+
+    int shiftLine (const int line, const int firstChangedLine, const int delta) const noexcept
+    {
+        return jmin (states.size(), line <= firstChangedLine ? line
+                                                             : jmax (firstChangedLine + 1, line + delta));
+    }
+
+    void setNumLinesTokenised (const int newNumLines) noexcept
+    {
+        numLinesTokenised = newNumLines;
+        staleStart = jmax (staleStart, newNumLines);
+
+        if (staleEnd <= staleStart)
+            staleStart = staleEnd = newNumLines;
+    }
+
+    bool canBeCompared (const int line, const int lastChangedLine) const noexcept
+    {
+        return line > lastChangedLine
+                && line < states.size() - 1
+                && (line < numLinesTokenised || (line >= staleStart && line < staleEnd));
+    }
+
+    void readStates (const int startLine, const int lastChangedLine, int endLine)
+    {
+        jassert (startLine < numLinesTokenised);
+        endLine = jmin (endLine, states.size());
+
+        int line = startLine;
+        while (line > 0 && states.getReference (line).firstTokenStart < 0)
+            --line;
+
+        const int checkpoint = CodeDocument::Position (&document, line, 0).getPosition()
+                                 + states.getReference (line).firstTokenStart;
+
+        const ScopedLock sl (tokeniserLock);
+        StateReader reader (document, tokeniser, line, checkpoint);
+        LineState state;
 
-            if (i < tokens.size() - 1)
+        while ((line = reader.getNextLine()) < endLine && reader.read (state))
+        {
+            LineState& oldState = states.getReference (line);
+
+            if (state.firstTokenStart >= 0 && canBeCompared (line, lastChangedLine) && state == oldState)
             {
-                if (token.width < 0)
-                    token.width = font.getStringWidthFloat (token.text);
+                // everything after here will be tokenised the same way as before..
+                if (line >= numLinesTokenised)
+                    setNumLinesTokenised (staleEnd);
 
-                x += token.width;
+                return;
             }
+
+            oldState = state;
+        }
+
+        line = reader.getNextLine();
+
+        if (line < numLinesTokenised)
+        {
+            // keep the old states of the remaining lines so that the background thread can
+            // stop when it reaches a line whose state hasn't changed
+            if (staleStart > numLinesTokenised)
+                staleEnd = numLinesTokenised;
+
+            staleStart = jmax (line, lastChangedLine + 1);
+            staleEnd = jmax (staleEnd, numLinesTokenised);
+            numLinesTokenised = line;
+
+            if (staleEnd <= staleStart)
+                staleStart = staleEnd = line;
+        }
+        else
+        {
+            setNumLinesTokenised (line);
         }
     }
 
-private:
-    struct SyntaxToken
+    void startBackgroundJob()
     {
-        SyntaxToken (const String& text_, const int type) noexcept
-            : text (text_), tokenType (type), width (-1.0f)
+        if (jobInProgress || numLinesTokenised >= states.size())
+            return;
+
+        int line = numLinesTokenised - 1;
+        while (line > 0 && states.getReference (line).firstTokenStart < 0)
+            --line;
+
+        const int endLine = jmin (states.size(), numLinesTokenised + linesPerJob);
+
+        Job job;
+        job.startLine = line;
+        job.reachesEndOfDocument = endLine >= states.size();
+        job.text = document.getTextBetween (CodeDocument::Position (&document, CodeDocument::Position (&document, line, 0).getPosition()
+                                                                                 + states.getReference (line).firstTokenStart),
+                                            CodeDocument::Position (&document, endLine, 0));
+
         {
+            const ScopedLock sl (jobLock);
+            pendingJob.swapWith (job);
+            hasPendingJob = true;
         }
 
-        bool operator!= (const SyntaxToken& other) const noexcept
+        jobInProgress = true;
+        firstLineChangedSinceJob = std::numeric_limits<int>::max();
+
+        if (! thread.isThreadRunning())
         {
-            return text != other.text || tokenType != other.tokenType;
+            thread.addTimeSliceClient (this);
+            thread.startThread (3);
         }
 
-        String text;
-        int tokenType;
-        float width;
-    };
+        thread.moveToFrontOfQueue (this);
+    }
 
-    Array <SyntaxToken> tokens;
-    int highlightColumnStart, highlightColumnEnd;
+    JUCE_DECLARE_NON_COPYABLE (LineTokeniser);
+};
+
+//==============================================================================
+class CodeEditorComponent::CodeEditorLine
+{
+public:
+    CodeEditorLine() noexcept
+       : highlightColumnStart (0), highlightColumnEnd (0)
+    {
+    }
 
-    static void createTokens (int startPosition, const String& lineText,
-                              CodeDocument::Iterator& source,
-                              CodeTokeniser* analyser,
-                              Array <SyntaxToken>& newTokens)
+    bool update (CodeDocument& document, int lineNum,
+                 LineTokeniser* tokeniser, const int spacesPerTab,
+                 const CodeDocument::Position& selectionStart,
+                 const CodeDocument::Position& selectionEnd)
     {
-        CodeDocument::Iterator lastIterator (source);
-        const int lineLength = lineText.length();
+        const String line (document.getLine (lineNum));
+        newTokens.clearQuick();
 
-        for (;;)
+        if (tokeniser == nullptr)
+            newTokens.add (Token (0, line.length(), -1));
+        else if (lineNum < document.getNumLines())
+            tokeniser->readTokens (lineNum, line.length(), newTokens);
+
+        const String newText (replaceTabsWithSpaces (line, newTokens, spacesPerTab));
+
+        int newHighlightStart = 0;
+        int newHighlightEnd = 0;
+
+        if (selectionStart.getLineNumber() <= lineNum && selectionEnd.getLineNumber() >= lineNum)
         {
-            int tokenType = analyser->readNextToken (source);
-            int tokenStart = lastIterator.getPosition();
-            int tokenEnd = source.getPosition();
+            CodeDocument::Position lineStart (&document, lineNum, 0), lineEnd (&document, lineNum + 1, 0);
+            newHighlightStart = indexToColumn (jmax (0, selectionStart.getPosition() - lineStart.getPosition()),
+                                               line, spacesPerTab);
+            newHighlightEnd = indexToColumn (jmin (lineEnd.getPosition() - lineStart.getPosition(), selectionEnd.getPosition() - lineStart.getPosition()),
+                                             line, spacesPerTab);
+        }
 
-            if (tokenEnd <= tokenStart)
-                break;
+        if (newHighlightStart != highlightColumnStart || newHighlightEnd != highlightColumnEnd)
+        {
+            highlightColumnStart = newHighlightStart;
+            highlightColumnEnd = newHighlightEnd;
+        }
+        else if (text == newText && tokens == newTokens)
+        {
+            return false;
+        }
 
-            tokenEnd -= startPosition;
+        text = newText;
+        tokens.swapWithArray (newTokens);
+        return true;
+    }
 
-            if (tokenEnd > 0)
-            {
-                tokenStart -= startPosition;
-                newTokens.add (SyntaxToken (lineText.substring (jmax (0, tokenStart), tokenEnd),
-                                            tokenType));
+    void draw (CodeEditorComponent& owner, Graphics& g,
+               float x, const int y, const int baselineOffset, const int lineHeight,
+               const Colour& highlightColour) const
+    {
+        const float charWidth = owner.getCharWidth();
 
-                if (tokenEnd >= lineLength)
-                    break;
+        if (highlightColumnStart < highlightColumnEnd)
+        {
+            g.setColour (highlightColour);
+            g.fillRect (roundToInt (x + highlightColumnStart * charWidth), y,
+                        roundToInt ((highlightColumnEnd - highlightColumnStart) * charWidth), lineHeight);
+        }
+
+        int lastType = std::numeric_limits<int>::min();
+
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            const Token& token = tokens.getReference(i);
+
+            if (lastType != token.tokenType)
+            {
+                lastType = token.tokenType;
+                g.setColour (owner.getColourForTokenType (lastType));
             }
 
-            lastIterator = source;
+            g.drawSingleLineText (text.substring (token.start, token.end),
+                                  roundToInt (x + token.start * charWidth), y + baselineOffset);
         }
-
-        source = lastIterator;
     }
 
-    static void replaceTabsWithSpaces (Array <SyntaxToken>& tokens, const int spacesPerTab)
+private:
+    typedef LineTokeniser::Token Token;
+
+    // The tokens index the line's text after its tabs have been expanded, and adjacent
+    // tokens of the same type are merged. The arrays keep their storage between updates.
+    String text;
+    Array <Token> tokens, newTokens;
+    int highlightColumnStart, highlightColumnEnd;
+
+    static String replaceTabsWithSpaces (const String& line, Array <Token>& tokens, const int spacesPerTab)
     {
-        int x = 0;
+        const bool hasTabs = line.containsChar ('\t');
+        String result;
+
+        String::CharPointerType t (line.getCharPointer());
+        int index = 0, column = 0, numMerged = 0;
+
         for (int i = 0; i < tokens.size(); ++i)
         {
-            SyntaxToken& t = tokens.getReference(i);
+            Token token (tokens.getReference(i));
 
-            for (;;)
+            if (hasTabs)
             {
-                int tabPos = t.text.indexOfChar ('\t');
-                if (tabPos < 0)
-                    break;
+                while (index < token.end)
+                {
+                    const juce_wchar c = t.getAndAdvance();
 
-                const int spacesNeeded = spacesPerTab - ((tabPos + x) % spacesPerTab);
-                t.text = t.text.replaceSection (tabPos, 1, String::repeatedString (" ", spacesNeeded));
+                    if (index++ == token.start)
+                        token.start = column;
+
+                    if (c == '\t')
+                    {
+                        const int spacesNeeded = spacesPerTab - (column % spacesPerTab);
+                        result << String::repeatedString (" ", spacesNeeded);
+                        column += spacesNeeded;
+                    }
+                    else
+                    {
+                        result << c;
+                        ++column;
+                    }
+                }
+
+                token.end = column;
             }
 
-            x += t.text.length();
+            if (numMerged > 0 && tokens.getReference (numMerged - 1).tokenType == token.tokenType)
+                tokens.getReference (numMerged - 1).end = token.end;
+            else
+                tokens.getReference (numMerged++) = token;
         }
+
+        tokens.removeRange (numMerged, tokens.size());
+        return hasTabs ? result : line;
     }
 
     int indexToColumn (int index, const String& line, int spacesPerTab) const noexcept
@@ -244,6 +674,9 @@ CodeEditorComponent::CodeEditorComponent (CodeDocument& document_,
       horizontalScrollBar (false),
       codeTokeniser (codeTokeniser_)
 {
+    if (codeTokeniser != nullptr)
+        lineTokeniser = new LineTokeniser (*this, *codeTokeniser);
+
     caretPos = CodeDocument::Position (&document_, 0, 0);
     caretPos.setPositionMaintained (true);
 
@@ -279,11 +712,11 @@ CodeEditorComponent::CodeEditorComponent (CodeDocument& document_,
 CodeEditorComponent::~CodeEditorComponent()
 {
     document.removeListener (this);
+    lineTokeniser = nullptr;
 }
 
 void CodeEditorComponent::loadContent (const String& newContent)
 {
-    clearCachedIterators (0);
     document.replaceAllContent (newContent);
     document.clearUndoHistory();
     document.setSavePoint();
@@ -312,7 +745,9 @@ Rectangle<int> CodeEditorComponent::getCaretRectangle()
 void CodeEditorComponent::codeDocumentChanged (const CodeDocument::Position& affectedTextStart,
                                                const CodeDocument::Position& affectedTextEnd)
 {
-    clearCachedIterators (affectedTextStart.getLineNumber());
+    if (lineTokeniser != nullptr)
+        lineTokeniser->documentChanged (affectedTextStart.getLineNumber(),
+                                        firstLineOnScreen + linesOnScreen + 1);
 
     triggerAsyncUpdate();
 
@@ -362,7 +797,7 @@ void CodeEditorComponent::paint (Graphics& g)
 
     for (int j = firstLineToDraw; j < lastLineToDraw; ++j)
     {
-        lines.getUnchecked(j)->draw (*this, g, font,
+        lines.getUnchecked(j)->draw (*this, g,
                                      (float) (gutter - xOffset * charWidth),
                                      lineHeight * j, baselineOffset, lineHeight,
                                      highlightColour);
@@ -405,14 +840,14 @@ void CodeEditorComponent::rebuildLineTokens()
 
     jassert (numNeeded == lines.size());
 
-    CodeDocument::Iterator source (&document);
-    getIteratorForPosition (CodeDocument::Position (&document, firstLineOnScreen, 0).getPosition(), source);
+    if (lineTokeniser != nullptr)
+        lineTokeniser->prepareLines (firstLineOnScreen + numNeeded);
 
     for (int i = 0; i < numNeeded; ++i)
     {
         CodeEditorLine* const line = lines.getUnchecked(i);
 
-        if (line->update (document, firstLineOnScreen + i, source, codeTokeniser, spacesPerTab,
+        if (line->update (document, firstLineOnScreen + i, lineTokeniser, spacesPerTab,
                           selectionStart, selectionEnd))
         {
             minLineToRepaint = jmin (minLineToRepaint, i);
@@ -516,8 +951,6 @@ void CodeEditorComponent::scrollToLineInternal (int newFirstLineOnScreen)
     {
         firstLineOnScreen = newFirstLineOnScreen;
         updateCaretPosition();
-
-        updateCachedIterators (firstLineOnScreen);
         triggerAsyncUpdate();
     }
 }
@@ -1042,7 +1475,8 @@ void CodeEditorComponent::setTabSize (const int numSpaces, const bool insertSpac
 
 int CodeEditorComponent::indexToColumn (int lineNum, int index) const noexcept
 {
-    String::CharPointerType t (document.getLine (lineNum).getCharPointer());
+    const String line (document.getLine (lineNum));
+    String::CharPointerType t (line.getCharPointer());
 
     int col = 0;
     for (int i = 0; i < index; ++i)
@@ -1064,7 +1498,8 @@ int CodeEditorComponent::indexToColumn (int lineNum, int index) const noexcept
 
 int CodeEditorComponent::columnToIndex (int lineNum, int column) const noexcept
 {
-    String::CharPointerType t (document.getLine (lineNum).getCharPointer());
+    const String line (document.getLine (lineNum));
+    String::CharPointerType t (line.getCharPointer());
 
     int i = 0, col = 0;
 
@@ -1123,75 +1558,170 @@ Colour CodeEditorComponent::getColourForTokenType (const int tokenType) const
     return coloursForTokenCategories.getReference (tokenType);
 }
 
-void CodeEditorComponent::clearCachedIterators (const int firstLineToBeInvalid)
-{
-    int i;
-    for (i = cachedIterators.size(); --i >= 0;)
-        if (cachedIterators.getUnchecked (i)->getLine() < firstLineToBeInvalid)
-            break;
-
-    cachedIterators.removeRange (jmax (0, i - 1), cachedIterators.size());
-}
+//==============================================================================
+#if JUCE_UNIT_TESTS
 
-void CodeEditorComponent::updateCachedIterators (int maxLineNum)
+class CodeEditorComponentTests  : public UnitTest
 {
-    const int maxNumCachedPositions = 5000;
-    const int linesBetweenCachedSources = jmax (10, document.getNumLines() / maxNumCachedPositions);
+public:
+    CodeEditorComponentTests()   : UnitTest ("CodeEditorComponent") {}
 
-    if (cachedIterators.size() == 0)
-        cachedIterators.add (new CodeDocument::Iterator (&document));
+    // counts the tokens that get read on the message thread, i.e. not by the background thread
+    class CountingTokeniser  : public CPlusPlusCodeTokeniser
+    {
+    public:
+        CountingTokeniser() : numTokensRead (0) {}
 
-    if (codeTokeniser == nullptr)
-        return;
+        int readNextToken (CodeDocument::Iterator& source)
+        {
+            if (MessageManager::getInstance()->isThisTheMessageThread())
+                ++numTokensRead;
 
-    for (;;)
-    {
-        CodeDocument::Iterator* last = cachedIterators.getLast();
+            return CPlusPlusCodeTokeniser::readNextToken (source);
+        }
 
-        if (last->getLine() >= maxLineNum)
-            break;
+        int numTokensRead;
+    };
 
-        CodeDocument::Iterator* t = new CodeDocument::Iterator (*last);
-        cachedIterators.add (t);
-        const int targetLine = last->getLine() + linesBetweenCachedSources;
+    // some code with a block comment from line 2000 to line 2100
+    static String createCode()
+    {
+        String s;
 
-        for (;;)
+        for (int i = 0; i < 3000; ++i)
         {
-            codeTokeniser->readNextToken (*t);
+            if (i == 2000)       s << "/* a comment\n";
+            else if (i == 2100)  s << "*/\n";
+            else if (i % 3 == 0) s << "int function" << i << " (int x)  { return x * " << i << "; }\n";
+            else if (i % 3 == 1) s << "    const char* s = \"a string\"; // and a comment\n";
+            else                 s << "    float f = " << i << ".0f;\n";
+        }
 
-            if (t->getLine() >= targetLine)
-                break;
+        return s;
+    }
 
-            if (t->isEOF())
-                return;
-        }
+    static Image paintEditor (CodeEditorComponent& editor)
+    {
+        Image image (Image::RGB, editor.getWidth(), editor.getHeight(), true, SoftwareImageType());
+        Graphics g (image);
+        editor.paint (g);
+        return image;
     }
-}
 
-void CodeEditorComponent::getIteratorForPosition (int position, CodeDocument::Iterator& source)
-{
-    if (codeTokeniser == nullptr)
-        return;
+    static bool imagesMatch (const Image& image1, const Image& image2)
+    {
+        const Image::BitmapData data1 (image1, Image::BitmapData::readOnly);
+        const Image::BitmapData data2 (image2, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < image1.getHeight(); ++y)
+            if (memcmp (data1.getLinePointer (y), data2.getLinePointer (y), (size_t) (image1.getWidth() * data1.pixelStride)) != 0)
+                return false;
 
-    for (int i = cachedIterators.size(); --i >= 0;)
+        return true;
+    }
+
+    // Draws some text as it should look, using an editor that's scrolled down the document a few
+    // hundred lines at a time, so that it tokenises all of it on the message thread.
+    static Image paintCorrectly (const String& text, const int firstLine)
     {
-        CodeDocument::Iterator* t = cachedIterators.getUnchecked (i);
-        if (t->getPosition() <= position)
+        CodeDocument doc;
+        CPlusPlusCodeTokeniser tokeniser;
+        CodeEditorComponent editor (doc, &tokeniser);
+        editor.setSize (400, 300);
+        editor.loadContent (text);
+
+        for (int line = 0; line < firstLine; line += 500)
         {
-            source = *t;
-            break;
+            editor.scrollToLine (line);
+            paintEditor (editor);
         }
+
+        editor.scrollToLine (firstLine);
+        return paintEditor (editor);
     }
 
-    while (source.getPosition() < position)
+    // runs the message loop until the background thread has caught up with the lines on screen
+    bool waitUntilEditorLooksLike (CodeEditorComponent& editor, const Image& expected)
     {
-        const CodeDocument::Iterator original (source);
-        codeTokeniser->readNextToken (source);
-
-        if (source.getPosition() > position || source.isEOF())
+        for (int i = 0; i < 1000; ++i)
         {
-            source = original;
-            break;
+            if (imagesMatch (paintEditor (editor), expected))
+                return true;
+
+            MessageManager::getInstance()->runDispatchLoopUntil (10);
         }
+
+        return false;
     }
-}
+
+    void runTest()
+    {
+        beginTest ("Tokenising in the background");
+
+        const String original (createCode());
+
+        CodeDocument doc;
+        CountingTokeniser tokeniser;
+        CodeEditorComponent editor (doc, &tokeniser);
+        editor.setSize (400, 300);
+        editor.loadContent (original);
+        paintEditor (editor);
+
+        // (until the thread reaches these lines, they're drawn as code rather than as a comment)
+        editor.scrollToLine (2040);
+        const Image expected (paintCorrectly (original, 2040));
+        expect (! imagesMatch (paintEditor (editor), expected));
+        expect (waitUntilEditorLooksLike (editor, expected));
+
+        beginTest ("Edits that leave the following lines unchanged");
+
+        // the lines after an edit are only read until their states match the old ones again..
+        tokeniser.numTokensRead = 0;
+        doc.insertText (CodeDocument::Position (&doc, 5, 6), "x");
+        expect (tokeniser.numTokensRead < 50);
+
+        editor.scrollToLine (2040);  // (the caret will have pulled it back to the edit)
+        expect (imagesMatch (paintEditor (editor), paintCorrectly (doc.getAllContent(), 2040)));
+
+        // ..which inside a comment is where it ends
+        tokeniser.numTokensRead = 0;
+        doc.insertText (CodeDocument::Position (&doc, 2050, 6), "x");
+        expect (tokeniser.numTokensRead < 50);
+
+        editor.scrollToLine (2040);
+        expect (imagesMatch (paintEditor (editor), paintCorrectly (doc.getAllContent(), 2040)));
+
+        doc.undo();
+        doc.undo();
+        expect (doc.getAllContent() == original);
+
+        beginTest ("Opening and closing a comment");
+
+        const CodeDocument::Position commentStart (&doc, 10, 0);
+        doc.insertText (commentStart, "/*");
+        const String commentedOut (doc.getAllContent());
+
+        editor.scrollToLine (1500);
+        expect (! imagesMatch (paintCorrectly (commentedOut, 1500), paintCorrectly (original, 1500)));
+        expect (waitUntilEditorLooksLike (editor, paintCorrectly (commentedOut, 1500)));
+
+        editor.scrollToLine (2095);
+        expect (waitUntilEditorLooksLike (editor, paintCorrectly (commentedOut, 2095)));
+
+        doc.deleteSection (commentStart, CodeDocument::Position (&doc, 10, 2));
+        expect (doc.getAllContent() == original);
+
+        editor.scrollToLine (2095);
+        expect (waitUntilEditorLooksLike (editor, paintCorrectly (original, 2095)));
+
+        editor.scrollToLine (1500);
+        expect (waitUntilEditorLooksLike (editor, paintCorrectly (original, 1500)));
+
+        editor.scrollToLine (2040);
+        expect (waitUntilEditorLooksLike (editor, paintCorrectly (original, 2040)));
+    }
+};
+
+static CodeEditorComponentTests codeEditorComponentTests;
+
+#endif
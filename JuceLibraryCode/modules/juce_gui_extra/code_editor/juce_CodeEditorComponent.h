@@ -51,6 +51,8 @@ public:
         The tokeniser object is optional - pass 0 to disable syntax highlighting.
         The object that you pass in is not owned or deleted by the editor - you must
         make sure that it doesn't get deleted while this component is still using it.
+        The parts of the document that aren't on screen are tokenised on a background
+        thread, so the tokeniser mustn't rely on being called by the message thread.
 
         @see CodeDocument
     */
@@ -287,10 +289,10 @@ private:
     OwnedArray <CodeEditorLine> lines;
     void rebuildLineTokens();
 
-    OwnedArray <CodeDocument::Iterator> cachedIterators;
-    void clearCachedIterators (int firstLineToBeInvalid);
-    void updateCachedIterators (int maxLineNum);
-    void getIteratorForPosition (int position, CodeDocument::Iterator& result);
+    class LineTokeniser;
+    friend class LineTokeniser;
+    ScopedPointer <LineTokeniser> lineTokeniser;
+
     void moveLineDelta (int delta, bool selecting);
 
     //==============================================================================
@@ -47,6 +47,11 @@ public:
 
         This must leave the source pointing to the first character in the
         next token.
+
+        The result must only depend on the text that follows the source's position,
+        because a CodeEditorComponent will restart the tokeniser from the beginning
+        of any token. It may also call this method from a background thread, although
+        never at the same time as another call from the same editor.
     */
     virtual int readNextToken (CodeDocument::Iterator& source) = 0;
 
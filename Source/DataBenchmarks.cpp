@@ -0,0 +1,2344 @@
+/*
+  ==============================================================================
+
+    DataBenchmarks.cpp
+
+    Command-line benchmarks for the library's data-handling classes.
+
+  ==============================================================================
+*/
+
+#include "DataBenchmarks.h"
+
+#if JUCE_WINDOWS
+ #define NOMINMAX 1
+ #define NOGDI 1
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment (lib, "psapi.lib")
+#endif
+
+
+//==============================================================================
+namespace
+{
+    var createObject()
+    {
+        return var (new DynamicObject());
+    }
+
+    void setProperty (const var& object, const Identifier& name, const var& value)
+    {
+        object.getDynamicObject()->setProperty (name, value);
+    }
+
+    //==============================================================================
+    /* Peak memory use is measured separately for each test where the OS allows the
+       high-water mark to be reset (i.e. on Linux) - elsewhere it's the peak for the
+       process so far, so only the first test's figure is meaningful.
+    */
+    void resetPeakMemory()
+    {
+       #if JUCE_LINUX
+        // (the proc files have to be written and read directly, as they don't have a size)
+        if (FILE* const f = fopen ("/proc/self/clear_refs", "w"))
+        {
+            fputs ("5", f);
+            fclose (f);
+        }
+       #endif
+    }
+
+    int64 getPeakMemoryKB()
+    {
+       #if JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters = { 0 };
+        counters.cb = sizeof (counters);
+
+        if (GetProcessMemoryInfo (GetCurrentProcess(), &counters, sizeof (counters)))
+            return (int64) counters.PeakWorkingSetSize / 1024;
+
+        return -1;
+       #elif JUCE_LINUX
+        int64 peakKB = -1;
+
+        if (FILE* const f = fopen ("/proc/self/status", "r"))
+        {
+            char line [256];
+
+            while (fgets (line, sizeof (line), f) != nullptr)
+                if (strncmp (line, "VmHWM:", 6) == 0)
+                    peakKB = String (line + 6).trim().getLargeIntValue();
+
+            fclose (f);
+        }
+
+        return peakKB;
+       #else
+        return -1;
+       #endif
+    }
+
+    /* Times a test and records its throughput and peak memory use. */
+    class TestRun
+    {
+    public:
+        TestRun (const var& results_, const String& name_, const int64 numBytes_)
+            : results (results_), name (name_), numBytes (numBytes_)
+        {
+            resetPeakMemory();
+            startTime = Time::getMillisecondCounterHiRes();
+        }
+
+        ~TestRun()
+        {
+            const double ms = Time::getMillisecondCounterHiRes() - startTime;
+
+            var result (createObject());
+            setProperty (result, "timeMs", ms);
+            setProperty (result, "MBPerSecond", (numBytes / (1024.0 * 1024.0)) / (jmax (1.0, ms) / 1000.0));
+            setProperty (result, "peakMemoryKB", getPeakMemoryKB());
+
+            if (! extraInfo.isVoid())
+                setProperty (result, "info", extraInfo);
+
+            setProperty (results, name, result);
+        }
+
+        var extraInfo;
+
+    private:
+        var results;
+        const String name;
+        const int64 numBytes;
+        double startTime;
+
+        JUCE_DECLARE_NON_COPYABLE (TestRun);
+    };
+
+    //==============================================================================
+    void writeXmlTestDocument (const File& file, const int64 sizeInBytes)
+    {
+        file.deleteFile();
+        FileOutputStream out (file, 1 << 20);
+
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<!-- generated for the XML parsing benchmark -->\n"
+               "<CATALOGUE version=\"3\">\n";
+
+        for (int group = 0; out.getPosition() < sizeInBytes; ++group)
+        {
+            out << "  <GROUP name=\"group " << group << "\" visible=\"1\">\n";
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const int id = group * 100 + i;
+
+                out << "    <ITEM id=\"" << id << "\" name=\"item &quot;" << id << "&quot;\" price=\""
+                    << (id % 1000) / 10.0 << "\" colour=\"ff" << String::toHexString (id & 0xffffff) << "\">"
+                    << "Description of item " << id << ", which costs &lt; " << (id % 97) << " &amp; weighs &#x3bb;"
+                    << "<NOTE/><![CDATA[raw <data> " << id << "]]></ITEM>\n";
+            }
+
+            out << "  </GROUP>\n";
+        }
+
+        out << "</CATALOGUE>\n";
+    }
+
+    int64 countEvents (XmlPullParser& parser, const bool decodeValues)
+    {
+        int64 numEvents = 0;
+
+        for (;;)
+        {
+            const XmlPullParser::EventType e = parser.next();
+
+            if (e == XmlPullParser::endOfDocument || e == XmlPullParser::parseError)
+                break;
+
+            if (decodeValues && (e == XmlPullParser::attribute || e == XmlPullParser::text))
+                parser.getDecodedValue();
+
+            ++numEvents;
+        }
+
+        jassert (parser.getEventType() == XmlPullParser::endOfDocument);
+        return numEvents;
+    }
+
+    int countElements (const XmlElement* const e)
+    {
+        int num = 1;
+
+        forEachXmlChildElement (*e, child)
+            num += countElements (child);
+
+        return num;
+    }
+
+    //==============================================================================
+    var createJsonTestItem (const int id)
+    {
+        var item (createObject());
+        setProperty (item, "id", id);
+        setProperty (item, "name", "item \"" + String (id) + "\"");
+        setProperty (item, "price", (id % 1000) / 10.0);
+        setProperty (item, "serial", id * (int64) 1000003);
+        setProperty (item, "visible", (id & 1) != 0);
+        setProperty (item, "description", "Description of item " + String (id) + ", which weighs "
+                                            + String (CharPointer_UTF8 ("\xce\xbb")) + "\n\tand is in stock");
+
+        var tags;
+        for (int i = 0; i < 4; ++i)
+            tags.append ("tag" + String ((id + i) % 50));
+
+        setProperty (item, "tags", tags);
+        setProperty (item, "parent", var::null);
+        return item;
+    }
+
+    var createJsonTestData (const int numItems)
+    {
+        var groups;
+
+        for (int group = 0; group * 100 < numItems; ++group)
+        {
+            var items;
+
+            for (int i = group * 100; i < jmin (numItems, (group + 1) * 100); ++i)
+                items.append (createJsonTestItem (i));
+
+            var g (createObject());
+            setProperty (g, "name", "group " + String (group));
+            setProperty (g, "items", items);
+            groups.append (g);
+        }
+
+        var root (createObject());
+        setProperty (root, "version", 3);
+        setProperty (root, "groups", groups);
+        return root;
+    }
+
+    int countVars (const var& v)
+    {
+        int num = 1;
+
+        if (const Array<var>* const array = v.getArray())
+        {
+            for (int i = 0; i < array->size(); ++i)
+                num += countVars (array->getReference (i));
+        }
+        else if (DynamicObject* const object = v.getDynamicObject())
+        {
+            const NamedValueSet& props = object->getProperties();
+
+            for (int i = 0; i < props.size(); ++i)
+                num += countVars (props.getValueAt (i));
+        }
+
+        return num;
+    }
+}
+
+//==============================================================================
+var DataBenchmarks::runXmlBenchmark (const int sizeInMB)
+{
+    const TemporaryFile temp (".xml");
+    const File& file = temp.getFile();
+    writeXmlTestDocument (file, sizeInMB * (int64) 1024 * 1024);
+
+    const int64 numBytes = file.getSize();
+    var results (createObject());
+    setProperty (results, "documentBytes", numBytes);
+
+    {
+        TestRun t (results, "pullParserMappedFile", numBytes);
+        MemoryMappedFile mapped (file, MemoryMappedFile::readOnly);
+        XmlPullParser parser (mapped);
+        t.extraInfo = countEvents (parser, false);
+    }
+
+    {
+        TestRun t (results, "pullParserMappedFileDecoded", numBytes);
+        MemoryMappedFile mapped (file, MemoryMappedFile::readOnly);
+        XmlPullParser parser (mapped);
+        t.extraInfo = countEvents (parser, true);
+    }
+
+    {
+        TestRun t (results, "pullParserFileStream", numBytes);
+        XmlPullParser parser (file.createInputStream(), true);
+        t.extraInfo = countEvents (parser, false);
+    }
+
+    {
+        TestRun t (results, "xmlDocumentFromFile", numBytes);
+        ScopedPointer<XmlElement> xml (XmlDocument::parse (file));
+        t.extraInfo = xml != nullptr ? countElements (xml) : 0;
+    }
+
+    {
+        TestRun t (results, "xmlDocumentFromString", numBytes);
+        ScopedPointer<XmlElement> xml (XmlDocument::parse (file.loadFileAsString()));
+        t.extraInfo = xml != nullptr ? countElements (xml) : 0;
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Times a loop of operations on a set of properties, and records the time per operation. */
+    class PropertyTest
+    {
+    public:
+        PropertyTest (const var& results_, const String& name_, const int64 numOperations_)
+            : results (results_), name (name_), numOperations (numOperations_),
+              startTime (Time::getMillisecondCounterHiRes())
+        {
+        }
+
+        ~PropertyTest()
+        {
+            const double ms = Time::getMillisecondCounterHiRes() - startTime;
+            setProperty (results, name, (ms * 1000000.0) / (double) numOperations);
+        }
+
+    private:
+        var results;
+        const String name;
+        const int64 numOperations;
+        const double startTime;
+
+        JUCE_DECLARE_NON_COPYABLE (PropertyTest);
+    };
+
+    var runPropertyTests (const int numProperties, const int64 numOperations)
+    {
+        Array<Identifier> names;
+
+        for (int i = 0; i < numProperties; ++i)
+            names.add (Identifier ("property" + String (i)));
+
+        NamedValueSet set;
+        ValueTree tree ("TREE");
+
+        for (int i = 0; i < numProperties; ++i)
+        {
+            set.set (names.getReference (i), i);
+            tree.setProperty (names.getReference (i), i, nullptr);
+        }
+
+        const int numPasses = (int) jmax ((int64) 1, numOperations / numProperties);
+        const int64 numOps = numPasses * (int64) numProperties;
+        var results (createObject());
+        int64 total = 0;
+
+        {
+            PropertyTest t (results, "getNsPerOp", numOps);
+
+            for (int pass = 0; pass < numPasses; ++pass)
+                for (int i = 0; i < numProperties; ++i)
+                    total += static_cast <int> (set [names.getReference (i)]);
+        }
+
+        {
+            PropertyTest t (results, "setNsPerOp", numOps);
+
+            for (int pass = 0; pass < numPasses; ++pass)
+                for (int i = 0; i < numProperties; ++i)
+                    set.set (names.getReference (i), pass + i);
+        }
+
+        {
+            PropertyTest t (results, "iterateNsPerOp", numOps);
+
+            for (int pass = 0; pass < numPasses; ++pass)
+                for (int i = 0; i < set.size(); ++i)
+                    if (set.getName (i).getCharPointer().getAddress() != nullptr)
+                        total += static_cast <int> (set.getValueAt (i));
+        }
+
+        {
+            PropertyTest t (results, "valueTreeGetNsPerOp", numOps);
+
+            for (int pass = 0; pass < numPasses; ++pass)
+                for (int i = 0; i < numProperties; ++i)
+                    total += static_cast <int> (tree.getProperty (names.getReference (i)));
+        }
+
+        {
+            PropertyTest t (results, "addAndClearNsPerOp", numOps);
+
+            for (int pass = 0; pass < numPasses; ++pass)
+            {
+                NamedValueSet newSet;
+
+                for (int i = 0; i < numProperties; ++i)
+                    newSet.set (names.getReference (i), i);
+            }
+        }
+
+        // (this stops the compiler optimising the loops away)
+        setProperty (results, "checksum", total);
+        return results;
+    }
+}
+
+var DataBenchmarks::runPropertiesBenchmark (const int numMillionOperations)
+{
+    var results (createObject());
+    const int sizes[] = { 4, 16, 64, 200 };
+
+    for (int i = 0; i < numElementsInArray (sizes); ++i)
+        setProperty (results, "properties" + String (sizes[i]),
+                     runPropertyTests (sizes[i], numMillionOperations * (int64) 1000000));
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    ValueTree createTestValueTree (const int64 sizeInBytes)
+    {
+        ValueTree root ("PROJECT");
+        root.setProperty ("version", 3, nullptr);
+
+        // (each item takes about 300 bytes in the original binary format)
+        const int numItems = (int) jmax ((int64) 1, sizeInBytes / 300);
+
+        for (int group = 0; group * 100 < numItems; ++group)
+        {
+            ValueTree g ("GROUP");
+            g.setProperty ("name", "group " + String (group), nullptr);
+
+            for (int i = group * 100; i < jmin (numItems, (group + 1) * 100); ++i)
+            {
+                ValueTree item ("ITEM");
+                item.setProperty ("id", i, nullptr);
+                item.setProperty ("name", "item " + String (i), nullptr);
+                item.setProperty ("price", (i % 1000) / 10.0, nullptr);
+                item.setProperty ("serial", i * (int64) 1000003, nullptr);
+                item.setProperty ("visible", (i & 1) != 0, nullptr);
+                item.setProperty ("colour", "ff" + String::toHexString (i & 0xffffff), nullptr);
+                item.setProperty ("description", "Description of item " + String (i) + ", which is in stock", nullptr);
+                item.setProperty ("width", 100 + i % 50, nullptr);
+                item.setProperty ("height", 20 + i % 10, nullptr);
+
+                ValueTree note ("NOTE");
+                note.setProperty ("text", "note " + String (i), nullptr);
+                item.addChild (note, -1, nullptr);
+
+                g.addChild (item, -1, nullptr);
+            }
+
+            root.addChild (g, -1, nullptr);
+        }
+
+        return root;
+    }
+
+    /* Reads every property of every node, and returns the number of nodes. */
+    int visitAllNodes (const ValueTree& tree)
+    {
+        int num = 1;
+
+        for (int i = 0; i < tree.getNumProperties(); ++i)
+            tree.getProperty (tree.getPropertyName (i));
+
+        for (int i = 0; i < tree.getNumChildren(); ++i)
+            num += visitAllNodes (tree.getChild (i));
+
+        return num;
+    }
+
+    /* Fetches a property from a node somewhere in the middle of the tree. */
+    var getNodeInMiddle (const ValueTree& root)
+    {
+        return root.getChild (root.getNumChildren() / 2).getChild (50).getChild (0).getProperty ("text");
+    }
+}
+
+var DataBenchmarks::runValueTreeBenchmark (const int sizeInMB)
+{
+    const ValueTree tree (createTestValueTree (sizeInMB * (int64) 1024 * 1024));
+    var results (createObject());
+
+    const TemporaryFile originalTemp (".bin"), compactTemp (".bin");
+    const File& originalFile = originalTemp.getFile();
+    const File& compactFile = compactTemp.getFile();
+
+    {
+        TestRun t (results, "writeToStream", 0);
+        FileOutputStream out (originalFile, 1 << 20);
+        ValueTree (tree).writeToStream (out);
+    }
+
+    {
+        TestRun t (results, "writeToCompactStream", 0);
+        FileOutputStream out (compactFile, 1 << 20);
+        tree.writeToCompactStream (out);
+    }
+
+    const int64 originalBytes = originalFile.getSize();
+    const int64 compactBytes = compactFile.getSize();
+    setProperty (results, "originalBytes", originalBytes);
+    setProperty (results, "compactBytes", compactBytes);
+
+    {
+        TestRun t (results, "readFromStream", originalBytes);
+        FileInputStream in (originalFile);
+        BufferedInputStream buffered (&in, 1 << 20, false);
+        const ValueTree loaded (ValueTree::readFromStream (buffered));
+        t.extraInfo = getNodeInMiddle (loaded);
+    }
+
+    {
+        TestRun t (results, "readFromCompactFileAndGetOneNode", compactBytes);
+        const ValueTree loaded (ValueTree::readFromCompactFile (compactFile));
+        t.extraInfo = getNodeInMiddle (loaded);
+    }
+
+    {
+        TestRun t (results, "readFromCompactFileAndVisitAll", compactBytes);
+        const ValueTree loaded (ValueTree::readFromCompactFile (compactFile));
+        t.extraInfo = visitAllNodes (loaded);
+    }
+
+    {
+        TestRun t (results, "readFromStreamAndVisitAll", originalBytes);
+        FileInputStream in (originalFile);
+        BufferedInputStream buffered (&in, 1 << 20, false);
+        const ValueTree loaded (ValueTree::readFromStream (buffered));
+        t.extraInfo = visitAllNodes (loaded);
+    }
+
+    return results;
+}
+
+//==============================================================================
+var DataBenchmarks::runPropertiesFileBenchmark (const int numThousandValues)
+{
+    const int numValues = numThousandValues * 1000;
+    var results (createObject());
+    setProperty (results, "numValues", numValues);
+
+    const TemporaryFile temp (".settings");
+    const File& file = temp.getFile();
+
+    const char* const formatNames[] = { "binary", "compressedBinary", "xml", "journal" };
+    const PropertiesFile::StorageFormat formats[] = { PropertiesFile::storeAsBinary,
+                                                      PropertiesFile::storeAsCompressedBinary,
+                                                      PropertiesFile::storeAsXML,
+                                                      PropertiesFile::storeAsJournal };
+
+    for (int i = 0; i < numElementsInArray (formats); ++i)
+    {
+        PropertiesFile::Options options;
+        options.millisecondsBeforeSaving = -1;
+        options.storageFormat = formats[i];
+
+        file.deleteFile();
+        var formatResults (createObject());
+
+        {
+            PropertiesFile props (file, options);
+
+            for (int j = 0; j < numValues; ++j)
+                props.setValue ("setting" + String (j), "value of setting " + String (j) + " " + String::toHexString (j * 7919));
+
+            {
+                TestRun t (formatResults, "saveAll", 0);
+                props.save();
+            }
+
+            setProperty (formatResults, "fileBytes", file.getSize());
+
+            {
+                props.setValue ("setting5", "changed");
+                TestRun t (formatResults, "saveOneChange", 0);
+                props.save();
+            }
+
+            // (the file is written on another thread, but on a single-core machine this
+            // will still include some of that thread's time)
+            {
+                props.setValue ("setting6", "changed");
+                TestRun t (formatResults, "saveOneChangeInBackground", 0);
+                props.saveInBackground();
+            }
+
+            {
+                TestRun t (formatResults, "waitForBackgroundSave", 0);
+                props.waitForBackgroundSave();
+            }
+        }
+
+        {
+            TestRun t (formatResults, "load", file.getSize());
+            PropertiesFile loaded (file, options);
+            t.extraInfo = loaded.getValue ("setting6");
+        }
+
+        setProperty (results, formatNames[i], formatResults);
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    String getZipTestEntryName (const int index)
+    {
+        return "assets/folder" + String (index / 100) + "/item" + String (index) + ".dat";
+    }
+
+    /* Writes a zip file with the given number of entries, alternately stored and compressed,
+       which are copies of a few source files of a few KB.
+    */
+    void writeZipTestFile (const File& zipFile, const File& tempFolder, const int numEntries, ThreadPool* const pool)
+    {
+        Array<File> sources;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const File f (tempFolder.getChildFile ("source" + String (i)));
+            String content;
+
+            for (int j = 0; j < 20 * (i + 1); ++j)
+                content << "Line " << j << " of source file " << i << ", " << String::toHexString (j * 7919 + i) << newLine;
+
+            f.replaceWithText (content);
+            sources.add (f);
+        }
+
+        ZipFile::Builder builder;
+
+        for (int i = 0; i < numEntries; ++i)
+            builder.addFile (sources [i % sources.size()], (i & 1) * 6, getZipTestEntryName (i));
+
+        zipFile.deleteFile();
+        FileOutputStream out (zipFile, 1 << 20);
+        builder.writeToStream (out, nullptr, pool);
+    }
+
+    /* Reads every entry in a zip file, using several threads. */
+    class ZipReader  : public ThreadPool::ParallelForBody
+    {
+    public:
+        ZipReader (ZipFile& zip_) : zip (zip_) {}
+
+        void processRange (const int startIndex, const int endIndex)
+        {
+            HeapBlock<char> buffer (32768);
+
+            for (int i = startIndex; i < endIndex; ++i)
+            {
+                const ScopedPointer<InputStream> in (zip.createStreamForEntry (i));
+
+                if (in != nullptr)
+                {
+                    int64 total = 0;
+
+                    for (;;)
+                    {
+                        const int num = in->read (buffer, 32768);
+
+                        if (num <= 0)
+                            break;
+
+                        total += num;
+                    }
+
+                    numBytes += total;
+                }
+            }
+        }
+
+        ZipFile& zip;
+        Atomic<int64> numBytes;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ZipReader);
+    };
+
+    int64 readAllZipEntries (ZipFile& zip, ThreadPool& pool)
+    {
+        ZipReader reader (zip);
+        pool.parallelFor (0, zip.getNumEntries(), 16, reader);
+        return reader.numBytes.get();
+    }
+}
+
+var DataBenchmarks::runZipBenchmark (const int numThousandEntries)
+{
+    const int numEntries = jmin (65535, numThousandEntries * 1000);
+    var results (createObject());
+    setProperty (results, "numEntries", numEntries);
+
+    const File tempFolder (File::createTempFile ("zipbenchmark"));
+    tempFolder.createDirectory();
+    const File zipFile (tempFolder.getChildFile ("test.zip"));
+
+    {
+        ThreadPool pool (1);
+        TestRun t (results, "buildOneThread", 0);
+        writeZipTestFile (zipFile, tempFolder, numEntries, &pool);
+    }
+
+    {
+        TestRun t (results, "build", 0);
+        writeZipTestFile (zipFile, tempFolder, numEntries, nullptr);
+    }
+
+    const int64 zipBytes = zipFile.getSize();
+    setProperty (results, "zipBytes", zipBytes);
+
+    {
+        ScopedPointer<ZipFile> zip;
+
+        {
+            TestRun t (results, "open", zipBytes);
+            zip = new ZipFile (zipFile);
+        }
+
+        {
+            TestRun t (results, "lookUpAllNames", 0);
+            int numFound = 0;
+
+            for (int i = 0; i < numEntries; ++i)
+                if (zip->getIndexOfFileName (getZipTestEntryName (i)) >= 0)
+                    ++numFound;
+
+            t.extraInfo = numFound;
+        }
+
+        const int numThreads = SystemStats::getNumCpus();
+        setProperty (results, "numThreads", numThreads);
+
+        {
+            ThreadPool pool (1);
+            TestRun t (results, "readAllOneThread", zipBytes);
+            t.extraInfo = readAllZipEntries (*zip, pool);
+        }
+
+        {
+            ThreadPool pool (numThreads);
+            TestRun t (results, "readAllParallel", zipBytes);
+            t.extraInfo = readAllZipEntries (*zip, pool);
+        }
+    }
+
+    {
+        // (for comparison, this shares a single stream between all the threads)
+        FileInputStream in (zipFile);
+        ZipFile zip (in);
+        ThreadPool pool (SystemStats::getNumCpus());
+        TestRun t (results, "readAllParallelFromSharedStream", zipBytes);
+        t.extraInfo = readAllZipEntries (zip, pool);
+    }
+
+    tempFolder.deleteRecursively();
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Compresses some data, either as a single stream or as a series of blocks. */
+    void compressGzipTestData (const MemoryBlock& source, MemoryOutputStream& dest,
+                               const int blockSize, ThreadPool* const pool,
+                               Array<GZIPDecompressorInputStream::SeekPoint>* const seekPoints)
+    {
+        dest.reset();
+        GZIPCompressorOutputStream gzip (&dest, 6, false);
+
+        if (blockSize > 0)
+            gzip.setBlockSize (blockSize, pool);
+
+        gzip.write (source.getData(), (int) source.getSize());
+        gzip.flush();
+
+        if (seekPoints != nullptr)
+            *seekPoints = gzip.getSeekPoints();
+    }
+
+    /* Reads all the data from a GZIPDecompressorInputStream, returning the number of bytes. */
+    int64 decompressGzipTestData (const MemoryOutputStream& compressed,
+                                  const Array<GZIPDecompressorInputStream::SeekPoint>* const seekPoints,
+                                  ThreadPool* const pool)
+    {
+        MemoryInputStream in (compressed.getData(), compressed.getDataSize(), false);
+        GZIPDecompressorInputStream gzip (in);
+
+        if (seekPoints != nullptr)
+            gzip.setSeekPoints (*seekPoints, pool);
+
+        HeapBlock<char> buffer (65536);
+        int64 total = 0;
+
+        for (;;)
+        {
+            const int num = gzip.read (buffer, 65536);
+
+            if (num <= 0)
+                break;
+
+            total += num;
+        }
+
+        return total;
+    }
+
+    /* Reads some small chunks from random positions in a compressed stream. */
+    int64 readGzipAtRandomPositions (const MemoryOutputStream& compressed, const int64 uncompressedSize,
+                                     const Array<GZIPDecompressorInputStream::SeekPoint>* const seekPoints,
+                                     const int numReads)
+    {
+        MemoryInputStream in (compressed.getData(), compressed.getDataSize(), false);
+        GZIPDecompressorInputStream gzip (in);
+
+        if (seekPoints != nullptr)
+            gzip.setSeekPoints (*seekPoints);
+
+        Random rng (1);
+        char buffer [4096];
+        int64 total = 0;
+
+        for (int i = 0; i < numReads; ++i)
+        {
+            gzip.setPosition ((int64) (rng.nextDouble() * (uncompressedSize - sizeof (buffer))));
+            total += gzip.read (buffer, sizeof (buffer));
+        }
+
+        return total;
+    }
+}
+
+var DataBenchmarks::runGzipBenchmark (const int sizeInMB)
+{
+    MemoryBlock source;
+
+    {
+        MemoryOutputStream out (source, false);
+        Random rng (1);
+
+        for (int i = 0; out.getPosition() < sizeInMB * (int64) 1024 * 1024; ++i)
+            out << "<ITEM id=\"" << i << "\" value=\"" << rng.nextInt (100000) << "\" name=\"item " << (i % 1000) << "\"/>\n";
+    }
+
+    const int64 numBytes = (int64) source.getSize();
+    const int blockSize = 1024 * 1024;
+    const int numThreads = SystemStats::getNumCpus();
+
+    var results (createObject());
+    setProperty (results, "uncompressedBytes", numBytes);
+    setProperty (results, "blockSize", blockSize);
+    setProperty (results, "numThreads", numThreads);
+
+    MemoryOutputStream singleStream, blocks;
+    Array<GZIPDecompressorInputStream::SeekPoint> seekPoints;
+
+    {
+        TestRun t (results, "compress", numBytes);
+        compressGzipTestData (source, singleStream, 0, nullptr, nullptr);
+        t.extraInfo = (int64) singleStream.getDataSize();
+    }
+
+    {
+        TestRun t (results, "compressBlocksOneThread", numBytes);
+        compressGzipTestData (source, blocks, blockSize, nullptr, nullptr);
+    }
+
+    {
+        ThreadPool pool (numThreads);
+        TestRun t (results, "compressBlocksParallel", numBytes);
+        compressGzipTestData (source, blocks, blockSize, &pool, &seekPoints);
+        t.extraInfo = (int64) blocks.getDataSize();
+    }
+
+    {
+        TestRun t (results, "decompress", numBytes);
+        t.extraInfo = decompressGzipTestData (singleStream, nullptr, nullptr);
+    }
+
+    {
+        TestRun t (results, "decompressBlocksOneThread", numBytes);
+        t.extraInfo = decompressGzipTestData (blocks, nullptr, nullptr);
+    }
+
+    {
+        ThreadPool pool (numThreads);
+        TestRun t (results, "decompressBlocksParallel", numBytes);
+        t.extraInfo = decompressGzipTestData (blocks, &seekPoints, &pool);
+    }
+
+    const int numRandomReads = 20;
+
+    {
+        TestRun t (results, "randomReadsWithoutSeekPoints", 0);
+        t.extraInfo = readGzipAtRandomPositions (singleStream, numBytes, nullptr, numRandomReads);
+    }
+
+    {
+        TestRun t (results, "randomReadsWithSeekPoints", 0);
+        t.extraInfo = readGzipAtRandomPositions (blocks, numBytes, &seekPoints, numRandomReads);
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Logs a number of messages as fast as it can. */
+    class LoggerBenchmarkThread  : public Thread
+    {
+    public:
+        LoggerBenchmarkThread (FileLogger& logger_, const int index_, const int numMessages_)
+            : Thread ("logger benchmark"), logger (logger_), index (index_), numMessages (numMessages_)
+        {
+        }
+
+        void run()
+        {
+            for (int i = 0; i < numMessages; ++i)
+                logger.logMessage ("thread " + String (index) + ": message number " + String (i)
+                                     + ", with some text to make it a typical length");
+        }
+
+    private:
+        FileLogger& logger;
+        const int index, numMessages;
+
+        JUCE_DECLARE_NON_COPYABLE (LoggerBenchmarkThread);
+    };
+
+    void logFromThreads (FileLogger& logger, const int numThreads, const int numMessagesPerThread)
+    {
+        OwnedArray<LoggerBenchmarkThread> threads;
+
+        for (int i = 0; i < numThreads; ++i)
+            threads.add (new LoggerBenchmarkThread (logger, i, numMessagesPerThread));
+
+        for (int i = 0; i < numThreads; ++i)
+            threads.getUnchecked (i)->startThread();
+
+        for (int i = 0; i < numThreads; ++i)
+            threads.getUnchecked (i)->waitForThreadToExit (-1);
+    }
+}
+
+var DataBenchmarks::runLoggerBenchmark (const int numThousandMessagesPerThread)
+{
+    const int numThreads = 16;
+    const int numMessagesPerThread = numThousandMessagesPerThread * 1000;
+    const double totalMessages = numThreads * (double) numMessagesPerThread;
+
+    var results (createObject());
+    setProperty (results, "numThreads", numThreads);
+    setProperty (results, "numMessages", totalMessages);
+
+    const TemporaryFile temp (".txt");
+    const File& file = temp.getFile();
+
+    for (int async = 0; async < 2; ++async)
+    {
+        file.deleteFile();
+        FileLogger logger (file, "benchmark", -1);
+
+        if (async != 0)
+            logger.startWritingOnBackgroundThread();
+
+        const double startTime = Time::getMillisecondCounterHiRes();
+
+        {
+            TestRun t (results, async != 0 ? "logAsync" : "logSync", 0);
+            logFromThreads (logger, numThreads, numMessagesPerThread);
+        }
+
+        {
+            TestRun t (results, async != 0 ? "logAsyncAndFlush" : "logSyncAndFlush", 0);
+            logger.flush (-1);
+        }
+
+        const double seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        setProperty (results, async != 0 ? "asyncMessagesPerSecond" : "syncMessagesPerSecond",
+                     totalMessages / jmax (0.001, seconds));
+    }
+
+    {
+        // (this checks how much the file grows past its limit while it's being rotated)
+        file.deleteFile();
+        FileLogger logger (file, "benchmark", -1);
+        logger.startWritingOnBackgroundThread (1024 * 1024, 2);
+
+        TestRun t (results, "logAsyncWithRotation", 0);
+        logFromThreads (logger, numThreads, numMessagesPerThread);
+        logger.flush (-1);
+        t.extraInfo = file.getSize();
+    }
+
+    for (int i = 1; i <= 2; ++i)
+        file.getSiblingFile (file.getFileNameWithoutExtension() + "." + String (i) + file.getFileExtension()).deleteFile();
+
+    return results;
+}
+
+//==============================================================================
+var DataBenchmarks::runBigIntegerBenchmark (const int numOperations)
+{
+    var results (createObject());
+    setProperty (results, "numOperations", numOperations);
+    Random rng (1);
+
+    for (int numBits = 512; numBits <= 4096; numBits *= 2)
+    {
+        BigInteger a, b, modulus, exponent;
+        rng.fillBitsRandomly (a, 0, numBits);
+        rng.fillBitsRandomly (b, 0, numBits);
+        rng.fillBitsRandomly (modulus, 0, numBits);
+        rng.fillBitsRandomly (exponent, 0, numBits);
+        modulus.setBit (numBits - 1);
+        modulus.setBit (0);
+
+        const BigInteger product (a * b);
+        var sizeResults (createObject());
+
+        {
+            TestRun t (sizeResults, "multiply", 0);
+
+            for (int i = 0; i < numOperations; ++i)
+                t.extraInfo = (a * b).getHighestBit();
+        }
+
+        {
+            TestRun t (sizeResults, "divide", 0);
+
+            for (int i = 0; i < numOperations; ++i)
+                t.extraInfo = (product / modulus).getHighestBit();
+        }
+
+        {
+            // (as this is so much slower, it's only done a tenth as many times)
+            TestRun t (sizeResults, "exponentModulo", 0);
+
+            for (int i = 0; i < jmax (1, numOperations / 10); ++i)
+            {
+                BigInteger n (a);
+                n.exponentModulo (exponent, modulus);
+                t.extraInfo = n.getHighestBit();
+            }
+        }
+
+        setProperty (results, "bits" + String (numBits), sizeResults);
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    const int numLayoutColumns = 10;
+
+    // Lays out a grid of children, each positioned relative to the parent and to its neighbours
+    RelativeRectangle createLayoutRectangle (const int index)
+    {
+        const int column = index % numLayoutColumns;
+        const String left (column == 0 ? String ("4") : "c" + String (index - 1) + ".right + 4");
+        const String top (index < numLayoutColumns ? String ("4") : "c" + String (index - numLayoutColumns) + ".bottom + 4");
+
+        return RelativeRectangle (left + ", " + top
+                                   + ", " + left + " + (parent.width - 44) / " + String (numLayoutColumns)
+                                   + ", " + top + " + max (20, parent.height / 12)");
+    }
+}
+
+var DataBenchmarks::runLayoutBenchmark (const int numResizes)
+{
+    const int numChildren = 100;
+
+    Component parent;
+    parent.setSize (1000, 800);
+    OwnedArray<Component> children;
+    Array<RelativeRectangle> rectangles;
+
+    for (int i = 0; i < numChildren; ++i)
+    {
+        Component* const c = new Component();
+        children.add (c);
+        parent.addChildAndSetID (c, "c" + String (i));
+        rectangles.add (createLayoutRectangle (i));
+    }
+
+    var results (createObject());
+    setProperty (results, "numChildren", numChildren);
+    setProperty (results, "numResizes", numResizes);
+
+    {
+        TestRun t (results, "applyToComponents", 0);
+
+        for (int i = 0; i < numChildren; ++i)
+            rectangles.getReference (i).applyToComponent (*children.getUnchecked (i));
+
+        t.extraInfo = children.getLast()->getBottom();
+    }
+
+    {
+        TestRun t (results, "resizeParent", 0);
+
+        for (int i = 0; i < numResizes; ++i)
+            parent.setSize (600 + (i * 7) % 800, 400 + (i * 13) % 600);
+
+        t.extraInfo = children.getLast()->getBottom();
+    }
+
+    // (these evaluate each child's coordinates without moving anything, to compare the
+    // compiled programs with evaluating the expressions directly)
+    {
+        TestRun t (results, "evaluateExpressions", 0);
+        double total = 0;
+
+        for (int i = 0; i < numResizes; ++i)
+        {
+            for (int j = 0; j < numChildren; ++j)
+            {
+                const RelativeCoordinatePositionerBase::ComponentScope scope (*children.getUnchecked (j));
+                const RelativeRectangle& r = rectangles.getReference (j);
+
+                total += r.left.resolve (&scope) + r.top.resolve (&scope)
+                          + r.right.resolve (&scope) + r.bottom.resolve (&scope);
+            }
+        }
+
+        t.extraInfo = total;
+    }
+
+    {
+        OwnedArray<Expression::Program> programs;
+
+        for (int j = 0; j < numChildren; ++j)
+        {
+            const RelativeCoordinatePositionerBase::ComponentScope scope (*children.getUnchecked (j));
+            const RelativeRectangle& r = rectangles.getReference (j);
+            const RelativeCoordinate* const coords[] = { &r.left, &r.top, &r.right, &r.bottom };
+
+            for (int k = 0; k < numElementsInArray (coords); ++k)
+            {
+                Expression::Program* const p = new Expression::Program();
+                programs.add (p);
+                p->compile (coords[k]->getExpression(), scope);
+            }
+        }
+
+        TestRun t (results, "evaluateCompiledPrograms", 0);
+        double total = 0;
+
+        for (int i = 0; i < numResizes; ++i)
+            for (int j = 0; j < programs.size(); ++j)
+                total += programs.getUnchecked (j)->evaluate();
+
+        t.extraInfo = total;
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    String createCodeDocumentText (const int numLines)
+    {
+        MemoryOutputStream mo;
+        Random rng (1);
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            const int indent = rng.nextInt (4) * 4;
+
+            for (int j = 0; j < indent; ++j)
+                mo << ' ';
+
+            mo << "int value" << i << " = someFunction (" << rng.nextInt (1000) << ", \"text\"); // comment\r\n";
+        }
+
+        return mo.toString();
+    }
+
+    // Types or deletes characters at a caret, updating the things that a CodeEditorComponent would
+    void typeIntoCodeDocument (CodeDocument& doc, CodeDocument::Position& caret, const int numKeystrokes, const bool deleting)
+    {
+        for (int i = 0; i < numKeystrokes; ++i)
+        {
+            doc.newTransaction();
+
+            if (deleting)
+                doc.deleteSection (caret.movedBy (-1), caret);
+            else
+                doc.insertText (caret, (i % 40) == 39 ? doc.getNewLineCharacters() : String ("x"));
+
+            doc.getMaximumLineLength();
+            doc.getNumLines();
+            caret.getLineNumber();
+        }
+    }
+}
+
+var DataBenchmarks::runCodeDocumentBenchmark (const int numThousandLines)
+{
+    const String text (createCodeDocumentText (numThousandLines * 1000));
+    const int numKeystrokes = 2000;
+
+    var results (createObject());
+    setProperty (results, "numLines", numThousandLines * 1000);
+    setProperty (results, "numKeystrokes", numKeystrokes);
+
+    CodeDocument doc;
+
+    {
+        TestRun t (results, "load", text.getNumBytesAsUTF8());
+        MemoryInputStream in (text.toUTF8(), text.getNumBytesAsUTF8(), false);
+        doc.loadFromStream (in);
+        t.extraInfo = doc.getNumLines();
+    }
+
+    CodeDocument::Position caret (&doc, 10, 4);
+    caret.setPositionMaintained (true);
+
+    {
+        TestRun t (results, "typeNearStart", 0);
+        typeIntoCodeDocument (doc, caret, numKeystrokes, false);
+        t.extraInfo = doc.getNumCharacters();
+    }
+
+    {
+        TestRun t (results, "deleteNearStart", 0);
+        typeIntoCodeDocument (doc, caret, numKeystrokes, true);
+        t.extraInfo = doc.getNumCharacters();
+    }
+
+    caret.setLineAndIndex (doc.getNumLines() - 10, 4);
+
+    {
+        TestRun t (results, "typeNearEnd", 0);
+        typeIntoCodeDocument (doc, caret, numKeystrokes, false);
+        t.extraInfo = doc.getNumCharacters();
+    }
+
+    {
+        TestRun t (results, "findPositions", 0);
+        Random rng (1);
+        int total = 0;
+
+        for (int i = 0; i < 100000; ++i)
+            total += CodeDocument::Position (&doc, rng.nextInt (doc.getNumCharacters())).getLineNumber();
+
+        t.extraInfo = total;
+    }
+
+    {
+        TestRun t (results, "undoAll", 0);
+
+        while (doc.getUndoManager().canUndo())
+            doc.undo();
+
+        t.extraInfo = doc.getNumCharacters();
+    }
+
+    {
+        TestRun t (results, "writeToStream", text.getNumBytesAsUTF8());
+        MemoryOutputStream out;
+        doc.writeToStream (out);
+        t.extraInfo = (int64) out.getDataSize();
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    // Lets the message thread deliver any results that an editor's background thread has posted
+    void runMessageLoopFor (const int milliseconds)
+    {
+       #if JUCE_MODAL_LOOPS_PERMITTED
+        MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+       #else
+        Thread::sleep (milliseconds);
+       #endif
+    }
+
+    void showEditorLine (CodeEditorComponent& editor, const int line)
+    {
+        editor.scrollToLine (line);
+        editor.handleUpdateNowIfNeeded();
+    }
+}
+
+var DataBenchmarks::runCodeEditorBenchmark (const int numThousandLines)
+{
+    const int idleMs = 10 * numThousandLines;
+    const int numEdits = 100;
+
+    var results (createObject());
+    setProperty (results, "numLines", numThousandLines * 1000);
+    setProperty (results, "idleMs", idleMs);
+    setProperty (results, "numEdits", numEdits);
+
+    CodeDocument doc;
+    doc.replaceAllContent (createCodeDocumentText (numThousandLines * 1000));
+    doc.clearUndoHistory();
+
+    CPlusPlusCodeTokeniser tokeniser;
+    ScopedPointer<CodeEditorComponent> editor;
+
+    {
+        TestRun t (results, "open", 0);
+        editor = new CodeEditorComponent (doc, &tokeniser);
+        editor->setSize (800, 600);
+        editor->handleUpdateNowIfNeeded();
+        t.extraInfo = editor->getNumLinesOnScreen();
+    }
+
+    {
+        TestRun t (results, "jumpToEnd", 0);
+        showEditorLine (*editor, doc.getNumLines());
+    }
+
+    runMessageLoopFor (idleMs);
+
+    {
+        TestRun t (results, "pageThroughDocument", 0);
+        int numPages = 0;
+
+        for (int line = 0; line < doc.getNumLines(); line += editor->getNumLinesOnScreen())
+        {
+            showEditorLine (*editor, line);
+            ++numPages;
+        }
+
+        t.extraInfo = numPages;
+    }
+
+    showEditorLine (*editor, 0);
+
+    {
+        TestRun t (results, "typeNearStartThenJumpToEnd", 0);
+
+        for (int i = 0; i < numEdits; ++i)
+        {
+            doc.insertText (CodeDocument::Position (&doc, 5, 4), "x");
+            editor->handleUpdateNowIfNeeded();
+            showEditorLine (*editor, doc.getNumLines());
+            showEditorLine (*editor, 0);
+        }
+    }
+
+    {
+        TestRun t (results, "openAndCloseComment", 0);
+
+        for (int i = 0; i < numEdits; ++i)
+        {
+            const CodeDocument::Position start (&doc, 5, 0);
+            doc.insertText (start, "/*");
+            editor->handleUpdateNowIfNeeded();
+            doc.deleteSection (start, start.movedBy (2));
+            editor->handleUpdateNowIfNeeded();
+        }
+    }
+
+    runMessageLoopFor (idleMs);
+
+    {
+        TestRun t (results, "jumpToEndAfterEdits", 0);
+        showEditorLine (*editor, doc.getNumLines());
+    }
+
+    editor = nullptr;
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    String createLogLine (Random& rng, const int index)
+    {
+        String line;
+        line << "2012-06-" << String (1 + index % 28).paddedLeft ('0', 2)
+             << " INFO [worker " << rng.nextInt (16) << "] request " << index
+             << " finished in " << rng.nextInt (1000) << "ms, status " << (200 + rng.nextInt (4) * 100) << "\n";
+        return line;
+    }
+
+    void paintTextEditor (TextEditor& editor, Image& image)
+    {
+        Graphics g (image);
+        editor.paintEntireComponent (g, true);
+    }
+}
+
+var DataBenchmarks::runTextEditorBenchmark (const int sizeInMB)
+{
+    const int64 logBytes = sizeInMB * (int64) 1024 * 1024;
+    const int linesPerAppend = 100;
+    const int numScrolls = 1000;
+
+    var results (createObject());
+    setProperty (results, "logBytes", logBytes);
+    setProperty (results, "linesPerAppend", linesPerAppend);
+    setProperty (results, "numScrolls", numScrolls);
+
+    TextEditor editor;
+    editor.setMultiLine (true, true);
+    editor.setReadOnly (true);
+    editor.setSize (800, 600);
+
+    Image image (Image::RGB, editor.getWidth(), editor.getHeight(), true);
+    Random rng (1);
+
+    {
+        TestRun t (results, "appendLines", logBytes);
+        int numLines = 0;
+
+        while (editor.getTotalNumChars() < logBytes)
+        {
+            String lines;
+
+            for (int i = 0; i < linesPerAppend; ++i)
+                lines << createLogLine (rng, numLines++);
+
+            editor.moveCaretToEnd();
+            editor.insertTextAtCaret (lines);
+        }
+
+        t.extraInfo = numLines;
+    }
+
+    {
+        TestRun t (results, "paintEnd", 0);
+        paintTextEditor (editor, image);
+    }
+
+    {
+        TestRun t (results, "scrollToRandomPositions", 0);
+        int total = 0;
+
+        for (int i = 0; i < numScrolls; ++i)
+        {
+            editor.setCaretPosition (rng.nextInt (editor.getTotalNumChars()));
+            total += editor.getCaretRectangle().getY();
+            paintTextEditor (editor, image);
+        }
+
+        t.extraInfo = total;
+    }
+
+    {
+        TestRun t (results, "findIndexAtPositions", 0);
+        int total = 0;
+
+        for (int i = 0; i < numScrolls; ++i)
+            total += editor.getTextIndexAt (rng.nextInt (editor.getWidth()), rng.nextInt (editor.getTextHeight()));
+
+        t.extraInfo = total;
+    }
+
+    {
+        TestRun t (results, "appendAndShowEnd", 0);
+
+        for (int i = 0; i < numScrolls; ++i)
+        {
+            editor.moveCaretToEnd();
+            editor.insertTextAtCaret (createLogLine (rng, i));
+            paintTextEditor (editor, image);
+        }
+
+        t.extraInfo = editor.getTotalNumChars();
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    class BenchmarkTreeItem  : public TreeViewItem
+    {
+    public:
+        BenchmarkTreeItem (const int index_) : index (index_) {}
+
+        bool mightContainSubItems()                 { return getNumSubItems() > 0; }
+        int getItemHeight() const                   { return 16 + (index % 3) * 4; }
+        int getItemWidth() const                    { return 100 + (index % 50); }
+
+        void paintItem (Graphics& g, int width, int height)
+        {
+            g.setColour ((index & 1) != 0 ? Colours::grey : Colours::darkgrey);
+            g.fillRect (0, 0, width, height);
+        }
+
+    private:
+        const int index;
+    };
+
+    void paintTreeView (TreeView& tree, Image& image)
+    {
+        Graphics g (image);
+        tree.paintEntireComponent (g, true);
+    }
+}
+
+var DataBenchmarks::runTreeViewBenchmark (const int numThousandItems)
+{
+    const int numItems = numThousandItems * 1000;
+    const int itemsPerGroup = 100;
+    const int numLookups = 100000;
+    const int numToggles = 1000;
+
+    var results (createObject());
+    setProperty (results, "numItems", numItems);
+    setProperty (results, "itemsPerGroup", itemsPerGroup);
+    setProperty (results, "numLookups", numLookups);
+    setProperty (results, "numToggles", numToggles);
+
+    TreeView tree;
+    tree.setSize (800, 600);
+    tree.setRootItemVisible (false);
+
+    Image image (Image::RGB, tree.getWidth(), tree.getHeight(), true);
+    Random rng (1);
+
+    BenchmarkTreeItem* const root = new BenchmarkTreeItem (0);
+    root->setOpen (true);
+
+    {
+        TestRun t (results, "buildAndShow", 0);
+
+        for (int i = 0; i < numItems; i += itemsPerGroup)
+        {
+            BenchmarkTreeItem* const group = new BenchmarkTreeItem (i);
+            root->addSubItem (group);
+
+            for (int j = 1; j < itemsPerGroup; ++j)
+                group->addSubItem (new BenchmarkTreeItem (i + j));
+
+            group->setOpen (true);
+        }
+
+        tree.setRootItem (root);
+        paintTreeView (tree, image);
+        t.extraInfo = tree.getNumRowsInTree();
+    }
+
+    Viewport* const viewport = tree.getViewport();
+
+    {
+        TestRun t (results, "pageThroughTree", 0);
+        const int contentHeight = viewport->getViewedComponent()->getHeight();
+        int numPages = 0;
+
+        for (int y = 0; y < contentHeight; y += viewport->getViewHeight())
+        {
+            viewport->setViewPosition (0, y);
+            paintTreeView (tree, image);
+            ++numPages;
+        }
+
+        t.extraInfo = numPages;
+    }
+
+    {
+        TestRun t (results, "scrollToRandomRows", 0);
+        const int numRows = tree.getNumRowsInTree();
+
+        for (int i = 0; i < numToggles; ++i)
+        {
+            tree.scrollToKeepItemVisible (tree.getItemOnRow (rng.nextInt (numRows)));
+            paintTreeView (tree, image);
+        }
+
+        t.extraInfo = viewport->getViewPositionY();
+    }
+
+    {
+        TestRun t (results, "rowLookups", 0);
+        const int numRows = tree.getNumRowsInTree();
+        int64 total = 0;
+
+        for (int i = 0; i < numLookups; ++i)
+            total += tree.getItemOnRow (rng.nextInt (numRows))->getRowNumberInTree();
+
+        t.extraInfo = total;
+    }
+
+    {
+        TestRun t (results, "itemPositions", 0);
+        int64 total = 0;
+
+        for (int i = 0; i < numLookups; ++i)
+            total += root->getSubItem (rng.nextInt (root->getNumSubItems()))->getItemPosition (false).getY();
+
+        t.extraInfo = total;
+    }
+
+    {
+        TestRun t (results, "openAndCloseGroups", 0);
+
+        for (int i = 0; i < numToggles; ++i)
+        {
+            TreeViewItem* const group = root->getSubItem (rng.nextInt (root->getNumSubItems()));
+            group->setOpen (! group->isOpen());
+            paintTreeView (tree, image);
+        }
+
+        t.extraInfo = tree.getNumRowsInTree();
+    }
+
+    tree.deleteRootItem();
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    class BenchmarkTableModel  : public TableListBoxModel
+    {
+    public:
+        BenchmarkTableModel (const int numRows_)
+            : numRows (numRows_), numCellComponentsCreated (0), numRowsPrefetched (0)
+        {
+        }
+
+        int getNumRows()                        { return numRows; }
+
+        void paintRowBackground (Graphics& g, int rowNumber, int, int, bool rowIsSelected)
+        {
+            g.fillAll (rowIsSelected ? Colours::lightblue : ((rowNumber & 1) != 0 ? Colours::white : Colours::lightgrey));
+        }
+
+        void paintCell (Graphics& g, int rowNumber, int columnId, int width, int height, bool)
+        {
+            g.setColour (Colours::black);
+            g.fillRect (2, 2, (rowNumber * columnId) % jmax (1, width - 4), height - 4);
+        }
+
+        Component* refreshComponentForCell (int rowNumber, int columnId, bool, Component* existingComponentToUpdate)
+        {
+            if (columnId % 4 != 0)
+            {
+                jassert (existingComponentToUpdate == nullptr);
+                return nullptr;
+            }
+
+            Label* label = dynamic_cast <Label*> (existingComponentToUpdate);
+
+            if (label == nullptr)
+            {
+                label = new Label();
+                ++numCellComponentsCreated;
+            }
+
+            label->setText (String (rowNumber), false);
+            return label;
+        }
+
+        void prefetchRows (int, int numRowsToPrefetch)
+        {
+            numRowsPrefetched += numRowsToPrefetch;
+        }
+
+        const int numRows;
+        int numCellComponentsCreated;
+        int64 numRowsPrefetched;
+    };
+
+    void paintTable (TableListBox& table, Image& image)
+    {
+        Graphics g (image);
+        table.paintEntireComponent (g, true);
+    }
+}
+
+var DataBenchmarks::runTableListBoxBenchmark (const int numThousandRows)
+{
+    const int numColumns = 16;
+    const int numSteps = 2000;
+    const int numLayoutChanges = 200;
+
+    var results (createObject());
+    setProperty (results, "numRows", numThousandRows * 1000);
+    setProperty (results, "numColumns", numColumns);
+    setProperty (results, "numSteps", numSteps);
+    setProperty (results, "numLayoutChanges", numLayoutChanges);
+
+    BenchmarkTableModel model (numThousandRows * 1000);
+    TableListBox table (String::empty, &model);
+    table.setVisible (true);
+    TableHeaderComponent& header = table.getHeader();
+    Viewport* const viewport = table.getViewport();
+
+    Image image (Image::RGB, 800, 600, true);
+    Random rng (1);
+
+    {
+        TestRun t (results, "open", 0);
+
+        for (int i = 1; i <= numColumns; ++i)
+            header.addColumn ("Column " + String (i), i, 60 + (i % 5) * 10);
+
+        table.setSize (800, 600);
+        table.updateContent();
+        paintTable (table, image);
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "scrollByRows", 0);
+
+        for (int i = 0; i < numSteps; ++i)
+            viewport->setViewPosition (0, viewport->getViewPositionY() + table.getRowHeight());
+
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "scrollByRowsAndPaint", 0);
+
+        for (int i = 0; i < numSteps; ++i)
+        {
+            viewport->setViewPosition (0, viewport->getViewPositionY() + table.getRowHeight());
+            paintTable (table, image);
+        }
+
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "jumpToRandomRows", 0);
+
+        for (int i = 0; i < numSteps; ++i)
+            table.setVerticalPosition (rng.nextDouble());
+
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "moveColumns", 0);
+
+        for (int i = 0; i < numLayoutChanges; ++i)
+        {
+            header.moveColumn (1 + rng.nextInt (numColumns), rng.nextInt (numColumns));
+            table.tableColumnsChanged (&header);
+        }
+
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "resizeTable", 0);
+
+        for (int i = 0; i < numLayoutChanges; ++i)
+        {
+            table.setSize (800, (i & 1) != 0 ? 600 : 200);
+        }
+
+        t.extraInfo = model.numCellComponentsCreated;
+    }
+
+    {
+        TestRun t (results, "findCells", 0);
+        int64 total = 0;
+
+        for (int i = 0; i < numSteps * 100; ++i)
+            total += header.getColumnIdAtX (rng.nextInt (header.getTotalWidth()))
+                      + table.getCellPosition (1 + rng.nextInt (numColumns), i, false).getX();
+
+        t.extraInfo = total;
+    }
+
+    setProperty (results, "numRowsPrefetched", model.numRowsPrefetched);
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Creates the given number of empty files in a folder, one in ten of them
+       with a .txt extension.
+    */
+    void createDirectoryScanTestFiles (const File& folder, const int firstIndex, const int numFiles)
+    {
+        folder.createDirectory();
+
+        for (int i = firstIndex; i < firstIndex + numFiles; ++i)
+            folder.getChildFile ("file" + String (i) + (i % 10 == 0 ? ".txt" : ".dat")).create();
+    }
+
+    int iterateDirectory (DirectoryIterator& iter, const bool getDetails)
+    {
+        int numFound = 0;
+        bool isDirectory, isHidden, isReadOnly;
+        int64 fileSize;
+        Time modTime, creationTime;
+
+        while (getDetails ? iter.next (&isDirectory, &isHidden, &fileSize, &modTime, &creationTime, &isReadOnly)
+                          : iter.next())
+            ++numFound;
+
+        return numFound;
+    }
+
+    void waitForContentsList (DirectoryContentsList& list, const bool untilFinished)
+    {
+        while (untilFinished ? list.isStillLoading() : (list.getNumFiles() == 0 && list.isStillLoading()))
+            Thread::sleep (1);
+    }
+}
+
+var DataBenchmarks::runDirectoryScanBenchmark (const int numThousandFiles)
+{
+    const int numFiles = numThousandFiles * 1000;
+    const int filesPerSubfolder = 100;
+
+    var results (createObject());
+    setProperty (results, "numFiles", numFiles);
+
+    const File tempFolder (File::createTempFile ("scanbenchmark"));
+    const File flatFolder (tempFolder.getChildFile ("flat"));
+    const File treeFolder (tempFolder.getChildFile ("tree"));
+
+    {
+        TestRun t (results, "createFiles", 0);
+        createDirectoryScanTestFiles (flatFolder, 0, numFiles);
+
+        // (the tree has the same number of files, in two levels of subfolders)
+        for (int i = 0; i < numFiles; i += filesPerSubfolder)
+            createDirectoryScanTestFiles (treeFolder.getChildFile ("group" + String (i / (filesPerSubfolder * 10)))
+                                                    .getChildFile ("folder" + String (i / filesPerSubfolder)),
+                                          i, filesPerSubfolder);
+    }
+
+    {
+        TestRun t (results, "iterate", 0);
+        DirectoryIterator iter (flatFolder, false);
+        t.extraInfo = iterateDirectory (iter, false);
+    }
+
+    {
+        TestRun t (results, "iterateWithDetails", 0);
+        DirectoryIterator iter (flatFolder, false);
+        t.extraInfo = iterateDirectory (iter, true);
+    }
+
+    {
+        TestRun t (results, "iterateWithWildcard", 0);
+        DirectoryIterator iter (flatFolder, false, "*.txt");
+        t.extraInfo = iterateDirectory (iter, false);
+    }
+
+    {
+        TimeSliceThread thread ("scanner");
+        thread.startThread();
+        DirectoryContentsList list (nullptr, thread);
+
+        {
+            TestRun t (results, "contentsListFirstFiles", 0);
+            list.setDirectory (flatFolder, true, true);
+            waitForContentsList (list, false);
+            t.extraInfo = list.getNumFiles();
+        }
+
+        {
+            TestRun t (results, "contentsListAllFiles", 0);
+            waitForContentsList (list, true);
+            t.extraInfo = list.getNumFiles();
+        }
+    }
+
+    {
+        TestRun t (results, "iterateTree", 0);
+        DirectoryIterator iter (treeFolder, true, "*.txt");
+        t.extraInfo = iterateDirectory (iter, false);
+    }
+
+    {
+        TestRun t (results, "iterateTreeWithDetails", 0);
+        DirectoryIterator iter (treeFolder, true);
+        t.extraInfo = iterateDirectory (iter, true);
+    }
+
+    const int numThreads = SystemStats::getNumCpus();
+    setProperty (results, "numThreads", numThreads);
+
+    {
+        ThreadPool pool (numThreads);
+        TestRun t (results, "iterateTreeParallel", 0);
+        DirectoryIterator iter (treeFolder, pool, "*.txt");
+        t.extraInfo = iterateDirectory (iter, false);
+    }
+
+    {
+        ThreadPool pool (numThreads);
+        TestRun t (results, "iterateTreeParallelWithDetails", 0);
+        DirectoryIterator iter (treeFolder, pool);
+        t.extraInfo = iterateDirectory (iter, true);
+    }
+
+    tempFolder.deleteRecursively();
+    return results;
+}
+
+var DataBenchmarks::runFileIndexBenchmark (const int numThousandFiles)
+{
+    const int numFiles = numThousandFiles * 1000;
+    const int filesPerSubfolder = 100;
+
+    var results (createObject());
+    setProperty (results, "numFiles", numFiles);
+
+    const File tempFolder (File::createTempFile ("indexbenchmark"));
+    const File treeFolder (tempFolder.getChildFile ("tree"));
+    const File snapshotFile (tempFolder.getChildFile ("snapshot"));
+
+    {
+        TestRun t (results, "createFiles", 0);
+
+        for (int i = 0; i < numFiles; i += filesPerSubfolder)
+            createDirectoryScanTestFiles (treeFolder.getChildFile ("group" + String (i / (filesPerSubfolder * 10)))
+                                                    .getChildFile ("folder" + String (i / filesPerSubfolder)),
+                                          i, filesPerSubfolder);
+    }
+
+    // (so that the folders aren't modified in the same second as they're scanned, which
+    // would make updateChangedDirectories() list them all again)
+    Thread::sleep (1100);
+
+    {
+        TestRun t (results, "iterateTreeWithWildcard", 0);
+        DirectoryIterator iter (treeFolder, true, "*.txt");
+        t.extraInfo = iterateDirectory (iter, false);
+    }
+
+    FileIndex index (treeFolder);
+
+    {
+        TestRun t (results, "rebuild", 0);
+        index.rebuild();
+        t.extraInfo = index.getNumFiles();
+    }
+
+    const int numThreads = SystemStats::getNumCpus();
+    setProperty (results, "numThreads", numThreads);
+
+    {
+        ThreadPool pool (numThreads);
+        TestRun t (results, "rebuildParallel", 0);
+        index.rebuild (&pool);
+        t.extraInfo = index.getNumFiles();
+    }
+
+    {
+        Array<File> found;
+        TestRun t (results, "findWildcard", 0);
+        t.extraInfo = index.findFiles (found, "*.txt");
+    }
+
+    {
+        Array<File> found;
+        TestRun t (results, "findWildcardMatchingCase", 0);
+        t.extraInfo = index.findFiles (found, "file1?0.txt", File::findFiles, false);
+    }
+
+    {
+        Array<File> found;
+        TestRun t (results, "findWildcardNoMatches", 0);
+        t.extraInfo = index.findFiles (found, "*.wav");
+    }
+
+    {
+        Array<File> found;
+        TestRun t (results, "findSubstring", 0);
+        t.extraInfo = index.findFilesContaining (found, "LE12");
+    }
+
+    {
+        Random r (1234);
+        int numFound = 0;
+        FileIndex::FileDetails details;
+
+        TestRun t (results, "getFileDetails10000Times", 0);
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            const int n = r.nextInt (jmax (1, numFiles));
+
+            if (index.getFileDetails (treeFolder.getChildFile ("group" + String (n / (filesPerSubfolder * 10)))
+                                                .getChildFile ("folder" + String (n / filesPerSubfolder))
+                                                .getChildFile ("file" + String (n) + (n % 10 == 0 ? ".txt" : ".dat")),
+                                      &details))
+                ++numFound;
+        }
+
+        t.extraInfo = numFound;
+    }
+
+    {
+        TestRun t (results, "saveSnapshot", 0);
+        index.saveSnapshot (snapshotFile);
+        t.extraInfo = snapshotFile.getSize();
+    }
+
+    {
+        FileIndex loadedIndex (treeFolder);
+
+        {
+            TestRun t (results, "loadSnapshot", snapshotFile.getSize());
+            loadedIndex.loadSnapshot (snapshotFile);
+            t.extraInfo = loadedIndex.getNumFiles();
+        }
+
+        {
+            TestRun t (results, "updateUnchangedDirectories", 0);
+            t.extraInfo = loadedIndex.updateChangedDirectories();
+        }
+    }
+
+    {
+        const bool allWatched = index.startWatching();
+        setProperty (results, "allFoldersWatched", allWatched);
+
+        // times how long it takes for a folder of new files to appear in the index
+        const File newFolder (treeFolder.getChildFile ("group0").getChildFile ("new"));
+        const int numFilesExpected = index.getNumFiles() + 101;
+
+        TestRun t (results, "watchNewFolderOf100Files", 0);
+        createDirectoryScanTestFiles (newFolder, numFiles, 100);
+
+        for (int i = 0; allWatched && i < 10000 && index.getNumFiles() < numFilesExpected; ++i)
+            Thread::sleep (1);
+
+        t.extraInfo = index.getNumFiles() - (numFilesExpected - 101);
+    }
+
+    index.stopWatching();
+    tempFolder.deleteRecursively();
+    return results;
+}
+
+//==============================================================================
+var DataBenchmarks::runJsonBenchmark (const int sizeInMB)
+{
+    const int64 bytesPerItem = JSON::toString (createJsonTestData (1)).getNumBytesAsUTF8();
+    const var data (createJsonTestData ((int) jmax ((int64) 1, sizeInMB * (int64) 1024 * 1024 / bytesPerItem)));
+    const String json (JSON::toString (data));
+    const int64 numBytes = json.getNumBytesAsUTF8();
+
+    var results (createObject());
+    setProperty (results, "documentBytes", numBytes);
+    setProperty (results, "numVars", countVars (data));
+
+    {
+        TestRun t (results, "toString", numBytes);
+        t.extraInfo = JSON::toString (data).length();
+    }
+
+    {
+        TestRun t (results, "toStringOneLine", numBytes);
+        t.extraInfo = JSON::toString (data, true).length();
+    }
+
+    const TemporaryFile temp (".json");
+    const File& file = temp.getFile();
+
+    {
+        TestRun t (results, "writeToFileStream", numBytes);
+        FileOutputStream out (file);
+        JSON::writeToStream (out, data);
+    }
+
+    {
+        TestRun t (results, "parseString", numBytes);
+        t.extraInfo = countVars (JSON::parse (json));
+    }
+
+    {
+        TestRun t (results, "parseFile", numBytes);
+        t.extraInfo = countVars (JSON::parse (file));
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Keeps the CPU busy for the given number of high-resolution ticks. */
+    void spinFor (const int64 numTicks) noexcept
+    {
+        const int64 endTime = Time::getHighResolutionTicks() + numTicks;
+
+        while (Time::getHighResolutionTicks() < endTime)
+        {}
+    }
+
+    class SpinJob  : public ThreadPoolJob
+    {
+    public:
+        SpinJob (const int64 numTicks_) : ThreadPoolJob ("spin"), numTicks (numTicks_) {}
+
+        JobStatus runJob()      { spinFor (numTicks); return jobHasFinished; }
+
+    private:
+        const int64 numTicks;
+    };
+
+    class SpinTask  : public ThreadPoolTask
+    {
+    public:
+        SpinTask (const int64 numTicks_) : numTicks (numTicks_) {}
+
+        void run()              { spinFor (numTicks); }
+
+    private:
+        const int64 numTicks;
+    };
+
+    class SpinBody  : public ThreadPool::ParallelForBody
+    {
+    public:
+        SpinBody (const int64 numTicks_) : numTicks (numTicks_) {}
+
+        void processRange (const int start, const int end)
+        {
+            for (int i = start; i < end; ++i)
+                spinFor (numTicks);
+        }
+
+    private:
+        const int64 numTicks;
+    };
+}
+
+var DataBenchmarks::runThreadPoolBenchmark (const int numHundredTasks)
+{
+    const int numThreads = SystemStats::getNumCpus();
+
+    var results (createObject());
+    setProperty (results, "numThreads", numThreads);
+
+    ThreadPool pool (numThreads);
+
+    for (int micros = 1; micros <= 1000; micros *= 10)
+    {
+        // (the 1ms tasks are only done a tenth as many times, to keep the run short)
+        const int numTasks = jmax (1, numHundredTasks * (micros < 1000 ? 100 : 10));
+        const int64 numTicks = jmax ((int64) 1, Time::getHighResolutionTicksPerSecond() * micros / 1000000);
+
+        var granularityResults (createObject());
+        setProperty (granularityResults, "numTasks", numTasks);
+        setProperty (granularityResults, "idealMs", numTasks * (double) micros / (1000.0 * numThreads));
+
+        {
+            // the old way: ThreadPoolJobs on the pool's shared, locked list
+            TestRun t (granularityResults, "jobs", 0);
+
+            for (int i = 0; i < numTasks; ++i)
+                pool.addJob (new SpinJob (numTicks), true);
+
+            while (pool.getNumJobs() > 0)
+                Thread::sleep (1);
+        }
+
+        {
+            TestRun t (granularityResults, "tasks", 0);
+            Array<ThreadPoolTask::Ptr> tasks;
+            tasks.ensureStorageAllocated (numTasks);
+
+            for (int i = 0; i < numTasks; ++i)
+                tasks.add (pool.addTask (new SpinTask (numTicks)));
+
+            for (int i = 0; i < numTasks; ++i)
+                tasks.getReference (i)->waitUntilFinished();
+        }
+
+        {
+            TestRun t (granularityResults, "parallelFor", 0);
+            SpinBody body (numTicks);
+            pool.parallelFor (0, numTasks, 1, body);
+        }
+
+        setProperty (results, String (micros) + "us", granularityResults);
+    }
+
+    return results;
+}
+
+//==============================================================================
+namespace
+{
+    /* Adds its own slice of a list of names to a StringPool. */
+    class StringPoolBenchmarkThread  : public Thread
+    {
+    public:
+        StringPoolBenchmarkThread (StringPool& pool_, const StringArray& names_)
+            : Thread ("string pool benchmark"), pool (pool_), names (names_)
+        {
+        }
+
+        void run()
+        {
+            for (int i = 0; i < names.size(); ++i)
+                pool.getPooledString (names[i]);
+        }
+
+    private:
+        StringPool& pool;
+        const StringArray& names;
+
+        JUCE_DECLARE_NON_COPYABLE (StringPoolBenchmarkThread);
+    };
+
+    void internFromThreads (StringPool& pool, const OwnedArray<StringArray>& namesForEachThread)
+    {
+        OwnedArray<StringPoolBenchmarkThread> threads;
+
+        for (int i = 0; i < namesForEachThread.size(); ++i)
+            threads.add (new StringPoolBenchmarkThread (pool, *namesForEachThread.getUnchecked (i)));
+
+        for (int i = 0; i < threads.size(); ++i)
+            threads.getUnchecked (i)->startThread();
+
+        for (int i = 0; i < threads.size(); ++i)
+            threads.getUnchecked (i)->waitForThreadToExit (-1);
+    }
+}
+
+var DataBenchmarks::runStringPoolBenchmark (const int numTenThousandNames)
+{
+    const int numThreads = 8;
+    const int numNames = numTenThousandNames * 10000;
+
+    var results (createObject());
+    setProperty (results, "numThreads", numThreads);
+    setProperty (results, "numNames", numNames);
+
+    OwnedArray<StringArray> namesForEachThread;
+
+    for (int i = 0; i < numThreads; ++i)
+        namesForEachThread.add (new StringArray());
+
+    for (int i = 0; i < numNames; ++i)
+        namesForEachThread.getUnchecked (i % numThreads)->add ("name" + String (i));
+
+    StringPool pool;
+
+    {
+        TestRun t (results, "internNewNames", 0);
+        internFromThreads (pool, namesForEachThread);
+        t.extraInfo = pool.size();
+    }
+
+    {
+        TestRun t (results, "internExistingNames", 0);
+        internFromThreads (pool, namesForEachThread);
+        t.extraInfo = pool.size();
+    }
+
+    return results;
+}
+
+//==============================================================================
+bool DataBenchmarks::isBenchmarkCommandLine (const String& commandLine)
+{
+    return commandLine.contains ("--data-benchmark=");
+}
+
+int DataBenchmarks::runFromCommandLine (const String& commandLine)
+{
+    StringArray args;
+    args.addTokens (commandLine, true);
+
+    String benchmarkName;
+    int size = 100;
+    File outputFile;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const String arg (args[i].unquoted());
+
+        if (arg.startsWith ("--data-benchmark="))   benchmarkName = arg.fromFirstOccurrenceOf ("=", false, false);
+        else if (arg.startsWith ("--size="))        size = arg.fromFirstOccurrenceOf ("=", false, false).getIntValue();
+        else if (arg.startsWith ("--output="))      outputFile = File::getCurrentWorkingDirectory()
+                                                                    .getChildFile (arg.fromFirstOccurrenceOf ("=", false, false));
+    }
+
+    var results;
+
+    if (size > 0)
+    {
+        if (benchmarkName == "xml")
+            results = runXmlBenchmark (size);
+        else if (benchmarkName == "json")
+            results = runJsonBenchmark (size);
+        else if (benchmarkName == "properties")
+            results = runPropertiesBenchmark (size);
+        else if (benchmarkName == "valuetree")
+            results = runValueTreeBenchmark (size);
+        else if (benchmarkName == "propertiesfile")
+            results = runPropertiesFileBenchmark (size);
+        else if (benchmarkName == "zip")
+            results = runZipBenchmark (size);
+        else if (benchmarkName == "gzip")
+            results = runGzipBenchmark (size);
+        else if (benchmarkName == "logger")
+            results = runLoggerBenchmark (size);
+        else if (benchmarkName == "biginteger")
+            results = runBigIntegerBenchmark (size);
+        else if (benchmarkName == "layout")
+            results = runLayoutBenchmark (size);
+        else if (benchmarkName == "codedocument")
+            results = runCodeDocumentBenchmark (size);
+        else if (benchmarkName == "codeeditor")
+            results = runCodeEditorBenchmark (size);
+        else if (benchmarkName == "texteditor")
+            results = runTextEditorBenchmark (size);
+        else if (benchmarkName == "treeview")
+            results = runTreeViewBenchmark (size);
+        else if (benchmarkName == "tablelistbox")
+            results = runTableListBoxBenchmark (size);
+        else if (benchmarkName == "directoryscan")
+            results = runDirectoryScanBenchmark (size);
+        else if (benchmarkName == "fileindex")
+            results = runFileIndexBenchmark (size);
+        else if (benchmarkName == "threadpool")
+            results = runThreadPoolBenchmark (size);
+        else if (benchmarkName == "stringpool")
+            results = runStringPoolBenchmark (size);
+    }
+
+    if (results.isVoid())
+    {
+        std::cerr << "Usage: --data-benchmark=xml|json|properties|valuetree|propertiesfile|zip|gzip|logger|biginteger|layout|codedocument|codeeditor|texteditor|treeview|tablelistbox|directoryscan|fileindex|threadpool|stringpool [--size=N] [--output=file.json]" << std::endl;
+        return 1;
+    }
+
+    const String json (JSON::toString (results));
+
+    if (outputFile == File::nonexistent)
+    {
+        std::cout << json << std::endl;
+    }
+    else if (! outputFile.replaceWithText (json))
+    {
+        std::cerr << "Couldn't write to " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
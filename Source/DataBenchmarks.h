@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    DataBenchmarks.h
+
+    Command-line benchmarks for the library's data-handling classes.
+
+  ==============================================================================
+*/
+
+#ifndef __DATABENCHMARKS_H_7E41B2C9__
+#define __DATABENCHMARKS_H_7E41B2C9__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    Headless benchmarks of the non-GUI classes - parsers, containers, file formats
+    and so on.
+
+    Each benchmark generates its own test data, times the operations it's
+    interested in, and returns the results as a var which can be written out
+    with JSON::toString().
+
+    The app runs these instead of opening its window if it's launched with
+    "--data-benchmark=name", e.g.
+    @code
+    JuceDirect2DS3 --data-benchmark=xml --size=100 --output=results.json
+    @endcode
+
+    The available benchmarks are:
+      - xml: parses a generated document of --size megabytes (default 100) with an
+        XmlPullParser and with XmlDocument, from a memory-mapped file, a file
+        stream and a String.
+      - json: builds a tree of vars whose JSON is about --size megabytes, and times
+        writing it as a String and to a file, and parsing it from a String and a file.
+      - properties: times getting, setting and iterating the values in NamedValueSets
+        and ValueTrees of 4 to 200 properties, doing --size million operations on
+        each one.
+      - valuetree: writes a generated ValueTree of about --size megabytes with
+        writeToStream() and writeToCompactStream(), then times loading it back with
+        readFromStream() and readFromCompactFile(), both to get a single node and to
+        visit the whole tree.
+      - propertiesfile: fills a PropertiesFile with --size thousand values, and for
+        each storage format, times saving all of them, saving after one change, both
+        synchronously and in the background, and loading the file.
+      - zip: builds a zip file of --size thousand small entries, compressing them with
+        one thread and with a thread per CPU, then times opening it, looking up every
+        entry by name, and reading all the entries with one thread and with a thread
+        per CPU.
+      - gzip: compresses --size megabytes of generated text as a single stream and as
+        1MB blocks (with one thread and with a thread per CPU), times decompressing each
+        of them, and times reading from random positions with and without seek points.
+      - logger: logs --size thousand messages from each of 16 threads to a FileLogger,
+        writing synchronously and on a background thread, and reports the number of
+        messages per second.
+      - biginteger: times --size multiplications and divisions, and a tenth as many
+        calls to exponentModulo(), with BigIntegers of 512, 1024, 2048 and 4096 bits.
+      - layout: positions a grid of 100 components with RelativeRectangles that refer
+        to the parent and to their neighbours, and times resizing the parent --size
+        times, and evaluating the coordinates --size times with and without compiling
+        them into Expression::Programs.
+      - codedocument: loads --size thousand lines into a CodeDocument, and times typing
+        and deleting characters near the start and end of it, finding the lines of
+        random positions, undoing all the edits and saving it.
+      - codeeditor: shows a CodeDocument of --size thousand lines in a C++
+        CodeEditorComponent, and times jumping to the end, paging through the whole
+        document, and typing near the start with the editor jumping between the start
+        and the end after each keystroke. The message loop runs for 10ms per thousand
+        lines between these, so that the editor's background work can finish.
+      - texteditor: appends log lines to a read-only, word-wrapped TextEditor until it
+        holds --size MB, then times painting it after moving the caret to random
+        positions, finding the characters at random points, and appending lines one
+        at a time while showing the end.
+      - treeview: fills a TreeView with --size thousand open items in groups of 100,
+        then times paging through it, scrolling to random rows, looking up items by
+        row and rows by item, finding their positions, and opening and closing groups.
+      - tablelistbox: shows a TableListBox of --size thousand rows and 16 columns, with
+        Labels in a quarter of its cells, and times scrolling it a row at a time (with
+        and without painting it), jumping to random rows, moving its columns, resizing it,
+        and finding cell positions.
+      - directoryscan: creates a folder of --size thousand files and a tree of folders
+        holding as many again, then times iterating through the folder with and without
+        the files' details and with a wildcard, loading it into a DirectoryContentsList,
+        and iterating through the tree with one thread and with a ThreadPool.
+      - fileindex: creates a tree of folders holding --size thousand files, and times
+        building a FileIndex of it (with one thread and with a ThreadPool), searching it
+        with wildcards and substrings, looking up files' details, saving and loading a
+        snapshot, and how long it takes for a new folder of files to appear in it while
+        it's being watched.
+      - threadpool: runs --size hundred tasks that each spin for 1us, 10us, 100us and
+        (a tenth as many) 1ms on a ThreadPool with a thread per CPU, as ThreadPoolJobs,
+        as ThreadPoolTasks and with parallelFor(), and times how long each takes to finish.
+      - stringpool: adds --size times 10000 different names (1M by default) to a
+        StringPool from 8 threads at once, each with its own share of them, and then
+        times adding them all again when they're already in the pool.
+*/
+class DataBenchmarks
+{
+public:
+    //==============================================================================
+    /** Returns true if the command line asks for one of these benchmarks. */
+    static bool isBenchmarkCommandLine (const String& commandLine);
+
+    /** Parses the command line, runs the benchmark, and writes out the results.
+        Returns a value that the app should use as its exit code.
+    */
+    static int runFromCommandLine (const String& commandLine);
+
+    //==============================================================================
+    /** Times XML parsing of a generated document of the given size. */
+    static var runXmlBenchmark (int sizeInMB);
+
+    /** Times JSON formatting and parsing of a generated tree of vars of the given size. */
+    static var runJsonBenchmark (int sizeInMB);
+
+    /** Times operations on NamedValueSets of various sizes. */
+    static var runPropertiesBenchmark (int numMillionOperations);
+
+    /** Times saving and loading a generated ValueTree of the given size. */
+    static var runValueTreeBenchmark (int sizeInMB);
+
+    /** Times saving and loading a PropertiesFile in each of its storage formats. */
+    static var runPropertiesFileBenchmark (int numThousandValues);
+
+    /** Times looking up and reading the entries in a generated zip file. */
+    static var runZipBenchmark (int numThousandEntries);
+
+    /** Times compressing and decompressing generated data with the GZIP streams. */
+    static var runGzipBenchmark (int sizeInMB);
+
+    /** Times logging from many threads at once to a FileLogger. */
+    static var runLoggerBenchmark (int numThousandMessagesPerThread);
+
+    /** Times BigInteger arithmetic with numbers of various sizes. */
+    static var runBigIntegerBenchmark (int numOperations);
+
+    /** Times laying out components whose bounds are RelativeRectangles. */
+    static var runLayoutBenchmark (int numResizes);
+
+    /** Times loading and editing a large CodeDocument. */
+    static var runCodeDocumentBenchmark (int numThousandLines);
+
+    /** Times scrolling and editing a large document in a CodeEditorComponent. */
+    static var runCodeEditorBenchmark (int numThousandLines);
+
+    /** Times appending to and scrolling through a large log in a TextEditor. */
+    static var runTextEditorBenchmark (int sizeInMB);
+
+    /** Times scrolling through and looking up the items in a large TreeView. */
+    static var runTreeViewBenchmark (int numThousandItems);
+
+    /** Times scrolling through and rearranging a large TableListBox. */
+    static var runTableListBoxBenchmark (int numThousandRows);
+
+    /** Times scanning a large folder and a tree of folders for files. */
+    static var runDirectoryScanBenchmark (int numThousandFiles);
+
+    /** Times building and searching a FileIndex of a large tree of folders. */
+    static var runFileIndexBenchmark (int numThousandFiles);
+
+    /** Times running lots of small jobs and tasks on a ThreadPool. */
+    static var runThreadPoolBenchmark (int numHundredTasks);
+
+    /** Times adding lots of names to a StringPool from several threads at once. */
+    static var runStringPoolBenchmark (int numTenThousandNames);
+
+private:
+    DataBenchmarks();
+};
+
+
+#endif  // __DATABENCHMARKS_H_7E41B2C9__
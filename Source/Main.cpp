@@ -10,6 +10,8 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainWindow.h"
+#include "RendererBenchmark.h"
+#include "DataBenchmarks.h"
 
 
 //==============================================================================
@@ -29,6 +31,20 @@ public:
     void initialise (const String& commandLine)
     {
         // Do your application's initialisation code here..
+        if (RendererBenchmark::isBenchmarkCommandLine (commandLine))
+        {
+            setApplicationReturnValue (RendererBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+
+        if (DataBenchmarks::isBenchmarkCommandLine (commandLine))
+        {
+            setApplicationReturnValue (DataBenchmarks::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+
         mainWindow = new MainAppWindow();
     }
 
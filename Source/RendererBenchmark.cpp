@@ -0,0 +1,511 @@
+/*
+  ==============================================================================
+
+    RendererBenchmark.cpp
+
+    Renders the WindowComponent test scene offscreen with the software
+    renderer and reports how long it took.
+
+  ==============================================================================
+*/
+
+#include "RendererBenchmark.h"
+#include "WindowComponent.h"
+
+#if JUCE_WINDOWS
+ #define NOMINMAX 1
+ #define NOGDI 1
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment (lib, "psapi.lib")
+#else
+ #include <sys/resource.h>
+#endif
+
+
+//==============================================================================
+/** Passes everything on to a software renderer, timing each of the drawing calls. */
+class RendererBenchmark::ProfilingContext  : public LowLevelGraphicsContext
+{
+public:
+    enum PrimitiveType
+    {
+        fillRectPrimitive = 0,
+        fillPathPrimitive,
+        drawImagePrimitive,
+        drawGlyphPrimitive,
+        drawLinePrimitive,
+        drawTextLayoutPrimitive,
+        clipPrimitive,
+        saveRestorePrimitive,
+        transparencyLayerPrimitive,
+        numPrimitiveTypes
+    };
+
+    ProfilingContext (const Image& image)
+        : renderer (image)
+    {
+        zeromem (counts, sizeof (counts));
+        zeromem (ticks, sizeof (ticks));
+    }
+
+    static const char* getPrimitiveName (const int type) noexcept
+    {
+        static const char* const names[] = { "fillRect", "fillPath", "drawImage", "drawGlyph", "drawLine",
+                                             "drawTextLayout", "clip", "saveRestoreState", "transparencyLayer" };
+        return names [type];
+    }
+
+    int64 getCount (const int type) const noexcept      { return counts [type]; }
+    double getTimeMs (const int type) const noexcept    { return Time::highResolutionTicksToSeconds (ticks [type]) * 1000.0; }
+
+    //==============================================================================
+    bool isVectorDevice() const                                         { return false; }
+    void setOrigin (int x, int y)                                       { renderer.setOrigin (x, y); }
+    void addTransform (const AffineTransform& t)                        { renderer.addTransform (t); }
+    float getScaleFactor()                                              { return renderer.getScaleFactor(); }
+
+    bool clipToRectangle (const Rectangle<int>& r)                      { const ScopedTimer t (*this, clipPrimitive); return renderer.clipToRectangle (r); }
+    bool clipToRectangleList (const RectangleList& r)                   { const ScopedTimer t (*this, clipPrimitive); return renderer.clipToRectangleList (r); }
+    void excludeClipRectangle (const Rectangle<int>& r)                 { const ScopedTimer t (*this, clipPrimitive); renderer.excludeClipRectangle (r); }
+    void clipToPath (const Path& p, const AffineTransform& t2)          { const ScopedTimer t (*this, clipPrimitive); renderer.clipToPath (p, t2); }
+    void clipToImageAlpha (const Image& i, const AffineTransform& t2)   { const ScopedTimer t (*this, clipPrimitive); renderer.clipToImageAlpha (i, t2); }
+
+    bool clipRegionIntersects (const Rectangle<int>& r)                 { return renderer.clipRegionIntersects (r); }
+    Rectangle<int> getClipBounds() const                                { return renderer.getClipBounds(); }
+    bool isClipEmpty() const                                            { return renderer.isClipEmpty(); }
+
+    void saveState()                                                    { const ScopedTimer t (*this, saveRestorePrimitive); renderer.saveState(); }
+    void restoreState()                                                 { const ScopedTimer t (*this, saveRestorePrimitive); renderer.restoreState(); }
+
+    void beginTransparencyLayer (float opacity)                         { const ScopedTimer t (*this, transparencyLayerPrimitive); renderer.beginTransparencyLayer (opacity); }
+    void endTransparencyLayer()                                         { const ScopedTimer t (*this, transparencyLayerPrimitive); renderer.endTransparencyLayer(); }
+
+    void setFill (const FillType& f)                                    { renderer.setFill (f); }
+    void setOpacity (float newOpacity)                                  { renderer.setOpacity (newOpacity); }
+    void setInterpolationQuality (Graphics::ResamplingQuality q)        { renderer.setInterpolationQuality (q); }
+
+    void fillRect (const Rectangle<int>& r, bool replace)               { const ScopedTimer t (*this, fillRectPrimitive); renderer.fillRect (r, replace); }
+    void fillPath (const Path& p, const AffineTransform& t2)            { const ScopedTimer t (*this, fillPathPrimitive); renderer.fillPath (p, t2); }
+    void drawImage (const Image& i, const AffineTransform& t2)          { const ScopedTimer t (*this, drawImagePrimitive); renderer.drawImage (i, t2); }
+
+    void drawLine (const Line <float>& l)                               { const ScopedTimer t (*this, drawLinePrimitive); renderer.drawLine (l); }
+    void drawVerticalLine (int x, float top, float bottom)              { const ScopedTimer t (*this, drawLinePrimitive); renderer.drawVerticalLine (x, top, bottom); }
+    void drawHorizontalLine (int y, float left, float right)            { const ScopedTimer t (*this, drawLinePrimitive); renderer.drawHorizontalLine (y, left, right); }
+
+    void setFont (const Font& f)                                        { renderer.setFont (f); }
+    const Font& getFont()                                               { return renderer.getFont(); }
+    void drawGlyph (int glyphNumber, const AffineTransform& t2)         { const ScopedTimer t (*this, drawGlyphPrimitive); renderer.drawGlyph (glyphNumber, t2); }
+
+    bool drawTextLayout (const AttributedString& s, const Rectangle<float>& area)
+    {
+        const ScopedTimer t (*this, drawTextLayoutPrimitive);
+        return renderer.drawTextLayout (s, area);
+    }
+
+private:
+    LowLevelGraphicsSoftwareRenderer renderer;
+    int64 counts [numPrimitiveTypes];
+    int64 ticks [numPrimitiveTypes];
+
+    struct ScopedTimer
+    {
+        ScopedTimer (ProfilingContext& owner_, const int type_) noexcept
+            : owner (owner_), type (type_), start (Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            ++owner.counts [type];
+            owner.ticks [type] += Time::getHighResolutionTicks() - start;
+        }
+
+        ProfilingContext& owner;
+        const int type;
+        const int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer);
+    };
+
+    JUCE_DECLARE_NON_COPYABLE (ProfilingContext);
+};
+
+//==============================================================================
+namespace
+{
+    var createObject()
+    {
+        return var (new DynamicObject());
+    }
+
+    void setProperty (const var& object, const Identifier& name, const var& value)
+    {
+        object.getDynamicObject()->setProperty (name, value);
+    }
+
+    var createTimingSummary (Array<double>& timesMs)
+    {
+        var summary (createObject());
+
+        if (timesMs.size() > 0)
+        {
+            DefaultElementComparator<double> sorter;
+            timesMs.sort (sorter);
+
+            double total = 0;
+            for (int i = 0; i < timesMs.size(); ++i)
+                total += timesMs.getUnchecked (i);
+
+            setProperty (summary, "count",  timesMs.size());
+            setProperty (summary, "min",    timesMs.getFirst());
+            setProperty (summary, "mean",   total / timesMs.size());
+            setProperty (summary, "median", timesMs [timesMs.size() / 2]);
+            setProperty (summary, "p95",    timesMs [(timesMs.size() * 95) / 100]);
+            setProperty (summary, "max",    timesMs.getLast());
+            setProperty (summary, "total",  total);
+        }
+
+        return summary;
+    }
+
+    var getGlyphCacheState()
+    {
+        const LowLevelGraphicsSoftwareRenderer::GlyphCacheStatistics stats
+            = LowLevelGraphicsSoftwareRenderer::getGlyphCacheStatistics();
+
+        var result (createObject());
+        setProperty (result, "slots",  stats.numGlyphSlots);
+        setProperty (result, "hits",   stats.numHits);
+        setProperty (result, "misses", stats.numMisses);
+        return result;
+    }
+
+    int64 getPeakResidentMemoryKB()
+    {
+       #if JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters = { 0 };
+        counters.cb = sizeof (counters);
+
+        if (GetProcessMemoryInfo (GetCurrentProcess(), &counters, sizeof (counters)))
+            return (int64) counters.PeakWorkingSetSize / 1024;
+
+        return -1;
+       #else
+        struct rusage usage;
+
+        if (getrusage (RUSAGE_SELF, &usage) != 0)
+            return -1;
+
+        #if JUCE_MAC
+         return (int64) usage.ru_maxrss / 1024; // (this is in bytes on the Mac, but KB elsewhere)
+        #else
+         return (int64) usage.ru_maxrss;
+        #endif
+       #endif
+    }
+}
+
+//==============================================================================
+/*  A parent with a big grid of small opaque children, each of which just fills
+    itself with a colour. Painting this goes through all the save/restore and clip
+    operations that Component::paintComponentAndChildren does for each child, but
+    draws nothing that should need any memory.
+*/
+class RendererBenchmark::ComponentGrid  : public Component
+{
+public:
+    ComponentGrid (const int numColumns, const int numRows, const int width, const int height)
+    {
+        setOpaque (true);
+        setSize (width, height);
+
+        for (int y = 0; y < numRows; ++y)
+        {
+            for (int x = 0; x < numColumns; ++x)
+            {
+                SolidComponent* const c = new SolidComponent (Colour::fromHSV ((x + y * numColumns) / (float) (numColumns * numRows),
+                                                                               0.6f, 0.8f, 1.0f));
+                c->setBounds (x * width / numColumns, y * height / numRows,
+                              width / numColumns, height / numRows);
+                addAndMakeVisible (c);
+                children.add (c);
+            }
+        }
+    }
+
+    void paint (Graphics& g)
+    {
+        g.fillAll (Colours::black);
+    }
+
+private:
+    class SolidComponent  : public Component
+    {
+    public:
+        SolidComponent (const Colour& colour_) : colour (colour_)   { setOpaque (true); }
+
+        void paint (Graphics& g)
+        {
+            g.setColour (colour);
+            g.fillRect (2, 2, getWidth() - 4, getHeight() - 4);
+        }
+
+    private:
+        const Colour colour;
+
+        JUCE_DECLARE_NON_COPYABLE (SolidComponent);
+    };
+
+    OwnedArray<Component> children;
+
+    JUCE_DECLARE_NON_COPYABLE (ComponentGrid);
+};
+
+//==============================================================================
+RendererBenchmark::RendererBenchmark (const int numFrames_, const int width_, const int height_)
+    : numFrames (jmax (1, numFrames_)),
+      width (width_),
+      height (height_)
+{
+}
+
+RendererBenchmark::~RendererBenchmark()
+{
+}
+
+var RendererBenchmark::run()
+{
+    WindowComponent scene;
+    scene.setSize (width, height);
+
+    Image image (Image::RGB, width, height, true, SoftwareImageType());
+    ProfilingContext context (image);
+
+    // paint one frame first so that fonts, images and the glyph cache are warmed up
+    {
+        LowLevelGraphicsSoftwareRenderer warmUpRenderer (image);
+        Graphics g (&warmUpRenderer);
+        scene.paintEntireComponent (g, true);
+    }
+
+    const var glyphCacheBefore (getGlyphCacheState());
+
+    const bool profilerWasEnabled = PaintProfiler::isEnabled();
+    PaintProfiler::clear();
+    PaintProfiler::setEnabled (true);
+
+    Array<double> frameTimes, componentTimes;
+    Array<int64> frameAllocations;
+    StringArray componentTypes;
+    Array<PaintProfiler::Event> events;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const int64 allocationsBefore = AllocationHooks::getNumAllocations();
+        const int64 start = Time::getHighResolutionTicks();
+
+        {
+            context.saveState();
+            Graphics g (&context);
+            scene.paintEntireComponent (g, true);
+            context.restoreState();
+        }
+
+        const int64 end = Time::getHighResolutionTicks();
+        frameAllocations.add (AllocationHooks::getNumAllocations() - allocationsBefore);
+        frameTimes.add (Time::highResolutionTicksToSeconds (end - start) * 1000.0);
+
+        // the profiler's event buffer is drained every frame so that it can't overflow
+        events.clearQuick();
+        PaintProfiler::readEvents (events);
+
+        for (int j = 0; j < events.size(); ++j)
+        {
+            const PaintProfiler::Event& e = events.getReference (j);
+
+            if (e.depth == 1)
+            {
+                const String type (e.getDescription().upToFirstOccurrenceOf (" ", false, false));
+                int index = componentTypes.indexOf (type);
+
+                if (index < 0)
+                {
+                    index = componentTypes.size();
+                    componentTypes.add (type);
+                    componentTimes.add (0.0);
+                }
+
+                componentTimes.getReference (index) += e.getDurationMs();
+            }
+        }
+    }
+
+    PaintProfiler::setEnabled (profilerWasEnabled);
+
+    //==============================================================================
+    var results (createObject());
+    setProperty (results, "renderer", "LowLevelGraphicsSoftwareRenderer");
+    setProperty (results, "width", width);
+    setProperty (results, "height", height);
+    setProperty (results, "frames", numFrames);
+    setProperty (results, "frameTimeMs", createTimingSummary (frameTimes));
+
+    var primitives (createObject());
+
+    for (int i = 0; i < ProfilingContext::numPrimitiveTypes; ++i)
+    {
+        var primitive (createObject());
+        setProperty (primitive, "calls", context.getCount (i));
+        setProperty (primitive, "totalMs", context.getTimeMs (i));
+        setProperty (primitive, "msPerFrame", context.getTimeMs (i) / numFrames);
+        setProperty (primitives, ProfilingContext::getPrimitiveName (i), primitive);
+    }
+
+    setProperty (results, "primitives", primitives);
+
+    var components (createObject());
+
+    for (int i = 0; i < componentTypes.size(); ++i)
+        setProperty (components, componentTypes[i], componentTimes.getUnchecked (i) / numFrames);
+
+    setProperty (results, "componentMsPerFrame", components);
+
+    int64 totalAllocations = 0;
+    for (int i = 0; i < frameAllocations.size(); ++i)
+        totalAllocations += frameAllocations.getUnchecked (i);
+
+    if (AllocationHooks::isEnabled())
+    {
+        var allocations (createObject());
+        setProperty (allocations, "total", totalAllocations);
+        setProperty (allocations, "perFrame", totalAllocations / (double) numFrames);
+        setProperty (results, "allocations", allocations);
+    }
+
+    setProperty (results, "peakResidentMemoryKB", getPeakResidentMemoryKB());
+
+    var glyphCache (createObject());
+    setProperty (glyphCache, "before", glyphCacheBefore);
+    setProperty (glyphCache, "after", getGlyphCacheState());
+    setProperty (results, "glyphCache", glyphCache);
+
+    setProperty (results, "componentGrid", runComponentGrid());
+
+    return results;
+}
+
+var RendererBenchmark::runComponentGrid()
+{
+    const int numColumns = 40, numRows = 25;
+    ComponentGrid grid (numColumns, numRows, width, height);
+
+    Image image (Image::RGB, width, height, true, SoftwareImageType());
+    LowLevelGraphicsSoftwareRenderer renderer (image);
+
+    Array<double> frameTimes;
+    frameTimes.ensureStorageAllocated (numFrames);
+    int64 steadyStateAllocations = 0;
+
+    // The first frame is allowed to allocate, while the renderer builds up its
+    // saved-state stack and clip regions - after that, it should be able to re-use them.
+    for (int i = -1; i < numFrames; ++i)
+    {
+        const int64 allocationsBefore = AllocationHooks::getNumAllocations();
+        const int64 start = Time::getHighResolutionTicks();
+
+        {
+            renderer.saveState();
+            Graphics g (&renderer);
+            grid.paintEntireComponent (g, true);
+            renderer.restoreState();
+        }
+
+        const int64 end = Time::getHighResolutionTicks();
+
+        if (i >= 0)
+        {
+            steadyStateAllocations += AllocationHooks::getNumAllocations() - allocationsBefore;
+            frameTimes.add (Time::highResolutionTicksToSeconds (end - start) * 1000.0);
+        }
+    }
+
+    var results (createObject());
+    setProperty (results, "components", grid.getNumChildComponents());
+    setProperty (results, "frameTimeMs", createTimingSummary (frameTimes));
+
+    if (AllocationHooks::isEnabled())
+        setProperty (results, "allocationsPerFrame", steadyStateAllocations / (double) numFrames);
+
+    return results;
+}
+
+//==============================================================================
+bool RendererBenchmark::isBenchmarkCommandLine (const String& commandLine)
+{
+    StringArray args;
+    args.addTokens (commandLine, true);
+    return args.contains ("--benchmark");
+}
+
+int RendererBenchmark::runFromCommandLine (const String& commandLine)
+{
+    StringArray args;
+    args.addTokens (commandLine, true);
+
+    int frames = 200, width = 870, height = 660;
+    bool checkAllocations = false;
+    File outputFile;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const String arg (args[i].unquoted());
+
+        if (arg.startsWith ("--frames="))       frames = arg.fromFirstOccurrenceOf ("=", false, false).getIntValue();
+        else if (arg.startsWith ("--width="))   width  = arg.fromFirstOccurrenceOf ("=", false, false).getIntValue();
+        else if (arg.startsWith ("--height="))  height = arg.fromFirstOccurrenceOf ("=", false, false).getIntValue();
+        else if (arg.startsWith ("--output="))  outputFile = File::getCurrentWorkingDirectory()
+                                                                .getChildFile (arg.fromFirstOccurrenceOf ("=", false, false));
+        else if (arg == "--check-allocations")  checkAllocations = true;
+    }
+
+    if (frames <= 0 || width <= 0 || height <= 0)
+    {
+        std::cerr << "Usage: --benchmark [--frames=N] [--width=W] [--height=H] [--output=file.json] [--check-allocations]" << std::endl;
+        return 1;
+    }
+
+    if (checkAllocations && ! AllocationHooks::isEnabled())
+    {
+        std::cerr << "--check-allocations needs a build with JUCE_ENABLE_ALLOCATION_HOOKS turned on" << std::endl;
+        return 1;
+    }
+
+    RendererBenchmark benchmark (frames, width, height);
+    const var results (benchmark.run());
+    const String json (JSON::toString (results));
+
+    if (outputFile == File::nonexistent)
+    {
+        std::cout << json << std::endl;
+    }
+    else if (! outputFile.replaceWithText (json))
+    {
+        std::cerr << "Couldn't write to " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (checkAllocations)
+    {
+        const double allocationsPerFrame = results ["componentGrid"]["allocationsPerFrame"];
+
+        if (allocationsPerFrame != 0)
+        {
+            std::cerr << "Painting the component grid made " << allocationsPerFrame
+                      << " heap allocations per frame - expected none" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
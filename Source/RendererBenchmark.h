@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    RendererBenchmark.h
+
+    Renders the WindowComponent test scene offscreen with the software
+    renderer and reports how long it took.
+
+  ==============================================================================
+*/
+
+#ifndef __RENDERERBENCHMARK_H_5C0A3F21__
+#define __RENDERERBENCHMARK_H_5C0A3F21__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    A headless benchmark of the software renderer.
+
+    This paints the same WindowComponent scene that the app shows into an
+    offscreen Image through a LowLevelGraphicsSoftwareRenderer, a given number
+    of times, and collects:
+      - the time taken by each frame,
+      - the time and call count for each kind of drawing primitive,
+      - the time spent painting each type of component,
+      - the number of heap allocations made (if JUCE_ENABLE_ALLOCATION_HOOKS is
+        turned on), and the process's peak memory use,
+      - the software renderer's glyph cache statistics.
+
+    It also paints a grid of 1000 plain child components, to check how many heap
+    allocations the renderer makes once it's warmed up (which should be none).
+
+    The results are returned as a var which can be written out with JSON::toString().
+
+    The app runs this instead of opening its window if it's launched with
+    "--benchmark", e.g.
+    @code
+    JuceDirect2DS3 --benchmark --frames=500 --output=results.json
+    @endcode
+
+    Adding "--check-allocations" makes the exit code non-zero if the component grid
+    made any allocations. Allocations can only be counted in a build that has
+    JUCE_ENABLE_ALLOCATION_HOOKS turned on - see AllocationHooks.
+*/
+class RendererBenchmark
+{
+public:
+    //==============================================================================
+    RendererBenchmark (int numFramesToRender, int width, int height);
+    ~RendererBenchmark();
+
+    /** Renders all the frames and returns the results as a JSON-style object. */
+    var run();
+
+    //==============================================================================
+    /** Returns true if the command line asks for a benchmark run. */
+    static bool isBenchmarkCommandLine (const String& commandLine);
+
+    /** Parses the command line, runs the benchmark, and writes out the results.
+        Returns a value that the app should use as its exit code.
+    */
+    static int runFromCommandLine (const String& commandLine);
+
+private:
+    //==============================================================================
+    class ProfilingContext;
+    class ComponentGrid;
+
+    var runComponentGrid();
+
+    const int numFrames, width, height;
+
+    JUCE_DECLARE_NON_COPYABLE (RendererBenchmark);
+};
+
+
+#endif  // __RENDERERBENCHMARK_H_5C0A3F21__